@@ -0,0 +1,302 @@
+/**
+	@file
+	@brief Glyph map cache file: the glyph-to-Unicode maps built by earlier print jobs, shared read-only by all the driver instances
+*/
+
+/*
+ * CC PDF Converter: Windows PDF Printer with Creative Commons license support
+ * Excel to PDF Converter: Excel PDF printing addin, keeping hyperlinks AND Creative Commons license support
+ * Copyright (C) 2007-2010 Guy Hachlili <hguy@cogniview.com>, Cogniview LTD.
+ * 
+ * This file is part of CC PDF Converter / Excel to PDF Converter
+ * 
+ * CC PDF Converter and Excel to PDF Converter are free software;
+ * you can redistribute them and/or modify them under the terms of the 
+ * GNU General Public License as published by the Free Software Foundation;
+ * either version 2 of the License, or (at your option) any later version.
+ * 
+ * CC PDF Converter and Excel to PDF Converter are is distributed in the hope 
+ * that they will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. * 
+ */
+
+#include "precomp.h"
+#include "debug.h"
+#include "GlyphMapFile.h"
+#include <shlobj.h>
+#include <sddl.h>
+
+/**
+*/
+GlyphMapFile::GlyphMapFile() : m_hFile(INVALID_HANDLE_VALUE), m_hMapping(NULL), m_pView(NULL), m_dwSize(0)
+{
+}
+
+/**
+	@return The full path of the glyph map cache file (in the printing user's own folder), or an empty string if the folder can't be created
+*/
+std::tstring GlyphMapFile::GetDefaultPath()
+{
+	// Rendering runs impersonating the printing user, so that's whose folder is used (and not the spooler's)
+	HANDLE hToken;
+	if (!::OpenThreadToken(::GetCurrentThread(), TOKEN_QUERY|TOKEN_IMPERSONATE, TRUE, &hToken) && 
+		!::OpenProcessToken(::GetCurrentProcess(), TOKEN_QUERY|TOKEN_IMPERSONATE, &hToken))
+		return _T("");
+	std::tstring sFolder;
+	TCHAR cPath[MAX_PATH + 1];
+	if (SUCCEEDED(::SHGetFolderPath(NULL, CSIDL_LOCAL_APPDATA|CSIDL_FLAG_CREATE, hToken, SHGFP_TYPE_CURRENT, cPath)))
+	{
+		sFolder = std::tstring(cPath) + _T("\\") GLYPHMAP_FOLDER_NAME;
+		if (!CreateFolder(sFolder.c_str(), hToken))
+		{
+			TRACE(DLLTEXT("Could not create the glyph map cache folder\r\n"));
+			sFolder.erase();
+		}
+	}
+	::CloseHandle(hToken);
+	if (sFolder.empty())
+		return _T("");
+	return sFolder + _T("\\") GLYPHMAP_FILE_NAME;
+}
+
+/**
+	@param lpFolder The folder's full path
+	@param hToken The printing user's token
+	@return true if the folder was created or already exists, false if failed
+*/
+bool GlyphMapFile::CreateFolder(LPCTSTR lpFolder, HANDLE hToken)
+{
+	// Get the user's SID for the folder's access list
+	DWORD dwSize = 0;
+	::GetTokenInformation(hToken, TokenUser, NULL, 0, &dwSize);
+	if (dwSize == 0)
+		return false;
+	std::vector<BYTE> arUser(dwSize);
+	LPTSTR lpSID;
+	if (!::GetTokenInformation(hToken, TokenUser, &arUser[0], dwSize, &dwSize) || !::ConvertSidToStringSid(((TOKEN_USER*)&arUser[0])->User.Sid, &lpSID))
+		return false;
+
+	// Full access for the system, administrators and the user, and none (not even inherited) for anyone 
+	// else; an existing folder is in the user's profile, so only these could have created it
+	TCHAR cDescriptor[256];
+	_stprintf_s(cDescriptor, _S(cDescriptor), _T("D:P(A;OICI;FA;;;SY)(A;OICI;FA;;;BA)(A;OICI;FA;;;%s)"), lpSID);
+	::LocalFree(lpSID);
+	SECURITY_ATTRIBUTES sa = {sizeof(sa), NULL, FALSE};
+	if (!::ConvertStringSecurityDescriptorToSecurityDescriptor(cDescriptor, SDDL_REVISION_1, &sa.lpSecurityDescriptor, NULL))
+		return false;
+	bool bRet = ::CreateDirectory(lpFolder, &sa) || (::GetLastError() == ERROR_ALREADY_EXISTS);
+	::LocalFree(sa.lpSecurityDescriptor);
+	return bRet;
+}
+
+/**
+	@param lpFilename The file's full path
+	@return true if the file was mapped, false if it's missing or not a valid glyph map cache file
+*/
+bool GlyphMapFile::Open(LPCTSTR lpFilename)
+{
+	Close();
+	if ((lpFilename == NULL) || (*lpFilename == '\0'))
+		return false;
+
+	// Share delete access, so a new file can be moved over this one while it's mapped
+	m_hFile = ::CreateFile(lpFilename, GENERIC_READ, FILE_SHARE_READ|FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (m_hFile == INVALID_HANDLE_VALUE)
+		return false;
+	m_dwSize = ::GetFileSize(m_hFile, NULL);
+	if ((m_dwSize == INVALID_FILE_SIZE) || (m_dwSize < sizeof(Header)))
+	{
+		Close();
+		return false;
+	}
+	m_hMapping = ::CreateFileMapping(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (m_hMapping != NULL)
+		m_pView = (const BYTE*)::MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (m_pView == NULL)
+	{
+		Close();
+		return false;
+	}
+
+	// Check it's a file we can use
+	const Header* pHeader = (const Header*)m_pView;
+	if ((pHeader->dwMagic != GLYPHMAP_FILE_MAGIC) || (pHeader->dwVersion != GLYPHMAP_FILE_VERSION) || (pHeader->dwCharSize != sizeof(WCHAR)) || 
+		(pHeader->dwSize != m_dwSize) || (pHeader->dwFonts > GLYPHMAP_MAX_FONTS) || (sizeof(Header) + pHeader->dwFonts * sizeof(Font) > m_dwSize))
+	{
+		TRACE(DLLTEXT("Glyph map cache file is not valid, ignored\r\n"));
+		Close();
+		return false;
+	}
+	return true;
+}
+
+/**
+*/
+void GlyphMapFile::Close()
+{
+	if (m_pView != NULL)
+	{
+		::UnmapViewOfFile(m_pView);
+		m_pView = NULL;
+	}
+	if (m_hMapping != NULL)
+	{
+		::CloseHandle(m_hMapping);
+		m_hMapping = NULL;
+	}
+	if (m_hFile != INVALID_HANDLE_VALUE)
+	{
+		::CloseHandle(m_hFile);
+		m_hFile = INVALID_HANDLE_VALUE;
+	}
+	m_dwSize = 0;
+}
+
+/**
+	@param font The font (in the file's font table)
+	@param[out] arPages Receives the font's pages in the view (NULL for pages without glyphs)
+	@return true if the font's pages are all in the file, false if the file is damaged
+*/
+bool GlyphMapFile::GetPages(const Font& font, const WCHAR* arPages[256]) const
+{
+	// Each offset is checked against the file size before the table's or page's size is, so nothing wraps around
+	if ((font.dwPageTable % sizeof(DWORD) != 0) || (font.dwPageTable > m_dwSize) || (m_dwSize - font.dwPageTable < 256 * sizeof(DWORD)))
+		return false;
+	const DWORD* pPageTable = (const DWORD*)(m_pView + font.dwPageTable);
+	for (int i = 0; i < 256; i++)
+	{
+		DWORD dwOffset = pPageTable[i];
+		if (dwOffset == 0)
+			arPages[i] = NULL;
+		else if ((dwOffset % sizeof(DWORD) == 0) && (dwOffset <= m_dwSize) && (m_dwSize - dwOffset >= 256 * sizeof(WCHAR)))
+			arPages[i] = (const WCHAR*)(m_pView + dwOffset);
+		else
+			return false;
+	}
+	return true;
+}
+
+/**
+	@param key The font's description
+	@param stamp The font's version
+	@param[out] map Receives the font's map (using the pages in the view, which must stay open while it's used)
+	@return true if found, false if the file doesn't have this version of the font
+*/
+bool GlyphMapFile::Find(const GlyphFontKey& key, const GlyphFontStamp& stamp, GlyphToText& map) const
+{
+	if (m_pView == NULL)
+		return false;
+
+	const Font* pFonts = GetFonts();
+	DWORD dwFonts = ((const Header*)m_pView)->dwFonts;
+	for (DWORD n = 0; n < dwFonts; n++)
+		if ((pFonts[n].key == key) && (pFonts[n].stamp == stamp))
+		{
+			const WCHAR* arPages[256];
+			if (!GetPages(pFonts[n], arPages))
+				return false;
+			map.Attach(arPages, pFonts[n].dwCount);
+			return true;
+		}
+	return false;
+}
+
+/**
+	@param lpFilename The file's full path
+	@param arNew The maps to add (they replace this file's maps of the same fonts)
+	@return true if written, false if failed
+	@note This file is closed once the new one is written, so the maps found in it can't be used after this
+*/
+bool GlyphMapFile::Save(LPCTSTR lpFilename, const std::vector<GlyphMapRecord>& arNew)
+{
+	if ((lpFilename == NULL) || (*lpFilename == '\0'))
+		return false;
+	std::tstring sFolder(lpFilename);
+	std::tstring::size_type nPos = sFolder.find_last_of(_T("\\/"));
+	if (nPos == std::tstring::npos)
+		return false;
+	sFolder.erase(nPos + 1);
+
+	// Collect the fonts to write: the new ones first, then the ones already in the file
+	std::vector<Font> arFonts;
+	std::vector<const WCHAR*> arPages;
+	const WCHAR* arFontPages[256];
+	for (std::vector<GlyphMapRecord>::const_iterator i = arNew.begin(); (i != arNew.end()) && (arFonts.size() < GLYPHMAP_MAX_FONTS); i++)
+	{
+		Font font = {(*i).key, (*i).stamp, (*i).pMap->size(), 0};
+		arFonts.push_back(font);
+		for (int n = 0; n < 256; n++)
+			arPages.push_back((*i).pMap->GetPage(n));
+	}
+	if (m_pView != NULL)
+	{
+		const Font* pFonts = GetFonts();
+		DWORD dwFonts = ((const Header*)m_pView)->dwFonts;
+		for (DWORD n = 0; (n < dwFonts) && (arFonts.size() < GLYPHMAP_MAX_FONTS); n++)
+		{
+			// Older versions of the new fonts are dropped
+			std::vector<GlyphMapRecord>::const_iterator i = arNew.begin();
+			while ((i != arNew.end()) && !((*i).key == pFonts[n].key))
+				i++;
+			if ((i != arNew.end()) || !GetPages(pFonts[n], arFontPages))
+				continue;
+			arFonts.push_back(pFonts[n]);
+			arPages.insert(arPages.end(), arFontPages, arFontPages + 256);
+		}
+	}
+
+	// Lay the file out: the header, the font table, and each font's page table followed by its pages
+	Header header = {GLYPHMAP_FILE_MAGIC, GLYPHMAP_FILE_VERSION, sizeof(WCHAR), (DWORD)arFonts.size(), 0};
+	std::vector<DWORD> arPageTables(arFonts.size() * 256);
+	DWORD dwOffset = (DWORD)(sizeof(Header) + arFonts.size() * sizeof(Font));
+	for (UINT nFont = 0; nFont < arFonts.size(); nFont++)
+	{
+		arFonts[nFont].dwPageTable = dwOffset;
+		dwOffset += 256 * sizeof(DWORD);
+		for (int n = 0; n < 256; n++)
+			if (arPages[nFont * 256 + n] != NULL)
+			{
+				arPageTables[nFont * 256 + n] = dwOffset;
+				dwOffset += 256 * sizeof(WCHAR);
+			}
+	}
+	header.dwSize = dwOffset;
+
+	// Write it under a unique name in the same folder (other jobs may be saving too), and move it over 
+	// the old file once complete
+	TCHAR cTempName[MAX_PATH + 1];
+	if (::GetTempFileName(sFolder.c_str(), _T("CGM"), 0, cTempName) == 0)
+		return false;
+	FILE* pFile;
+	if (0 != _tfopen_s(&pFile, cTempName, _T("wb")))
+	{
+		_tunlink(cTempName);
+		return false;
+	}
+	bool bRet = (fwrite(&header, sizeof(header), 1, pFile) == 1);
+	if (bRet && !arFonts.empty())
+		bRet = (fwrite(&arFonts[0], sizeof(Font), arFonts.size(), pFile) == arFonts.size());
+	for (UINT nFont = 0; bRet && (nFont < arFonts.size()); nFont++)
+	{
+		bRet = (fwrite(&arPageTables[nFont * 256], sizeof(DWORD), 256, pFile) == 256);
+		for (int n = 0; bRet && (n < 256); n++)
+			if (arPages[nFont * 256 + n] != NULL)
+				bRet = (fwrite(arPages[nFont * 256 + n], sizeof(WCHAR), 256, pFile) == 256);
+	}
+	if (fclose(pFile) != 0)
+		bRet = false;
+
+	// The pages written came from the view, so it's only unmapped now; it must be before the file it 
+	// maps is replaced
+	Close();
+	if (!bRet || !::MoveFileEx(cTempName, lpFilename, MOVEFILE_REPLACE_EXISTING))
+	{
+		_tunlink(cTempName);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,134 @@
+/**
+	@file
+	@brief Glyph map cache file: the glyph-to-Unicode maps built by earlier print jobs, shared read-only by all the driver instances
+*/
+
+/*
+ * CC PDF Converter: Windows PDF Printer with Creative Commons license support
+ * Excel to PDF Converter: Excel PDF printing addin, keeping hyperlinks AND Creative Commons license support
+ * Copyright (C) 2007-2010 Guy Hachlili <hguy@cogniview.com>, Cogniview LTD.
+ * 
+ * This file is part of CC PDF Converter / Excel to PDF Converter
+ * 
+ * CC PDF Converter and Excel to PDF Converter are free software;
+ * you can redistribute them and/or modify them under the terms of the 
+ * GNU General Public License as published by the Free Software Foundation;
+ * either version 2 of the License, or (at your option) any later version.
+ * 
+ * CC PDF Converter and Excel to PDF Converter are is distributed in the hope 
+ * that they will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. * 
+ */
+
+#ifndef _GLYPHMAPFILE_H_
+#define _GLYPHMAPFILE_H_
+
+#include "GlyphTranslator.h"
+
+/// Name of the folder of the glyph map cache file (in the printing user's local application data folder)
+#define GLYPHMAP_FOLDER_NAME	_T("CC PDF Converter")
+/// Name of the glyph map cache file
+#define GLYPHMAP_FILE_NAME		_T("CCPDFGlyphMaps.dat")
+/// Glyph map cache file identifier ("CCGM")
+#define GLYPHMAP_FILE_MAGIC		0x4D474343
+/// Glyph map cache file format version
+#define GLYPHMAP_FILE_VERSION	1
+/// Maximum number of fonts kept in the glyph map cache file
+#define GLYPHMAP_MAX_FONTS		256
+
+/**
+    @brief The glyph map cache file, mapped into memory
+
+	The file holds the glyph maps of up to GLYPHMAP_MAX_FONTS fonts, each kept by its description and 
+	the version of its font file, so a map is never used for a font that was updated. A header is 
+	followed by the font table; each font has a table of 256 page offsets (0 for pages without 
+	glyphs), and its pages of 256 letters each, so the maps found in the file use the pages right 
+	where they are in the view (see GlyphToText::Attach()).
+
+	The file is never changed once written: new maps are saved by writing a new file (with the 
+	current maps it has) and moving it over the old one, so driver instances that have the old one
+	mapped keep using it safely. It's kept in a folder of the printing user's own, which only that 
+	user, the system and administrators can write to, so nobody else can plant maps in it.
+*/
+class GlyphMapFile
+{
+public:
+	// Ctors
+	/// Default constructor
+	GlyphMapFile();
+	/// Destructor: unmaps the file
+	~GlyphMapFile() {Close();};
+
+protected:
+	/// File header
+	struct Header
+	{
+		/// File identifier (GLYPHMAP_FILE_MAGIC)
+		DWORD			dwMagic;
+		/// Format version (GLYPHMAP_FILE_VERSION)
+		DWORD			dwVersion;
+		/// Size of a letter (the file is only used by drivers built with the same WCHAR)
+		DWORD			dwCharSize;
+		/// Number of fonts in the font table (which follows the header)
+		DWORD			dwFonts;
+		/// Size of the file
+		DWORD			dwSize;
+	};
+	/// Font table entry
+	struct Font
+	{
+		/// The font's description
+		GlyphFontKey	key;
+		/// The font's version
+		GlyphFontStamp	stamp;
+		/// Number of glyphs in the map
+		DWORD			dwCount;
+		/// Offset of the font's page table (256 offsets of pages, 0 for pages without glyphs)
+		DWORD			dwPageTable;
+	};
+
+	// Members
+	/// Handle to the file
+	HANDLE				m_hFile;
+	/// Handle to the file mapping
+	HANDLE				m_hMapping;
+	/// The file's view (NULL if not open)
+	const BYTE*			m_pView;
+	/// Size of the file
+	DWORD				m_dwSize;
+
+public:
+	// Data Access
+	/**
+		@brief Checks if the file is open
+		@return true if the file is mapped
+	*/
+	bool	IsOpen() const {return m_pView != NULL;};
+	/// Returns the glyph map cache file's location
+	static std::tstring GetDefaultPath();
+
+	// Methods
+	/// Maps the file into memory
+	bool	Open(LPCTSTR lpFilename);
+	/// Unmaps the file
+	void	Close();
+	/// Finds a font's map in the file
+	bool	Find(const GlyphFontKey& key, const GlyphFontStamp& stamp, GlyphToText& map) const;
+	/// Writes a new file with new maps and this file's, and closes this one
+	bool	Save(LPCTSTR lpFilename, const std::vector<GlyphMapRecord>& arNew);
+
+protected:
+	// Helpers
+	/// Returns the file's font table
+	const Font*	GetFonts() const {return (const Font*)(m_pView + sizeof(Header));};
+	/// Gets the pages of a font in the file
+	bool	GetPages(const Font& font, const WCHAR* arPages[256]) const;
+	/// Creates the glyph map cache file's folder, with access for the user only
+	static bool	CreateFolder(LPCTSTR lpFolder, HANDLE hToken);
+};
+
+#endif   //#define _GLYPHMAPFILE_H_
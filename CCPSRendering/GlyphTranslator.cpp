@@ -28,65 +28,285 @@
 #include "debug.h"
 #include "oemps.h"
 #include "GlyphTranslator.h"
+#include "GlyphMapFile.h"
+#include "TrueTypeCmap.h"
+#ifndef URWMAPGEN
+// (Not when building urwmapgen, which makes it)
+#include "URWGlyphMaps.h"
+#endif
+
+/// The shared page of unknown glyphs
+const WCHAR GlyphToText::s_arUnknownPage[256] =
+{
+#define UNKNOWN_16	GLYPH_UNKNOWN, GLYPH_UNKNOWN, GLYPH_UNKNOWN, GLYPH_UNKNOWN, GLYPH_UNKNOWN, GLYPH_UNKNOWN, GLYPH_UNKNOWN, GLYPH_UNKNOWN, \
+					GLYPH_UNKNOWN, GLYPH_UNKNOWN, GLYPH_UNKNOWN, GLYPH_UNKNOWN, GLYPH_UNKNOWN, GLYPH_UNKNOWN, GLYPH_UNKNOWN, GLYPH_UNKNOWN
+	UNKNOWN_16, UNKNOWN_16, UNKNOWN_16, UNKNOWN_16, UNKNOWN_16, UNKNOWN_16, UNKNOWN_16, UNKNOWN_16,
+	UNKNOWN_16, UNKNOWN_16, UNKNOWN_16, UNKNOWN_16, UNKNOWN_16, UNKNOWN_16, UNKNOWN_16, UNKNOWN_16
+#undef UNKNOWN_16
+};
 
 /**
-	@param lf Font description
-	@param hDC Handle to the DC to use for translation
+*/
+GlyphToText::GlyphToText() : m_nCount(0), m_bBorrowed(false)
+{
+	for (int i = 0; i < 256; i++)
+		m_arPages[i] = (WCHAR*)s_arUnknownPage;
+}
+
+/**
+	@param other The map to copy
+*/
+GlyphToText::GlyphToText(const GlyphToText& other) : m_nCount(0), m_bBorrowed(false)
+{
+	for (int i = 0; i < 256; i++)
+		m_arPages[i] = (WCHAR*)s_arUnknownPage;
+	*this = other;
+}
+
+/**
+	@param other The map to copy (if its pages are borrowed, the copy still owns its own)
+	@return Reference to this object
+*/
+GlyphToText& GlyphToText::operator=(const GlyphToText& other)
+{
+	if (&other == this)
+		return *this;
+	clear();
+	for (int i = 0; i < 256; i++)
+		if (other.m_arPages[i] != s_arUnknownPage)
+		{
+			m_arPages[i] = new WCHAR[256];
+			memcpy(m_arPages[i], other.m_arPages[i], 256 * sizeof(WCHAR));
+		}
+	m_nCount = other.m_nCount;
+	return *this;
+}
+
+/**
+*/
+void GlyphToText::clear()
+{
+	for (int i = 0; i < 256; i++)
+		if (m_arPages[i] != s_arUnknownPage)
+		{
+			if (!m_bBorrowed)
+				delete [] m_arPages[i];
+			m_arPages[i] = (WCHAR*)s_arUnknownPage;
+		}
+	m_nCount = 0;
+	m_bBorrowed = false;
+}
+
+/**
+	@param arPages The pages (NULL for pages without glyphs); they must stay valid (and unchanged) while the map uses them
+	@param nCount Number of glyphs in the pages
+*/
+void GlyphToText::Attach(const WCHAR* const arPages[256], UINT nCount)
+{
+	clear();
+	for (int i = 0; i < 256; i++)
+		if (arPages[i] != NULL)
+			m_arPages[i] = (WCHAR*)arPages[i];
+	m_nCount = nCount;
+	m_bBorrowed = true;
+}
+
+/**
+*/
+void GlyphToText::MakeOwn()
+{
+	if (!m_bBorrowed)
+		return;
+	for (int i = 0; i < 256; i++)
+		if (m_arPages[i] != s_arUnknownPage)
+		{
+			WCHAR* pPage = new WCHAR[256];
+			memcpy(pPage, m_arPages[i], 256 * sizeof(WCHAR));
+			m_arPages[i] = pPage;
+		}
+	m_bBorrowed = false;
+}
+
+/**
+	@param wGlyph The glyph index
+	@param cLetter The glyph's letter (a glyph can show more than one character; the first one added is kept)
+*/
+void GlyphToText::Add(WORD wGlyph, WCHAR cLetter)
+{
+	MakeOwn();
+	WCHAR*& pPage = m_arPages[wGlyph >> 8];
+	if (pPage == s_arUnknownPage)
+	{
+		pPage = new WCHAR[256];
+		memcpy(pPage, s_arUnknownPage, sizeof(s_arUnknownPage));
+	}
+	WCHAR& c = pPage[wGlyph & 0xFF];
+	if ((c != GLYPH_UNKNOWN) || (cLetter == GLYPH_UNKNOWN))
+		return;
+	c = cLetter;
+	m_nCount++;
+}
+
+/**
+	@param pGlyphs The glyphs to translate
+	@param nCount Number of glyphs
+	@param[out] pLetters Buffer for the letters (unknown glyphs become GLYPH_UNKNOWN)
+*/
+void GlyphToText::TranslateRun(const WCHAR* pGlyphs, UINT nCount, WCHAR* pLetters) const
+{
+	// No tests in the loop: glyphs without a page read the shared unknown page
+	for (UINT n = 0; n < nCount; n++)
+	{
+		WORD wGlyph = (WORD)pGlyphs[n];
+		pLetters[n] = m_arPages[wGlyph >> 8][wGlyph & 0xFF];
+	}
+}
+
+/**
+	@param hDC Handle to the DC to use for translation, with the font selected into it
 	@return true if the map was populated successfully, false if failed
 */
-bool GlyphToText::Initialize(const LOGFONT& lf, HDC hDC)
+bool GlyphToText::Initialize(HDC hDC)
 {
-	// Get a matching font from Windows
-	HFONT hFont = ::CreateFontIndirect(&lf);
-	if (hFont == NULL)
-		// Dah! Not found!
-		return false;
+	// TrueType fonts: invert the character map table in one pass
+	DWORD dwCmapSize = ::GetFontData(hDC, GLYPH_TABLE_CMAP, 0, NULL, 0);
+	if ((dwCmapSize != GDI_ERROR) && (dwCmapSize > 0))
+	{
+		std::vector<BYTE> arCmap(dwCmapSize);
+		if ((::GetFontData(hDC, GLYPH_TABLE_CMAP, 0, &arCmap[0], dwCmapSize) == dwCmapSize) && TrueTypeCmap::ReadGlyphMap(&arCmap[0], dwCmapSize, *this))
+			return true;
+		// No usable Unicode subtable (e.g. a symbol font): let GDI translate instead
+		clear();
+	}
 
 	// Get range of characters in the font
-	HGDIOBJ hOldFont = ::SelectObject(hDC, hFont);
 	DWORD dwSize = ::GetFontUnicodeRanges(hDC, NULL);
 	if (dwSize == 0)
-	{
 		// None - nothing to add
-		::SelectObject(hDC, hOldFont);
 		return true;
-	}
 
 	// Create a translation set and get it
 	LPGLYPHSET pSet = (LPGLYPHSET)new char[dwSize];
 	::GetFontUnicodeRanges(hDC, pSet);
 
-	// Go over the set:
-	WORD dwGlyphs[1];
-	TCHAR c[1];
-	int nCount = 0;
+	// Go over the set, one range at a time
+	std::vector<WCHAR> arChars;
+	std::vector<WORD> arGlyphs;
 	for (UINT i=0;i<pSet->cRanges;i++)
 	{
-		// For each range
-		for (UINT u=0;u<pSet->ranges[i].cGlyphs;u++)
+		// Put the range's characters in a buffer
+		UINT nCount = pSet->ranges[i].cGlyphs;
+		if (nCount == 0)
+			continue;
+		arChars.resize(nCount);
+		arGlyphs.resize(nCount);
+		for (UINT u=0;u<nCount;u++)
+			arChars[u] = pSet->ranges[i].wcLow + u;
+		// And retrieve the glyphs for them
+		if (::GetGlyphIndices(hDC, &arChars[0], nCount, &arGlyphs[0], GGI_MARK_NONEXISTING_GLYPHS) != nCount)
 		{
-			// Put the glyph in a buffer
-			c[0] = pSet->ranges[i].wcLow + u;
-			// And retrieve the character for it
-			if (::GetGlyphIndices(hDC, c, 1, (LPWORD)&dwGlyphs, GGI_MARK_NONEXISTING_GLYPHS) != 1)
-			{
-				// Cannot get it, fail
-				delete [] pSet;
-				::SelectObject(hDC, hOldFont);
-				return false;
-			}
-			// OK, replace it if not already there (there can be two glyphs for the same character)
-			if (find(dwGlyphs[0]) == end())
-				operator[](dwGlyphs[0]) = c[0];
+			// Cannot get it, fail
+			delete [] pSet;
+			return false;
 		}
+		// OK, add them if not already there (there can be two glyphs for the same character)
+		for (UINT u=0;u<nCount;u++)
+			if (arGlyphs[u] != 0xFFFF)
+				Add(arGlyphs[u], arChars[u]);
 	}
 
 	// OK, this is it
 	delete [] pSet;
-	::SelectObject(hDC, hOldFont);
 	return true;
 }
 
+/**
+	@param lf The font's description
+*/
+GlyphFontKey::GlyphFontKey(const LOGFONT& lf)
+{
+	// The whole key is cleared first, so keys compare, hash and save by value
+	memset(this, 0, sizeof(GlyphFontKey));
+	for (int i = 0; (i < LF_FACESIZE) && (lf.lfFaceName[i] != 0); i++)
+		cFace[i] = lf.lfFaceName[i];
+	lHeight = lf.lfHeight;
+	lWeight = lf.lfWeight;
+	cStyle = (lf.lfItalic ? 1 : 0) | (lf.lfUnderline ? 2 : 0) | (lf.lfStrikeOut ? 4 : 0);
+	cPitchAndFamily = lf.lfPitchAndFamily;
+}
+
+/**
+	@param key The font description
+	@return The description's hash (FNV-1a)
+*/
+size_t GlyphFontKeyHash::operator()(const GlyphFontKey& key) const
+{
+	UINT uHash = 2166136261U;
+	for (int i = 0; (i < LF_FACESIZE) && (key.cFace[i] != 0); i++)
+		uHash = (uHash ^ (UINT)key.cFace[i]) * 16777619U;
+	uHash = (uHash ^ (UINT)key.lHeight) * 16777619U;
+	uHash = (uHash ^ (UINT)key.lWeight) * 16777619U;
+	uHash = (uHash ^ (key.cStyle | (key.cPitchAndFamily << 8))) * 16777619U;
+	return uHash;
+}
+
+/**
+*/
+GlyphTranslator::GlyphTranslator() : m_pFile(NULL)
+{
+	memset(m_arCache, 0, sizeof(m_arCache));
+}
+
+/**
+*/
+GlyphTranslator::~GlyphTranslator()
+{
+	// The maps may use the file's pages, so they go first
+	m_arBuilt.clear();
+	m_mapFonts.clear();
+	if (m_pFile != NULL)
+		delete m_pFile;
+}
+
+/**
+	@param id The font's identity
+	@param[out] pMap Receives the font's map (NULL if the font can't be translated), if found
+	@return true if the font was found in the identity cache, false if it must be looked up by its description
+*/
+bool GlyphTranslator::FindFont(const GlyphFontID& id, const GlyphToText*& pMap) const
+{
+	if (id.iUniq == 0)
+		return false;
+	const CacheEntry& entry = m_arCache[CacheIndex(id)];
+	if (!(entry.id == id))
+		return false;
+	pMap = entry.pMap;
+	return true;
+}
+
+/**
+	@param id The font's identity (if its iUniq is 0, the map isn't cached by it)
+	@param lf The font's description
+	@param hDC Handle to the DC to use for translation (if NULL, uses the default screen DC)
+	@return A pointer to the translation map (NULL if cannot traslate this font)
+*/
+const GlyphToText* GlyphTranslator::GetFontTranslation(const GlyphFontID& id, const LOGFONT& lf, HDC hDC /* = NULL */)
+{
+	const GlyphToText* pMap;
+	if (FindFont(id, pMap))
+		return pMap;
+
+	pMap = GetFontTranslation(lf, hDC);
+	if (id.iUniq != 0)
+	{
+		// Cached even if the font can't be translated, so it isn't tried again for every page
+		CacheEntry& entry = m_arCache[CacheIndex(id)];
+		entry.id = id;
+		entry.pMap = pMap;
+	}
+	return pMap;
+}
+
 /**
 	@param lf Font description
 	@param hDC Handle to the DC to use for translation (if NULL, uses the default screen DC)
@@ -95,31 +315,130 @@ bool GlyphToText::Initialize(const LOGFONT& lf, HDC hDC)
 const GlyphToText* GlyphTranslator::GetFontTranslation(const LOGFONT& lf, HDC hDC /* = NULL */)
 {
 	// Check out if we have this font cached
-	TCHAR cFontID[LF_FACESIZE + 128];
-	_stprintf_s(cFontID, _S(cFontID), _T("%.*s|%d|%d|%d|%d|%d"), LF_FACESIZE, lf.lfFaceName, lf.lfHeight, lf.lfWeight, (lf.lfItalic ? 1 : 0) | (lf.lfUnderline ? 2 : 0) | (lf.lfStrikeOut ? 4 : 0), lf.lfPitchAndFamily);
-	iterator iGlyphData;
+	GlyphFontKey key(lf);
+	std::unordered_map<GlyphFontKey, GlyphToText, GlyphFontKeyHash>::iterator iGlyphData = m_mapFonts.find(key);
+	if (iGlyphData != m_mapFonts.end())
+		return &((*iGlyphData).second);
 
-	if ((iGlyphData = find(cFontID)) == end())
+	// Nope, so get a matching font from Windows
+	HDC hUseDC = (hDC == NULL) ? GetDC(NULL) : hDC;
+	if (hUseDC == NULL)
+		return NULL;
+	HFONT hFont = ::CreateFontIndirect(&lf);
+	if (hFont == NULL)
 	{
-		// Nope, so add an empty translation map
-		insert(std::pair<std::tstring, GlyphToText>(cFontID, GlyphToText()));
-		iGlyphData = find(cFontID);
-		_ASSERT(iGlyphData != end());
-		// And initialize it for the font
-		HDC hUseDC = (hDC == NULL) ? GetDC(NULL) : hDC;
-		if (hUseDC == NULL)
-			return NULL;
-		bool bRet = !(*iGlyphData).second.Initialize(lf, hUseDC);
+		// Dah! Not found!
 		if (hUseDC != hDC)
 			DeleteDC(hUseDC);
-		if (!bRet)
+		return NULL;
+	}
+	HGDIOBJ hOldFont = ::SelectObject(hUseDC, hFont);
+
+	// Add an empty translation map, and fill it from the built-in maps if this is a bundled font, or
+	// from the glyph map cache file if it has this version of the font
+	iGlyphData = m_mapFonts.insert(std::make_pair(key, GlyphToText())).first;
+	GlyphToText& map = (*iGlyphData).second;
+	GlyphMapRecord record = {key, {0, 0, 0, 0}, &map};
+	bool bStamp = GetFontStamp(hUseDC, record.stamp), bRet = true;
+	bool bFound = bStamp && FindBuiltInMap(key, record.stamp, map);
+	if (!bFound && bStamp)
+	{
+		if (m_pFile == NULL)
 		{
-			// Cannot, so fail
-			erase(iGlyphData);
-			return NULL;
+			m_pFile = new GlyphMapFile;
+			m_pFile->Open(GlyphMapFile::GetDefaultPath().c_str());
 		}
+		bFound = m_pFile->Find(key, record.stamp, map);
+	}
+	if (!bFound)
+	{
+		// Not there, so read it from the font (and save it later, if the font has a version)
+		bRet = map.Initialize(hUseDC);
+		if (bRet && bStamp)
+			m_arBuilt.push_back(record);
+	}
+
+	::SelectObject(hUseDC, hOldFont);
+	::DeleteObject(hFont);
+	if (hUseDC != hDC)
+		DeleteDC(hUseDC);
+	if (!bRet)
+	{
+		// Cannot, so fail
+		m_mapFonts.erase(iGlyphData);
+		return NULL;
 	}
 
 	// OK, found it
-	return &((*iGlyphData).second);
+	return &map;
+}
+
+/**
+	@note Saving closes the glyph map cache file, so the maps found so far are dropped
+*/
+void GlyphTranslator::SaveMaps()
+{
+	if ((m_pFile == NULL) || m_arBuilt.empty())
+		return;
+	if (!m_pFile->Save(GlyphMapFile::GetDefaultPath().c_str(), m_arBuilt))
+		TRACE(DLLTEXT("Could not save the glyph map cache file\r\n"));
+	m_arBuilt.clear();
+	if (!m_pFile->IsOpen())
+	{
+		// The maps may have used the file's pages
+		m_mapFonts.clear();
+		memset(m_arCache, 0, sizeof(m_arCache));
+	}
+}
+
+/**
+	@param hDC Handle to the DC, with the font selected into it
+	@param[out] stamp Receives the font's version
+	@return true if found, false if the font has no TrueType header (its map isn't saved then)
+*/
+bool GlyphTranslator::GetFontStamp(HDC hDC, GlyphFontStamp& stamp)
+{
+	// The 'head' table: version, fontRevision, checkSumAdjustment, magicNumber, flags, unitsPerEm, created, modified (big-endian)
+	BYTE cHead[36];
+	if (::GetFontData(hDC, GLYPH_TABLE_HEAD, 0, cHead, sizeof(cHead)) != sizeof(cHead))
+		return false;
+#define BE_DWORD(p)		(((DWORD)(p)[0] << 24) | ((DWORD)(p)[1] << 16) | ((DWORD)(p)[2] << 8) | (DWORD)(p)[3])
+	stamp.dwRevision = BE_DWORD(cHead + 4);
+	stamp.dwChecksum = BE_DWORD(cHead + 8);
+	stamp.dwModifiedHigh = BE_DWORD(cHead + 28);
+	stamp.dwModifiedLow = BE_DWORD(cHead + 32);
+#undef BE_DWORD
+	return true;
+}
+
+/**
+	@param key The font's description
+	@param stamp The font's version
+	@param[out] map The map to use the built-in map's pages
+	@return true if found, false if the font isn't one of the bundled fonts (or is another version of it)
+*/
+bool GlyphTranslator::FindBuiltInMap(const GlyphFontKey& key, const GlyphFontStamp& stamp, GlyphToText& map)
+{
+#ifdef URWMAPGEN
+	return false;
+#else
+	bool bItalic = (key.cStyle & 1) != 0;
+	for (UINT i = 0; i < _S(s_arURWGlyphMaps); i++)
+	{
+		const GlyphBuiltInMap& font = s_arURWGlyphMaps[i];
+		if (!(font.stamp == stamp) || (font.lWeight != key.lWeight) || (font.bItalic != bItalic) || (wcscmp(font.pFace, key.cFace) != 0))
+			continue;
+
+		// Found: borrow its pages (they're constant data, so they're never freed)
+		const WCHAR* arPages[256] = {NULL};
+		for (UINT n = 0; n < font.nPages; n++)
+		{
+			const GlyphBuiltInPage& page = s_arURWGlyphPageList[font.nFirstPage + n];
+			arPages[page.cPage] = s_arURWGlyphPages[page.wIndex];
+		}
+		map.Attach(arPages, font.nCount);
+		return true;
+	}
+	return false;
+#endif
 }
@@ -27,31 +27,290 @@
 #ifndef _GLYPHTRANSLATOR_H_
 #define _GLYPHTRANSLATOR_H_
 
-#include <map>
+#include <unordered_map>
+#include <vector>
 #include "CCTChar.h"
 
+class GlyphMapFile;
+
+/// Letter a glyph without a character translates to
+#define GLYPH_UNKNOWN	((WCHAR)0x7F)
+/// Tag of the TrueType header table ('head', as GetFontData() takes table tags)
+#define GLYPH_TABLE_HEAD	0x64616568
+/// Tag of the TrueType character map table ('cmap', as GetFontData() takes table tags)
+#define GLYPH_TABLE_CMAP	0x70616D63
+
 /**
     @brief This class holds glyph-to-Unicode-character data for a specific font
+
+	The map is a two-level table: 256 pages of 256 letters each, indexed by the high and low byte 
+	of the glyph index. Pages are only allocated when a glyph in them is added; the others all 
+	point to a shared page of GLYPH_UNKNOWN, so a lookup is two loads and never a test. A map can 
+	also borrow its pages from the glyph map cache file (see GlyphMapFile) or from the built-in 
+	maps of the bundled fonts (see URWGlyphMaps.h) instead of owning them.
 */
-struct GlyphToText : public std::map<WORD, WCHAR>
+class GlyphToText
 {
 public:
+	// Ctors
+	/// Default constructor
+	GlyphToText();
+	/// Copy constructor
+	GlyphToText(const GlyphToText& other);
+	/// Destructor
+	~GlyphToText() {clear();};
+
+	/// Assignment operator
+	GlyphToText& operator=(const GlyphToText& other);
+
+protected:
+	// Members
+	/// The pages of the table (pages without glyphs point to the shared unknown page)
+	WCHAR*			m_arPages[256];
+	/// Number of glyphs in the table
+	UINT			m_nCount;
+	/// true if the pages belong to a glyph map cache file view, and not to the map
+	bool			m_bBorrowed;
+
+	/// The shared page of unknown glyphs
+	static const WCHAR	s_arUnknownPage[256];
+
+public:
+	// Data Access
+	/**
+		@brief Checks if the map has any glyphs
+		@return true if no glyph was added
+	*/
+	bool	empty() const {return m_nCount == 0;};
+	/**
+		@brief Returns the number of glyphs in the map
+		@return The number of glyphs with a letter
+	*/
+	UINT	size() const {return m_nCount;};
+	/// Removes all the glyphs
+	void	clear();
+	/**
+		@brief Returns one of the table's pages
+		@param nPage The page (the glyph indices' high byte)
+		@return The page's 256 letters, or NULL if the page has no glyphs
+	*/
+	const WCHAR* GetPage(UINT nPage) const {return (m_arPages[nPage] == s_arUnknownPage) ? NULL : m_arPages[nPage];};
+	/// Uses pages of a glyph map cache file view (or of a built-in map) as the map's table
+	void	Attach(const WCHAR* const arPages[256], UINT nCount);
+	/**
+		@brief Translates a glyph
+		@param wGlyph The glyph index
+		@return The glyph's letter (GLYPH_UNKNOWN if the glyph has none)
+	*/
+	WCHAR	Translate(WORD wGlyph) const {return m_arPages[wGlyph >> 8][wGlyph & 0xFF];};
+	/**
+		@brief Checks if a glyph has a letter
+		@param wGlyph The glyph index
+		@return true if the glyph has a letter
+	*/
+	bool	Has(WORD wGlyph) const {return Translate(wGlyph) != GLYPH_UNKNOWN;};
+	/// Sets a glyph's letter, unless it already has one
+	void	Add(WORD wGlyph, WCHAR cLetter);
+	/// Translates a run of glyphs
+	void	TranslateRun(const WCHAR* pGlyphs, UINT nCount, WCHAR* pLetters) const;
+
+	// Methods
+	/// Adds the data of the font selected into a DC to the object
+	bool	Initialize(HDC hDC);
+
+protected:
+	// Helpers
+	/// Copies borrowed pages, so the map can be changed
+	void	MakeOwn();
+};
+
+/**
+    @brief Identity of a realized font, as the engine hands it to DrvTextOut
+*/
+struct GlyphFontID
+{
+	/// The FONTOBJ's iUniq (0 if the font has no identity)
+	ULONG	iUniq;
+	/// The FONTOBJ's iFace
+	ULONG	iFace;
+	/// The notional to device transform
+	FLOATL	eM11, eM12, eM21, eM22;
+
+	/**
+		@brief Compares two font identities
+		@param other The identity to compare to
+		@return true if both are the same font realization
+	*/
+	bool operator==(const GlyphFontID& other) const {return (iUniq == other.iUniq) && (iFace == other.iFace) && (eM11 == other.eM11) && (eM12 == other.eM12) && (eM21 == other.eM21) && (eM22 == other.eM22);};
+};
+
+/**
+    @brief A font's description, as the maps are kept by (fixed layout: it's saved in the glyph map cache file)
+*/
+struct GlyphFontKey
+{
+	/// Constructor
+	GlyphFontKey(const LOGFONT& lf);
+	/**
+		@brief Compares two font descriptions
+		@param other The description to compare to
+		@return true if both describe the same font
+	*/
+	bool operator==(const GlyphFontKey& other) const {return memcmp(this, &other, sizeof(GlyphFontKey)) == 0;};
+
+	/// Font face name (the rest of the buffer is cleared)
+	WCHAR	cFace[LF_FACESIZE];
+	/// Font height
+	LONG	lHeight;
+	/// Font weight
+	LONG	lWeight;
+	/// Italic (1), underline (2) and strikeout (4) flags
+	BYTE	cStyle;
+	/// Pitch and family
+	BYTE	cPitchAndFamily;
+	/// Padding (always 0)
+	WORD	wReserved;
+};
+
+/**
+    @brief Hash function for font descriptions
+*/
+struct GlyphFontKeyHash
+{
+	/// Hashes a font description
+	size_t operator()(const GlyphFontKey& key) const;
+};
+
+/**
+    @brief Version of a font's file, from its TrueType header: a saved map is only used if the font is the same version
+*/
+struct GlyphFontStamp
+{
+	/// Font revision
+	DWORD	dwRevision;
+	/// Checksum adjustment of the font file
+	DWORD	dwChecksum;
+	/// Modification time (seconds since 1904), high and low parts
+	DWORD	dwModifiedHigh, dwModifiedLow;
+
 	/**
-		@brief Default constructor
+		@brief Compares two font versions
+		@param other The version to compare to
+		@return true if both are the same
 	*/
-	GlyphToText() {};
-	/// Adds the font data to the object
-	bool	Initialize(const LOGFONT& lf, HDC hDC);
+	bool operator==(const GlyphFontStamp& other) const {return (dwRevision == other.dwRevision) && (dwChecksum == other.dwChecksum) && (dwModifiedHigh == other.dwModifiedHigh) && (dwModifiedLow == other.dwModifiedLow);};
+};
+
+/**
+    @brief A map built during the job, to be saved in the glyph map cache file
+*/
+struct GlyphMapRecord
+{
+	/// The font's description
+	GlyphFontKey		key;
+	/// The font's version
+	GlyphFontStamp		stamp;
+	/// The map
+	const GlyphToText*	pMap;
+};
+
+/**
+    @brief A page of a built-in map
+*/
+struct GlyphBuiltInPage
+{
+	/// The page (the glyph indices' high byte)
+	BYTE	cPage;
+	/// Index of the page's letters in the built-in pages
+	WORD	wIndex;
 };
 
+/**
+    @brief A glyph map compiled into the driver, for one of the fonts the installer ships (made by urwmapgen)
+*/
+struct GlyphBuiltInMap
+{
+	/// Font face name
+	const WCHAR*	pFace;
+	/// Font weight
+	LONG			lWeight;
+	/// true if italic
+	bool			bItalic;
+	/// The font's version
+	GlyphFontStamp	stamp;
+	/// Number of glyphs in the map
+	UINT			nCount;
+	/// Index of the map's first page in the built-in page list
+	UINT			nFirstPage;
+	/// Number of pages
+	UINT			nPages;
+};
+
+/// Number of bits of the font identity cache index
+#define GLYPH_CACHE_BITS	6
+/// Number of entries in the font identity cache
+#define GLYPH_CACHE_SIZE	(1 << GLYPH_CACHE_BITS)
+
 /**
     @brief This class retrieves a glyph-to-Unicode map for a font (and caches the map)
+
+	The maps are kept by font description (face, height, weight, style and pitch) in a hash table.
+	In front of it is a small direct-mapped cache keyed by the font's identity, so a font already 
+	seen in the job is found without building its description. Behind it are the built-in maps of 
+	the fonts the installer ships, and then the glyph map cache file, which keeps the maps built by 
+	earlier jobs, so a font is only read from GDI once (until it's updated).
 */
-class GlyphTranslator : protected std::map<std::tstring, GlyphToText>
+class GlyphTranslator
 {
 public:
+	// Ctors
+	/// Default constructor
+	GlyphTranslator();
+	/// Destructor
+	~GlyphTranslator();
+
+protected:
+	/**
+	    @brief Entry of the font identity cache
+	*/
+	struct CacheEntry
+	{
+		/// The font (iUniq is 0 if the entry is empty)
+		GlyphFontID			id;
+		/// The font's map (NULL if the font can't be translated)
+		const GlyphToText*	pMap;
+	};
+
+	// Members
+	/// The maps, by font description
+	std::unordered_map<GlyphFontKey, GlyphToText, GlyphFontKeyHash>	m_mapFonts;
+	/// Font identity cache
+	CacheEntry			m_arCache[GLYPH_CACHE_SIZE];
+	/// The glyph map cache file (NULL until the first font is looked up)
+	GlyphMapFile*		m_pFile;
+	/// The maps built (and not found in the glyph map cache file), to be saved in it
+	std::vector<GlyphMapRecord>	m_arBuilt;
+
+	/// Returns the cache entry of a font
+	static UINT	CacheIndex(const GlyphFontID& id) {return ((id.iUniq ^ (id.iFace << 16)) * 2654435761U) >> (32 - GLYPH_CACHE_BITS);};
+
+public:
+	// Methods
+	/// Looks up a font by its identity only
+	bool	FindFont(const GlyphFontID& id, const GlyphToText*& pMap) const;
+	/// Get a translation map for a font, and cache it by its identity
+	const GlyphToText* GetFontTranslation(const GlyphFontID& id, const LOGFONT& lf, HDC hDC = NULL);
 	/// Get a translation map for a font
 	const GlyphToText* GetFontTranslation(const LOGFONT& lf, HDC hDC = NULL);
+	/// Saves the maps built in this job to the glyph map cache file
+	void	SaveMaps();
+
+protected:
+	// Helpers
+	/// Gets the version of the font selected into a DC
+	static bool	GetFontStamp(HDC hDC, GlyphFontStamp& stamp);
+	/// Uses the built-in map of a bundled font, if the font is one
+	static bool	FindBuiltInMap(const GlyphFontKey& key, const GlyphFontStamp& stamp, GlyphToText& map);
 };
 
 #endif   //#define _GLYPHTRANSLATOR_H_
@@ -0,0 +1,135 @@
+/**
+	@file
+	@brief 
+*/
+
+/*
+ * CC PDF Converter: Windows PDF Printer with Creative Commons license support
+ * Excel to PDF Converter: Excel PDF printing addin, keeping hyperlinks AND Creative Commons license support
+ * Copyright (C) 2007-2010 Guy Hachlili <hguy@cogniview.com>, Cogniview LTD.
+ * 
+ * This file is part of CC PDF Converter / Excel to PDF Converter
+ * 
+ * CC PDF Converter and Excel to PDF Converter are free software;
+ * you can redistribute them and/or modify them under the terms of the 
+ * GNU General Public License as published by the Free Software Foundation;
+ * either version 2 of the License, or (at your option) any later version.
+ * 
+ * CC PDF Converter and Excel to PDF Converter are is distributed in the hope 
+ * that they will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. * 
+ */
+
+#include "precomp.h"
+
+#include "debug.h"
+#include "PageArena.h"
+
+/// Alignment of the arena allocations
+#define PAGE_ARENA_ALIGN	8
+
+/**
+	@brief Default constructor
+*/
+PageArena::PageArena() : m_pFirst(NULL), m_pCurrent(NULL), m_nUsed(0), m_nAllocs(0), m_nBytes(0), m_nNewBlocks(0)
+{
+}
+
+/**
+	@brief Destructor: frees all the blocks
+*/
+PageArena::~PageArena()
+{
+	while (m_pFirst != NULL)
+	{
+		Block* pNext = m_pFirst->pNext;
+		delete [] (BYTE*)m_pFirst;
+		m_pFirst = pNext;
+	}
+}
+
+/**
+	@brief Allocates memory that stays valid until the next call to Reset()
+	@param nSize Size of the memory to allocate
+	@return Pointer to the allocated memory (NULL if out of memory)
+*/
+void* PageArena::Alloc(size_t nSize)
+{
+	// Keep all the allocations aligned
+	nSize = (nSize + PAGE_ARENA_ALIGN - 1) & ~(size_t)(PAGE_ARENA_ALIGN - 1);
+	if (nSize == 0)
+		nSize = PAGE_ARENA_ALIGN;
+
+	if ((m_pCurrent == NULL) || (m_nUsed + nSize > m_pCurrent->nSize))
+	{
+		// Move to the next block if it's big enough (blocks kept from previous pages)
+		Block* pNext = (m_pCurrent == NULL) ? m_pFirst : m_pCurrent->pNext;
+		if ((pNext == NULL) || (pNext->nSize < nSize))
+		{
+			// Have to get a new one, and put it right after the current block
+			size_t nBlock = (nSize > PAGE_ARENA_BLOCK) ? nSize : PAGE_ARENA_BLOCK;
+			BYTE* pMem = new BYTE[sizeof(Block) + nBlock];
+			if (pMem == NULL)
+				return NULL;
+			Block* pNew = (Block*)pMem;
+			pNew->nSize = nBlock;
+			pNew->pNext = pNext;
+			if (m_pCurrent == NULL)
+				m_pFirst = pNew;
+			else
+				m_pCurrent->pNext = pNew;
+			pNext = pNew;
+			m_nNewBlocks++;
+		}
+		m_pCurrent = pNext;
+		m_nUsed = 0;
+	}
+
+	// Bump the pointer
+	void* pRet = ((BYTE*)(m_pCurrent + 1)) + m_nUsed;
+	m_nUsed += nSize;
+	m_nAllocs++;
+	m_nBytes += nSize;
+	return pRet;
+}
+
+/**
+	@brief Makes all the arena's memory available again; all the pointers returned before are invalid after this
+*/
+void PageArena::Reset()
+{
+	m_pCurrent = NULL;
+	m_nUsed = 0;
+	m_nAllocs = 0;
+	m_nBytes = 0;
+	m_nNewBlocks = 0;
+}
+
+/**
+	@brief Converts a string to an ANSI string in the arena
+	@param sString The string to convert
+	@return The converted string, valid until the next call to Reset()
+*/
+LPCSTR PageArena::MakeAnsiString(const std::tstring& sString)
+{
+#ifdef _UNICODE
+	int nLen = WideCharToMultiByte(CP_ACP, WC_COMPOSITECHECK | WC_DEFAULTCHAR, sString.c_str(), (int)sString.size(), NULL, 0, NULL, NULL);
+	char* pRet = (char*)Alloc(nLen + 1);
+	if (pRet == NULL)
+		return "";
+	if (nLen > 0)
+		WideCharToMultiByte(CP_ACP, WC_COMPOSITECHECK | WC_DEFAULTCHAR, sString.c_str(), (int)sString.size(), pRet, nLen, NULL, NULL);
+	pRet[nLen] = '\0';
+	return pRet;
+#else
+	char* pRet = (char*)Alloc(sString.size() + 1);
+	if (pRet == NULL)
+		return "";
+	memcpy(pRet, sString.c_str(), sString.size() + 1);
+	return pRet;
+#endif
+}
@@ -0,0 +1,108 @@
+/**
+	@file
+	@brief 
+*/
+
+/*
+ * CC PDF Converter: Windows PDF Printer with Creative Commons license support
+ * Excel to PDF Converter: Excel PDF printing addin, keeping hyperlinks AND Creative Commons license support
+ * Copyright (C) 2007-2010 Guy Hachlili <hguy@cogniview.com>, Cogniview LTD.
+ * 
+ * This file is part of CC PDF Converter / Excel to PDF Converter
+ * 
+ * CC PDF Converter and Excel to PDF Converter are free software;
+ * you can redistribute them and/or modify them under the terms of the 
+ * GNU General Public License as published by the Free Software Foundation;
+ * either version 2 of the License, or (at your option) any later version.
+ * 
+ * CC PDF Converter and Excel to PDF Converter are is distributed in the hope 
+ * that they will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. * 
+ */
+
+#ifndef _PAGEARENA_H_
+#define _PAGEARENA_H_
+
+#include "CCTChar.h"
+
+/// Default size of a page arena block
+#define PAGE_ARENA_BLOCK	(64 * 1024)
+
+/**
+    @brief Memory for the allocations that only live until the end of the printed page
+
+	Allocations are taken one after the other from large blocks, and are never freed one by one:
+	Reset() makes all the blocks available again at once (at the end of the page), so a page 
+	doesn't allocate any memory from the heap once the blocks have grown to the size of a page.
+*/
+class PageArena
+{
+public:
+	// Ctors
+	/// Default constructor
+	PageArena();
+	/// Destructor: frees all the blocks
+	~PageArena();
+
+protected:
+	/// Header of a memory block (the block's memory follows it)
+	struct Block
+	{
+		/// Next block
+		Block*					pNext;
+		/// Size of the block's memory
+		size_t					nSize;
+	};
+
+	// Members
+	/// First block
+	Block*						m_pFirst;
+	/// Block allocations are currently taken from
+	Block*						m_pCurrent;
+	/// Used part of the current block
+	size_t						m_nUsed;
+	/// Number of allocations since the last Reset()
+	UINT						m_nAllocs;
+	/// Bytes allocated since the last Reset()
+	size_t						m_nBytes;
+	/// Number of blocks allocated from the heap since the last Reset()
+	UINT						m_nNewBlocks;
+
+private:
+	/// No copies
+	PageArena(const PageArena&);
+	/// No copies
+	PageArena& operator=(const PageArena&);
+
+public:
+	// Data Access
+	/**
+		@brief Returns the number of allocations since the last Reset()
+		@return Count of allocations
+	*/
+	UINT	GetAllocCount() const {return m_nAllocs;};
+	/**
+		@brief Returns the number of bytes allocated since the last Reset()
+		@return Size allocated
+	*/
+	size_t	GetAllocSize() const {return m_nBytes;};
+	/**
+		@brief Returns the number of blocks allocated from the heap since the last Reset()
+		@return Count of heap allocations
+	*/
+	UINT	GetNewBlockCount() const {return m_nNewBlocks;};
+
+	// Methods
+	/// Allocates memory until the next Reset()
+	void*	Alloc(size_t nSize);
+	/// Makes all the memory available again (keeps the blocks)
+	void	Reset();
+	/// Converts a string to an ANSI string allocated until the next Reset()
+	LPCSTR	MakeAnsiString(const std::tstring& sString);
+};
+
+#endif   //#define _PAGEARENA_H_
@@ -28,239 +28,378 @@
 
 #include "debug.h"
 #include "TextPart.h"
+#include <algorithm>
+#if defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+/// SSE2 is always there on this platform
+#define TEXT_SSE2
+#endif
 
 /**
-	@param s The sentence's text
-	@param arGlyphPos The location of each letter
-	@param pWidths The widths of each letter
-	@param nStart The first letter to use
-	@param nEnd The last letter to use
+	@brief Checks if a letter separates words
+	@param c The letter to check
+	@return true if the letter is a space of some kind
 */
-TextWord::TextWord(const std::wstring& s, const PGLYPHPOS& arGlyphPos, const POINTQF* pWidths, std::tstring::size_type nStart, std::tstring::size_type nEnd /* = -1 */)
+inline bool IsWordBreak(WCHAR c)
 {
-	// Calculate the end of the word if not specified
-	if (nEnd == -1)
-		nEnd = s.size();
-	// Go over the data
-	for (; nStart < nEnd; nStart++)
-	{
-		// Add a letter object from each letter and position
-		ASSERT(s[nStart] != ' ');
-		push_back(TextLetter(s[nStart], arGlyphPos[nStart].ptl.x, pWidths[nStart].x.HighPart >> 4));
-	}
+	return (c == ' ') || (c == '\r') || (c == '\n') || (c == '\t');
 }
 
 /**
-	@param s The sentence's text
-	@param nCharWidth The width of each glyph
-	@param nStart The first letter to use
-	@param nEnd The last letter to use
+	@brief Checks if two rectangles are on the same line
+	@param rect1 First line to check
+	@param rect2 Second line to check
+	@return true if the rectangles are more-or-less on the same line, false if not
 */
-TextWord::TextWord(const std::wstring& s, int nCharWidth, std::tstring::size_type nStart, std::tstring::size_type nEnd /* = -1 */)
+bool OnSameLine(const RECTL& rect1, const RECTL& rect2)
 {
-	// Calculate the end of the word if not specified
-	if (nEnd == -1)
-		nEnd = s.size();
-	// Go over the data
-	for (; nStart < nEnd; nStart++)
-	{
-		// Add a letter object from each letter and position
-		ASSERT(s[nStart] != ' ');
-		push_back(TextLetter(s[nStart], (long) (nStart * nCharWidth), nCharWidth));
-	}
+	int nMiddle1 = (rect1.top + rect1.bottom) / 2, nMiddle2 = (rect2.top + rect2.bottom) / 2;
+	return ((nMiddle1 >= rect2.top) && (nMiddle1 <= rect2.bottom)) || ((nMiddle2 >= rect1.top) && (nMiddle2 <= rect1.bottom));
 }
 
+/// URL class: letter can be part of a URL
+#define URL_LETTER	1
+/// URL class: letter is removed from the end of a URL
+#define URL_TRIM	2
 
+/// URL class of each letter under 256 (URL_LETTER is for a-z A-Z 0-9 and .+$-_@&!*"'(),%/?; URL_TRIM for ).'"?)
+static const BYTE s_arURLClass[256] =
+{
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 1, 3, 0, 1, 1, 1, 3, 1, 3, 1, 1, 1, 1, 3, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 3,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1,
+	0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
 
 /**
-	@param s The line's text
-	@param rc The line's printed location
-	@param arGlyphPos Array of glyph locations
-	@param pWidths Array of glyph widths
+	@brief Returns the URL class of a letter
+	@param c The letter
+	@return The class flags (URL_LETTER, URL_TRIM)
 */
-TextLine::TextLine(const std::wstring& s, const RECTL& rc, const PGLYPHPOS& arGlyphPos, const POINTQF* pWidths) : rcArea(rc)
+inline BYTE URLClass(WCHAR c)
 {
-	// Go over the text, break on spaces and such
-	size_t nPos = 0, nEndPos = s.find_first_of(_T(" \r\n\t"));
-	while (nEndPos != std::wstring::npos)
+	return (c < 256) ? s_arURLClass[c] : 0;
+}
+
+/**
+	@brief Finds the next "://" in a letter buffer
+	@param p The letters
+	@param nFrom Index of the first letter to look at
+	@param nTo Index after the last letter to look at
+	@return Index of the ':', or nTo if not found
+*/
+UINT FindURLMark(const WCHAR* p, UINT nFrom, UINT nTo)
+{
+	UINT n = nFrom;
+#ifdef TEXT_SSE2
+	// 8 letters at a time: compare the letters at n, n+1 and n+2 with the 3 marks
+	const __m128i mColon = _mm_set1_epi16(':'), mSlash = _mm_set1_epi16('/');
+	for (; n + 10 <= nTo; n += 8)
 	{
-		// Do we have something here?
-		if (nEndPos > nPos)
-			// Yes, add the word
-			push_back(TextWord(s, arGlyphPos, pWidths, nPos, nEndPos));
-
-		// Move on
-		nPos = nEndPos + 1;
-		if (nPos < s.size())
-			// Find end of space
-			nEndPos = s.find_first_of(_T(" \r\n\t"), nPos);
-		else
-			// Ah, finished
-			nEndPos = std::wstring::npos;
+		__m128i m = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(p + n)), mColon);
+		m = _mm_and_si128(m, _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(p + n + 1)), mSlash));
+		m = _mm_and_si128(m, _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(p + n + 2)), mSlash));
+		int nMask = _mm_movemask_epi8(m);
+		if (nMask != 0)
+		{
+			// Lowest set bit: 2 mask bits per letter
+			UINT nBit = 0;
+			while ((nMask & (1 << nBit)) == 0)
+				nBit++;
+			return n + nBit / 2;
+		}
 	}
-	if (nPos < s.size())
-		// Add the last word
-		push_back(TextWord(s, arGlyphPos, pWidths, nPos));
+#endif
+	// The rest, a letter at a time
+	for (; n + 3 <= nTo; n++)
+		if ((p[n] == ':') && (p[n + 1] == '/') && (p[n + 2] == '/'))
+			return n;
+	return nTo;
+}
+
+
 
-	// Update the line rectangle
-	SetSides();
+/// Height of a band of the line index
+#define TEXT_BAND_HEIGHT	128
+
+/**
+	@brief Returns the band of the line index a y-location is in
+	@param y The y-location
+	@return The band
+*/
+inline long TextBand(long y)
+{
+	return (y >= 0) ? (y / TEXT_BAND_HEIGHT) : -((TEXT_BAND_HEIGHT - 1 - y) / TEXT_BAND_HEIGHT);
 }
 
+
+
 /**
-	@param s The line's text
-	@param rc The line's printed location
-	@param nCharWidth The width of each glyph (fixed font)
+	
 */
-TextLine::TextLine(const std::wstring& s, const RECTL& rc, int nCharWidth) : rcArea(rc)
+TextArea::TextArea() : m_bLaidOut(true), m_nLastLine(TEXT_NONE), m_nLine(0), m_nWord(0)
 {
-	// Go over the text, break on spaces and such
-	std::tstring::size_type nPos = 0, nEndPos = s.find_first_of(_T(" \r\n\t"));
-	while (nEndPos != std::wstring::npos)
-	{
-		// Do we have something here?
-		if (nEndPos > nPos)
-			// Yes, add the word
-			push_back(TextWord(s, nCharWidth, nPos, nEndPos));
-
-		// Move on
-		nPos = nEndPos + 1;
-		if (nPos < s.size())
-			// Find end of space
-			nEndPos = s.find_first_of(_T(" \r\n\t"), nPos);
-		else
-			// Ah, finished
-			nEndPos = std::wstring::npos;
-	}
-	if (nPos < s.size())
-		// Add the last word
-		push_back(TextWord(s, nCharWidth, nPos));
+	// The offset tables always end with the total count
+	m_arWordStart.push_back(0);
+	m_arLineStart.push_back(0);
+	m_arRunWordStart.push_back(0);
+	m_arRunStart.push_back(0);
+}
+
+/**
+	
+*/
+void TextArea::clear()
+{
+	// Resizing down keeps the memory, so the next page won't have to allocate it again
+	m_arLetters.resize(0);
+	m_arX.resize(0);
+	m_arWidths.resize(0);
+	m_arWordStart.resize(1);
+	m_arLineStart.resize(1);
+	m_arLineArea.resize(0);
+	m_arLineFirstRun.resize(0);
+	m_arLineLastRun.resize(0);
+	m_bLaidOut = true;
 
-	// Update the line rectangle
-	SetSides();
+	m_arRunLetters.resize(0);
+	m_arRunX.resize(0);
+	m_arRunWidths.resize(0);
+	m_arRunWordStart.resize(1);
+	m_arRunStart.resize(1);
+	m_arRunArea.resize(0);
+	m_arRunNext.resize(0);
+	for (std::map<long, std::vector<UINT> >::iterator i = m_mapBands.begin(); i != m_mapBands.end(); i++)
+		(*i).second.resize(0);
+	m_nLastLine = TEXT_NONE;
+
+	m_nLine = 0;
+	m_nWord = 0;
 }
 
 /**
-	@brief Checks if two rectangles are on the same line
-	@param rect1 First line to check
-	@param rect2 Second line to check
-	@return true if the rectangles are more-or-less on the same line, false if not
+	@param s The line's text
+	@param rc The line's printed location
+	@param arGlyphPos Array of glyph locations
+	@param pWidths Array of glyph widths
 */
-bool OnSameLine(const RECTL& rect1, const RECTL& rect2)
+void TextArea::AddLine(const std::wstring& s, const RECTL& rc, const PGLYPHPOS& arGlyphPos, const POINTQF* pWidths)
 {
-	int nMiddle1 = (rect1.top + rect1.bottom) / 2, nMiddle2 = (rect2.top + rect2.bottom) / 2;
-	return ((nMiddle1 >= rect2.top) && (nMiddle1 <= rect2.bottom)) || ((nMiddle2 >= rect1.top) && (nMiddle2 <= rect1.bottom));
+	// Convert the locations to page units
+	m_arInX.resize(s.size());
+	m_arInWidths.resize(s.size());
+	for (std::wstring::size_type n = 0; n < s.size(); n++)
+	{
+		m_arInX[n] = arGlyphPos[n].ptl.x;
+		m_arInWidths[n] = pWidths[n].x.HighPart >> 4;
+	}
+	if (!s.empty())
+		AppendLine(s.c_str(), (UINT)s.size(), rc, &m_arInX[0], &m_arInWidths[0], 0);
 }
 
 /**
-	@param other The text line object to check
-	@return true if the other line object's data was added to this one, false if not
+	@param pText The line's text
+	@param nCount Number of letters in the text
+	@param rc The line's printed location
+	@param pX Array of letter locations (NULL for a fixed font)
+	@param pWidths Array of letter widths (NULL for a fixed font)
+	@param nCharWidth The width of each letter (fixed font)
 */
-bool TextLine::AddTextSameLine(const TextLine& other)
+void TextArea::AppendLine(const WCHAR* pText, UINT nCount, const RECTL& rc, const long* pX, const int* pWidths, int nCharWidth)
 {
-	// Are we on the same line?
-	if (!OnSameLine(rcArea, other.rcArea))
-		// No, just leave it
-		return false;
+	UINT nLetterBase = (UINT)m_arRunLetters.size(), nWordBase = (UINT)m_arRunWordStart.size() - 1;
 
-	// Same line: before or after?
-	int nOffset;
-	if (rcArea.left > other.rcArea.left)
+	// Go over the text, break on spaces and such
+	for (UINT n = 0; n < nCount; n++)
 	{
-		nOffset = rcArea.left - other.rcArea.left;
-		if (rcArea.left > other.rcArea.right + 2)
+		if (IsWordBreak(pText[n]))
 		{
-			/* <other> <me> */
-			insert(begin(), other.begin(), other.end());
+			// End of word (if we're in one)
+			if (m_arRunLetters.size() > m_arRunWordStart.back())
+				m_arRunWordStart.push_back((UINT)m_arRunLetters.size());
+			continue;
+		}
+
+		// Add the letter with its position
+		m_arRunLetters.push_back(pText[n]);
+		if (pX != NULL)
+		{
+			m_arRunX.push_back(pX[n]);
+			m_arRunWidths.push_back(pWidths[n]);
 		}
 		else
 		{
-			/* <other><me> */
-			ASSERT(!other.empty());
-			ASSERT(!empty());
-			TextWord part(other.back());
-			part += front();
-			erase(begin());
-			push_front(part);
-			if (other.size() > 1)
-			{
-				const_iterator ci = other.end();
-				ci--;
-				insert(begin(), other.begin(), ci);
-			}
+			m_arRunX.push_back((long) (n * nCharWidth));
+			m_arRunWidths.push_back(nCharWidth);
 		}
-		rcArea.left = other.rcArea.left;
+	}
+	// Close the last word
+	if (m_arRunLetters.size() > m_arRunWordStart.back())
+		m_arRunWordStart.push_back((UINT)m_arRunLetters.size());
+
+	// Don't put in empty lines
+	UINT nWords = (UINT)m_arRunWordStart.size() - 1;
+	if (nWords == nWordBase)
+		return;
+
+	// Add the run; get the range from the actual words (it could be larger)
+	UINT nRun = (UINT)m_arRunArea.size();
+	RECTL rcRun = rc;
+	rcRun.left = m_arRunX[nLetterBase];
+	rcRun.right = m_arRunX.back() + m_arRunWidths.back();
+	m_arRunStart.push_back(nWords);
+	m_arRunArea.push_back(rcRun);
+	m_arRunNext.push_back(TEXT_NONE);
+	m_bLaidOut = false;
+
+	// Which line is it on?
+	UINT nLine = FindLine(rcRun);
+	if (nLine == TEXT_NONE)
+	{
+		// OK, it's not on any line, so add it
+		nLine = (UINT)m_arLineArea.size();
+		m_arLineArea.push_back(rcRun);
+		m_arLineFirstRun.push_back(nRun);
+		m_arLineLastRun.push_back(nRun);
+		AddToBands(nLine, NULL, rcRun);
+		m_nLastLine = nLine;
+		return;
+	}
+	m_nLastLine = nLine;
+
+	// Put it in the line by its x-location
+	UINT nPrev = m_arLineLastRun[nLine];
+	if (m_arRunArea[nPrev].left <= rcRun.left)
+	{
+		// After the rest (the usual case)
+		m_arRunNext[nPrev] = nRun;
+		m_arLineLastRun[nLine] = nRun;
+	}
+	else if (m_arRunArea[m_arLineFirstRun[nLine]].left > rcRun.left)
+	{
+		// Before the rest
+		m_arRunNext[nRun] = m_arLineFirstRun[nLine];
+		m_arLineFirstRun[nLine] = nRun;
 	}
 	else
 	{
-		nOffset = other.rcArea.left - rcArea.left;
-		std::tstring::size_type nSize = size();
-		if (rcArea.right < other.rcArea.left - 2)
-		{
-			/* <me> <other> */
-			insert(end(), other.begin(), other.end());
-		}
-		else
-		{
-			/* <me><other> */
-			ASSERT(!other.empty());
-			ASSERT(!empty());
-			const_iterator i = other.begin();
-			back() += (*i);
-			i++;
-			if (i != other.end())
-				insert(end(), i, other.end());
-		}
-		rcArea.right = other.rcArea.right;
+		// Somewhere in the middle
+		for (nPrev = m_arLineFirstRun[nLine]; m_arRunArea[m_arRunNext[nPrev]].left <= rcRun.left; nPrev = m_arRunNext[nPrev])
+			;
+		m_arRunNext[nRun] = m_arRunNext[nPrev];
+		m_arRunNext[nPrev] = nRun;
 	}
 
 	// Combine the areas
-	rcArea.top = min(rcArea.top, other.rcArea.top);
-	rcArea.bottom = max(rcArea.bottom, other.rcArea.bottom);
-	return true;
+	RECTL& rcLine = m_arLineArea[nLine];
+	RECTL rcOld = rcLine;
+	rcLine.left = min(rcLine.left, rcRun.left);
+	rcLine.right = max(rcLine.right, rcRun.right);
+	rcLine.top = min(rcLine.top, rcRun.top);
+	rcLine.bottom = max(rcLine.bottom, rcRun.bottom);
+	AddToBands(nLine, &rcOld, rcLine);
 }
 
 /**
-	
+	@param rc The area to check
+	@return The line the area is on (the latest one if more than one), TEXT_NONE if none
+
+	A line is on the same line as the area if the middle of either is inside the other (see
+	OnSameLine), so the line crosses one of the bands between the top and bottom of the area.
 */
-void TextLine::SetSides() 
+UINT TextArea::FindLine(const RECTL& rc) const
 {
-	// Do we have any data?
-	if (empty()) 
-		// No, make it VERY small :>
-		rcArea.right = rcArea.left; 
-	else 
+	// Text usually comes in order, so start with the last line used
+	if ((m_nLastLine != TEXT_NONE) && OnSameLine(m_arLineArea[m_nLastLine], rc))
+		return m_nLastLine;
+
+	// Check the lines listed in the bands of the area
+	UINT nFound = TEXT_NONE;
+	long nLast = TextBand(max(rc.top, rc.bottom));
+	for (std::map<long, std::vector<UINT> >::const_iterator i = m_mapBands.lower_bound(TextBand(min(rc.top, rc.bottom))); (i != m_mapBands.end()) && ((*i).first <= nLast); i++)
 	{
-		// Get the range from the actual words (it could be larger)
-		const TextWord& word = back(); 
-		rcArea.right = word.GetEnd(word.size() - 1);
-		rcArea.left = front().GetStart(0);
+		const std::vector<UINT>& arLines = (*i).second;
+		for (std::vector<UINT>::const_iterator iLine = arLines.begin(); iLine != arLines.end(); iLine++)
+			if (((nFound == TEXT_NONE) || (*iLine > nFound)) && OnSameLine(m_arLineArea[*iLine], rc))
+				nFound = *iLine;
 	}
+	return nFound;
 }
 
-
-
-
+/**
+	@param nLine The line
+	@param prcOld The area the line was listed for (NULL for a new line)
+	@param rcNew The line's area now
+*/
+void TextArea::AddToBands(UINT nLine, const RECTL* prcOld, const RECTL& rcNew)
+{
+	long nOldFirst = 0, nOldLast = -1;
+	if (prcOld != NULL)
+	{
+		nOldFirst = TextBand(min(prcOld->top, prcOld->bottom));
+		nOldLast = TextBand(max(prcOld->top, prcOld->bottom));
+	}
+	long nFirst = TextBand(min(rcNew.top, rcNew.bottom)), nLast = TextBand(max(rcNew.top, rcNew.bottom));
+	for (long nBand = nFirst; nBand <= nLast; nBand++)
+	{
+		// Only the bands it grew into
+		if ((nBand < nOldFirst) || (nBand > nOldLast))
+			m_mapBands[nBand].push_back(nLine);
+	}
+}
 
 /**
-	@param line The line to add
+	Copies the run words into the page arrays line by line, with the runs of each line from left to right.
+	When a run touches the one before it, its first word continues the last word before it.
 */
-void TextArea::AddLine(const TextLine& line)
+void TextArea::Layout()
 {
-	// Don't put in empty lines
-	if (line.empty())
-		return;
+	m_arLetters.resize(0);
+	m_arX.resize(0);
+	m_arWidths.resize(0);
+	m_arWordStart.resize(1);
+	m_arLineStart.resize(1);
 
-	if (empty())
-		// Just put it in
-		push_back(line);
-	else
+	for (UINT nLine = 0; nLine < m_arLineArea.size(); nLine++)
 	{
-		// Check against the previous line
-		TextLine& last = back();
-		if (!last.AddTextSameLine(line))
-			// OK, it's not on the same line, so add it
-			push_back(line);
+		long nRight = 0;
+		for (UINT nRun = m_arLineFirstRun[nLine]; nRun != TEXT_NONE; nRun = m_arRunNext[nRun])
+		{
+			const RECTL& rcRun = m_arRunArea[nRun];
+			bool bJoin = (nRun != m_arLineFirstRun[nLine]) && (nRight >= rcRun.left - 2);
+			for (UINT nWord = m_arRunStart[nRun]; nWord < m_arRunStart[nRun + 1]; nWord++)
+			{
+				// Copy the word
+				UINT nFrom = m_arRunWordStart[nWord], nTo = m_arRunWordStart[nWord + 1];
+				m_arLetters.insert(m_arLetters.end(), m_arRunLetters.begin() + nFrom, m_arRunLetters.begin() + nTo);
+				m_arX.insert(m_arX.end(), m_arRunX.begin() + nFrom, m_arRunX.begin() + nTo);
+				m_arWidths.insert(m_arWidths.end(), m_arRunWidths.begin() + nFrom, m_arRunWidths.begin() + nTo);
+				if (bJoin)
+				{
+					// Touching, so the first word continues the last word
+					m_arWordStart.back() = (UINT)m_arLetters.size();
+					bJoin = false;
+				}
+				else
+					m_arWordStart.push_back((UINT)m_arLetters.size());
+			}
+			nRight = (nRun == m_arLineFirstRun[nLine]) ? rcRun.right : max(nRight, rcRun.right);
+		}
+		m_arLineStart.push_back((UINT)m_arWordStart.size() - 1);
 	}
+	m_bLaidOut = true;
 }
 
 /**
@@ -268,11 +407,13 @@ void TextArea::AddLine(const TextLine& line)
 */
 void TextArea::InitSearch()
 {
-	// Initialize the search location to the first line
-	m_iLine = begin();
-	if (m_iLine != end())
-		// And the first word in the line
-		m_iWord = (*m_iLine).begin();
+	// Make sure the page text is in order
+	if (!m_bLaidOut)
+		Layout();
+
+	// Initialize the search location to the first line, and the first word in the line
+	m_nLine = 0;
+	m_nWord = 0;
 }
 
 /**
@@ -288,46 +429,50 @@ bool TextArea::SearchFor(const STRLIST& words, RECTL& rectArea)
 		return false;
 
 	// Start searching
-	const_iterator iPrev = m_iLine;
+	UINT nPrev = m_nLine, nLines = (UINT)m_arLineArea.size();
 	std::wstring sWord;
 	std::wstring::size_type pos;
 
-	for (; m_iLine != end(); m_iLine++)
+	for (; m_nLine < nLines; m_nLine++)
 	{
 		// Did we move to a new line?
-		if (iPrev != m_iLine)
+		if (nPrev != m_nLine)
 		{
 			// Yeah, does it have enough words to cover the expression?
-			if ((*m_iLine).size() < words.size())
+			if (m_arLineStart[m_nLine + 1] - m_arLineStart[m_nLine] < words.size())
 				// No, go to the next line
 				continue;
 			// Initialize the search to the first word in the line
-			m_iWord = (*m_iLine).begin();
+			m_nWord = m_arLineStart[m_nLine];
 		}
 
 		// Go over the words in the current line
-		for (; m_iWord != (*m_iLine).end(); m_iWord++)
+		UINT nLineEnd = m_arLineStart[m_nLine + 1];
+		for (; m_nWord < nLineEnd; m_nWord++)
 		{
 			// Get the text
-			sWord = (*m_iWord).GetText();
-			if ((pos = sWord.find(words.front().c_str())) != (sWord.size() - words.front().size()))
-				// Can't be this word: didn't find the first expression's word as the end of this word
+			GetText(m_nWord, sWord);
+			if ((sWord.size() < words.front().size()) || (sWord.compare(pos = sWord.size() - words.front().size(), std::wstring::npos, words.front()) != 0))
+				// Can't be this word: the first expression's word isn't the end of this word
 				// This is for matching:
 				// 'and' as the end of 'wand'!
+				// Only the end of the word is compared, so 'and' is also found at the end of 'andand', 
+				// and a word shorter than the expression's first word never matches (the old list-based 
+				// search used find() and missed the first, and wrongly matched words one letter short)
 				continue;
 
 			// Initialize the search for the rest of the expression
-			TextLine::const_iterator iTestThis = m_iWord;
+			UINT nTestThis = m_nWord;
 			STRLIST::const_iterator iTestWords = words.begin(), iTestWordsNext;
 			iTestWords++;
 			while (iTestWords != words.end())
 			{
 				// Get next word
-				iTestThis++;
-				if (iTestThis == (*m_iLine).end())
+				nTestThis++;
+				if (nTestThis == nLineEnd)
 					// Nothing in this line, so not found
 					break;
-				sWord = (*iTestThis).GetText();
+				GetText(nTestThis, sWord);
 
 				iTestWordsNext = iTestWords;
 				iTestWordsNext++;
@@ -352,15 +497,14 @@ bool TextArea::SearchFor(const STRLIST& words, RECTL& rectArea)
 			if (iTestWords == words.end())
 			{
 				// Found it
-				rectArea = (*m_iLine).rcArea;
-				rectArea.left = (*m_iWord).GetStart(pos);
-				rectArea.right = (*iTestThis).GetEnd((*iTestThis).size() - 1);
-				m_iWord = iTestThis;
-				m_iWord++;
+				rectArea = m_arLineArea[m_nLine];
+				rectArea.left = GetStart(m_nWord, pos);
+				rectArea.right = GetEnd(nTestThis, WordLength(nTestThis) - 1);
+				m_nWord = nTestThis + 1;
 				return true;
 			}
 		}			
-		iPrev = m_iLine;
+		nPrev = m_nLine;
 	}
 	return false;
 }
@@ -369,63 +513,613 @@ bool TextArea::SearchFor(const STRLIST& words, RECTL& rectArea)
 	@param[out] rectArea Location of next URL
 	@param[out] sURL The URL found
 	@return true if a URL was found, false if none were found
+
+	Instead of going word by word, the page letters are scanned for "://" (SSE2 where available),
+	and only the words where it comes right after http or https at the start are looked at.
 */
 bool TextArea::SearchForURL(RECTL& rectArea, std::wstring& sURL)
 {
 	// Continue from last search
-	const_iterator iPrev = m_iLine;
-	std::wstring sWord;
-	std::tstring::size_type nStart, nEnd;
-	for (; m_iLine != end(); m_iLine++)
+	UINT nWords = WordCount(), nLetters = (UINT)m_arLetters.size();
+	if (m_nWord >= nWords)
+		return false;
+	const WCHAR* p = &m_arLetters[0];
+
+	// We are gonna assume that a URL cannot have a space in it. Which is basically true.
+	for (UINT nMark = m_arWordStart[m_nWord]; (nMark = FindURLMark(p, nMark, nLetters)) < nLetters; nMark++)
 	{
-		// We are gonna assume that a URL cannot have a space in it. Which is basically true.
+		// Which word is it in?
+		while (m_arWordStart[m_nWord + 1] <= nMark)
+			m_nWord++;
+		UINT nFirst = m_arWordStart[m_nWord], nLength = WordLength(m_nWord), nStart = nMark - nFirst;
+		if (nLength < 8)
+			// Too short
+			continue;
+		// Must be http:// or https://
+		if ((nStart != 4) && ((nStart != 5) || ((p[nFirst + 4] != 's') && (p[nFirst + 4] != 'S'))))
+			continue;
+		if (_wcsnicmp(p + nFirst, _T("http"), 4) != 0)
+			continue;
+		nStart += 3;
+
+		// Find the end of the URL
+		UINT nEnd = nStart;
+		while ((nEnd < nLength) && ((URLClass(p[nFirst + nEnd]) & URL_LETTER) != 0))
+			nEnd++;
+		// Remove all kinds of non-URL stuff sometimes found at the end of the URL
+		while ((nEnd > nStart) && ((URLClass(p[nFirst + nEnd - 1]) & URL_TRIM) != 0))
+			nEnd--;
 
-		if (iPrev != m_iLine)
-			// Start from the beginning of the next line...
-			m_iWord = (*m_iLine).begin();
+		// Calculate position (up to the last letter of the URL; the old list-based search asked 
+		// for the letter after it, so got 0 for a URL ending the word and the trimmed letter otherwise)
+		while (m_arLineStart[m_nLine + 1] <= m_nWord)
+			m_nLine++;
+		rectArea = m_arLineArea[m_nLine];
+		rectArea.right = GetEnd(m_nWord, nEnd - 1);
+		rectArea.left = GetStart(m_nWord, 0);
+		sURL.assign(p + nFirst, nEnd);
+
+		// Leave it pointing to the next part
+		m_nWord++;
+		return true;
+	}
+	m_nWord = nWords;
+	m_nLine = (UINT)m_arLineArea.size();
+	return false;
+}
 
-		// Go over the words
-		for (; m_iWord != (*m_iLine).end(); m_iWord++)
+/**
+	@param[in,out] matcher The phrases to search for; gets the matches
+*/
+void TextArea::FindAll(TextMatcher& matcher)
+{
+	// Make sure the page text and the automaton are in order
+	if (!m_bLaidOut)
+		Layout();
+	if (!matcher.m_bBuilt)
+		matcher.Build();
+
+	// Run the page text through the automaton, line by line (phrases can't go over a line's end)
+	matcher.m_arFoundPhrase.resize(0);
+	matcher.m_arFoundFirstWord.resize(0);
+	matcher.m_arFoundLastWord.resize(0);
+	matcher.m_arFoundArea.resize(0);
+	for (UINT nLine = 0; nLine < m_arLineArea.size(); nLine++)
+	{
+		UINT nNode = 0;
+		for (UINT nWord = m_arLineStart[nLine]; nWord < m_arLineStart[nLine + 1]; nWord++)
 		{
-			// Get the text
-			sWord = (*m_iWord).GetText();
-			if (sWord.size() < 8)
-				// Too short
-				continue;
-			if (_wcsnicmp(sWord.c_str(), _T("http"), 4) != 0)
-				// No http
+			// The words are separated by a single space, as in the phrases
+			if (nWord > m_arLineStart[nLine])
+				nNode = matcher.Step(nNode, ' ');
+			UINT nLength = WordLength(nWord);
+			for (UINT nLetter = 0; nLetter < nLength; nLetter++)
+			{
+				nNode = matcher.Step(nNode, m_arLetters[m_arWordStart[nWord] + nLetter]);
+
+				// Go over all the phrases ending here
+				for (UINT nOut = (matcher.m_arNodePhrase[nNode] != TEXT_NONE) ? nNode : matcher.m_arNodeOutput[nNode]; nOut != TEXT_NONE; nOut = matcher.m_arNodeOutput[nOut])
+				{
+					UINT nPhrase = matcher.m_arNodePhrase[nOut], nWords = matcher.m_arPhraseWords[nPhrase];
+					if ((nWords == 1) && (nLetter < nLength - 1))
+						// A single word must be at the end of the page word
+						continue;
+
+					// Found, the last word is completed by the rest of the page word
+					UINT nFirst = nWord - (nWords - 1);
+					RECTL rcArea = m_arLineArea[nLine];
+					rcArea.left = GetStart(nFirst, WordLength(nFirst) - matcher.m_arPhraseFirstLen[nPhrase]);
+					rcArea.right = GetEnd(nWord, nLength - 1);
+					matcher.m_arFoundPhrase.push_back(nPhrase);
+					matcher.m_arFoundFirstWord.push_back(nFirst);
+					matcher.m_arFoundLastWord.push_back(nWord);
+					matcher.m_arFoundArea.push_back(rcArea);
+				}
+			}
+		}
+	}
+
+	// Sort the matches by phrase, keeping the page order for each phrase
+	UINT nPhrases = (UINT)matcher.m_arPhraseWords.size(), nFound = (UINT)matcher.m_arFoundPhrase.size(), n;
+	matcher.m_arMatchStart.assign(nPhrases + 1, 0);
+	for (n = 0; n < nFound; n++)
+		matcher.m_arMatchStart[matcher.m_arFoundPhrase[n] + 1]++;
+	for (n = 0; n < nPhrases; n++)
+		matcher.m_arMatchStart[n + 1] += matcher.m_arMatchStart[n];
+	matcher.m_arFoundNext.assign(matcher.m_arMatchStart.begin(), matcher.m_arMatchStart.end() - 1);
+	matcher.m_arMatchFirstWord.resize(nFound);
+	matcher.m_arMatchLastWord.resize(nFound);
+	matcher.m_arMatchArea.resize(nFound);
+	for (n = 0; n < nFound; n++)
+	{
+		UINT nTo = matcher.m_arFoundNext[matcher.m_arFoundPhrase[n]]++;
+		matcher.m_arMatchFirstWord[nTo] = matcher.m_arFoundFirstWord[n];
+		matcher.m_arMatchLastWord[nTo] = matcher.m_arFoundLastWord[n];
+		matcher.m_arMatchArea[nTo] = matcher.m_arFoundArea[n];
+	}
+
+	// A match starting before the previous one ends means searching skips it, so it can't be indexed
+	matcher.m_arMatchOverlap.assign(nPhrases, 0);
+	for (n = 0; n < nPhrases; n++)
+		for (UINT nMatch = matcher.m_arMatchStart[n] + 1; nMatch < matcher.m_arMatchStart[n + 1]; nMatch++)
+			if (matcher.m_arMatchFirstWord[nMatch] <= matcher.m_arMatchLastWord[nMatch - 1])
+			{
+				matcher.m_arMatchOverlap[n] = 1;
+				break;
+			}
+	matcher.Restart();
+}
+
+/**
+	@param nPage The page number
+	@param sizePage The page size
+	@param[in,out] sOut The string to append the JSON object to
+
+	The object is {"page":n,"width":w,"height":h,"words":[[left,top,right,bottom,"text"],...]}, with
+	the words in reading order (line by line); it has no line breaks, so it can be sent as a single
+	comment line in the PostScript file.
+*/
+void TextArea::WriteWords(UINT nPage, const SIZEL& sizePage, std::string& sOut)
+{
+	if (!m_bLaidOut)
+		Layout();
+
+	char cNum[80];
+	sprintf_s(cNum, _S(cNum), "{\"page\":%u,\"width\":%ld,\"height\":%ld,\"words\":[", nPage, (long)sizePage.cx, (long)sizePage.cy);
+	sOut += cNum;
+	bool bFirst = true;
+	for (UINT nLine = 0; nLine < m_arLineArea.size(); nLine++)
+	{
+		const RECTL& rcLine = m_arLineArea[nLine];
+		for (UINT nWord = m_arLineStart[nLine]; nWord < m_arLineStart[nLine + 1]; nWord++)
+		{
+			UINT nLength = WordLength(nWord);
+			if (nLength == 0)
 				continue;
+			sprintf_s(cNum, _S(cNum), "%s[%ld,%ld,%ld,%ld,\"", bFirst ? "" : ",", GetStart(nWord, 0), (long)rcLine.top, GetEnd(nWord, nLength - 1), (long)rcLine.bottom);
+			sOut += cNum;
+			WriteJSONWord(nWord, sOut);
+			sOut += "\"]";
+			bFirst = false;
+		}
+	}
+	sOut += "]}";
+}
+
+/**
+	@param nWord The word
+	@param[in,out] sOut The string to append the word to
+*/
+void TextArea::WriteJSONWord(UINT nWord, std::string& sOut) const
+{
+	static const char cHex[] = "0123456789abcdef";
+	const WCHAR* pLetter = &m_arLetters[m_arWordStart[nWord]];
+	const WCHAR* pEnd = pLetter + WordLength(nWord);
+	for (; pLetter < pEnd; pLetter++)
+	{
+		unsigned long c = (unsigned long)*pLetter;
+		if ((c == '"') || (c == '\\'))
+		{
+			sOut += '\\';
+			sOut += (char)c;
+		}
+		else if (c < 0x20)
+		{
+			// Control characters must be escaped (and there can't be any line breaks)
+			sOut += "\\u00";
+			sOut += cHex[c >> 4];
+			sOut += cHex[c & 0xF];
+		}
+		else if (c < 0x80)
+			sOut += (char)c;
+		else
+		{
+			// Surrogate pairs make a single letter
+			if ((c >= 0xD800) && (c < 0xDC00) && (pLetter + 1 < pEnd) && (pLetter[1] >= 0xDC00) && (pLetter[1] < 0xE000))
+			{
+				c = 0x10000 + ((c - 0xD800) << 10) + ((unsigned long)pLetter[1] - 0xDC00);
+				pLetter++;
+			}
+			else if ((c >= 0xD800) && (c < 0xE000))
+				// A broken pair can't be UTF-8
+				c = 0xFFFD;
+
+			if (c < 0x800)
+			{
+				sOut += (char)(0xC0 | (c >> 6));
+			}
+			else if (c < 0x10000)
+			{
+				sOut += (char)(0xE0 | (c >> 12));
+				sOut += (char)(0x80 | ((c >> 6) & 0x3F));
+			}
+			else
+			{
+				sOut += (char)(0xF0 | (c >> 18));
+				sOut += (char)(0x80 | ((c >> 12) & 0x3F));
+				sOut += (char)(0x80 | ((c >> 6) & 0x3F));
+			}
+			sOut += (char)(0x80 | (c & 0x3F));
+		}
+	}
+}
+
+
+
+/**
+	
+*/
+TextMatcher::TextMatcher() : m_bBuilt(false), m_nCursor(0)
+{
+	clear();
+}
+
+/**
+	
+*/
+void TextMatcher::clear()
+{
+	// Resizing down keeps the memory, so the next page won't have to allocate it again
+	m_arNodeChild.resize(0);
+	m_arNodeSibling.resize(0);
+	m_arNodeLetter.resize(0);
+	m_arNodePhrase.resize(0);
+	m_arPhraseWords.resize(0);
+	m_arPhraseFirstLen.resize(0);
+	m_arMatchStart.resize(0);
+	m_arMatchFirstWord.resize(0);
+	m_arMatchLastWord.resize(0);
+	m_arMatchArea.resize(0);
+	m_arMatchOverlap.resize(0);
+	m_bBuilt = false;
+	m_nCursor = 0;
 
-			nStart = 4;
-			if ((sWord[nStart] == 's') || (sWord[nStart] == 'S'))
-				// https
-				nStart++;
-			// Does it have :// now?
-			if (wcsncmp(sWord.c_str() + nStart, _T("://"), 3) != 0)
-				// Nope
+	// The root node
+	m_arNodeChild.push_back(TEXT_NONE);
+	m_arNodeSibling.push_back(TEXT_NONE);
+	m_arNodeLetter.push_back(0);
+	m_arNodePhrase.push_back(TEXT_NONE);
+}
+
+/**
+	@param words The expression to search for
+	@return The phrase ID (the same for the same expression), TEXT_NONE if there are no words in it
+*/
+UINT TextMatcher::AddPhrase(const STRLIST& words)
+{
+	UINT nNode = 0, nWords = 0, nFirstLen = 0;
+	for (STRLIST::const_iterator i = words.begin(); i != words.end(); i++)
+	{
+		const std::tstring& s = *i;
+		for (std::tstring::size_type n = 0; n < s.size(); n++)
+		{
+			if (IsWordBreak(s[n]))
 				continue;
-			nStart += 3;
-
-			// Find the end of the URL
-			nEnd = sWord.find_first_not_of(_T("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789.+$-_@&+-!*\"'(),%/?"), nStart);
-			if (nEnd == std::wstring::npos)
-				nEnd = sWord.size();
-			// Remove all kinds of non-URL stuff sometimes found at the end of the URL
-			while ((nEnd > nStart) && wcschr(_T(").'\"?"), sWord[nEnd-1]) != NULL)
-				nEnd--;
-
-			// Calculate position
-			rectArea = (*m_iLine).rcArea;
-			rectArea.right = (*m_iWord).GetEnd(nEnd);
-			rectArea.left = (*m_iWord).GetStart(0);
-			sURL = sWord.substr(0, nEnd);
-
-			// Leave it pointing to the next part
-			m_iWord++;
-			return true;
+			// Start of another word?
+			if ((n == 0) || IsWordBreak(s[n - 1]))
+			{
+				if (nWords > 0)
+					nNode = AddEdge(nNode, ' ');
+				nWords++;
+			}
+			nNode = AddEdge(nNode, s[n]);
+			if (nWords == 1)
+				nFirstLen++;
 		}
-		iPrev = m_iLine;
 	}
-	return false;
+	if (nWords == 0)
+		return TEXT_NONE;
+
+	// Do we have it already?
+	if (m_arNodePhrase[nNode] == TEXT_NONE)
+	{
+		m_arNodePhrase[nNode] = (UINT)m_arPhraseWords.size();
+		m_arPhraseWords.push_back(nWords);
+		m_arPhraseFirstLen.push_back(nFirstLen);
+	}
+	return m_arNodePhrase[nNode];
+}
+
+/**
+	@param nNode The node
+	@param c The letter
+	@return The child node (added if it wasn't there)
+*/
+UINT TextMatcher::AddEdge(UINT nNode, WCHAR c)
+{
+	// Already there?
+	UINT nChild;
+	for (nChild = m_arNodeChild[nNode]; nChild != TEXT_NONE; nChild = m_arNodeSibling[nChild])
+		if (m_arNodeLetter[nChild] == c)
+			return nChild;
+
+	// New node
+	nChild = (UINT)m_arNodePhrase.size();
+	m_arNodeChild.push_back(TEXT_NONE);
+	m_arNodeSibling.push_back(m_arNodeChild[nNode]);
+	m_arNodeLetter.push_back(c);
+	m_arNodePhrase.push_back(TEXT_NONE);
+	m_arNodeChild[nNode] = nChild;
+	m_bBuilt = false;
+	return nChild;
+}
+
+/**
+	
+*/
+void TextMatcher::Build()
+{
+	// List the edges of each node, sorted by letter
+	UINT nNodes = (UINT)m_arNodePhrase.size(), n;
+	m_arNodeEdge.resize(0);
+	m_arEdgeLetter.resize(0);
+	m_arEdgeTarget.resize(0);
+	for (n = 0; n < nNodes; n++)
+	{
+		m_arNodeEdge.push_back((UINT)m_arEdgeLetter.size());
+		m_arSortEdges.resize(0);
+		for (UINT nChild = m_arNodeChild[n]; nChild != TEXT_NONE; nChild = m_arNodeSibling[nChild])
+			m_arSortEdges.push_back(std::make_pair(m_arNodeLetter[nChild], nChild));
+		std::sort(m_arSortEdges.begin(), m_arSortEdges.end());
+		for (std::vector<std::pair<WCHAR, UINT> >::const_iterator i = m_arSortEdges.begin(); i != m_arSortEdges.end(); i++)
+		{
+			m_arEdgeLetter.push_back((*i).first);
+			m_arEdgeTarget.push_back((*i).second);
+		}
+	}
+	m_arNodeEdge.push_back((UINT)m_arEdgeLetter.size());
+
+	// Failure and output links, breadth first (so the links of shorter prefixes are ready)
+	m_arFail.assign(nNodes, 0);
+	m_arNodeOutput.assign(nNodes, TEXT_NONE);
+	m_arQueue.resize(0);
+	m_arQueue.push_back(0);
+	for (n = 0; n < m_arQueue.size(); n++)
+	{
+		UINT nNode = m_arQueue[n];
+		for (UINT nEdge = m_arNodeEdge[nNode]; nEdge < m_arNodeEdge[nNode + 1]; nEdge++)
+		{
+			UINT nChild = m_arEdgeTarget[nEdge];
+			if (nNode != 0)
+			{
+				// Longest suffix in the trie that can go on with this letter
+				WCHAR c = m_arEdgeLetter[nEdge];
+				UINT nFail = m_arFail[nNode], nNext;
+				while (((nNext = Child(nFail, c)) == TEXT_NONE) && (nFail != 0))
+					nFail = m_arFail[nFail];
+				m_arFail[nChild] = (nNext == TEXT_NONE) ? 0 : nNext;
+				nFail = m_arFail[nChild];
+				m_arNodeOutput[nChild] = (m_arNodePhrase[nFail] != TEXT_NONE) ? nFail : m_arNodeOutput[nFail];
+			}
+			m_arQueue.push_back(nChild);
+		}
+	}
+	m_bBuilt = true;
+}
+
+/**
+	@param nNode The node
+	@param c The letter
+	@return The child node, TEXT_NONE if there is none
+*/
+UINT TextMatcher::Child(UINT nNode, WCHAR c) const
+{
+	// The edges of each node are sorted by letter
+	std::vector<WCHAR>::const_iterator iFirst = m_arEdgeLetter.begin() + m_arNodeEdge[nNode], iLast = m_arEdgeLetter.begin() + m_arNodeEdge[nNode + 1];
+	std::vector<WCHAR>::const_iterator i = std::lower_bound(iFirst, iLast, c);
+	return ((i == iLast) || (*i != c)) ? TEXT_NONE : m_arEdgeTarget[i - m_arEdgeLetter.begin()];
+}
+
+/**
+	@param nPhrase The phrase ID (from AddPhrase)
+	@param[out] rectArea The page location in which the phrase was found
+	@param nRepeat The amount of times to jump over the phrase before reporting success
+	@param pRegion The page area the phrase must be in (NULL for anywhere); only matches in it are counted
+	@return true if the phrase was found, false if not
+
+	Like TextArea::SearchFor, this is a forward only search: each match found moves the search to the
+	page word after it, for all the phrases; use Restart to search from the beginning.
+*/
+bool TextMatcher::SearchFor(UINT nPhrase, RECTL& rectArea, int nRepeat, const RECTL* pRegion /* = NULL */)
+{
+	if ((nPhrase >= m_arPhraseWords.size()) || (nPhrase + 1 >= m_arMatchStart.size()))
+		return false;
+
+	std::vector<UINT>::const_iterator iFirst = m_arMatchFirstWord.begin() + m_arMatchStart[nPhrase], iLast = m_arMatchFirstWord.begin() + m_arMatchStart[nPhrase + 1];
+	if ((pRegion == NULL) && (m_arMatchOverlap[nPhrase] == 0))
+	{
+		// The matches don't overlap, so each one follows the one before: jump right to the Nth
+		std::vector<UINT>::const_iterator i = std::lower_bound(iFirst, iLast, m_nCursor);
+		UINT nSkip = (nRepeat > 1) ? (UINT)(nRepeat - 1) : 0;
+		if ((UINT)(iLast - i) <= nSkip)
+			return false;
+		UINT nMatch = (UINT)(i - m_arMatchFirstWord.begin()) + nSkip;
+		rectArea = m_arMatchArea[nMatch];
+		m_nCursor = m_arMatchLastWord[nMatch] + 1;
+		return true;
+	}
+
+	do
+	{
+		// First match starting after the last one found
+		std::vector<UINT>::const_iterator i = std::lower_bound(iFirst, iLast, m_nCursor);
+		if (pRegion != NULL)
+			// Skip the ones outside the region
+			while ((i != iLast) && !AreasIntersect(m_arMatchArea[i - m_arMatchFirstWord.begin()], *pRegion))
+				i++;
+		if (i == iLast)
+			return false;
+		UINT nMatch = (UINT)(i - m_arMatchFirstWord.begin());
+		rectArea = m_arMatchArea[nMatch];
+		m_nCursor = m_arMatchLastWord[nMatch] + 1;
+		nRepeat--;
+	} while (nRepeat > 0);
+	return true;
+}
+
+/**
+	@brief Default constructor
+*/
+URLDetector::URLDetector() : m_nUsed(0), m_nNextFound(0)
+{
+	for (UINT n = 0; n < URL_TAILS; n++)
+	{
+		m_arTails[n].bOpen = false;
+		m_arTails[n].nUsed = 0;
+	}
+}
+
+/**
+*/
+void URLDetector::clear()
+{
+	for (UINT n = 0; n < URL_TAILS; n++)
+		m_arTails[n].bOpen = false;
+	m_arFoundArea.resize(0);
+	m_arFoundURL.resize(0);
+	m_nNextFound = 0;
+}
+
+/**
+	@param pText The run's text
+	@param nCount Number of letters in the text
+	@param rc The run's printed location
+	@param pX Array of letter locations
+	@param pWidths Array of letter widths
+
+	Call GetURL() to retrieve the URLs found.
+*/
+void URLDetector::AddRun(const WCHAR* pText, UINT nCount, const RECTL& rc, const long* pX, const int* pWidths)
+{
+	if (nCount == 0)
+		return;
+
+	// Is there an unfinished word on this line?
+	m_arLetters.resize(0);
+	m_arX.resize(0);
+	m_arWidths.resize(0);
+	RECTL rcLine = rc;
+	for (UINT n = 0; n < URL_TAILS; n++)
+	{
+		Tail& tail = m_arTails[n];
+		if (!tail.bOpen || !OnSameLine(tail.rc, rc))
+			continue;
+		if ((tail.rc.left <= rc.left) && (tail.rc.right >= rc.left - 2))
+		{
+			// Touching, so the run continues the word
+			m_arLetters.swap(tail.arLetters);
+			m_arX.swap(tail.arX);
+			m_arWidths.swap(tail.arWidths);
+			rcLine.top = min(rcLine.top, tail.rc.top);
+			rcLine.bottom = max(rcLine.bottom, tail.rc.bottom);
+			tail.bOpen = false;
+		}
+		else
+			// Something else: the word is done
+			Close(tail);
+		break;
+	}
+	m_arLetters.insert(m_arLetters.end(), pText, pText + nCount);
+	m_arX.insert(m_arX.end(), pX, pX + nCount);
+	m_arWidths.insert(m_arWidths.end(), pWidths, pWidths + nCount);
+
+	// Keep the last word if it may continue in the next run
+	UINT nTotal = (UINT)m_arLetters.size(), nCut = nTotal;
+	while ((nCut > 0) && !IsWordBreak(m_arLetters[nCut - 1]))
+		nCut--;
+	if (nTotal - nCut > URL_TAIL_MAX)
+		nCut = nTotal;
+
+	// Check the rest now
+	Check(&m_arLetters[0], nCut, rcLine, &m_arX[0], &m_arWidths[0]);
+	if (nCut == nTotal)
+		return;
+
+	// Find a place for the word: a free tail, or the one not used for the longest time
+	Tail* pTail = &m_arTails[0];
+	for (UINT n = 0; n < URL_TAILS; n++)
+	{
+		if (!m_arTails[n].bOpen)
+		{
+			pTail = &m_arTails[n];
+			break;
+		}
+		if (m_arTails[n].nUsed < pTail->nUsed)
+			pTail = &m_arTails[n];
+	}
+	if (pTail->bOpen)
+		Close(*pTail);
+	pTail->bOpen = true;
+	pTail->nUsed = ++m_nUsed;
+	pTail->rc = rcLine;
+	pTail->rc.left = m_arX[nCut];
+	pTail->rc.right = m_arX.back() + m_arWidths.back();
+	pTail->arLetters.assign(m_arLetters.begin() + nCut, m_arLetters.end());
+	pTail->arX.assign(m_arX.begin() + nCut, m_arX.end());
+	pTail->arWidths.assign(m_arWidths.begin() + nCut, m_arWidths.end());
+}
+
+/**
+	@param[out] rectArea The page location of the URL
+	@param[out] sURL The URL
+	@return true if a URL was retrieved, false if there are no more
+*/
+bool URLDetector::GetURL(RECTL& rectArea, std::wstring& sURL)
+{
+	if (m_nNextFound >= m_arFoundArea.size())
+	{
+		// All retrieved: start over
+		m_arFoundArea.resize(0);
+		m_arFoundURL.resize(0);
+		m_nNextFound = 0;
+		return false;
+	}
+	rectArea = m_arFoundArea[m_nNextFound];
+	sURL.swap(m_arFoundURL[m_nNextFound]);
+	m_nNextFound++;
+	return true;
+}
+
+/**
+	Call GetURL() to retrieve the URLs found.
+*/
+void URLDetector::Flush()
+{
+	for (UINT n = 0; n < URL_TAILS; n++)
+		if (m_arTails[n].bOpen)
+			Close(m_arTails[n]);
 }
 
+/**
+	@param pText The text
+	@param nCount Number of letters in the text
+	@param rc The printed location of the text
+	@param pX Array of letter locations
+	@param pWidths Array of letter widths
+*/
+void URLDetector::Check(const WCHAR* pText, UINT nCount, const RECTL& rc, const long* pX, const int* pWidths)
+{
+	// Only text with a URL mark is worth a closer look
+	if ((nCount == 0) || (FindURLMark(pText, 0, nCount) >= nCount))
+		return;
+
+	m_oPiece.clear();
+	m_oPiece.AddLine(pText, nCount, rc, pX, pWidths);
+	m_oPiece.InitSearch();
+	RECTL rcURL;
+	std::wstring sURL;
+	while (m_oPiece.SearchForURL(rcURL, sURL))
+	{
+		m_arFoundArea.push_back(rcURL);
+		m_arFoundURL.push_back(sURL);
+	}
+}
+
+/**
+	@param tail The tail to check
+*/
+void URLDetector::Close(Tail& tail)
+{
+	tail.bOpen = false;
+	Check(&tail.arLetters[0], (UINT)tail.arLetters.size(), tail.rc, &tail.arX[0], &tail.arWidths[0]);
+}
@@ -29,153 +29,228 @@
 
 #include <string>
 #include <list>
+#include <vector>
+#include <map>
 #include "CCTChar.h"
 
 /// Definition: string list
 typedef std::list<std::tstring> STRLIST;
 
+/// No run/line/phrase
+#define TEXT_NONE			((UINT)-1)
+
 /**
-    @brief Helper object for location of a printed letter
+	@brief Checks if two page areas have anything in common
+	@param rc1 First area
+	@param rc2 Second area
+	@return true if the areas intersect (or touch), false if not
 */
-struct TextLetter
+inline bool AreasIntersect(const RECTL& rc1, const RECTL& rc2)
 {
-	// Ctors
-	/**
-		@brief Default constructor
-	*/
-	TextLetter() : wLetter(0), x(0), nWidth(0) {};
-	/**
-		@brief Constructor
-		@param w The letter
-		@param pos The start location
-		@param width The width
-	*/
-	TextLetter(WCHAR w, long _x, int width) : wLetter(w), x(_x), nWidth(width) {};
-	/**
-		@brief Copy constructor
-		@param other The letter data object to copy
-	*/
-	TextLetter(const TextLetter& other) : wLetter(other.wLetter), x(other.x), nWidth(other.nWidth) {};
-
-	// Members
-	/// The letter
-	WCHAR						wLetter;
-	/// The x-location
-	long						x;
-	/// The width
-	int							nWidth;
-};
+	return (rc1.left <= rc2.right) && (rc1.right >= rc2.left) && (rc1.top <= rc2.bottom) && (rc1.bottom >= rc2.top);
+}
 
 /**
-    @brief Helper object for printed word location
+    @brief Set of expressions (phrases) to search for in the page text all at once
+
+	The phrases are compiled into an Aho-Corasick automaton over their words joined by single spaces,
+	which TextArea::FindAll runs once over the whole page; the matches of each phrase are then kept in
+	page order (an occurrence index, so the Nth match is found without searching N times), and 
+	SearchFor picks them with the same forward-only semantics as TextArea::SearchFor:
+	the first word of a phrase matches the end of a page word, the middle words match whole page words,
+	and the last word matches the beginning of a page word.
 */
-struct TextWord : public std::list<TextLetter>
+class TextMatcher
 {
+	friend class TextArea;
+public:
 	// Ctors
-	/**
-		@brief Default constructor
-	*/
-	TextWord() {};
-	/**
-		@brief Copy constructor
-		@param other Printer work location object to copy
-	*/
-	TextWord(const TextWord& other) {assign(other.begin(), other.end());};
-	/// Constructor: create from a variable-width font string
-	TextWord(const std::wstring& s, const PGLYPHPOS& arGlyphPos, const POINTQF* pWidths, std::tstring::size_type nStart, std::tstring::size_type nEnd = -1);
-	/// Constructor: create from a fixed-width font string
-	TextWord(const std::wstring& s, int nCharWidth, std::tstring::size_type nStart, std::tstring::size_type nEnd = -1);
+	/// Default constructor
+	TextMatcher();
 
-	// Data Access methods
-	/**
-		@brief Returns the left border of the requested letter
-		@param nLetter The letter to get the location of
-		@return Location of the requested letter
-	*/
-	long GetStart(size_type nLetter) const 
-	{
-		if ((nLetter < 0) || (nLetter >= size())) 
-			return 0; 
-		const_iterator i; 
-		for (i = begin(); nLetter > 0; nLetter--, i++) ; 
-		return (*i).x;
-	};
+protected:
+	// Members (automaton)
+	/// First child of each node in the phrase trie (TEXT_NONE if none)
+	std::vector<UINT>			m_arNodeChild;
+	/// Next child of the same parent (TEXT_NONE if none)
+	std::vector<UINT>			m_arNodeSibling;
+	/// Letter leading to each node from its parent
+	std::vector<WCHAR>			m_arNodeLetter;
+	/// Index of the first edge of each node (plus the edge count)
+	std::vector<UINT>			m_arNodeEdge;
+	/// Letter of each edge, sorted by node and letter
+	std::vector<WCHAR>			m_arEdgeLetter;
+	/// Target node of each edge
+	std::vector<UINT>			m_arEdgeTarget;
+	/// Failure link of each node (longest suffix which is also in the trie)
+	std::vector<UINT>			m_arFail;
+	/// Phrase ending at each node (TEXT_NONE if none)
+	std::vector<UINT>			m_arNodePhrase;
+	/// Next node on the failure links where a phrase ends (TEXT_NONE if none)
+	std::vector<UINT>			m_arNodeOutput;
+	/// true if the edges and links are up to date with the phrases
+	bool						m_bBuilt;
+
+	// Members (phrases)
+	/// Number of words in each phrase
+	std::vector<UINT>			m_arPhraseWords;
+	/// Length of the first word of each phrase
+	std::vector<UINT>			m_arPhraseFirstLen;
+
+	// Members (matches)
+	/// Index of the first match of each phrase (plus the match count)
+	std::vector<UINT>			m_arMatchStart;
+	/// First page word of each match
+	std::vector<UINT>			m_arMatchFirstWord;
+	/// Last page word of each match
+	std::vector<UINT>			m_arMatchLastWord;
+	/// The page area of each match
+	std::vector<RECTL>			m_arMatchArea;
+	/// Non-zero for each phrase with overlapping matches (their Nth match can't be picked by index)
+	std::vector<BYTE>			m_arMatchOverlap;
+	/// Next page word to search from
+	UINT						m_nCursor;
+
+	// Members (work buffers, kept between pages)
+	/// Edges of a node while sorting them by letter
+	std::vector<std::pair<WCHAR, UINT> >	m_arSortEdges;
+	/// Nodes left to link while building
+	std::vector<UINT>			m_arQueue;
+	/// Phrase of each match while searching, in page order
+	std::vector<UINT>			m_arFoundPhrase;
+	/// First page word of each match while searching
+	std::vector<UINT>			m_arFoundFirstWord;
+	/// Last page word of each match while searching
+	std::vector<UINT>			m_arFoundLastWord;
+	/// The page area of each match while searching
+	std::vector<RECTL>			m_arFoundArea;
+	/// Next match index of each phrase while sorting the matches
+	std::vector<UINT>			m_arFoundNext;
+
+public:
+	// Data Access
+	/// Adds a phrase (words in the listed strings are split on spaces) and returns its ID
+	UINT	AddPhrase(const STRLIST& words);
 	/**
-		@brief Returns the right border of the requested letter
-		@param nLetter The letter to get the location of
-		@return Location of the requested letter
+		@brief Checks if there are any phrases to search for
+		@return true if no phrase was added
 	*/
-	long GetEnd(size_type nLetter) const 
-	{
-		if ((nLetter < 0) || (nLetter >= (int)size())) 
-			return 0; 
-		const_iterator i; 
-		for (i = begin(); nLetter > 0; nLetter--, i++) ; 
-		return (*i).x + (*i).nWidth;
-	};
+	bool	empty() const {return m_arPhraseWords.empty();};
+	/// Removes all the phrases and matches (keeps the allocated memory for the next page)
+	void	clear();
+
+	// Methods
 	/**
-		@brief Returns the word's contents
-		@return The text
+		@brief Starts the search from the beginning of the page again
 	*/
-	std::wstring GetText() const {std::wstring s; for (const_iterator i = begin(); i != end(); i++) s += (*i).wLetter; return s;};
+	void	Restart() {m_nCursor = 0;};
+	/// Gets the next match of a phrase (after the last match found), after TextArea::FindAll
+	bool	SearchFor(UINT nPhrase, RECTL& rectArea, int nRepeat, const RECTL* pRegion = NULL);
 
-	// Operators
+protected:
+	// Helpers
+	/// Adds a letter to the phrase trie
+	UINT	AddEdge(UINT nNode, WCHAR c);
+	/// Builds the edge arrays and the failure links
+	void	Build();
+	/// Returns the child of a node by a letter (TEXT_NONE if none)
+	UINT	Child(UINT nNode, WCHAR c) const;
 	/**
-		@brief Adds another word's letters after the current letters
-		@param other The word to add
-		@return This object
+		@brief Moves the automaton by a letter
+		@param nNode The current node
+		@param c The letter
+		@return The new node
 	*/
-	const TextWord& operator+=(const TextWord& other) {insert(end(), other.begin(), other.end()); return *this;};
+	UINT	Step(UINT nNode, WCHAR c) const {for (;;) {UINT nNext = Child(nNode, c); if (nNext != TEXT_NONE) return nNext; if (nNode == 0) return 0; nNode = m_arFail[nNode];}};
 };
 
 /**
-    @brief Helper object for printed text line
+    @brief Page text helper object, used to search for specific strings to find their location
+
+	The page text is kept in flat arrays so that capturing a glyph does not allocate anything once
+	the arrays have grown to the page size: the letters, their x-locations and widths are stored one
+	after the other, words are ranges of letters and lines are ranges of words. Word i is made of the
+	letters m_arWordStart[i] to m_arWordStart[i+1]-1, and line i of the words m_arLineStart[i] to
+	m_arLineStart[i+1]-1; both offset tables always end with the total count.
+
+	Text runs can be printed in any order (Excel prints cell by cell, sometimes column by column), so
+	they are first stored as they arrive, each linked into its line in x-order; the line is found by
+	a y-index of bands, each band listing the lines crossing it. The page arrays above are only laid
+	out from the runs when searching starts.
 */
-struct TextLine : public std::list<TextWord>
+class TextArea
 {
+public:
 	// Ctors
-	/**
-		@brief Default constructor
-	*/
-	TextLine() {rcArea.left = 0; rcArea.top = 0; rcArea.right = 0; rcArea.bottom = 0;};
-	/**
-		@brief Copy constructor
-		@param other The text line object to copy
-	*/
-	TextLine(const TextLine& other) {rcArea = other.rcArea; assign(other.begin(), other.end());};
-	/// Constructor: from a string of variable-width font
-	TextLine(const std::wstring& s, const RECTL& rc, const PGLYPHPOS& arGlyphPos, const POINTQF* pWidths);
-	/// Constructor: from a string of fixed-width font
-	TextLine(const std::wstring& s, const RECTL& rc, int nCharWidth);
+	/// Default constructor
+	TextArea();
 
+protected:
 	// Members
-	/// The line's area
-	RECTL rcArea;
+	/// The letters
+	std::vector<WCHAR>			m_arLetters;
+	/// The x-location of each letter
+	std::vector<long>			m_arX;
+	/// The width of each letter
+	std::vector<int>			m_arWidths;
+	/// Index of the first letter of each word (plus the letter count)
+	std::vector<UINT>			m_arWordStart;
+	/// Index of the first word of each line (plus the word count)
+	std::vector<UINT>			m_arLineStart;
+	/// The area of each line
+	std::vector<RECTL>			m_arLineArea;
+	/// First run (leftmost) of each line
+	std::vector<UINT>			m_arLineFirstRun;
+	/// Last run (rightmost) of each line
+	std::vector<UINT>			m_arLineLastRun;
+	/// true if the page arrays are up to date with the runs
+	bool						m_bLaidOut;
 
-	/// This function checks if the received line of text is on the same line as this one, and if so, adds its data to this line
-	bool AddTextSameLine(const TextLine& other);
+	// Members (runs, as they were printed)
+	/// The letters of all the runs
+	std::vector<WCHAR>			m_arRunLetters;
+	/// The x-location of each run letter
+	std::vector<long>			m_arRunX;
+	/// The width of each run letter
+	std::vector<int>			m_arRunWidths;
+	/// Index of the first run letter of each run word (plus the run letter count)
+	std::vector<UINT>			m_arRunWordStart;
+	/// Index of the first run word of each run (plus the run word count)
+	std::vector<UINT>			m_arRunStart;
+	/// The area of each run
+	std::vector<RECTL>			m_arRunArea;
+	/// Next run (to the right) on the same line
+	std::vector<UINT>			m_arRunNext;
+	/// Letter locations of a line added with glyph positions (reused buffer)
+	std::vector<long>			m_arInX;
+	/// Letter widths of a line added with glyph positions (reused buffer)
+	std::vector<int>			m_arInWidths;
+	/// Lines crossing each band, by band
+	std::map<long, std::vector<UINT> >	m_mapBands;
+	/// Line the last run went to
+	UINT						m_nLastLine;
 
-protected:
-	/// Updates the line's rectangle using the word locations
-	void SetSides();
-};
-
-/**
-    @brief Page text helper object, used to search for specific strings to find their location
-*/
-struct TextArea : public std::list<TextLine>
-{
-protected:
 	// Members (for forward-only search)
 	/// Current search line
-	const_iterator m_iLine;
+	UINT						m_nLine;
 	/// Current search word
-	TextLine::const_iterator m_iWord;
+	UINT						m_nWord;
 
 public:
 	// Data Access
-	/// Add a new text line to the object
-	void	AddLine(const TextLine& line);
+	/// Add a new text line of variable-width font to the object
+	void	AddLine(const std::wstring& s, const RECTL& rc, const PGLYPHPOS& arGlyphPos, const POINTQF* pWidths);
+	/// Add a new text line of variable-width font to the object, with the letter locations already in page units
+	void	AddLine(const WCHAR* pText, UINT nCount, const RECTL& rc, const long* pX, const int* pWidths) {AppendLine(pText, nCount, rc, pX, pWidths, 0);};
+	/// Add a new text line of fixed-width font to the object
+	void	AddLine(const std::wstring& s, const RECTL& rc, int nCharWidth) {AppendLine(s.c_str(), (UINT)s.size(), rc, NULL, NULL, nCharWidth);};
+	/**
+		@brief Checks if there is any text on the page
+		@return true if no text was added since the last clear()
+	*/
+	bool	empty() const {return m_arLineArea.empty();};
+	/// Removes all the text (keeps the allocated memory for the next page)
+	void	clear();
 
 	// Methods
 	/// Start a new search
@@ -195,6 +270,131 @@ public:
 	bool	SearchFor(const STRLIST& words, RECTL& rectArea);
 	/// Search for the next string that starts with http:// or https:// and return its location
 	bool	SearchForURL(RECTL& rectArea, std::wstring& sWord);
+	/// Finds all the matches of all the phrases on the page, in one pass
+	void	FindAll(TextMatcher& matcher);
+	/// Appends the page words and their locations as a single-line JSON object (the page's text layer)
+	void	WriteWords(UINT nPage, const SIZEL& sizePage, std::string& sOut);
+
+protected:
+	// Helpers
+	/// Adds the words of a string as a run, to the line it is on or as a new line
+	void	AppendLine(const WCHAR* pText, UINT nCount, const RECTL& rc, const long* pX, const int* pWidths, int nCharWidth);
+	/// Finds the (latest) line the area is on
+	UINT	FindLine(const RECTL& rc) const;
+	/// Lists a line in the bands of its area it isn't listed in yet
+	void	AddToBands(UINT nLine, const RECTL* prcOld, const RECTL& rcNew);
+	/// Lays out the page arrays from the runs
+	void	Layout();
+	/**
+		@brief Returns the number of words on the page
+		@return Count of words
+	*/
+	UINT	WordCount() const {return (UINT)m_arWordStart.size() - 1;};
+	/**
+		@brief Returns the number of letters in a word
+		@param nWord The word
+		@return Count of letters
+	*/
+	UINT	WordLength(UINT nWord) const {return m_arWordStart[nWord + 1] - m_arWordStart[nWord];};
+	/**
+		@brief Returns the left border of the requested letter
+		@param nWord The word
+		@param nLetter The letter (in the word) to get the location of
+		@return Location of the requested letter
+	*/
+	long	GetStart(UINT nWord, std::wstring::size_type nLetter) const {return (nLetter >= WordLength(nWord)) ? 0 : m_arX[m_arWordStart[nWord] + nLetter];};
+	/**
+		@brief Returns the right border of the requested letter
+		@param nWord The word
+		@param nLetter The letter (in the word) to get the location of
+		@return Location of the requested letter
+	*/
+	long	GetEnd(UINT nWord, std::wstring::size_type nLetter) const {if (nLetter >= WordLength(nWord)) return 0; UINT n = m_arWordStart[nWord] + (UINT)nLetter; return m_arX[n] + m_arWidths[n];};
+	/**
+		@brief Retrieves the contents of a word
+		@param nWord The word
+		@param[out] s The text (the string buffer is reused)
+	*/
+	void	GetText(UINT nWord, std::wstring& s) const {s.assign(&m_arLetters[m_arWordStart[nWord]], WordLength(nWord));};
+	/// Appends a word to a JSON string (escaped, in UTF-8)
+	void	WriteJSONWord(UINT nWord, std::string& sOut) const;
+};
+
+/// Number of lines a URLDetector keeps an unfinished word for
+#define URL_TAILS			8
+/// Longest unfinished word a URLDetector keeps (longer ones are checked as they are)
+#define URL_TAIL_MAX		1024
+
+/**
+    @brief Finds the URLs in the page text as it is printed, without keeping the page text
+
+	Each run is checked for URLs (with the same rules as TextArea::SearchForURL) when it's added, 
+	and only runs that have a "://" are looked at closer. The last word of a run may continue in 
+	the next run on the same line, so it's kept (for a few lines at most) until the line goes on 
+	with another run or the page ends.
+*/
+class URLDetector
+{
+public:
+	// Ctors
+	/// Default constructor
+	URLDetector();
+
+protected:
+	/// Unfinished word at the end of a line
+	struct Tail
+	{
+		/// true if the tail has a word
+		bool					bOpen;
+		/// Last time the tail was used
+		UINT					nUsed;
+		/// The area of the line the word is on
+		RECTL					rc;
+		/// The letters of the word
+		std::vector<WCHAR>		arLetters;
+		/// The x-location of each letter
+		std::vector<long>		arX;
+		/// The width of each letter
+		std::vector<int>		arWidths;
+	};
+
+	// Members
+	/// The unfinished words
+	Tail						m_arTails[URL_TAILS];
+	/// Use counter, for replacing the least recently used tail
+	UINT						m_nUsed;
+	/// Text being checked: run with its tail before it (reused buffer)
+	std::vector<WCHAR>			m_arLetters;
+	/// The x-location of each letter being checked (reused buffer)
+	std::vector<long>			m_arX;
+	/// The width of each letter being checked (reused buffer)
+	std::vector<int>			m_arWidths;
+	/// Text area for searching a piece of text (reused)
+	TextArea					m_oPiece;
+	/// The area of each URL found and not retrieved yet
+	std::vector<RECTL>			m_arFoundArea;
+	/// Each URL found and not retrieved yet
+	std::vector<std::wstring>	m_arFoundURL;
+	/// Next URL to retrieve
+	UINT						m_nNextFound;
+
+public:
+	// Data Access
+	/// Checks a new run of text for URLs
+	void	AddRun(const WCHAR* pText, UINT nCount, const RECTL& rc, const long* pX, const int* pWidths);
+	/// Retrieves the next URL found
+	bool	GetURL(RECTL& rectArea, std::wstring& sURL);
+	/// Checks the unfinished words at the end of the page
+	void	Flush();
+	/// Drops everything (keeps the allocated memory for the next page)
+	void	clear();
+
+protected:
+	// Helpers
+	/// Checks a piece of text for URLs
+	void	Check(const WCHAR* pText, UINT nCount, const RECTL& rc, const long* pX, const int* pWidths);
+	/// Checks a tail for URLs and closes it
+	void	Close(Tail& tail);
 };
 
 #endif   //#define _TEXTPART_H_
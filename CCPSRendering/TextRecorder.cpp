@@ -0,0 +1,271 @@
+/**
+	@file
+	@brief 
+*/
+
+/*
+ * CC PDF Converter: Windows PDF Printer with Creative Commons license support
+ * Excel to PDF Converter: Excel PDF printing addin, keeping hyperlinks AND Creative Commons license support
+ * Copyright (C) 2007-2010 Guy Hachlili <hguy@cogniview.com>, Cogniview LTD.
+ * 
+ * This file is part of CC PDF Converter / Excel to PDF Converter
+ * 
+ * CC PDF Converter and Excel to PDF Converter are free software;
+ * you can redistribute them and/or modify them under the terms of the 
+ * GNU General Public License as published by the Free Software Foundation;
+ * either version 2 of the License, or (at your option) any later version.
+ * 
+ * CC PDF Converter and Excel to PDF Converter are is distributed in the hope 
+ * that they will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. * 
+ */
+
+
+#include "precomp.h"
+#include "debug.h"
+#include "TextRecorder.h"
+#include "GlyphTranslator.h"
+
+/**
+	@brief Default constructor
+*/
+TextRecorder::TextRecorder() : m_nLastFont(TEXT_NONE), m_nDecoded(0)
+{
+	m_arRunStart.push_back(0);
+}
+
+/**
+*/
+void TextRecorder::clear()
+{
+	// Resizing down keeps the memory, so the next page won't have to allocate it again
+	m_arFonts.resize(0);
+	m_arFontID.resize(0);
+	m_arFontKey.resize(0);
+	m_arFontMap.resize(0);
+	m_arPendingFonts.resize(0);
+	m_nLastFont = TEXT_NONE;
+	m_arRunFont.resize(0);
+	m_arRunStart.resize(1);
+	m_arRunArea.resize(0);
+	m_arGlyphs.resize(0);
+	m_arX.resize(0);
+	m_arWidths.resize(0);
+	m_nDecoded = 0;
+	m_arRegions.resize(0);
+}
+
+/**
+	@param rc The run's printed location
+	@return true if the run is in one of the regions (or there are no regions), false if it can be dropped
+*/
+bool TextRecorder::IsWanted(const RECTL& rc) const
+{
+	if (m_arRegions.empty())
+		return true;
+	for (std::vector<RECTL>::const_iterator i = m_arRegions.begin(); i != m_arRegions.end(); i++)
+		if (AreasIntersect(*i, rc))
+			return true;
+	return false;
+}
+
+/**
+	@param nFontID The font's identity (the FONTOBJ's iUniq)
+	@return The font's index, or TEXT_NONE if it's not in the table yet (or has no identity)
+*/
+UINT TextRecorder::FindFont(ULONG nFontID)
+{
+	// A font without an identity can't be matched
+	if (nFontID == 0)
+		return TEXT_NONE;
+
+	// Usually the same font as before
+	if ((m_nLastFont != TEXT_NONE) && (m_arFontID[m_nLastFont] == nFontID))
+		return m_nLastFont;
+
+	// There are only a few fonts on a page
+	for (UINT n = 0; n < m_arFontID.size(); n++)
+		if (m_arFontID[n] == nFontID)
+		{
+			m_nLastFont = n;
+			return n;
+		}
+	return TEXT_NONE;
+}
+
+/**
+	@param id The font's identity (its iUniq is 0 if it has none)
+	@param lf The font's description, for translating its glyphs
+	@return The index of the new font
+*/
+UINT TextRecorder::AddFont(const GlyphFontID& id, const LOGFONT& lf)
+{
+	m_nLastFont = (UINT)m_arFontID.size();
+	m_arFontID.push_back(id.iUniq);
+	m_arFontKey.push_back(id);
+	m_arFontMap.push_back(NULL);
+	m_arFonts.resize(m_nLastFont + 1);
+	m_arFonts[m_nLastFont] = lf;
+	m_arPendingFonts.push_back(m_nLastFont);
+	return m_nLastFont;
+}
+
+/**
+	@param id The font's identity
+	@param pMap The font's map (NULL if it can't be translated)
+	@return The index of the new font
+*/
+UINT TextRecorder::AddFont(const GlyphFontID& id, const GlyphToText* pMap)
+{
+	m_nLastFont = (UINT)m_arFontID.size();
+	m_arFontID.push_back(id.iUniq);
+	m_arFontKey.push_back(id);
+	m_arFontMap.push_back(pMap);
+	return m_nLastFont;
+}
+
+/**
+	@param nFont The run's font (TEXT_NONE if the glyphs are letters)
+	@param pGlyphs The glyphs
+	@param nCount Number of glyphs
+	@param rc The run's printed location
+*/
+void TextRecorder::StartRun(UINT nFont, const WCHAR* pGlyphs, UINT nCount, const RECTL& rc)
+{
+	m_arRunFont.push_back(nFont);
+	m_arRunArea.push_back(rc);
+	m_arGlyphs.insert(m_arGlyphs.end(), pGlyphs, pGlyphs + nCount);
+	m_arRunStart.push_back((UINT)m_arGlyphs.size());
+}
+
+/**
+	@param nFont The run's font (TEXT_NONE if the glyphs are letters)
+	@param pGlyphs The glyphs
+	@param nCount Number of glyphs
+	@param rc The run's printed location
+	@param arGlyphPos Array of glyph locations, as received from the DDI
+	@param pWidths Array of glyph advance widths, as received from the DDI
+*/
+void TextRecorder::AddRun(UINT nFont, const WCHAR* pGlyphs, UINT nCount, const RECTL& rc, const PGLYPHPOS arGlyphPos, const POINTQF* pWidths)
+{
+	StartRun(nFont, pGlyphs, nCount, rc);
+	for (UINT n = 0; n < nCount; n++)
+	{
+		m_arX.push_back(arGlyphPos[n].ptl.x);
+		m_arWidths.push_back(pWidths[n].x.HighPart >> 4);
+	}
+}
+
+/**
+	@param nFont The run's font (TEXT_NONE if the glyphs are letters)
+	@param pGlyphs The glyphs
+	@param nCount Number of glyphs
+	@param rc The run's printed location
+	@param nCharWidth The width of each glyph
+*/
+void TextRecorder::AddRun(UINT nFont, const WCHAR* pGlyphs, UINT nCount, const RECTL& rc, int nCharWidth)
+{
+	StartRun(nFont, pGlyphs, nCount, rc);
+	for (UINT n = 0; n < nCount; n++)
+	{
+		m_arX.push_back((long) (n * nCharWidth));
+		m_arWidths.push_back(nCharWidth);
+	}
+}
+
+/**
+	@param pTranslator The glyph translator (if NULL, the glyph runs can't be translated)
+*/
+void TextRecorder::MapFonts(GlyphTranslator* pTranslator)
+{
+	// Get each font's map once
+	if (pTranslator != NULL)
+		for (std::vector<UINT>::const_iterator i = m_arPendingFonts.begin(); i != m_arPendingFonts.end(); i++)
+			m_arFontMap[*i] = pTranslator->GetFontTranslation(m_arFontKey[*i], m_arFonts[*i]);
+	m_arPendingFonts.resize(0);
+	m_arLetters.resize(m_arGlyphs.size());
+}
+
+/**
+	@param nRun The run to translate (MapFonts() must be called first)
+	@return The letters of the run, or NULL if the run is empty or can't be translated
+*/
+const WCHAR* TextRecorder::DecodeRun(UINT nRun)
+{
+	UINT nStart = m_arRunStart[nRun], nCount = m_arRunStart[nRun + 1] - nStart;
+	if (nCount == 0)
+		return NULL;
+	if (m_arRunFont[nRun] == TEXT_NONE)
+		// An actual string
+		return &m_arGlyphs[nStart];
+
+	// Those are glyphs, not an actual string, so we need to translate them
+	const GlyphToText* pMap = m_arFontMap[m_arRunFont[nRun]];
+	if (pMap == NULL)
+	{
+		TRACE(DLLTEXT("Could not unglyph run %u...\r\n"), nRun);
+		return NULL;
+	}
+	pMap->TranslateRun(&m_arGlyphs[nStart], nCount, &m_arLetters[nStart]);
+	return &m_arLetters[nStart];
+}
+
+/**
+	@param pTranslator The glyph translator (if NULL, only the string runs are added)
+	@param text The page text to add the runs to, in the order they were printed
+
+	Runs decoded by an earlier call are not added again, so the page text can be taken more than once.
+*/
+void TextRecorder::Decode(GlyphTranslator* pTranslator, TextArea& text)
+{
+	if (m_nDecoded >= m_arRunArea.size())
+		return;
+
+	// Translate the runs and add them
+	MapFonts(pTranslator);
+	for (UINT nRun = m_nDecoded; nRun < m_arRunArea.size(); nRun++)
+	{
+		const WCHAR* pLetters = DecodeRun(nRun);
+		if (pLetters != NULL)
+		{
+			UINT nStart = m_arRunStart[nRun];
+			text.AddLine(pLetters, m_arRunStart[nRun + 1] - nStart, m_arRunArea[nRun], &m_arX[nStart], &m_arWidths[nStart]);
+		}
+	}
+	m_nDecoded = (UINT)m_arRunArea.size();
+}
+
+/**
+	@param pTranslator The glyph translator (if NULL, only the string runs are checked)
+	@param urls The URL detector to pass the runs to, in the order they were printed
+*/
+void TextRecorder::Stream(GlyphTranslator* pTranslator, URLDetector& urls)
+{
+	if (empty())
+		return;
+
+	// Translate the runs and check them
+	MapFonts(pTranslator);
+	for (UINT nRun = 0; nRun < m_arRunArea.size(); nRun++)
+	{
+		const WCHAR* pLetters = DecodeRun(nRun);
+		if (pLetters != NULL)
+		{
+			UINT nStart = m_arRunStart[nRun];
+			urls.AddRun(pLetters, m_arRunStart[nRun + 1] - nStart, m_arRunArea[nRun], &m_arX[nStart], &m_arWidths[nStart]);
+		}
+	}
+
+	// Forget the runs, but keep the fonts for the rest of the page
+	m_arRunFont.resize(0);
+	m_arRunStart.resize(1);
+	m_arRunArea.resize(0);
+	m_arGlyphs.resize(0);
+	m_arX.resize(0);
+	m_arWidths.resize(0);
+	m_nDecoded = 0;
+}
@@ -0,0 +1,130 @@
+/**
+	@file
+	@brief 
+*/
+
+/*
+ * CC PDF Converter: Windows PDF Printer with Creative Commons license support
+ * Excel to PDF Converter: Excel PDF printing addin, keeping hyperlinks AND Creative Commons license support
+ * Copyright (C) 2007-2010 Guy Hachlili <hguy@cogniview.com>, Cogniview LTD.
+ * 
+ * This file is part of CC PDF Converter / Excel to PDF Converter
+ * 
+ * CC PDF Converter and Excel to PDF Converter are free software;
+ * you can redistribute them and/or modify them under the terms of the 
+ * GNU General Public License as published by the Free Software Foundation;
+ * either version 2 of the License, or (at your option) any later version.
+ * 
+ * CC PDF Converter and Excel to PDF Converter are is distributed in the hope 
+ * that they will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. * 
+ */
+
+#ifndef _TEXTRECORDER_H_
+#define _TEXTRECORDER_H_
+
+#include <vector>
+#include "TextPart.h"
+#include "GlyphTranslator.h"
+
+/**
+    @brief Raw record of the text runs printed on a page, decoded into a TextArea only when the page text is searched
+
+	Each run keeps its font (an index into the page's font table, or TEXT_NONE if the run is an 
+	actual string), its glyphs and the location and width of each glyph, all in flat arrays. Glyph 
+	indices are translated to Unicode in Decode(), one font map lookup per font and one tight loop
+	per run, so pages whose text is never searched don't pay for the translation.
+*/
+class TextRecorder
+{
+public:
+	// Ctors
+	/// Default constructor
+	TextRecorder();
+
+protected:
+	// Members (fonts)
+	/// The fonts used on the page (only those whose map is still to be looked up are filled)
+	std::vector<LOGFONT>		m_arFonts;
+	/// The identity of each font (the FONTOBJ's iUniq)
+	std::vector<ULONG>			m_arFontID;
+	/// The full identity of each font
+	std::vector<GlyphFontID>	m_arFontKey;
+	/// The font the last lookup found
+	UINT						m_nLastFont;
+
+	// Members (runs)
+	/// Font of each run (TEXT_NONE if the run is a string and not glyphs)
+	std::vector<UINT>			m_arRunFont;
+	/// Index of the first glyph of each run (plus the glyph count)
+	std::vector<UINT>			m_arRunStart;
+	/// The area of each run
+	std::vector<RECTL>			m_arRunArea;
+	/// The glyphs (or letters) of all the runs
+	std::vector<WCHAR>			m_arGlyphs;
+	/// The x-location of each glyph
+	std::vector<long>			m_arX;
+	/// The width of each glyph
+	std::vector<int>			m_arWidths;
+	/// Number of runs already added to the page text
+	UINT						m_nDecoded;
+
+	/// The page areas to record the runs of (empty for the whole page)
+	std::vector<RECTL>			m_arRegions;
+
+	// Members (decoding)
+	/// Map of each font (NULL if it can't be translated, or isn't looked up yet)
+	std::vector<const GlyphToText*>	m_arFontMap;
+	/// The fonts whose map is still to be looked up
+	std::vector<UINT>			m_arPendingFonts;
+	/// Decoded letters (reused buffer)
+	std::vector<WCHAR>			m_arLetters;
+
+public:
+	// Data Access
+	/**
+		@brief Checks if any text was recorded on the page
+		@return true if no run was added since the last clear()
+	*/
+	bool	empty() const {return m_arRunArea.empty();};
+	/// Removes all the runs, fonts and regions (keeps the allocated memory for the next page)
+	void	clear();
+	/**
+		@brief Sets the page areas to record the text of; runs outside all of them are dropped
+		@param arRegions The areas (empty to record the whole page)
+	*/
+	void	SetRegions(const std::vector<RECTL>& arRegions) {m_arRegions = arRegions;};
+	/// Checks if a run in a page area should be recorded
+	bool	IsWanted(const RECTL& rc) const;
+	/// Finds a font by its identity
+	UINT	FindFont(ULONG nFontID);
+	/// Adds a font to the page's font table, to be looked up when the page text is decoded
+	UINT	AddFont(const GlyphFontID& id, const LOGFONT& lf);
+	/// Adds a font whose map is already known to the page's font table
+	UINT	AddFont(const GlyphFontID& id, const GlyphToText* pMap);
+	/// Records a run of a variable-width font
+	void	AddRun(UINT nFont, const WCHAR* pGlyphs, UINT nCount, const RECTL& rc, const PGLYPHPOS arGlyphPos, const POINTQF* pWidths);
+	/// Records a run of a fixed-width font
+	void	AddRun(UINT nFont, const WCHAR* pGlyphs, UINT nCount, const RECTL& rc, int nCharWidth);
+
+	// Methods
+	/// Translates the recorded runs (not yet decoded) and adds them to the page text
+	void	Decode(GlyphTranslator* pTranslator, TextArea& text);
+	/// Translates the runs recorded so far, checks them for URLs and forgets them (keeps the fonts)
+	void	Stream(GlyphTranslator* pTranslator, URLDetector& urls);
+
+protected:
+	// Helpers
+	/// Starts a new run
+	void	StartRun(UINT nFont, const WCHAR* pGlyphs, UINT nCount, const RECTL& rc);
+	/// Looks up the maps of the fonts added since the last call
+	void	MapFonts(GlyphTranslator* pTranslator);
+	/// Translates a run
+	const WCHAR* DecodeRun(UINT nRun);
+};
+
+#endif   //#define _TEXTRECORDER_H_
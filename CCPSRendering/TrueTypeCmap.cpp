@@ -0,0 +1,214 @@
+/**
+	@file
+	@brief Reads glyph-to-Unicode maps straight from TrueType character map (cmap) tables
+*/
+
+/*
+ * CC PDF Converter: Windows PDF Printer with Creative Commons license support
+ * Excel to PDF Converter: Excel PDF printing addin, keeping hyperlinks AND Creative Commons license support
+ * Copyright (C) 2007-2010 Guy Hachlili <hguy@cogniview.com>, Cogniview LTD.
+ * 
+ * This file is part of CC PDF Converter / Excel to PDF Converter
+ * 
+ * CC PDF Converter and Excel to PDF Converter are free software;
+ * you can redistribute them and/or modify them under the terms of the 
+ * GNU General Public License as published by the Free Software Foundation;
+ * either version 2 of the License, or (at your option) any later version.
+ * 
+ * CC PDF Converter and Excel to PDF Converter are is distributed in the hope 
+ * that they will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. * 
+ */
+
+#include "precomp.h"
+#include "debug.h"
+#include "TrueTypeCmap.h"
+
+/// Tag of a TrueType collection file ('ttcf')
+#define TRUETYPE_TAG_COLLECTION	0x74746366
+
+/**
+	@param pFont The font file's data
+	@param nSize Size of the data
+	@param dwTag The table's tag (as a big-endian number, e.g. TRUETYPE_TAG_CMAP)
+	@param[out] pTable Receives the table's data
+	@param[out] nTableSize Receives the table's size
+	@return true if found, false if the font doesn't have the table (or isn't a TrueType font)
+*/
+bool TrueTypeCmap::FindTable(const BYTE* pFont, size_t nSize, DWORD dwTag, const BYTE*& pTable, size_t& nTableSize)
+{
+	// A collection starts with the offsets of its fonts
+	size_t nStart = 0;
+	if ((nSize >= 16) && (ReadDWord(pFont) == TRUETYPE_TAG_COLLECTION))
+	{
+		if (ReadDWord(pFont + 8) == 0)
+			return false;
+		nStart = ReadDWord(pFont + 12);
+	}
+	if ((nStart > nSize) || (nSize - nStart < 12))
+		return false;
+
+	// The table directory: 12 bytes of header, then 16 bytes per table
+	const BYTE* pDir = pFont + nStart;
+	UINT nTables = ReadWord(pDir + 4);
+	if ((nSize - nStart - 12) / 16 < nTables)
+		return false;
+	for (UINT n = 0; n < nTables; n++)
+	{
+		const BYTE* pRecord = pDir + 12 + n * 16;
+		if (ReadDWord(pRecord) != dwTag)
+			continue;
+		size_t nOffset = ReadDWord(pRecord + 8), nLength = ReadDWord(pRecord + 12);
+		if ((nOffset > nSize) || (nLength > nSize - nOffset))
+			return false;
+		pTable = pFont + nOffset;
+		nTableSize = nLength;
+		return true;
+	}
+	return false;
+}
+
+/**
+	@param pCmap The character map table
+	@param nSize Size of the table
+	@param[out] map The map to add the glyphs to
+	@return true if done, false if the table has no Unicode subtable that can be read (or is damaged)
+*/
+bool TrueTypeCmap::ReadGlyphMap(const BYTE* pCmap, size_t nSize, GlyphToText& map)
+{
+	if (nSize < 4)
+		return false;
+	UINT nSubtables = ReadWord(pCmap + 2);
+	if ((nSize - 4) / 8 < nSubtables)
+		return false;
+
+	// Find the best Unicode subtable: full repertoire (format 12) first, then BMP only (format 4)
+	const BYTE* pBest = NULL;
+	size_t nBestSize = 0;
+	int nBestRank = 0;
+	for (UINT n = 0; n < nSubtables; n++)
+	{
+		const BYTE* pRecord = pCmap + 4 + n * 8;
+		WORD wPlatform = ReadWord(pRecord), wEncoding = ReadWord(pRecord + 2);
+		size_t nOffset = ReadDWord(pRecord + 4);
+		if ((nOffset > nSize) || (nSize - nOffset < 4))
+			continue;
+		// Unicode platform (0), or Windows platform (3) Unicode BMP (1) or full repertoire (10) encodings
+		if ((wPlatform != 0) && !((wPlatform == 3) && ((wEncoding == 1) || (wEncoding == 10))))
+			continue;
+		WORD wFormat = ReadWord(pCmap + nOffset);
+		int nRank = (wFormat == 12) ? 2 : ((wFormat == 4) ? 1 : 0);
+		if (nRank > nBestRank)
+		{
+			pBest = pCmap + nOffset;
+			nBestSize = nSize - nOffset;
+			nBestRank = nRank;
+		}
+	}
+	if (pBest == NULL)
+		return false;
+	return (nBestRank == 2) ? ReadFormat12(pBest, nBestSize, map) : ReadFormat4(pBest, nBestSize, map);
+}
+
+/**
+	@param pSub The subtable
+	@param nSize Size of the subtable (up to the end of the character map table)
+	@param[out] map The map to add the glyphs to
+	@return true if done, false if the subtable is damaged
+*/
+bool TrueTypeCmap::ReadFormat4(const BYTE* pSub, size_t nSize, GlyphToText& map)
+{
+	// Header: format, length, language, segCountX2, searchRange, entrySelector, rangeShift
+	if (nSize < 14)
+		return false;
+	size_t nLength = min((size_t)ReadWord(pSub + 2), nSize);
+	UINT nSegments = ReadWord(pSub + 6) / 2;
+	// Then endCode[], a pad word, startCode[], idDelta[] and idRangeOffset[], and the glyph index array
+	const BYTE* pEnd = pSub + 14;
+	const BYTE* pStart = pEnd + nSegments * 2 + 2;
+	const BYTE* pDelta = pStart + nSegments * 2;
+	const BYTE* pRangeOffset = pDelta + nSegments * 2;
+	if (14 + nSegments * 8 + 2 > nLength)
+		return false;
+
+	UINT nPrevLast = 0;
+	for (UINT n = 0; n < nSegments; n++)
+	{
+		UINT nFirst = ReadWord(pStart + n * 2), nLast = ReadWord(pEnd + n * 2);
+		WORD wDelta = ReadWord(pDelta + n * 2), wRangeOffset = ReadWord(pRangeOffset + n * 2);
+		// The segments are sorted and don't overlap, so no character is read twice
+		if (((n > 0) && (nFirst <= nPrevLast)) || (nFirst > nLast))
+			return false;
+		nPrevLast = nLast;
+		// The last segment is only an end marker
+		if (nLast == 0xFFFF)
+			nLast = 0xFFFE;
+		if (wRangeOffset == 0)
+		{
+			for (UINT c = nFirst; c <= nLast; c++)
+			{
+				WORD wGlyph = (WORD)(c + wDelta);
+				if (wGlyph != 0)
+					map.Add(wGlyph, (WCHAR)c);
+			}
+		}
+		else
+		{
+			// The glyphs are in the glyph index array, from where this segment's idRangeOffset points
+			size_t nOffset = (pRangeOffset + n * 2 - pSub) + wRangeOffset;
+			if ((nFirst <= nLast) && (nOffset + (nLast - nFirst + 1) * 2 > nLength))
+				return false;
+			const BYTE* pGlyphs = pSub + nOffset;
+			for (UINT c = nFirst; c <= nLast; c++)
+			{
+				WORD wGlyph = ReadWord(pGlyphs + (c - nFirst) * 2);
+				if (wGlyph != 0)
+					wGlyph = (WORD)(wGlyph + wDelta);
+				if (wGlyph != 0)
+					map.Add(wGlyph, (WCHAR)c);
+			}
+		}
+	}
+	return true;
+}
+
+/**
+	@param pSub The subtable
+	@param nSize Size of the subtable (up to the end of the character map table)
+	@param[out] map The map to add the glyphs to
+	@return true if done, false if the subtable is damaged
+*/
+bool TrueTypeCmap::ReadFormat12(const BYTE* pSub, size_t nSize, GlyphToText& map)
+{
+	// Header: format, reserved, length, language, numGroups; then 12 bytes per group
+	if (nSize < 16)
+		return false;
+	size_t nLength = min((size_t)ReadDWord(pSub + 4), nSize);
+	DWORD dwGroups = ReadDWord(pSub + 12);
+	if ((nLength < 16) || ((nLength - 16) / 12 < dwGroups))
+		return false;
+
+	DWORD dwPrevLast = 0;
+	for (DWORD n = 0; n < dwGroups; n++)
+	{
+		const BYTE* pGroup = pSub + 16 + n * 12;
+		DWORD dwFirst = ReadDWord(pGroup), dwLast = ReadDWord(pGroup + 4), dwGlyph = ReadDWord(pGroup + 8);
+		// The groups are sorted and don't overlap, so no character is read twice
+		if (((n > 0) && (dwFirst <= dwPrevLast)) || (dwFirst > dwLast))
+			return false;
+		// Only the Basic Multilingual Plane
+		if (dwFirst > 0xFFFF)
+			break;
+		dwPrevLast = dwLast;
+		if (dwLast > 0xFFFF)
+			dwLast = 0xFFFF;
+		for (DWORD c = dwFirst; (c <= dwLast) && (dwGlyph <= 0xFFFF); c++, dwGlyph++)
+			if (dwGlyph != 0)
+				map.Add((WORD)dwGlyph, (WCHAR)c);
+	}
+	return true;
+}
@@ -0,0 +1,69 @@
+/**
+	@file
+	@brief Reads glyph-to-Unicode maps straight from TrueType character map (cmap) tables
+*/
+
+/*
+ * CC PDF Converter: Windows PDF Printer with Creative Commons license support
+ * Excel to PDF Converter: Excel PDF printing addin, keeping hyperlinks AND Creative Commons license support
+ * Copyright (C) 2007-2010 Guy Hachlili <hguy@cogniview.com>, Cogniview LTD.
+ * 
+ * This file is part of CC PDF Converter / Excel to PDF Converter
+ * 
+ * CC PDF Converter and Excel to PDF Converter are free software;
+ * you can redistribute them and/or modify them under the terms of the 
+ * GNU General Public License as published by the Free Software Foundation;
+ * either version 2 of the License, or (at your option) any later version.
+ * 
+ * CC PDF Converter and Excel to PDF Converter are is distributed in the hope 
+ * that they will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. * 
+ */
+
+#ifndef _TRUETYPECMAP_H_
+#define _TRUETYPECMAP_H_
+
+#include "GlyphTranslator.h"
+
+/// Tag of the character map table, as it's in a font file's table directory ('cmap')
+#define TRUETYPE_TAG_CMAP		0x636D6170
+
+/**
+    @brief Builds glyph-to-Unicode maps from TrueType character map tables
+
+	The character map is read from its Unicode subtable (format 12 if the font has one, else format
+	4), and inverted in one pass over its segments, in character order, so each glyph gets the 
+	lowest character that shows it (as GDI's ranges give them). Characters beyond the Basic 
+	Multilingual Plane are left out, as a WCHAR can't hold them.
+
+	All the data is checked against the table size, so a damaged table fails instead of reading
+	past it. A table whose segments aren't sorted or overlap fails too: each character is read 
+	only once, so no table takes more than 65536 steps. Nothing here uses GDI: the table can come
+	from GetFontData() or from a font file (see FindTable()).
+*/
+class TrueTypeCmap
+{
+public:
+	// Methods
+	/// Finds a table in a TrueType font file (or the first font of a collection)
+	static bool	FindTable(const BYTE* pFont, size_t nSize, DWORD dwTag, const BYTE*& pTable, size_t& nTableSize);
+	/// Builds a glyph-to-Unicode map from a character map table
+	static bool	ReadGlyphMap(const BYTE* pCmap, size_t nSize, GlyphToText& map);
+
+protected:
+	// Helpers
+	/// Reads a big-endian WORD
+	static WORD		ReadWord(const BYTE* p) {return (WORD)((p[0] << 8) | p[1]);};
+	/// Reads a big-endian DWORD
+	static DWORD	ReadDWord(const BYTE* p) {return ((DWORD)p[0] << 24) | ((DWORD)p[1] << 16) | ((DWORD)p[2] << 8) | (DWORD)p[3];};
+	/// Inverts a format 4 subtable (segment mapping to delta values)
+	static bool	ReadFormat4(const BYTE* pSub, size_t nSize, GlyphToText& map);
+	/// Inverts a format 12 subtable (segmented coverage)
+	static bool	ReadFormat12(const BYTE* pSub, size_t nSize, GlyphToText& map);
+};
+
+#endif   //#define _TRUETYPECMAP_H_
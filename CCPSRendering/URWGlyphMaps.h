@@ -0,0 +1,434 @@
+/**
+	@file
+	@brief Glyph maps of the fonts the installer ships (Install/urwfonts), compiled into the driver
+*/
+
+/*
+ * Generated by urwmapgen (see urwmapgen.cpp) - do not edit.
+ */
+
+#ifndef _URWGLYPHMAPS_H_
+#define _URWGLYPHMAPS_H_
+
+/// Pages of the built-in maps (14 different pages, shared between the maps)
+static constexpr WCHAR s_arURWGlyphPages[14][256] =
+{
+	{
+		0x007F, 0x007F, 0x007F, 0x0020, 0x0021, 0x0022, 0x0023, 0x0024, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002A, 0x002B, 0x002C,
+		0x002D, 0x002E, 0x002F, 0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003A, 0x003B, 0x003C,
+		0x003D, 0x003E, 0x003F, 0x0040, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004A, 0x004B, 0x004C,
+		0x004D, 0x004E, 0x004F, 0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005A, 0x005B, 0x005C,
+		0x005D, 0x005E, 0x005F, 0x0060, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006A, 0x006B, 0x006C,
+		0x006D, 0x006E, 0x006F, 0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007A, 0x007B, 0x007C,
+		0x007D, 0x007E, 0x00C4, 0x00C5, 0x00C7, 0x00C9, 0x00D1, 0x00D6, 0x00DC, 0x00E1, 0x00E0, 0x00E2, 0x00E4, 0x00E3, 0x00E5, 0x00E7,
+		0x00E9, 0x00E8, 0x00EA, 0x00EB, 0x00ED, 0x00EC, 0x00EE, 0x00EF, 0x00F1, 0x00F3, 0x00F2, 0x00F4, 0x00F6, 0x00F5, 0x00FA, 0x00F9,
+		0x00FB, 0x00FC, 0x2020, 0x00B0, 0x00A2, 0x00A3, 0x00A7, 0x2022, 0x00B6, 0x00DF, 0x00AE, 0x00A9, 0x2122, 0x00B4, 0x00A8, 0x2260,
+		0x00C6, 0x00D8, 0x221E, 0x00B1, 0x2264, 0x2265, 0x00A5, 0x00B5, 0x2202, 0x2211, 0x220F, 0x03C0, 0x222B, 0x00AA, 0x00BA, 0x2126,
+		0x00E6, 0x00F8, 0x00BF, 0x00A1, 0x00AC, 0x221A, 0x0192, 0x2248, 0x2206, 0x00AB, 0x00BB, 0x2026, 0x007F, 0x00C0, 0x00C3, 0x00D5,
+		0x0152, 0x0153, 0x2013, 0x2014, 0x201C, 0x201D, 0x2018, 0x2019, 0x00F7, 0x25CA, 0x00FF, 0x0178, 0x007F, 0x00A4, 0x2039, 0x203A,
+		0xF001, 0xF002, 0x2021, 0x2219, 0x201A, 0x201E, 0x2030, 0x00C2, 0x00CA, 0x00C1, 0x00CB, 0x00C8, 0x00CD, 0x00CE, 0x00CF, 0x00CC,
+		0x00D3, 0x00D4, 0x007F, 0x00D2, 0x00DA, 0x00DB, 0x00D9, 0x0131, 0x02C6, 0x02DC, 0x02C9, 0x02D8, 0x02D9, 0x02DA, 0x00B8, 0x02DD,
+		0x02DB, 0x02C7, 0x0014, 0x00A0, 0x00A6, 0x00AD, 0x00AF, 0x00B2, 0x00B3, 0x00B7, 0x00B9, 0x00BC, 0x00BD, 0x00BE, 0x00D0, 0x00D7,
+		0x00DD, 0x00DE, 0x00F0, 0x00FD, 0x00FE, 0x0100, 0x0101, 0x0102, 0x0103, 0x0104, 0x0105, 0x0106, 0x0107, 0x010C, 0x010D, 0x010E
+	},
+	{
+		0x010F, 0x0110, 0x0111, 0x0112, 0x0113, 0x0116, 0x0117, 0x0118, 0x0119, 0x011A, 0x011B, 0x011E, 0x011F, 0x0122, 0x0123, 0x0128,
+		0x0129, 0x012A, 0x012B, 0x012E, 0x012F, 0x0130, 0x0132, 0x0133, 0x0136, 0x0137, 0x0138, 0x0139, 0x013A, 0x013B, 0x013C, 0x013D,
+		0x013E, 0x013F, 0x0140, 0x0141, 0x0142, 0x0143, 0x0144, 0x0145, 0x0146, 0x0147, 0x0148, 0x0149, 0x014A, 0x014B, 0x014C, 0x014D,
+		0x0150, 0x0151, 0x0154, 0x0155, 0x0156, 0x0157, 0x0158, 0x0159, 0x015A, 0x015B, 0x015E, 0x015F, 0x0160, 0x0161, 0x0162, 0x0163,
+		0x0164, 0x0165, 0x0166, 0x0167, 0x0168, 0x0169, 0x016A, 0x016B, 0x016E, 0x016F, 0x0170, 0x0171, 0x0172, 0x0173, 0x0179, 0x017A,
+		0x017B, 0x017C, 0x017D, 0x017E, 0x0393, 0x0398, 0x039B, 0x039E, 0x03A0, 0x03A3, 0x03A5, 0x03A6, 0x03A8, 0x03A9, 0x03B1, 0x03B2,
+		0x03B3, 0x03B4, 0x03B5, 0x03B6, 0x03B7, 0x03B8, 0x03B9, 0x03BA, 0x03BB, 0x03BC, 0x03BD, 0x03BE, 0x03BF, 0x03C1, 0x03C2, 0x03C3,
+		0x03C4, 0x03C5, 0x03C6, 0x03C7, 0x03C8, 0x03C9, 0x03D1, 0x03D5, 0x03D6, 0x2017, 0x2032, 0x2033, 0x203C, 0x2070, 0x2074, 0x2075,
+		0x2076, 0x2077, 0x2078, 0x2079, 0x207F, 0x20A7, 0x2105, 0x210F, 0x2111, 0x2112, 0x2113, 0x2118, 0x211C, 0x211E, 0x2120, 0x2128,
+		0x212D, 0x212F, 0x2135, 0x2136, 0x2137, 0x2190, 0x2191, 0x2192, 0x2193, 0x2194, 0x2195, 0x2196, 0x2197, 0x2198, 0x2199, 0x21A8,
+		0x21B5, 0x21C4, 0x21C6, 0x21D0, 0x21D1, 0x21D2, 0x21D3, 0x21D4, 0x21D5, 0x2200, 0x2203, 0x2205, 0x2207, 0x2208, 0x2209, 0x220B,
+		0x220D, 0x2212, 0x2213, 0x2215, 0x2217, 0x2218, 0x221D, 0x221F, 0x2220, 0x2223, 0x2225, 0x2227, 0x2228, 0x2229, 0x222A, 0x222E,
+		0x2234, 0x2235, 0x2237, 0x2243, 0x2245, 0x2261, 0x2262, 0x226A, 0x226B, 0x2282, 0x2283, 0x2284, 0x2285, 0x2286, 0x2287, 0x2295,
+		0x2296, 0x2297, 0x2298, 0x2299, 0x22A2, 0x22A3, 0x22A4, 0x22A5, 0x22BB, 0x2302, 0x2310, 0x2320, 0x2321, 0x2329, 0x232A, 0x2500,
+		0x2502, 0x250C, 0x2510, 0x2514, 0x2518, 0x251C, 0x2524, 0x252C, 0x2534, 0x253C, 0x2550, 0x2551, 0x2552, 0x2553, 0x2554, 0x2555,
+		0x2556, 0x2557, 0x2558, 0x2559, 0x255A, 0x255B, 0x255C, 0x255D, 0x255E, 0x255F, 0x2560, 0x2561, 0x2562, 0x2563, 0x2564, 0x2565
+	},
+	{
+		0x2566, 0x2567, 0x2568, 0x2569, 0x256A, 0x256B, 0x256C, 0x256D, 0x256E, 0x256F, 0x2570, 0x2580, 0x2584, 0x2588, 0x258C, 0x2590,
+		0x2591, 0x2592, 0x2593, 0x25A0, 0x25A1, 0x25AA, 0x25AB, 0x25AC, 0x25B2, 0x25B5, 0x25B9, 0x25BA, 0x25BC, 0x25BF, 0x25C3, 0x25C4,
+		0x25C6, 0x25C7, 0x25CB, 0x25CF, 0x25D8, 0x25D9, 0x25E6, 0x263A, 0x263B, 0x263C, 0x2640, 0x2642, 0x2660, 0x2663, 0x2665, 0x2666,
+		0x266A, 0x266B, 0x301A, 0x301B, 0xEFBF, 0xEFC0, 0xEFC1, 0xEFC2, 0xEFC3, 0xEFC4, 0xEFC5, 0xEFC6, 0xEFC7, 0xEFC8, 0xEFC9, 0xEFCA,
+		0xEFCB, 0xEFCC, 0xEFCD, 0xEFCE, 0xEFCF, 0xEFD0, 0xEFD1, 0xEFD2, 0xEFD3, 0xEFD4, 0xEFD5, 0xEFD6, 0xEFD7, 0xEFD8, 0xEFD9, 0xEFDA,
+		0xEFDB, 0xEFDC, 0xEFDD, 0xEFDE, 0xEFDF, 0xEFE0, 0xEFE1, 0xEFE2, 0xEFE3, 0xEFE4, 0xEFE5, 0xEFE6, 0xEFE7, 0xEFE8, 0xEFE9, 0xEFEA,
+		0xEFEB, 0xEFEC, 0xEFED, 0xEFEE, 0xEFEF, 0xEFF0, 0xEFF1, 0xEFF2, 0xEFF3, 0xEFF4, 0xEFF5, 0xEFF6, 0xEFF7, 0xEFF8, 0xEFF9, 0xEFFA,
+		0xEFFB, 0xEFFC, 0xEFFD, 0xEFFE, 0xEFFF, 0xFB00, 0xFB03, 0xFB04, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F
+	},
+	{
+		0x007F, 0x0020, 0x0021, 0x0024, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002A, 0x002B, 0x002C, 0x002D, 0x002E, 0x002F, 0x0030,
+		0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003A, 0x003B, 0x003C, 0x003D, 0x003E, 0x003F, 0x0040,
+		0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004A, 0x004B, 0x004C, 0x004D, 0x004E, 0x004F, 0x0050,
+		0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005A, 0x005B, 0x005C, 0x005D, 0x005E, 0x005F, 0x0060,
+		0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006A, 0x006B, 0x006C, 0x006D, 0x006E, 0x006F, 0x0070,
+		0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007A, 0x007B, 0x007C, 0x007D, 0x007E, 0x0022, 0x0023,
+		0x00E2, 0x00E3, 0x00C9, 0x00A0, 0x00E0, 0x00F6, 0x00E4, 0x00DC, 0x00CE, 0x00D4, 0x00D5, 0x00D2, 0x00D3, 0x00A5, 0x00D1, 0x00F7,
+		0x00AA, 0x00CF, 0x00D9, 0x00C1, 0x00A2, 0x00A3, 0x00DB, 0x00B4, 0x00A4, 0x00AC, 0x00A9, 0x00BB, 0x00C7, 0x00C2, 0x00A8, 0x00F8,
+		0x00A1, 0x00B1, 0x00AB, 0x00B5, 0x00E1, 0x00FC, 0x00C8, 0x00C0, 0x00CB, 0x00E7, 0x00E5, 0x00CC, 0x00AE, 0x201A, 0x00E9, 0x0192,
+		0x00E6, 0x00E8, 0x00ED, 0x00EA, 0x00EB, 0x00EC, 0x201E, 0x00F1, 0x00EE, 0x00EF, 0x00CD, 0x2026, 0x00AF, 0x00F4, 0x00F2, 0x00F3,
+		0x2020, 0x00A7, 0x02C6, 0x2021, 0x2030, 0x2039, 0x0152, 0x2018, 0x201C, 0x2019, 0x201D, 0x2022, 0x2013, 0x02DC, 0x2122, 0x203A,
+		0x00D6, 0x00BF, 0x0153, 0x0178, 0x00D8, 0x00F5, 0x00FF, 0x00F9, 0x00FA, 0x00FB, 0x00FE, 0x00FD, 0x00B9, 0x00BD, 0x00B6, 0x00C6,
+		0x00B8, 0x00B7, 0x00C3, 0x00B0, 0x00BA, 0x00C5, 0x00AD, 0x00B2, 0x00B3, 0x00D7, 0x00DE, 0x00DF, 0x2014, 0x00C4, 0x007F, 0x00D0,
+		0x00DD, 0x00A6, 0x00BC, 0x0081, 0x0160, 0x00BE, 0x008D, 0x008F, 0x008E, 0x0090, 0x007F, 0x0161, 0x009D, 0x009E, 0x007F, 0x007F,
+		0x017D, 0x007F, 0x017E, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x0100, 0x0101, 0x0102, 0x0103, 0x0104, 0x0105, 0x0106, 0x0107
+	},
+	{
+		0x010C, 0x010D, 0x010E, 0x010F, 0x0110, 0x0111, 0x0112, 0x0113, 0x0116, 0x0117, 0x0118, 0x0119, 0x011A, 0x011B, 0x011E, 0x011F,
+		0x0122, 0x0123, 0x0128, 0x0129, 0x012A, 0x012B, 0x012E, 0x012F, 0x0130, 0x0132, 0x0133, 0x0136, 0x0137, 0x0138, 0x0139, 0x013A,
+		0x013B, 0x013C, 0x013D, 0x013E, 0x013F, 0x0140, 0x0141, 0x0142, 0x0143, 0x0144, 0x0145, 0x0146, 0x0147, 0x0148, 0x0149, 0x014A,
+		0x014B, 0x014C, 0x014D, 0x0150, 0x0151, 0x0154, 0x0155, 0x0156, 0x0157, 0x0158, 0x0159, 0x015A, 0x015B, 0x015E, 0x015F, 0x0162,
+		0x0163, 0x0164, 0x0165, 0x0166, 0x0167, 0x0168, 0x0169, 0x016A, 0x016B, 0x016E, 0x016F, 0x0170, 0x0171, 0x0172, 0x0173, 0x0179,
+		0x017A, 0x017B, 0x017C, 0x02C9, 0x0393, 0x0398, 0x039B, 0x039E, 0x03A0, 0x03A3, 0x03A5, 0x03A6, 0x03A8, 0x03A9, 0x03B1, 0x03B2,
+		0x03B3, 0x03B4, 0x03B5, 0x03B6, 0x03B7, 0x03B8, 0x03B9, 0x03BA, 0x03BB, 0x03BC, 0x03BD, 0x03BE, 0x03BF, 0x03C1, 0x03C2, 0x03C3,
+		0x03C4, 0x03C5, 0x03C6, 0x03C7, 0x03C8, 0x03C9, 0x03D1, 0x03D5, 0x03D6, 0x2017, 0x2032, 0x2033, 0x203C, 0x2070, 0x2074, 0x2075,
+		0x2076, 0x2077, 0x2078, 0x2079, 0x207F, 0x20A7, 0x2105, 0x210F, 0x2111, 0x2112, 0x2113, 0x2118, 0x211C, 0x211E, 0x2120, 0x2128,
+		0x212D, 0x212F, 0x2135, 0x2136, 0x2137, 0x2190, 0x2191, 0x2192, 0x2193, 0x2194, 0x2195, 0x2196, 0x2197, 0x2198, 0x2199, 0x21A8,
+		0x21B5, 0x21C4, 0x21C6, 0x21D0, 0x21D1, 0x21D2, 0x21D3, 0x21D4, 0x21D5, 0x2200, 0x2203, 0x2205, 0x2207, 0x2208, 0x2209, 0x220B,
+		0x220D, 0x2212, 0x2213, 0x2215, 0x2217, 0x2218, 0x2219, 0x221D, 0x221F, 0x2220, 0x2223, 0x2225, 0x2227, 0x2228, 0x2229, 0x222A,
+		0x222E, 0x2234, 0x2235, 0x2237, 0x2243, 0x2245, 0x2261, 0x2262, 0x226A, 0x226B, 0x2282, 0x2283, 0x2284, 0x2285, 0x2286, 0x2287,
+		0x2295, 0x2296, 0x2297, 0x2298, 0x2299, 0x22A2, 0x22A3, 0x22A4, 0x22A5, 0x22BB, 0x2302, 0x2310, 0x2320, 0x2321, 0x2329, 0x232A,
+		0x2500, 0x2502, 0x250C, 0x2510, 0x2514, 0x2518, 0x251C, 0x2524, 0x252C, 0x2534, 0x253C, 0x2550, 0x2551, 0x2552, 0x2553, 0x2554,
+		0x2555, 0x2556, 0x2557, 0x2558, 0x2559, 0x255A, 0x255B, 0x255C, 0x255D, 0x255E, 0x255F, 0x2560, 0x2561, 0x2562, 0x2563, 0x2564
+	},
+	{
+		0x2565, 0x2566, 0x2567, 0x2568, 0x2569, 0x256A, 0x256B, 0x256C, 0x256D, 0x256E, 0x256F, 0x2570, 0x2580, 0x2584, 0x2588, 0x258C,
+		0x2590, 0x2591, 0x2592, 0x2593, 0x25A0, 0x25A1, 0x25AA, 0x25AB, 0x25AC, 0x25B2, 0x25B5, 0x25B9, 0x25BA, 0x25BC, 0x25BF, 0x25C3,
+		0x25C4, 0x25C6, 0x25C7, 0x25CB, 0x25CF, 0x25D8, 0x25D9, 0x25E6, 0x263A, 0x263B, 0x263C, 0x2640, 0x2642, 0x2660, 0x2663, 0x2665,
+		0x2666, 0x266A, 0x266B, 0x301A, 0x301B, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F
+	},
+	{
+		0x007F, 0x007F, 0x007F, 0x0020, 0x0021, 0x0022, 0x0023, 0x0024, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002A, 0x002B, 0x002C,
+		0x002D, 0x002E, 0x002F, 0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003A, 0x003B, 0x003C,
+		0x003D, 0x003E, 0x003F, 0x0040, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004A, 0x004B, 0x004C,
+		0x004D, 0x004E, 0x004F, 0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005A, 0x005B, 0x005C,
+		0x005D, 0x005E, 0x005F, 0x0060, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006A, 0x006B, 0x006C,
+		0x006D, 0x006E, 0x006F, 0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007A, 0x007B, 0x007C,
+		0x007D, 0x007E, 0x00C4, 0x00C5, 0x00C7, 0x00C9, 0x00D1, 0x00D6, 0x00DC, 0x00E1, 0x00E0, 0x00E2, 0x00E4, 0x00E3, 0x00E5, 0x00E7,
+		0x00E9, 0x00E8, 0x00EA, 0x00EB, 0x00ED, 0x00EC, 0x00EE, 0x00EF, 0x00F1, 0x00F3, 0x00F2, 0x00F4, 0x00F6, 0x00F5, 0x00FA, 0x00F9,
+		0x00FB, 0x00FC, 0x2020, 0x00B0, 0x00A2, 0x00A3, 0x00A7, 0x2022, 0x00B6, 0x00DF, 0x00AE, 0x00A9, 0x2122, 0x00B4, 0x00A8, 0x2260,
+		0x00C6, 0x00D8, 0x221E, 0x00B1, 0x2264, 0x2265, 0x00A5, 0x00B5, 0x2202, 0x2211, 0x220F, 0x03C0, 0x222B, 0x00AA, 0x00BA, 0x2126,
+		0x00E6, 0x00F8, 0x00BF, 0x00A1, 0x00AC, 0x221A, 0x0192, 0x2248, 0x2206, 0x00AB, 0x00BB, 0x2026, 0x007F, 0x00C0, 0x00C3, 0x00D5,
+		0x0152, 0x0153, 0x2013, 0x2014, 0x201C, 0x201D, 0x2018, 0x2019, 0x00F7, 0x25CA, 0x00FF, 0x0178, 0x2044, 0x00A4, 0x2039, 0x203A,
+		0xF001, 0xF002, 0x2021, 0x2219, 0x201A, 0x201E, 0x2030, 0x00C2, 0x00CA, 0x00C1, 0x00CB, 0x00C8, 0x00CD, 0x00CE, 0x00CF, 0x00CC,
+		0x00D3, 0x00D4, 0x20AC, 0x00D2, 0x00DA, 0x00DB, 0x00D9, 0x0131, 0x02C6, 0x02DC, 0x02C9, 0x02D8, 0x02D9, 0x02DA, 0x00B8, 0x02DD,
+		0x02DB, 0x02C7, 0x00A0, 0x00A6, 0x00AD, 0x00AF, 0x00B2, 0x00B3, 0x00B7, 0x00B9, 0x00BC, 0x00BD, 0x00BE, 0x00D0, 0x00D7, 0x00DD,
+		0x00DE, 0x00F0, 0x00FD, 0x00FE, 0x0100, 0x0101, 0x0102, 0x0103, 0x0104, 0x0105, 0x0106, 0x0107, 0x010B, 0x010C, 0x010D, 0x010E
+	},
+	{
+		0x010F, 0x0110, 0x0111, 0x0112, 0x0113, 0x0114, 0x0115, 0x0116, 0x0117, 0x0118, 0x0119, 0x011A, 0x011B, 0x011E, 0x011F, 0x0122,
+		0x0123, 0x012A, 0x012B, 0x012E, 0x012F, 0x0130, 0x0136, 0x0137, 0x0139, 0x013A, 0x013B, 0x013C, 0x013D, 0x013E, 0x013F, 0x0140,
+		0x0141, 0x0142, 0x0143, 0x0144, 0x0145, 0x0146, 0x0147, 0x0148, 0x014A, 0x014B, 0x014C, 0x014D, 0x0150, 0x0151, 0x0154, 0x0155,
+		0x0156, 0x0157, 0x0158, 0x0159, 0x015A, 0x015B, 0x015D, 0x015E, 0x015F, 0x0160, 0x0161, 0x0162, 0x0163, 0x0164, 0x0165, 0x0166,
+		0x0167, 0x016A, 0x016B, 0x016E, 0x016F, 0x0170, 0x0171, 0x0172, 0x0173, 0x0179, 0x017A, 0x017B, 0x017C, 0x017D, 0x017E, 0x01D3,
+		0x01D4, 0x037E, 0x0387, 0x0393, 0x0398, 0x03A3, 0x03A6, 0x03A9, 0x03B1, 0x03B4, 0x03B5, 0x03C3, 0x03C4, 0x03C6, 0x2010, 0x2011,
+		0x2012, 0x2015, 0x2017, 0x201B, 0x203C, 0x203E, 0x2070, 0x2074, 0x2075, 0x2076, 0x2077, 0x2078, 0x2079, 0x207F, 0x2080, 0x2081,
+		0x2082, 0x2083, 0x2084, 0x2085, 0x2086, 0x2087, 0x2088, 0x2089, 0x20A3, 0x20A7, 0x212E, 0x2190, 0x2191, 0x2192, 0x2193, 0x2194,
+		0x2195, 0x21A8, 0x2205, 0x2212, 0x2215, 0x221F, 0x2229, 0x2261, 0x22C5, 0x2302, 0x2310, 0x2320, 0x2321, 0x2500, 0x2502, 0x250C,
+		0x2510, 0x2514, 0x2518, 0x251C, 0x2524, 0x252C, 0x2534, 0x253C, 0x2550, 0x2551, 0x2552, 0x2553, 0x2554, 0x2555, 0x2556, 0x2557,
+		0x2558, 0x2559, 0x255A, 0x255B, 0x255C, 0x255D, 0x255E, 0x255F, 0x2560, 0x2561, 0x2562, 0x2563, 0x2564, 0x2565, 0x2566, 0x2567,
+		0x2568, 0x2569, 0x256A, 0x256B, 0x256C, 0x2580, 0x2584, 0x2588, 0x258C, 0x2590, 0x2591, 0x2592, 0x2593, 0x25A0, 0x25AC, 0x25B2,
+		0x25BA, 0x25BC, 0x25C4, 0x25CB, 0x25D8, 0x25D9, 0x263A, 0x263B, 0x263C, 0x2640, 0x2642, 0x2660, 0x2663, 0x2665, 0x2666, 0x266A,
+		0x266B, 0xEA01, 0xEA02, 0xEA11, 0xEA12, 0xEA13, 0xEA14, 0xEA15, 0xEA16, 0xEA17, 0xEA18, 0xEA19, 0xEA1A, 0xEA1B, 0xEA1C, 0xEA1D,
+		0xEA3F, 0xEA4F, 0xEA66, 0xEA67, 0xEA68, 0xEA69, 0xEA6A, 0xEA6B, 0xEA6C, 0xEA6D, 0xEA6E, 0xEFED, 0xEFEE, 0xEFEF, 0xEFF0, 0xEFF1,
+		0xEFF2, 0xEFF3, 0xEFF4, 0xEFF5, 0xEFF6, 0xEFF7, 0xEFF8, 0xEFF9, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F
+	},
+	{
+		0x010F, 0x0110, 0x0111, 0x0112, 0x0113, 0x0114, 0x0115, 0x0116, 0x0117, 0x0118, 0x0119, 0x011A, 0x011B, 0x011E, 0x011F, 0x0122,
+		0x0123, 0x012A, 0x012B, 0x012E, 0x012F, 0x0130, 0x0136, 0x0137, 0x0139, 0x013A, 0x013B, 0x013C, 0x013D, 0x013E, 0x013F, 0x0140,
+		0x0141, 0x0142, 0x0143, 0x0144, 0x0145, 0x0146, 0x0147, 0x0148, 0x014A, 0x014B, 0x014C, 0x014D, 0x0150, 0x0151, 0x0154, 0x0155,
+		0x0156, 0x0157, 0x0158, 0x0159, 0x015A, 0x015B, 0x015D, 0x015E, 0x015F, 0x0160, 0x0161, 0x0162, 0x0163, 0x0164, 0x0165, 0x0166,
+		0x0167, 0x016A, 0x016B, 0x016E, 0x016F, 0x0170, 0x0171, 0x0172, 0x0173, 0x0179, 0x017A, 0x017B, 0x017C, 0x017D, 0x017E, 0x01D3,
+		0x01D4, 0x037E, 0x0387, 0x0393, 0x0398, 0x03A3, 0x03A6, 0x03A9, 0x03B1, 0x03B4, 0x03B5, 0x03C3, 0x03C4, 0x03C6, 0x2002, 0x2003,
+		0x2010, 0x2011, 0x2012, 0x2015, 0x2017, 0x201B, 0x203C, 0x203E, 0x2070, 0x2074, 0x2075, 0x2076, 0x2077, 0x2078, 0x2079, 0x207F,
+		0x2080, 0x2081, 0x2082, 0x2083, 0x2084, 0x2085, 0x2086, 0x2087, 0x2088, 0x2089, 0x20A3, 0x20A7, 0x212E, 0x2190, 0x2191, 0x2192,
+		0x2193, 0x2194, 0x2195, 0x21A8, 0x2205, 0x2212, 0x2215, 0x221F, 0x2229, 0x2261, 0x22C5, 0x2302, 0x2310, 0x2320, 0x2321, 0x2500,
+		0x2502, 0x250C, 0x2510, 0x2514, 0x2518, 0x251C, 0x2524, 0x252C, 0x2534, 0x253C, 0x2550, 0x2551, 0x2552, 0x2553, 0x2554, 0x2555,
+		0x2556, 0x2557, 0x2558, 0x2559, 0x255A, 0x255B, 0x255C, 0x255D, 0x255E, 0x255F, 0x2560, 0x2561, 0x2562, 0x2563, 0x2564, 0x2565,
+		0x2566, 0x2567, 0x2568, 0x2569, 0x256A, 0x256B, 0x256C, 0x2580, 0x2584, 0x2588, 0x258C, 0x2590, 0x2591, 0x2592, 0x2593, 0x25A0,
+		0x25AC, 0x25B2, 0x25BA, 0x25BC, 0x25C4, 0x25CB, 0x25D8, 0x25D9, 0x263A, 0x263B, 0x263C, 0x2640, 0x2642, 0x2660, 0x2663, 0x2665,
+		0x2666, 0x266A, 0x266B, 0xEA00, 0xEA01, 0xEA02, 0xEA03, 0xEA04, 0xEA11, 0xEA12, 0xEA13, 0xEA14, 0xEA15, 0xEA16, 0xEA17, 0xEA18,
+		0xEA19, 0xEA1A, 0xEA1B, 0xEA1C, 0xEA1D, 0xEA3F, 0xEA4F, 0xEA66, 0xEA67, 0xEA68, 0xEA69, 0xEA6A, 0xEA6B, 0xEA6C, 0xEA6D, 0xEA6E,
+		0xEFED, 0xEFEE, 0xEFEF, 0xEFF0, 0xEFF1, 0xEFF2, 0xEFF3, 0xEFF4, 0xEFF5, 0xEFF6, 0xEFF7, 0xEFF8, 0xEFF9, 0xFB00, 0xFB03, 0xFB04
+	},
+	{
+		0x010F, 0x0110, 0x0111, 0x0112, 0x0113, 0x0114, 0x0115, 0x0116, 0x0117, 0x0118, 0x0119, 0x011A, 0x011B, 0x011E, 0x011F, 0x0122,
+		0x0123, 0x012A, 0x012B, 0x012E, 0x012F, 0x0130, 0x0136, 0x0137, 0x0139, 0x013A, 0x013B, 0x013C, 0x013D, 0x013E, 0x013F, 0x0140,
+		0x0141, 0x0142, 0x0143, 0x0144, 0x0145, 0x0146, 0x0147, 0x0148, 0x014A, 0x014B, 0x014C, 0x014D, 0x0150, 0x0151, 0x0154, 0x0155,
+		0x0156, 0x0157, 0x0158, 0x0159, 0x015A, 0x015B, 0x015D, 0x015E, 0x015F, 0x0160, 0x0161, 0x0162, 0x0163, 0x0164, 0x0165, 0x0166,
+		0x0167, 0x016A, 0x016B, 0x016E, 0x016F, 0x0170, 0x0171, 0x0172, 0x0173, 0x0179, 0x017A, 0x017B, 0x017C, 0x017D, 0x017E, 0x01D3,
+		0x01D4, 0x037E, 0x0384, 0x0385, 0x0386, 0x0387, 0x0388, 0x0389, 0x038A, 0x038C, 0x038E, 0x038F, 0x0390, 0x0391, 0x0392, 0x0393,
+		0x0394, 0x0395, 0x0396, 0x0397, 0x0398, 0x0399, 0x039A, 0x039B, 0x039C, 0x039D, 0x039E, 0x039F, 0x03A0, 0x03A1, 0x03A3, 0x03A4,
+		0x03A5, 0x03A6, 0x03A7, 0x03A8, 0x03A9, 0x03AA, 0x03AB, 0x03AC, 0x03AD, 0x03AE, 0x03AF, 0x03B0, 0x03B1, 0x03B2, 0x03B3, 0x03B4,
+		0x03B5, 0x03B6, 0x03B7, 0x03B8, 0x03B9, 0x03BA, 0x03BB, 0x03BC, 0x03BD, 0x03BE, 0x03BF, 0x03C1, 0x03C2, 0x03C3, 0x03C4, 0x03C5,
+		0x03C6, 0x03C7, 0x03C8, 0x03C9, 0x03CA, 0x03CB, 0x03CC, 0x03CD, 0x03CE, 0x03D1, 0x03D5, 0x0401, 0x0402, 0x0403, 0x0404, 0x0405,
+		0x0406, 0x0407, 0x0408, 0x0409, 0x040A, 0x040B, 0x040C, 0x040E, 0x040F, 0x0410, 0x0411, 0x0412, 0x0413, 0x0414, 0x0415, 0x0416,
+		0x0417, 0x0418, 0x0419, 0x041A, 0x041B, 0x041C, 0x041D, 0x041E, 0x041F, 0x0420, 0x0421, 0x0422, 0x0423, 0x0424, 0x0425, 0x0426,
+		0x0427, 0x0428, 0x0429, 0x042A, 0x042B, 0x042C, 0x042D, 0x042E, 0x042F, 0x0430, 0x0431, 0x0432, 0x0433, 0x0434, 0x0435, 0x0436,
+		0x0437, 0x0438, 0x0439, 0x043A, 0x043B, 0x043C, 0x043D, 0x043E, 0x043F, 0x0440, 0x0441, 0x0442, 0x0443, 0x0444, 0x0445, 0x0446,
+		0x0447, 0x0448, 0x0449, 0x044A, 0x044B, 0x044C, 0x044D, 0x044E, 0x044F, 0x0451, 0x0452, 0x0453, 0x0454, 0x0455, 0x0456, 0x0457,
+		0x0458, 0x0459, 0x045A, 0x045B, 0x045C, 0x045E, 0x045F, 0x0490, 0x0491, 0x0492, 0x0493, 0x0496, 0x0497, 0x049A, 0x049B, 0x049C
+	},
+	{
+		0x049D, 0x04A2, 0x04A3, 0x04AE, 0x04AF, 0x04B2, 0x04B3, 0x04B8, 0x04B9, 0x04BA, 0x04BB, 0x04C0, 0x04D8, 0x04D9, 0x04E8, 0x04E9,
+		0x2010, 0x2011, 0x2012, 0x2015, 0x2017, 0x201B, 0x203C, 0x203E, 0x2070, 0x2074, 0x2075, 0x2076, 0x2077, 0x2078, 0x2079, 0x207F,
+		0x2080, 0x2081, 0x2082, 0x2083, 0x2084, 0x2085, 0x2086, 0x2087, 0x2088, 0x2089, 0x20A3, 0x20A7, 0x2116, 0x212E, 0x2190, 0x2191,
+		0x2192, 0x2193, 0x2194, 0x2195, 0x21A8, 0x2205, 0x2212, 0x2215, 0x221F, 0x2229, 0x2243, 0x2261, 0x22C5, 0x2302, 0x2310, 0x2320,
+		0x2321, 0x2500, 0x2502, 0x250C, 0x2510, 0x2514, 0x2518, 0x251C, 0x2524, 0x252C, 0x2534, 0x253C, 0x2550, 0x2551, 0x2552, 0x2553,
+		0x2554, 0x2555, 0x2556, 0x2557, 0x2558, 0x2559, 0x255A, 0x255B, 0x255C, 0x255D, 0x255E, 0x255F, 0x2560, 0x2561, 0x2562, 0x2563,
+		0x2564, 0x2565, 0x2566, 0x2567, 0x2568, 0x2569, 0x256A, 0x256B, 0x256C, 0x2580, 0x2584, 0x2588, 0x258C, 0x2590, 0x2591, 0x2592,
+		0x2593, 0x25A0, 0x25AC, 0x25B2, 0x25BA, 0x25BC, 0x25C4, 0x25CB, 0x25D8, 0x25D9, 0x263A, 0x263B, 0x263C, 0x2640, 0x2642, 0x2660,
+		0x2663, 0x2665, 0x2666, 0x266A, 0x266B, 0xEA01, 0xEA02, 0xEA11, 0xEA12, 0xEA13, 0xEA14, 0xEA15, 0xEA16, 0xEA17, 0xEA18, 0xEA19,
+		0xEA1A, 0xEA1B, 0xEA1C, 0xEA1D, 0xEA3F, 0xEA4F, 0xEA66, 0xEA67, 0xEA68, 0xEA69, 0xEA6A, 0xEA6B, 0xEA6C, 0xEA6D, 0xEA6E, 0xEFED,
+		0xEFEE, 0xEFEF, 0xEFF0, 0xEFF1, 0xEFF2, 0xEFF3, 0xEFF4, 0xEFF5, 0xEFF6, 0xEFF7, 0xEFF8, 0xEFF9, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F
+	},
+	{
+		0x010F, 0x0110, 0x0111, 0x0112, 0x0113, 0x0114, 0x0115, 0x0116, 0x0117, 0x0118, 0x0119, 0x011A, 0x011B, 0x011E, 0x011F, 0x0122,
+		0x0123, 0x0128, 0x0129, 0x012A, 0x012B, 0x012E, 0x012F, 0x0130, 0x0132, 0x0133, 0x0136, 0x0137, 0x0138, 0x0139, 0x013A, 0x013B,
+		0x013C, 0x013D, 0x013E, 0x013F, 0x0140, 0x0141, 0x0142, 0x0143, 0x0144, 0x0145, 0x0146, 0x0147, 0x0148, 0x0149, 0x014A, 0x014B,
+		0x014C, 0x014D, 0x0150, 0x0151, 0x0154, 0x0155, 0x0156, 0x0157, 0x0158, 0x0159, 0x015A, 0x015B, 0x015D, 0x015E, 0x015F, 0x0160,
+		0x0161, 0x0162, 0x0163, 0x0164, 0x0165, 0x0166, 0x0167, 0x0168, 0x0169, 0x016A, 0x016B, 0x016E, 0x016F, 0x0170, 0x0171, 0x0172,
+		0x0173, 0x0179, 0x017A, 0x017B, 0x017C, 0x017D, 0x017E, 0x01D3, 0x01D4, 0x037E, 0x0387, 0x0393, 0x0398, 0x03A3, 0x03A6, 0x03A9,
+		0x03B1, 0x03B4, 0x03B5, 0x03C3, 0x03C4, 0x03C6, 0x2002, 0x2003, 0x2009, 0x2010, 0x2011, 0x2012, 0x2015, 0x2017, 0x201B, 0x2032,
+		0x2033, 0x203C, 0x203E, 0x2070, 0x2074, 0x2075, 0x2076, 0x2077, 0x2078, 0x2079, 0x207F, 0x2080, 0x2081, 0x2082, 0x2083, 0x2084,
+		0x2085, 0x2086, 0x2087, 0x2088, 0x2089, 0x20A3, 0x20A7, 0x2105, 0x2113, 0x212E, 0x2190, 0x2191, 0x2192, 0x2193, 0x2194, 0x2195,
+		0x21A8, 0x2205, 0x2212, 0x2215, 0x221F, 0x2229, 0x2261, 0x22C5, 0x2302, 0x2310, 0x2320, 0x2321, 0x2500, 0x2502, 0x250C, 0x2510,
+		0x2514, 0x2518, 0x251C, 0x2524, 0x252C, 0x2534, 0x253C, 0x2550, 0x2551, 0x2552, 0x2553, 0x2554, 0x2555, 0x2556, 0x2557, 0x2558,
+		0x2559, 0x255A, 0x255B, 0x255C, 0x255D, 0x255E, 0x255F, 0x2560, 0x2561, 0x2562, 0x2563, 0x2564, 0x2565, 0x2566, 0x2567, 0x2568,
+		0x2569, 0x256A, 0x256B, 0x256C, 0x2580, 0x2584, 0x2588, 0x258C, 0x2590, 0x2591, 0x2592, 0x2593, 0x25A0, 0x25AC, 0x25B2, 0x25BA,
+		0x25BC, 0x25C4, 0x25CB, 0x25D8, 0x25D9, 0x263A, 0x263B, 0x263C, 0x2640, 0x2642, 0x2660, 0x2663, 0x2665, 0x2666, 0x266A, 0x266B,
+		0xEA00, 0xEA01, 0xEA02, 0xEA03, 0xEA04, 0xEA11, 0xEA12, 0xEA13, 0xEA14, 0xEA15, 0xEA16, 0xEA17, 0xEA18, 0xEA19, 0xEA1A, 0xEA1B,
+		0xEA1C, 0xEA1D, 0xEA3F, 0xEA4F, 0xEA66, 0xEA67, 0xEA68, 0xEA69, 0xEA6A, 0xEA6B, 0xEA6C, 0xEA6D, 0xEA6E, 0xEFED, 0xEFEE, 0xEFEF
+	},
+	{
+		0xEFF0, 0xEFF1, 0xEFF2, 0xEFF3, 0xEFF4, 0xEFF5, 0xEFF6, 0xEFF7, 0xEFF8, 0xEFF9, 0xFB00, 0xFB03, 0xFB04, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F,
+		0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F
+	},
+	{
+		0x010F, 0x0110, 0x0111, 0x0112, 0x0113, 0x0114, 0x0115, 0x0116, 0x0117, 0x0118, 0x0119, 0x011A, 0x011B, 0x011E, 0x011F, 0x0122,
+		0x0123, 0x012A, 0x012B, 0x012E, 0x012F, 0x0130, 0x0136, 0x0137, 0x0139, 0x013A, 0x013B, 0x013C, 0x013D, 0x013E, 0x013F, 0x0140,
+		0x0141, 0x0142, 0x0143, 0x0144, 0x0145, 0x0146, 0x0147, 0x0148, 0x014A, 0x014B, 0x014C, 0x014D, 0x0150, 0x0151, 0x0154, 0x0155,
+		0x0156, 0x0157, 0x0158, 0x0159, 0x015A, 0x015B, 0x015D, 0x015E, 0x015F, 0x0160, 0x0161, 0x0162, 0x0163, 0x0164, 0x0165, 0x0166,
+		0x0167, 0x016A, 0x016B, 0x016E, 0x016F, 0x0170, 0x0171, 0x0172, 0x0173, 0x0179, 0x017A, 0x017B, 0x017C, 0x017D, 0x017E, 0x01D3,
+		0x01D4, 0x037E, 0x0387, 0x0393, 0x0398, 0x03A3, 0x03A6, 0x03A9, 0x03B1, 0x03B4, 0x03B5, 0x03C3, 0x03C4, 0x03C6, 0x2010, 0x2011,
+		0x2012, 0x2015, 0x2017, 0x201B, 0x203C, 0x203E, 0x2070, 0x2074, 0x2075, 0x2076, 0x2077, 0x2078, 0x2079, 0x207F, 0x2080, 0x2081,
+		0x2082, 0x2083, 0x2084, 0x2085, 0x2086, 0x2087, 0x2088, 0x2089, 0x20A7, 0x212E, 0x2190, 0x2191, 0x2192, 0x2193, 0x2194, 0x2195,
+		0x21A8, 0x2205, 0x2212, 0x2215, 0x221F, 0x2229, 0x2261, 0x22C5, 0x2302, 0x2310, 0x2320, 0x2321, 0x2500, 0x2502, 0x250C, 0x2510,
+		0x2514, 0x2518, 0x251C, 0x2524, 0x252C, 0x2534, 0x253C, 0x2550, 0x2551, 0x2552, 0x2553, 0x2554, 0x2555, 0x2556, 0x2557, 0x2558,
+		0x2559, 0x255A, 0x255B, 0x255C, 0x255D, 0x255E, 0x255F, 0x2560, 0x2561, 0x2562, 0x2563, 0x2564, 0x2565, 0x2566, 0x2567, 0x2568,
+		0x2569, 0x256A, 0x256B, 0x256C, 0x2580, 0x2584, 0x2588, 0x258C, 0x2590, 0x2591, 0x2592, 0x2593, 0x25A0, 0x25AC, 0x25B2, 0x25BA,
+		0x25BC, 0x25C4, 0x25CB, 0x25D8, 0x25D9, 0x263A, 0x263B, 0x263C, 0x2640, 0x2642, 0x2660, 0x2663, 0x2665, 0x2666, 0x266A, 0x266B,
+		0xEA01, 0xEA02, 0xEA11, 0xEA12, 0xEA13, 0xEA14, 0xEA15, 0xEA16, 0xEA17, 0xEA18, 0xEA19, 0xEA1A, 0xEA1B, 0xEA1C, 0xEA1D, 0xEA3F,
+		0xEA4F, 0xEA66, 0xEA67, 0xEA68, 0xEA69, 0xEA6A, 0xEA6B, 0xEA6C, 0xEA6D, 0xEA6E, 0xEFED, 0xEFEE, 0xEFEF, 0xEFF0, 0xEFF1, 0xEFF2,
+		0xEFF3, 0xEFF4, 0xEFF5, 0xEFF6, 0xEFF7, 0xEFF8, 0xEFF9, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F, 0x007F
+	},
+};
+
+/// Pages of each built-in map
+static constexpr GlyphBuiltInPage s_arURWGlyphPageList[] =
+{
+	{0, 0}, {1, 1}, {2, 2}, // A028-Ext.ttf
+	{0, 0}, {1, 1}, {2, 2}, // A028-Med.ttf
+	{0, 0}, {1, 1}, {2, 2}, // A030-Reg.ttf
+	{0, 0}, {1, 1}, {2, 2}, // A030-Ita.ttf
+	{0, 0}, {1, 1}, {2, 2}, // A030-Bol.ttf
+	{0, 0}, {1, 1}, {2, 2}, // A030-BolIta.ttf
+	{0, 0}, {1, 1}, {2, 2}, // AntiqueOlive-Reg.ttf
+	{0, 0}, {1, 1}, {2, 2}, // AntiqueOlive-Ita.ttf
+	{0, 0}, {1, 1}, {2, 2}, // AntiqueOlive-Bol.ttf
+	{0, 3}, {1, 4}, {2, 5}, // ArtLinePrinter.ttf
+	{0, 6}, {1, 7}, // CenturySchL-Roma.ttf
+	{0, 6}, {1, 7}, // CenturySchL-Ital.ttf
+	{0, 6}, {1, 7}, // CenturySchL-Bold.ttf
+	{0, 6}, {1, 7}, // CenturySchL-BoldItal.ttf
+	{0, 0}, {1, 1}, {2, 2}, // ClarendonURW-BolCon.ttf
+	{0, 0}, {1, 1}, {2, 2}, // Coronet.ttf
+	{0, 0}, {1, 1}, {2, 2}, // GaramondNo8-Reg.ttf
+	{0, 0}, {1, 1}, {2, 2}, // GaramondNo8-Ita.ttf
+	{0, 0}, {1, 1}, {2, 2}, // GaramondNo8-Med.ttf
+	{0, 0}, {1, 1}, {2, 2}, // GaramondNo8-MedIta.ttf
+	{0, 0}, {1, 1}, {2, 2}, // LetterGothic-Reg.ttf
+	{0, 0}, {1, 1}, {2, 2}, // LetterGothic-Ita.ttf
+	{0, 0}, {1, 1}, {2, 2}, // LetterGothic-Bol.ttf
+	{0, 0}, {1, 1}, {2, 2}, // Mauritius-Reg.ttf
+	{0, 6}, {1, 7}, // NimbusMonL-Regu.ttf
+	{0, 6}, {1, 7}, // NimbusMonL-ReguObli.ttf
+	{0, 6}, {1, 7}, // NimbusMonL-Bold.ttf
+	{0, 6}, {1, 7}, // NimbusMonL-BoldObli.ttf
+	{0, 0}, {1, 1}, {2, 2}, // NimbusMono-Reg.ttf
+	{0, 0}, {1, 1}, {2, 2}, // NimbusMono-Ita.ttf
+	{0, 0}, {1, 1}, {2, 2}, // NimbusMono-Bol.ttf
+	{0, 0}, {1, 1}, {2, 2}, // NimbusMono-BolIta.ttf
+	{0, 6}, {1, 8}, // NimbusRomNo9L-Regu.ttf
+	{0, 6}, {1, 7}, // NimbusRomNo9L-ReguItal.ttf
+	{0, 6}, {1, 8}, // NimbusRomNo9L-Medi.ttf
+	{0, 6}, {1, 7}, // NimbusRomNo9L-MediItal.ttf
+	{0, 0}, {1, 1}, {2, 2}, // NimbusRomanNo4-Lig.ttf
+	{0, 0}, {1, 1}, {2, 2}, // NimbusRomanNo4-LigIta.ttf
+	{0, 0}, {1, 1}, {2, 2}, // NimbusRomanNo4-Bol.ttf
+	{0, 0}, {1, 1}, {2, 2}, // NimbusRomanNo4-BolIta.ttf
+	{0, 0}, {1, 1}, {2, 2}, // NimbusRomanNo9-Reg.ttf
+	{0, 0}, {1, 1}, {2, 2}, // NimbusRomanNo9-Ita.ttf
+	{0, 0}, {1, 1}, {2, 2}, // NimbusRomanNo9-Med.ttf
+	{0, 0}, {1, 1}, {2, 2}, // NimbusRomanNo9-MedIta.ttf
+	{0, 6}, {1, 9}, {2, 10}, // NimbusSanL-Regu.ttf
+	{0, 6}, {1, 9}, {2, 10}, // NimbusSanL-ReguItal.ttf
+	{0, 6}, {1, 9}, {2, 10}, // NimbusSanL-Bold.ttf
+	{0, 6}, {1, 9}, {2, 10}, // NimbusSanL-BoldItal.ttf
+	{0, 6}, {1, 7}, // NimbusSanL-ReguCond.ttf
+	{0, 6}, {1, 7}, // NimbusSanL-ReguCondItal.ttf
+	{0, 6}, {1, 7}, // NimbusSanL-BoldCond.ttf
+	{0, 6}, {1, 7}, // NimbusSanL-BoldCondItal.ttf
+	{0, 0}, {1, 1}, {2, 2}, // U001-Reg.ttf
+	{0, 0}, {1, 1}, {2, 2}, // U001-Ita.ttf
+	{0, 0}, {1, 1}, {2, 2}, // U001-Bol.ttf
+	{0, 0}, {1, 1}, {2, 2}, // U001-BolIta.ttf
+	{0, 0}, {1, 1}, {2, 2}, // U001Con-Reg.ttf
+	{0, 0}, {1, 1}, {2, 2}, // U001Con-Ita.ttf
+	{0, 0}, {1, 1}, {2, 2}, // U001Con-Bol.ttf
+	{0, 0}, {1, 1}, {2, 2}, // U001Con-BolIta.ttf
+	{0, 6}, {1, 7}, // URWBookmanL-Ligh.ttf
+	{0, 6}, {1, 7}, // URWBookmanL-LighItal.ttf
+	{0, 6}, {1, 7}, // URWBookmanL-DemiBold.ttf
+	{0, 6}, {1, 7}, // URWBookmanL-DemiBoldItal.ttf
+	{0, 6}, {1, 11}, {2, 12}, // URWChanceryL-MediItal.ttf
+	{0, 0}, {1, 1}, {2, 2}, // URWClassico-Reg.ttf
+	{0, 0}, {1, 1}, {2, 2}, // URWClassico-Ita.ttf
+	{0, 0}, {1, 1}, {2, 2}, // URWClassico-Bol.ttf
+	{0, 0}, {1, 1}, {2, 2}, // URWClassico-BolIta.ttf
+	{0, 6}, {1, 7}, // URWGothicL-Book.ttf
+	{0, 6}, {1, 7}, // URWGothicL-BookObli.ttf
+	{0, 6}, {1, 7}, // URWGothicL-Demi.ttf
+	{0, 6}, {1, 7}, // URWGothicL-DemiObli.ttf
+	{0, 6}, {1, 7}, // URWPalladioL-Roma.ttf
+	{0, 6}, {1, 7}, // URWPalladioL-Ital.ttf
+	{0, 6}, {1, 7}, // URWPalladioL-Bold.ttf
+	{0, 6}, {1, 13}, // URWPalladioL-BoldItal.ttf
+};
+
+/// The built-in maps, by face name, weight and italic flag
+static constexpr GlyphBuiltInMap s_arURWGlyphMaps[] =
+{
+	{L"A028 Extrabold", 400, false, {0x00010CCC, 0xD2DCB494, 0x00000000, 0xB869CFFF}, 626, 0, 3},	// A028-Ext.ttf
+	{L"A028 Medium", 400, false, {0x00010CCC, 0xBF7735B0, 0x00000000, 0xB869CFFC}, 626, 3, 3},	// A028-Med.ttf
+	{L"A030", 400, false, {0x00010CCC, 0x1C38399C, 0x00000000, 0xB869D016}, 626, 6, 3},	// A030-Reg.ttf
+	{L"A030", 400, true, {0x00010CCC, 0xE6D35C58, 0x00000000, 0xB869D01C}, 626, 9, 3},	// A030-Ita.ttf
+	{L"A030", 700, false, {0x00010CCC, 0x274F3BDC, 0x00000000, 0xB869D019}, 626, 12, 3},	// A030-Bol.ttf
+	{L"A030", 700, true, {0x00010CCC, 0x05015D16, 0x00000000, 0xB869D01F}, 626, 15, 3},	// A030-BolIta.ttf
+	{L"AntiqueOlive", 400, false, {0x00010CCC, 0x9CA97D92, 0x00000000, 0xB869CFF3}, 626, 18, 3},	// AntiqueOlive-Reg.ttf
+	{L"AntiqueOlive", 400, true, {0x00010CCC, 0x774549BA, 0x00000000, 0xB869CFF9}, 626, 21, 3},	// AntiqueOlive-Ita.ttf
+	{L"AntiqueOlive", 700, false, {0x00010CCC, 0xB04A920E, 0x00000000, 0xB869CFF6}, 626, 24, 3},	// AntiqueOlive-Bol.ttf
+	{L"ArtLinePrinter", 400, false, {0x00010000, 0x3BD5B3F7, 0x00000000, 0xC410A79A}, 538, 27, 3},	// ArtLinePrinter.ttf
+	{L"CenturySchL", 400, false, {0x00010CCC, 0x5BDBC8A1, 0x00000000, 0xB89A8A9C}, 500, 30, 2},	// CenturySchL-Roma.ttf
+	{L"CenturySchL", 400, true, {0x00010CCC, 0x319456A5, 0x00000000, 0xB89A8AA4}, 500, 32, 2},	// CenturySchL-Ital.ttf
+	{L"CenturySchL", 700, false, {0x00010CCC, 0x59E6F04D, 0x00000000, 0xB89A8AA0}, 500, 34, 2},	// CenturySchL-Bold.ttf
+	{L"CenturySchL", 700, true, {0x00010CCC, 0x1524AAC7, 0x00000000, 0xB89A8AA8}, 500, 36, 2},	// CenturySchL-BoldItal.ttf
+	{L"ClarendonURWBolCon", 400, false, {0x00010CCC, 0xFA42B5BA, 0x00000000, 0xBA5D5555}, 626, 38, 3},	// ClarendonURW-BolCon.ttf
+	{L"Coronet", 400, false, {0x00010CCC, 0xB5D22D90, 0x00000000, 0xBA5D5558}, 626, 41, 3},	// Coronet.ttf
+	{L"GaramondNo8", 400, false, {0x00010CCC, 0x4EAB2258, 0x00000000, 0xB869D008}, 626, 44, 3},	// GaramondNo8-Reg.ttf
+	{L"GaramondNo8", 400, true, {0x00010CCC, 0x15942CD4, 0x00000000, 0xB869D00E}, 626, 47, 3},	// GaramondNo8-Ita.ttf
+	{L"GaramondNo8", 700, false, {0x00010CCC, 0xD487F9C8, 0x00000000, 0xB869D00C}, 626, 50, 3},	// GaramondNo8-Med.ttf
+	{L"GaramondNo8", 700, true, {0x00010CCC, 0xC5BEDB6A, 0x00000000, 0xB869D011}, 626, 53, 3},	// GaramondNo8-MedIta.ttf
+	{L"LetterGothic", 400, false, {0x00010CCC, 0xFF796178, 0x00000000, 0xB869CE98}, 626, 56, 3},	// LetterGothic-Reg.ttf
+	{L"LetterGothic", 400, true, {0x00010CCC, 0x0B81952E, 0x00000000, 0xB869CEA0}, 626, 59, 3},	// LetterGothic-Ita.ttf
+	{L"LetterGothic", 700, false, {0x00010CCC, 0xF69B2BC6, 0x00000000, 0xB869CE9C}, 626, 62, 3},	// LetterGothic-Bol.ttf
+	{L"Mauritius", 400, false, {0x00010CCC, 0x868E644C, 0x00000000, 0xB869D014}, 626, 65, 3},	// Mauritius-Reg.ttf
+	{L"NimbusMonL", 400, false, {0x00010CCC, 0x463A89BF, 0x00000000, 0xB89A8AD9}, 500, 68, 2},	// NimbusMonL-Regu.ttf
+	{L"NimbusMonL", 400, true, {0x00010CCC, 0x4B512E33, 0x00000000, 0xB89A8AE1}, 500, 70, 2},	// NimbusMonL-ReguObli.ttf
+	{L"NimbusMonL", 700, false, {0x00010CCC, 0x65702181, 0x00000000, 0xB89A8ADD}, 500, 72, 2},	// NimbusMonL-Bold.ttf
+	{L"NimbusMonL", 700, true, {0x00010CCC, 0xEAD08579, 0x00000000, 0xB89A8AE5}, 500, 74, 2},	// NimbusMonL-BoldObli.ttf
+	{L"NimbusMono", 400, false, {0x00010CCC, 0xD5FDA7EC, 0x00000000, 0xB869CECD}, 626, 76, 3},	// NimbusMono-Reg.ttf
+	{L"NimbusMono", 400, true, {0x00010CCC, 0x8A89920C, 0x00000000, 0xB869CED8}, 626, 79, 3},	// NimbusMono-Ita.ttf
+	{L"NimbusMono", 700, false, {0x00010CCC, 0x9EA03BD0, 0x00000000, 0xB869CED2}, 626, 82, 3},	// NimbusMono-Bol.ttf
+	{L"NimbusMono", 700, true, {0x00010CCC, 0xCD936154, 0x00000000, 0xB869CEDD}, 626, 85, 3},	// NimbusMono-BolIta.ttf
+	{L"NimbusRomNo9L", 400, false, {0x00010CCC, 0x2C165CE7, 0x00000000, 0xB89A8AC9}, 508, 88, 2},	// NimbusRomNo9L-Regu.ttf
+	{L"NimbusRomNo9L", 400, true, {0x00010CCC, 0xB10B55A3, 0x00000000, 0xB89A8AD1}, 500, 90, 2},	// NimbusRomNo9L-ReguItal.ttf
+	{L"NimbusRomNo9L", 700, false, {0x00010CCC, 0xE318EF61, 0x00000000, 0xB89A8ACD}, 508, 92, 2},	// NimbusRomNo9L-Medi.ttf
+	{L"NimbusRomNo9L", 700, true, {0x00010CCC, 0x744973C5, 0x00000000, 0xB89A8AD5}, 500, 94, 2},	// NimbusRomNo9L-MediItal.ttf
+	{L"NimbusRomanNo4", 400, false, {0x00010CCC, 0x197D131C, 0x00000000, 0xBA5D555B}, 626, 96, 3},	// NimbusRomanNo4-Lig.ttf
+	{L"NimbusRomanNo4", 400, true, {0x00010CCC, 0xE4211238, 0x00000000, 0xBA5D5560}, 626, 99, 3},	// NimbusRomanNo4-LigIta.ttf
+	{L"NimbusRomanNo4", 700, false, {0x00010CCC, 0x35CB6958, 0x00000000, 0xBA5D555E}, 626, 102, 3},	// NimbusRomanNo4-Bol.ttf
+	{L"NimbusRomanNo4", 700, true, {0x00010CCC, 0xF8A50848, 0x00000000, 0xBA5D5563}, 626, 105, 3},	// NimbusRomanNo4-BolIta.ttf
+	{L"NimbusRomanNo9", 400, false, {0x00010CCC, 0xA6E26AD8, 0x00000000, 0xB869D022}, 626, 108, 3},	// NimbusRomanNo9-Reg.ttf
+	{L"NimbusRomanNo9", 400, true, {0x00010CCC, 0x2614E3C0, 0x00000000, 0xB869D028}, 626, 111, 3},	// NimbusRomanNo9-Ita.ttf
+	{L"NimbusRomanNo9", 700, false, {0x00010CCC, 0x3CA9F98A, 0x00000000, 0xB869D025}, 626, 114, 3},	// NimbusRomanNo9-Med.ttf
+	{L"NimbusRomanNo9", 700, true, {0x00010CCC, 0x46E788D6, 0x00000000, 0xB869D02B}, 626, 117, 3},	// NimbusRomanNo9-MedIta.ttf
+	{L"NimbusSanL", 400, false, {0x00010CCC, 0x6673349E, 0x00000000, 0xB89A8AAC}, 680, 120, 3},	// NimbusSanL-Regu.ttf
+	{L"NimbusSanL", 400, true, {0x00010CCC, 0x23E69DD6, 0x00000000, 0xB89A8AB4}, 680, 123, 3},	// NimbusSanL-ReguItal.ttf
+	{L"NimbusSanL", 700, false, {0x00010CCC, 0x7FE74E0E, 0x00000000, 0xB89A8AB0}, 680, 126, 3},	// NimbusSanL-Bold.ttf
+	{L"NimbusSanL", 700, true, {0x00010CCC, 0x2AE247B0, 0x00000000, 0xB89A8AB8}, 680, 129, 3},	// NimbusSanL-BoldItal.ttf
+	{L"NimbusSanLCon", 400, false, {0x00010CCC, 0x75DC5611, 0x00000000, 0xB89A8ABD}, 500, 132, 2},	// NimbusSanL-ReguCond.ttf
+	{L"NimbusSanLCon", 400, true, {0x00010CCC, 0xA0F54EC9, 0x00000000, 0xB89A8AC3}, 500, 134, 2},	// NimbusSanL-ReguCondItal.ttf
+	{L"NimbusSanLCon", 700, false, {0x00010CCC, 0x16772463, 0x00000000, 0xB89A8AC0}, 500, 136, 2},	// NimbusSanL-BoldCond.ttf
+	{L"NimbusSanLCon", 700, true, {0x00010CCC, 0xE867AF3B, 0x00000000, 0xB89A8AC6}, 500, 138, 2},	// NimbusSanL-BoldCondItal.ttf
+	{L"U001", 400, false, {0x00010CCC, 0xCABAAB22, 0x00000000, 0xB869D045}, 626, 140, 3},	// U001-Reg.ttf
+	{L"U001", 400, true, {0x00010CCC, 0x2445102C, 0x00000000, 0xB869D04A}, 626, 143, 3},	// U001-Ita.ttf
+	{L"U001", 700, false, {0x00010CCC, 0x5DBA05DE, 0x00000000, 0xB869D048}, 626, 146, 3},	// U001-Bol.ttf
+	{L"U001", 700, true, {0x00010CCC, 0xC6C6058E, 0x00000000, 0xB869D04D}, 626, 149, 3},	// U001-BolIta.ttf
+	{L"U001Con", 400, false, {0x00010CCC, 0x595FCEE0, 0x00000000, 0xB869D050}, 626, 152, 3},	// U001Con-Reg.ttf
+	{L"U001Con", 400, true, {0x00010CCC, 0x243E63C4, 0x00000000, 0xB869D054}, 626, 155, 3},	// U001Con-Ita.ttf
+	{L"U001Con", 700, false, {0x00010CCC, 0x60F933D2, 0x00000000, 0xB869D052}, 626, 158, 3},	// U001Con-Bol.ttf
+	{L"U001Con", 700, true, {0x00010CCC, 0x6B699564, 0x00000000, 0xB869D056}, 626, 161, 3},	// U001Con-BolIta.ttf
+	{L"URWBookmanL", 400, false, {0x00010CCC, 0xFE87B659, 0x00000000, 0xB89A8A8D}, 500, 164, 2},	// URWBookmanL-Ligh.ttf
+	{L"URWBookmanL", 400, true, {0x00010CCC, 0x13417985, 0x00000000, 0xB89A8A95}, 500, 166, 2},	// URWBookmanL-LighItal.ttf
+	{L"URWBookmanL", 700, false, {0x00010CCC, 0x145ED1C3, 0x00000000, 0xB89A8A91}, 500, 168, 2},	// URWBookmanL-DemiBold.ttf
+	{L"URWBookmanL", 700, true, {0x00010CCC, 0xD26CCD09, 0x00000000, 0xB89A8A98}, 500, 170, 2},	// URWBookmanL-DemiBoldItal.ttf
+	{L"URWChanceryLMed", 400, true, {0x00010CCC, 0x14E08F1F, 0x00000000, 0xB89A8AF9}, 521, 172, 3},	// URWChanceryL-MediItal.ttf
+	{L"URWClassico", 400, false, {0x00010CCC, 0x57613628, 0x00000000, 0xB869D03A}, 626, 175, 3},	// URWClassico-Reg.ttf
+	{L"URWClassico", 400, true, {0x00010CCC, 0x0DE75578, 0x00000000, 0xB869D040}, 626, 178, 3},	// URWClassico-Ita.ttf
+	{L"URWClassico", 700, false, {0x00010CCC, 0x0D7E7DF4, 0x00000000, 0xB869D03D}, 626, 181, 3},	// URWClassico-Bol.ttf
+	{L"URWClassico", 700, true, {0x00010CCC, 0x6AD7661E, 0x00000000, 0xB869D043}, 626, 184, 3},	// URWClassico-BolIta.ttf
+	{L"URWGothicL", 400, false, {0x00010CCC, 0x28E6012F, 0x00000000, 0xB89A8A80}, 500, 187, 2},	// URWGothicL-Book.ttf
+	{L"URWGothicL", 400, true, {0x00010CCC, 0x5BEBD5F3, 0x00000000, 0xB89A8A87}, 500, 189, 2},	// URWGothicL-BookObli.ttf
+	{L"URWGothicLDem", 400, false, {0x00010CCC, 0x9B1C8965, 0x00000000, 0xB89A8A84}, 500, 191, 2},	// URWGothicL-Demi.ttf
+	{L"URWGothicLDem", 400, true, {0x00010CCC, 0xCDD5820D, 0x00000000, 0xB89A8A8A}, 500, 193, 2},	// URWGothicL-DemiObli.ttf
+	{L"URWPalladioL", 400, false, {0x00010CCC, 0x30B42DD3, 0x00000000, 0xB89A8AE9}, 500, 195, 2},	// URWPalladioL-Roma.ttf
+	{L"URWPalladioL", 400, true, {0x00010CCC, 0x450627C1, 0x00000000, 0xB89A8AF1}, 500, 197, 2},	// URWPalladioL-Ital.ttf
+	{L"URWPalladioL", 700, false, {0x00010CCC, 0x9C94326D, 0x00000000, 0xB89A8AED}, 500, 199, 2},	// URWPalladioL-Bold.ttf
+	{L"URWPalladioL", 700, true, {0x00010CCC, 0x0ED596B1, 0x00000000, 0xB89A8AF5}, 499, 201, 2},	// URWPalladioL-BoldItal.ttf
+};
+
+#endif   //#define _URWGLYPHMAPS_H_
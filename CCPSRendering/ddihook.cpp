@@ -31,6 +31,7 @@
 #include <PRCOMOEM.H>
 #include "CCTChar.h"
 #include "CCPrintRegistry.h"
+#include "CCCommon.h"
 #include "GlyphTranslator.h"
 #include "CCPrintData.h"
 
@@ -317,6 +318,9 @@ show\n"
 /// Postscript circle definition
 #define PS_CIRCLE "newpath %d %d %d 0 360 arc fill closepath\n"
 
+/// Text layer comment start (the converter app moves these lines to a file next to the PDF)
+#define PS_TEXTLAYER "\r\n%%TextLayer: "
+
 /// PostScript image start definition
 #define PS_IMAGE_START "gsave\n\
 %d %d translate\n\
@@ -870,6 +874,52 @@ BOOL DoLicensePage(SURFOBJ* pso)
     return (((PFN_DrvSendPage)(poempdev->pfnPS[UD_DrvSendPage]))(pso));
 }
 
+/**
+	@brief Puts a new link at the head of the page's links
+	@param pDevOEM Pointer to the private PDEV structure
+	@param pLink The new link, allocated from the page arena with its pNext set to the page's links (NULL if it couldn't be allocated)
+	@return true if added, false if the link or its data couldn't be allocated (the page's links are left as they were)
+*/
+bool AddPageLink(POEMPDEV pDevOEM, InnerEscapeLinkData* pLink)
+{
+	if ((pLink == NULL) || (pLink->pData == NULL))
+	{
+		ERR(DLLTEXT("AddPageLink: out of memory, link dropped\r\n"));
+		return false;
+	}
+	pDevOEM->pLinks = pLink;
+	return true;
+}
+
+/**
+	@brief Adds the URLs found by the URL detector to the page's links
+	@param pDevOEM Pointer to the private PDEV structure
+*/
+void AddFoundURLs(POEMPDEV pDevOEM)
+{
+	std::wstring sURL;
+	RECTL rcArea;
+	while (pDevOEM->oURLs.GetURL(rcArea, sURL))
+		// Found a URL, add it to the list of links
+		AddPageLink(pDevOEM, new (pDevOEM->oArena) InnerEscapeLinkData(pDevOEM->oArena, rcArea, pDevOEM->oArena.MakeAnsiString(sURL), pDevOEM->pLinks));
+}
+
+/**
+	@brief Writes the page words and their locations into the PostScript file, as a single comment line
+	@param pdevobj Pointer to the device object representing the PostScript printer
+	@param pDevOEM Pointer to the CC PDF Converter render plugin object
+	@param sizePage The page size
+*/
+void PrintTextLayer(PDEVOBJ pdevobj, POEMPDEV pDevOEM, const SIZEL& sizePage)
+{
+	// The runs added now are not decoded again if the page is searched for links too
+	pDevOEM->oRuns.Decode(pDevOEM->pTranslator, pDevOEM->oText);
+	pDevOEM->sTextLayer = PS_TEXTLAYER;
+	pDevOEM->oText.WriteWords(pDevOEM->nPage, sizePage, pDevOEM->sTextLayer);
+	pDevOEM->sTextLayer += "\r\n";
+	PrintPS(pdevobj, pDevOEM, pDevOEM->sTextLayer.c_str());
+}
+
 
 
 /**
@@ -894,7 +944,15 @@ BOOL APIENTRY OEMStartPage(SURFOBJ* pso)
 
 	// Only get text if needed
 	if (poempdev->bLoadedData)
-		poempdev->bNeedText = poempdev->dataLinks.IsTestPage() || poempdev->dataLinks.GetPageData(poempdev->nPage).HasTextLink();
+	{
+		poempdev->bNeedText = poempdev->bTextLayer || poempdev->dataLinks.IsTestPage() || poempdev->dataLinks.GetPageData(poempdev->nPage).HasTextLink();
+		// If all the text links say where they are, only the text there is needed (unless all of it is exported)
+		std::vector<RECTL> arRegions;
+		if (poempdev->bNeedText && !poempdev->bTextLayer && !poempdev->dataLinks.IsTestPage() && poempdev->dataLinks.GetPageData(poempdev->nPage).GetTextRegions(arRegions))
+			poempdev->oRuns.SetRegions(arRegions);
+	}
+	// Auto-URL jobs check the text as it's printed (but the text layer needs all of it at the end)
+	poempdev->bStreamURLs = !poempdev->dataLinks.HasData() && ((POEMDEV)pdevobj->pOEMDM)->bAutoURLs && !poempdev->bTextLayer;
 #ifdef _DEBUG
 	poempdev->bNeedText = true;
 #endif
@@ -918,6 +976,10 @@ BOOL APIENTRY OEMSendPage(SURFOBJ* pso)
     pdevobj = (PDEVOBJ)pso->dhpdev;
     poempdev = (POEMPDEV)pdevobj->pdevOEM;
 
+	// Export the page text first, if so set
+	if (poempdev->bTextLayer && !poempdev->bDiscardOutput)
+		PrintTextLayer(pdevobj, poempdev, pso->sizlBitmap);
+
 	// Work with external data (i.e., links file)
 	POEMDEV pDevMode = (POEMDEV)pdevobj->pOEMDM;
 	if (poempdev->dataLinks.HasData())
@@ -930,6 +992,7 @@ BOOL APIENTRY OEMSendPage(SURFOBJ* pso)
 		if (poempdev->dataLinks.IsTestPage())
 		{
 			// This is a text print job: we'll write back the link locations in the INI file
+			poempdev->oRuns.Decode(poempdev->pTranslator, poempdev->oText);
 			if (poempdev->oText.empty())
 			{
 				// Not yet
@@ -944,9 +1007,22 @@ BOOL APIENTRY OEMSendPage(SURFOBJ* pso)
 					CCPrintData dataCompute;
 					dataCompute.SetTestPage();
 
-					// Get the link data to test for
+					// Get the link data to test for, and look for all of it at once
 					const CCPrintData::PageData& data = poempdev->dataLinks.GetPageData(poempdev->nPage);
-					for (CCPrintData::PageData::const_iterator i = data.begin(); i != data.end(); i++)
+					TextMatcher& matcher = poempdev->oMatcher;
+					matcher.clear();
+					std::vector<UINT> arPhrases;
+					CCPrintData::PageData::const_iterator i;
+					for (i = data.begin(); i != data.end(); i++)
+					{
+						STRLIST words;
+						words.push_back((*i).sText);
+						arPhrases.push_back(matcher.AddPhrase(words));
+					}
+					poempdev->oText.FindAll(matcher);
+
+					std::vector<UINT>::const_iterator iPhrase = arPhrases.begin();
+					for (i = data.begin(); i != data.end(); i++, iPhrase++)
 					{
 						// For each link, try to find it
 						const CCPrintData::LinkData& link = (*i);
@@ -954,11 +1030,8 @@ BOOL APIENTRY OEMSendPage(SURFOBJ* pso)
 						ASSERT(link.nRepeat == 1);
 
 						// We don't know the order, so start at the beginning
-						poempdev->oText.InitSearch();
-						STRLIST words;
-						words.push_back(link.sText);
-					
-						if (poempdev->oText.SearchFor(words, rcArea, link.nRepeat))
+						matcher.Restart();
+						if (matcher.SearchFor(*iPhrase, rcArea, link.nRepeat))
 							// Found, add to the results
 							dataCompute.AddLink(link.sURL, rcArea, 1);
 					}
@@ -976,9 +1049,29 @@ BOOL APIENTRY OEMSendPage(SURFOBJ* pso)
 			const CCPrintData::PageData& data = poempdev->dataLinks.GetPageData(poempdev->nPage);
 			if (!data.empty())
 			{
-				// Make sure we can search for text links
-				poempdev->oText.InitSearch();
-				for (CCPrintData::PageData::const_iterator i = data.begin(); i != data.end(); i++)
+				// Look for all the text links at once (the words are split by the matcher)
+				TextMatcher& matcher = poempdev->oMatcher;
+				matcher.clear();
+				std::vector<UINT> arPhrases;
+				CCPrintData::PageData::const_iterator i;
+				for (i = data.begin(); i != data.end(); i++)
+				{
+					if (!(*i).IsLocation())
+					{
+						STRLIST words;
+						words.push_back((*i).sText);
+						arPhrases.push_back(matcher.AddPhrase(words));
+					}
+				}
+				if (!matcher.empty())
+				{
+					// Only now is the text needed
+					poempdev->oRuns.Decode(poempdev->pTranslator, poempdev->oText);
+					poempdev->oText.FindAll(matcher);
+				}
+
+				std::vector<UINT>::const_iterator iPhrase = arPhrases.begin();
+				for (i = data.begin(); i != data.end(); i++)
 				{
 					// Get next link
 					const CCPrintData::LinkData& link = (*i);
@@ -995,30 +1088,17 @@ BOOL APIENTRY OEMSendPage(SURFOBJ* pso)
 						else
 						{
 							// External link, add it to the list
-							poempdev->pLinks = new InnerEscapeLinkData(link.rectLocation, MakeAnsiString(link.sURL).c_str(), poempdev->pLinks, link.sTitle.empty() ? NULL : MakeAnsiString(link.sTitle).c_str());
+							AddPageLink(poempdev, new (poempdev->oArena) InnerEscapeLinkData(poempdev->oArena, link.rectLocation, poempdev->oArena.MakeAnsiString(link.sURL), poempdev->pLinks, link.sTitle.empty() ? NULL : poempdev->oArena.MakeAnsiString(link.sTitle)));
 							VERBOSE(DLLTEXT("Adding location-based link to %s:\r\n(%d,%d)-(%d,%d)\r\n"), link.sURL.c_str(), link.rectLocation.left, link.rectLocation.top, link.rectLocation.right, link.rectLocation.bottom);
 						}
 					}
 					else
 					{
-						// Text link: break it into words
-						std::tstring::size_type pos = link.sText.find(' '), oldpos = 0;
-						STRLIST words;
-						while ((oldpos < link.sText.size()) && (pos != std::tstring::npos))
-						{
-							if (pos > oldpos)
-								words.push_back(link.sText.substr(oldpos, pos - oldpos));
-							oldpos = pos + 1;
-							pos = link.sText.find(' ', oldpos);
-						}
-						if (oldpos < link.sText.size())
-							words.push_back(link.sText.substr(oldpos));
-
-						// Try to find the words
-						if (!poempdev->oText.SearchFor(words, rcArea, link.nRepeat))
+						// Text link: try to find the words (after the previous text link)
+						if (!matcher.SearchFor(*iPhrase++, rcArea, link.nRepeat, link.HasRegion() ? &link.rectRegion : NULL))
 							break;
 						// Found, so mark the location
-						poempdev->pLinks = new InnerEscapeLinkData(rcArea, MakeAnsiString(link.sURL).c_str(), poempdev->pLinks, link.sTitle.empty() ? NULL : MakeAnsiString(link.sTitle).c_str());
+						AddPageLink(poempdev, new (poempdev->oArena) InnerEscapeLinkData(poempdev->oArena, rcArea, poempdev->oArena.MakeAnsiString(link.sURL), poempdev->pLinks, link.sTitle.empty() ? NULL : poempdev->oArena.MakeAnsiString(link.sTitle)));
 					}
 				}
 			}
@@ -1026,15 +1106,15 @@ BOOL APIENTRY OEMSendPage(SURFOBJ* pso)
 	}
 	else if (pDevMode->bAutoURLs)
 	{
-		// Find and highlight URLs if so set by the user
-		std::wstring sURL;
-		RECTL rcArea;
-		poempdev->oText.InitSearch();
-		while (poempdev->oText.SearchForURL(rcArea, sURL))
-			// Found a URL, add it to the list of links
-			poempdev->pLinks = new InnerEscapeLinkData(rcArea, MakeAnsiString(sURL).c_str(), poempdev->pLinks);
+		// Find and highlight URLs if so set by the user; most were found as the text was printed, 
+		// this only leaves the words at the end of the lines
+		poempdev->oRuns.Stream(poempdev->pTranslator, poempdev->oURLs);
+		poempdev->oURLs.Flush();
+		AddFoundURLs(poempdev);
 	}
+	poempdev->oRuns.clear();
 	poempdev->oText.clear();
+	poempdev->oURLs.clear();
 
 	// Do we have links to add to this page?
 	if (poempdev->pLinks != NULL)
@@ -1058,8 +1138,6 @@ BOOL APIENTRY OEMSendPage(SURFOBJ* pso)
 			else
 				// Print without title
 				PrintURLLink(pdevobj, poempdev, pLink->pData->url, rectTarget);
-
-			delete pLink;
 		}
 	}
 
@@ -1158,6 +1236,10 @@ BOOL APIENTRY OEMSendPage(SURFOBJ* pso)
 		}
 	}
 
+	// Done with this page's memory
+	VERBOSE(DLLTEXT("Page %d: %u allocations (%u bytes) from the page arena, %u new blocks\r\n"), poempdev->nPage, poempdev->oArena.GetAllocCount(), (UINT)poempdev->oArena.GetAllocSize(), poempdev->oArena.GetNewBlockCount());
+	poempdev->oArena.Reset();
+
     //
     // turn around to call PS
     //
@@ -1196,10 +1278,16 @@ BOOL APIENTRY OEMStartDoc(SURFOBJ* pso, PWSTR pwszDocName,DWORD dwJobId)
 	POEMDEV pDevMode = (POEMDEV)pdevobj->pOEMDM;
 	std::string sFilename = MakeAnsiString(pDevMode->cFilename);
 
+	// Pages are counted per document (an application can print more than one on the same DC)
+	poempdev->nPage = 0;
 	poempdev->pLinks = NULL;
+	poempdev->bDiscardOutput = false;
+	poempdev->bStreamURLs = false;
 	if (poempdev->pTranslator == NULL)
 		poempdev->pTranslator = new GlyphTranslator;
-	poempdev->bNeedText = pDevMode->bAutoURLs ? true : false;
+	poempdev->bTextLayer = CCPrintRegistry::GetRegistryBool(pdevobj->hPrinter, SETTINGS_TEXTLAYER, false);
+	poempdev->bNeedText = (pDevMode->bAutoURLs || poempdev->bTextLayer) ? true : false;
+	bool bCalibration = false;
 
 	// Check registry for data file for this print job
 	poempdev->bUsedPrintData = false;
@@ -1215,6 +1303,7 @@ BOOL APIENTRY OEMStartDoc(SURFOBJ* pso, PWSTR pwszDocName,DWORD dwJobId)
 			{
 				poempdev->bNeedText = true;
 				sFilename = ":dropfile:";
+				bCalibration = true;
 			}
 		}
 	}
@@ -1222,33 +1311,70 @@ BOOL APIENTRY OEMStartDoc(SURFOBJ* pso, PWSTR pwszDocName,DWORD dwJobId)
 	// Do we know the filename we will use?
 	if (!sFilename.empty())
 	{
-		// Yeh, so put it in the file (the converter app will get it from there)
+		// Yeh, so put it in the file (the converter app will get it from there), with the auto open command if we should
 		sFilename = "%%File: " + sFilename + "\r\n";
-		DWORD dwResult;
-		std::tstring::size_type dwLen = sFilename.size();
-
-		poempdev->pOEMHelp->DrvWriteSpoolBuf(pdevobj, (LPVOID)sFilename.c_str(), (DWORD)dwLen, &dwResult);
-		if (dwResult != dwLen)
-			return FALSE;
-
-		// Also write the auto open command, if we should:
 		if (pDevMode->bAutoOpen)
+			sFilename += pDevMode->bCreateAsTemp ? "%%CreateAsTemp\r\n" : "%%FileAutoOpen\r\n";
+		DWORD dwResult = 0;
+		DWORD dwLen = (DWORD)sFilename.size();
+
+		if (bCalibration)
 		{
-			if (pDevMode->bCreateAsTemp)
-				sFilename = "%%CreateAsTemp\r\n";
-			else
-				sFilename = "%%FileAutoOpen\r\n";
-			dwLen = (DWORD) sFilename.size();
-			poempdev->pOEMHelp->DrvWriteSpoolBuf(pdevobj, (LPVOID)sFilename.c_str(), (DWORD)dwLen, &dwResult);
-			if (dwResult != dwLen)
+			// The core driver buffers what it spools, and everything it passes to OEMWritePrinter from now on is dropped,
+			// so the header goes straight to the spooler
+			if (!::WritePrinter(pdevobj->hPrinter, (LPVOID)sFilename.c_str(), dwLen, &dwResult))
 				return FALSE;
-
 		}
+		else
+			poempdev->pOEMHelp->DrvWriteSpoolBuf(pdevobj, (LPVOID)sFilename.c_str(), dwLen, &dwResult);
+		if (dwResult != dwLen)
+			return FALSE;
+	}
+
+	// Calibration job: the converter only needs the drop file header written above, so don't spool anything else
+	if (bCalibration)
+	{
+		VERBOSE(DLLTEXT("Link calibration job, discarding output\r\n"));
+		poempdev->bDiscardOutput = true;
 	}
 
 	return TRUE;
 }
 
+/**
+	@brief Writes the core driver's output to the spooler (IOemPS::WritePrinter)
+	@param pdevobj Pointer to the DEVOBJ structure
+	@param pBuf Data to write to the spooler (NULL when the driver checks if we support this method)
+	@param cbBuffer Size of the data in pBuf
+	@param pcbWritten Pointer to the count of bytes written
+	@return S_OK if successful, E_FAIL if failed
+
+	All the output of the core driver goes through here; while a link calibration (test page) job is
+	printed the data is dropped, as only the link locations matter for it and not the PostScript itself.
+*/
+HRESULT OEMWritePrinter(PDEVOBJ pdevobj, PVOID pBuf, DWORD cbBuffer, PDWORD pcbWritten)
+{
+	// The core driver calls us with no data to see if we support this
+	if ((pBuf == NULL) && (cbBuffer == 0))
+		return S_OK;
+
+	POEMPDEV poempdev = (POEMPDEV)pdevobj->pdevOEM;
+	if ((poempdev != NULL) && poempdev->bDiscardOutput)
+	{
+		// Calibration job: pretend it was written
+		if (pcbWritten != NULL)
+			*pcbWritten = cbBuffer;
+		return S_OK;
+	}
+
+	DWORD dwWritten = 0;
+	if (!::WritePrinter(pdevobj->hPrinter, pBuf, cbBuffer, &dwWritten))
+		return E_FAIL;
+	if (pcbWritten != NULL)
+		*pcbWritten = dwWritten;
+	return S_OK;
+}
+
 /**
 	@brief This function is called the printing has ended
 	@param pso Pointer to the surface object representing the writing PostScript file
@@ -1267,19 +1393,23 @@ BOOL APIENTRY OEMEndDoc(SURFOBJ* pso, FLONG fl)
     poempdev = (POEMPDEV)pdevobj->pdevOEM;
 	POEMDEV pDevMode = (POEMDEV)pdevobj->pOEMDM;
 
-	// Clean up the translator
+	// Clean up the translator (the maps it built are kept in the glyph map cache file for the next jobs)
 	if (poempdev->pTranslator != NULL)
 	{
+		poempdev->pTranslator->SaveMaps();
 		delete poempdev->pTranslator;
 		poempdev->pTranslator = NULL;
 	}
+	// Drop whatever was left from an unfinished page
+	poempdev->pLinks = NULL;
+	poempdev->oArena.Reset();
 	// Clean up the link data file (only if actually printed: the printer driver is called for setting up stuff before the actual printing)
 	if (poempdev->bUsedPrintData)
 	{
 		poempdev->dataLinks.CleanSaved(pdevobj->hPrinter);
 	}
 
-	if (fl != ED_ABORTDOC)
+	if ((fl != ED_ABORTDOC) && !poempdev->bDiscardOutput)
 	{
 		switch (pDevMode->info.m_eLicense)
 		{
@@ -1360,11 +1490,18 @@ ULONG APIENTRY OEMEscape(SURFOBJ* pso, ULONG iEsc, ULONG cjIn, PVOID pvIn, ULONG
 				if (cjIn < sizeof(EscapeLinkData))
 					return FALSE;
 				// Do something:
-				poempdev->pLinks = new InnerEscapeLinkData((const char*)pvIn, cjIn, poempdev->pLinks);
+				if (!AddPageLink(poempdev, new (poempdev->oArena) InnerEscapeLinkData(poempdev->oArena, (const char*)pvIn, cjIn, poempdev->pLinks)))
+					return FALSE;
 				return TRUE;
 			case ESCAPE_DISABLE_AUTO_URL:
 				// A disable-auto-URL-linking escape
 				poempdev->bNeedText = false;
+				if (poempdev->bTextLayer)
+				{
+					// The text is still needed for the text layer, so only the URL search is turned off
+					poempdev->bNeedText = true;
+					((POEMDEV)pdevobj->pOEMDM)->bAutoURLs = FALSE;
+				}
 				return TRUE;
 		}
 	}
@@ -1399,53 +1536,37 @@ BOOL APIENTRY OEMTextOut(SURFOBJ *pso, STROBJ *pstro, FONTOBJ *pfo, CLIPOBJ *pco
 	poempdev = (POEMPDEV)pdevobj->pdevOEM;
 
 	// Do we need to save the text location for later?
-	if (poempdev->bNeedText && ((pstro->cGlyphs > 0) && (pstro->pwszOrg != NULL)))
+	if (poempdev->bNeedText && ((pstro->cGlyphs > 0) && (pstro->pwszOrg != NULL)) && poempdev->oRuns.IsWanted(pstro->rclBkGround))
 	{
-		// Yes...
-		PGLYPHPOS pGlyphPos;
-		POINTQF* pWidths = NULL;
-		bool bValid = false;
-
-		// Is this a fixed-font?
-		if (pstro->ulCharInc == 0)
-		{
-			// No, so get glyph locations
-			ULONG uCount;
-			BOOL bRet = STROBJ_bEnumPositionsOnly(pstro, &uCount, &pGlyphPos);
-
-			if ((bRet != DDI_ERROR) && (uCount == pstro->cGlyphs))
-			{
-				pWidths = new POINTQF[uCount];
-				if (STROBJ_bGetAdvanceWidths(pstro, 0, uCount, pWidths))
-					bValid = true;
-			}
-		}
-		else
-			bValid = true;
-
-		if (bValid)
+		// Yes; only record the run here, it's translated when (and if) the page text is searched
+		UINT nFont = TEXT_NONE;
+		bool bValid = true;
+		if ((pstro->flAccel & SO_GLYPHINDEX_TEXTOUT) != 0)
 		{
-			// OK, we can go on and read the actual text now
-			std::wstring sText;
-			if ((pstro->flAccel & SO_GLYPHINDEX_TEXTOUT) != 0)
+			// Those are glyphs, not an actual string, so we need their font for translating them later
+			nFont = poempdev->oRuns.FindFont(pfo->iUniq);
+			if (nFont == TEXT_NONE)
 			{
-				// Those are glyphs, not an actual string, so we need to translate them:
-				const GlyphToText* pGlyphMap = NULL;
+				// New font on this page: get its identity
+				GlyphFontID idFont;
+				XFORML xForm;
+				const GlyphToText* pMap;
+				idFont.iUniq = pfo->iUniq;
+				idFont.iFace = pfo->iFace;
+				XFORMOBJ_iGetXform(FONTOBJ_pxoGetXform(pfo), &xForm);
+				idFont.eM11 = xForm.eM11;
+				idFont.eM12 = xForm.eM12;
+				idFont.eM21 = xForm.eM21;
+				idFont.eM22 = xForm.eM22;
+
+				// Already seen in this job? Then its description isn't needed
 				PIFIMETRICS pifi;
-
-				TRACE(DLLTEXT("Found glyph text:\r\n"));
-
-				// Get font data:
-				pifi = FONTOBJ_pifi(pfo);
-				if (pifi != NULL)
+				if ((poempdev->pTranslator != NULL) && poempdev->pTranslator->FindFont(idFont, pMap))
+					nFont = poempdev->oRuns.AddFont(idFont, pMap);
+				else if ((pifi = FONTOBJ_pifi(pfo)) != NULL)
 				{
 					LOGFONT lfFont;
 					// Calculate font point size
-					XFORMOBJ* pFormObj = FONTOBJ_pxoGetXform(pfo);
-					XFORML xForm;
-					ULONG uXForm = XFORMOBJ_iGetXform(pFormObj, &xForm);
-
-					double dXScale = sqrt(xForm.eM11 * xForm.eM11 + xForm.eM12 * xForm.eM12);
 					double dYScale = sqrt(xForm.eM22 * xForm.eM22 + xForm.eM21 * xForm.eM21);
 
 					// Populate font object for translation
@@ -1464,59 +1585,202 @@ BOOL APIENTRY OEMTextOut(SURFOBJ *pso, STROBJ *pstro, FONTOBJ *pfo, CLIPOBJ *pco
 					lfFont.lfPitchAndFamily = pifi->jWinPitchAndFamily;
 					wcsncpy_s(lfFont.lfFaceName, _S(lfFont.lfFaceName), (TCHAR*)(((char*)pifi) + (DWORD)pifi->dpwszFamilyName), LF_FACESIZE);
 
-					// Get the glyph map
-					pGlyphMap = (poempdev->pTranslator == NULL) ? NULL : poempdev->pTranslator->GetFontTranslation(lfFont);
-					if (pGlyphMap != NULL)
-					{
-						// Found it
-						GlyphToText::const_iterator iChar;
-						for (unsigned int i=0;i<pstro->cGlyphs;i++)
-						{
-							// Map each glyph into a character
-							iChar = pGlyphMap->find(pstro->pwszOrg[i]);
-							if (iChar != pGlyphMap->end())
-								sText += (*iChar).second;
-							else
-								sText += (WCHAR)0x7F;
-						}
-						TRACE(DLLTEXT("%s\r\n"), sText.c_str());
-					}
+					nFont = poempdev->oRuns.AddFont(idFont, lfFont);
 				}
-				if (sText.empty())
+				else
 				{
-					TRACE(DLLTEXT("Could not unglyph it...\r\n"));
+					TRACE(DLLTEXT("Could not get the font of the glyphs...\r\n"));
+					bValid = false;
 				}
 			}
-			else
-			{
-				// This is just a string, use it
-				sText.assign(pstro->pwszOrg, pstro->cGlyphs);
-				TRACE(DLLTEXT("Got the following text:\r\n"));
-			}
+		}
 
-			if (!sText.empty())
+		if (bValid)
+		{
+			// Is this a fixed-font?
+			if (pstro->ulCharInc == 0)
 			{
-				// OK we have data
-				TRACE(DLLTEXT("%s [at %d,%d-%d,%d]\r\n"), sText.c_str(), pstro->rclBkGround.left, pstro->rclBkGround.top, pstro->rclBkGround.right, pstro->rclBkGround.bottom);
-		
-				// Add to the parts
-				if (pstro->ulCharInc == 0)
-				{
-					// Use variable locations
-					ASSERT(pWidths != NULL);
-					poempdev->oText.AddLine(TextLine(sText, pstro->rclBkGround, pGlyphPos, pWidths));
-					delete [] pWidths;
-				}
-				else
+				// No, so get glyph locations
+				PGLYPHPOS pGlyphPos;
+				ULONG uCount;
+				BOOL bRet = STROBJ_bEnumPositionsOnly(pstro, &uCount, &pGlyphPos);
+
+				if ((bRet != (BOOL)DDI_ERROR) && (uCount == pstro->cGlyphs))
 				{
-					// Fixed font
-					ASSERT(pWidths == NULL);
-					poempdev->oText.AddLine(TextLine(sText, pstro->rclBkGround, pstro->ulCharInc));
+					// The recorder keeps its own copy of the widths, so they only need a scratch buffer
+					if (poempdev->arWidths.size() < uCount)
+						poempdev->arWidths.resize(uCount);
+					if ((uCount > 0) && STROBJ_bGetAdvanceWidths(pstro, 0, uCount, &poempdev->arWidths[0]))
+						poempdev->oRuns.AddRun(nFont, pstro->pwszOrg, pstro->cGlyphs, pstro->rclBkGround, pGlyphPos, &poempdev->arWidths[0]);
 				}
 			}
+			else
+				poempdev->oRuns.AddRun(nFont, pstro->pwszOrg, pstro->cGlyphs, pstro->rclBkGround, pstro->ulCharInc);
+			TRACE(DLLTEXT("Recorded %u glyphs [at %d,%d-%d,%d]\r\n"), pstro->cGlyphs, pstro->rclBkGround.left, pstro->rclBkGround.top, pstro->rclBkGround.right, pstro->rclBkGround.bottom);
+
+			// Auto-URL job: check the run right away, so the page text isn't kept
+			if (poempdev->bStreamURLs)
+			{
+				poempdev->oRuns.Stream(poempdev->pTranslator, poempdev->oURLs);
+				AddFoundURLs(poempdev);
+			}
 		}
 	}
 
+	// Calibration job: we only needed the text location
+	if (poempdev->bDiscardOutput)
+		return TRUE;
+
 	// Call base driver to do the actual printing work...
 	return (((PFN_DrvTextOut)(poempdev->pfnPS[UD_DrvTextOut])) (pso, pstro, pfo, pco, prclExtra, prclOpaque, pboFore, pboOpaque, pptlOrg, mix));
 }
+
+/**
+	@brief This function is called to draw a bit block
+	@param psoTrg Target surface object
+	@param psoSrc Source surface object
+	@param psoMask Mask surface object
+	@param pco Clip object
+	@param pxlo Color translation object
+	@param prclTrg Target rectangle
+	@param pptlSrc Source origin
+	@param pptlMask Mask origin
+	@param pbo Brush object
+	@param pptlBrush Brush origin
+	@param rop4 Raster operation
+	@return TRUE if successful, FALSE if failed
+*/
+BOOL APIENTRY OEMBitBlt(SURFOBJ *psoTrg, SURFOBJ *psoSrc, SURFOBJ *psoMask, CLIPOBJ *pco, XLATEOBJ *pxlo, RECTL *prclTrg, POINTL *pptlSrc, POINTL *pptlMask, BRUSHOBJ *pbo, POINTL *pptlBrush, ROP4 rop4)
+{
+	PDEVOBJ pdevobj = (PDEVOBJ)psoTrg->dhpdev;
+	POEMPDEV poempdev = (POEMPDEV)pdevobj->pdevOEM;
+
+	// Nothing to draw in a calibration job
+	if (poempdev->bDiscardOutput)
+		return TRUE;
+
+	return (((PFN_DrvBitBlt)(poempdev->pfnPS[UD_DrvBitBlt])) (psoTrg, psoSrc, psoMask, pco, pxlo, prclTrg, pptlSrc, pptlMask, pbo, pptlBrush, rop4));
+}
+
+/**
+	@brief This function is called to draw a stretched bit block
+	@param psoDest Target surface object
+	@param psoSrc Source surface object
+	@param psoMask Mask surface object
+	@param pco Clip object
+	@param pxlo Color translation object
+	@param pca Color adjustment
+	@param pptlHTOrg Halftone origin
+	@param prclDest Target rectangle
+	@param prclSrc Source rectangle
+	@param pptlMask Mask origin
+	@param iMode Stretching mode
+	@return TRUE if successful, FALSE if failed
+*/
+BOOL APIENTRY OEMStretchBlt(SURFOBJ *psoDest, SURFOBJ *psoSrc, SURFOBJ *psoMask, CLIPOBJ *pco, XLATEOBJ *pxlo, COLORADJUSTMENT *pca, POINTL *pptlHTOrg, RECTL *prclDest, RECTL *prclSrc, POINTL *pptlMask, ULONG iMode)
+{
+	PDEVOBJ pdevobj = (PDEVOBJ)psoDest->dhpdev;
+	POEMPDEV poempdev = (POEMPDEV)pdevobj->pdevOEM;
+
+	// Nothing to draw in a calibration job
+	if (poempdev->bDiscardOutput)
+		return TRUE;
+
+	return (((PFN_DrvStretchBlt)(poempdev->pfnPS[UD_DrvStretchBlt])) (psoDest, psoSrc, psoMask, pco, pxlo, pca, pptlHTOrg, prclDest, prclSrc, pptlMask, iMode));
+}
+
+/**
+	@brief This function is called to copy bits to the device
+	@param psoDst Target surface object
+	@param psoSrc Source surface object
+	@param pco Clip object
+	@param pxlo Color translation object
+	@param prclDst Target rectangle
+	@param pptlSrc Source origin
+	@return TRUE if successful, FALSE if failed
+*/
+BOOL APIENTRY OEMCopyBits(SURFOBJ *psoDst, SURFOBJ *psoSrc, CLIPOBJ *pco, XLATEOBJ *pxlo, RECTL *prclDst, POINTL *pptlSrc)
+{
+	// Either surface may be the device one
+	PDEVOBJ pdevobj = (PDEVOBJ)((psoDst->iType == STYPE_BITMAP) ? psoSrc->dhpdev : psoDst->dhpdev);
+	POEMPDEV poempdev = (POEMPDEV)pdevobj->pdevOEM;
+
+	// Nothing to draw in a calibration job
+	if (poempdev->bDiscardOutput)
+		return TRUE;
+
+	return (((PFN_DrvCopyBits)(poempdev->pfnPS[UD_DrvCopyBits])) (psoDst, psoSrc, pco, pxlo, prclDst, pptlSrc));
+}
+
+/**
+	@brief This function is called to draw a path outline
+	@param pso Pointer to the surface object representing the writing PostScript file
+	@param ppo Path object
+	@param pco Clip object
+	@param pxo Transformation object
+	@param pbo Brush object
+	@param pptlBrushOrg Brush origin
+	@param plineattrs Line attributes
+	@param mix Raster operation
+	@return TRUE if successful, FALSE if failed
+*/
+BOOL APIENTRY OEMStrokePath(SURFOBJ *pso, PATHOBJ *ppo, CLIPOBJ *pco, XFORMOBJ *pxo, BRUSHOBJ *pbo, POINTL *pptlBrushOrg, LINEATTRS *plineattrs, MIX mix)
+{
+	PDEVOBJ pdevobj = (PDEVOBJ)pso->dhpdev;
+	POEMPDEV poempdev = (POEMPDEV)pdevobj->pdevOEM;
+
+	// Nothing to draw in a calibration job
+	if (poempdev->bDiscardOutput)
+		return TRUE;
+
+	return (((PFN_DrvStrokePath)(poempdev->pfnPS[UD_DrvStrokePath])) (pso, ppo, pco, pxo, pbo, pptlBrushOrg, plineattrs, mix));
+}
+
+/**
+	@brief This function is called to fill a path
+	@param pso Pointer to the surface object representing the writing PostScript file
+	@param ppo Path object
+	@param pco Clip object
+	@param pbo Brush object
+	@param pptlBrushOrg Brush origin
+	@param mix Raster operation
+	@param flOptions Fill mode
+	@return TRUE if successful, FALSE if failed
+*/
+BOOL APIENTRY OEMFillPath(SURFOBJ *pso, PATHOBJ *ppo, CLIPOBJ *pco, BRUSHOBJ *pbo, POINTL *pptlBrushOrg, MIX mix, FLONG flOptions)
+{
+	PDEVOBJ pdevobj = (PDEVOBJ)pso->dhpdev;
+	POEMPDEV poempdev = (POEMPDEV)pdevobj->pdevOEM;
+
+	// Nothing to draw in a calibration job
+	if (poempdev->bDiscardOutput)
+		return TRUE;
+
+	return (((PFN_DrvFillPath)(poempdev->pfnPS[UD_DrvFillPath])) (pso, ppo, pco, pbo, pptlBrushOrg, mix, flOptions));
+}
+
+/**
+	@brief This function is called to draw and fill a path
+	@param pso Pointer to the surface object representing the writing PostScript file
+	@param ppo Path object
+	@param pco Clip object
+	@param pxo Transformation object
+	@param pboStroke Outline brush object
+	@param plineattrs Line attributes
+	@param pboFill Fill brush object
+	@param pptlBrushOrg Brush origin
+	@param mixFill Fill raster operation
+	@param flOptions Fill mode
+	@return TRUE if successful, FALSE if failed
+*/
+BOOL APIENTRY OEMStrokeAndFillPath(SURFOBJ *pso, PATHOBJ *ppo, CLIPOBJ *pco, XFORMOBJ *pxo, BRUSHOBJ *pboStroke, LINEATTRS *plineattrs, BRUSHOBJ *pboFill, POINTL *pptlBrushOrg, MIX mixFill, FLONG flOptions)
+{
+	PDEVOBJ pdevobj = (PDEVOBJ)pso->dhpdev;
+	POEMPDEV poempdev = (POEMPDEV)pdevobj->pdevOEM;
+
+	// Nothing to draw in a calibration job
+	if (poempdev->bDiscardOutput)
+		return TRUE;
+
+	return (((PFN_DrvStrokeAndFillPath)(poempdev->pfnPS[UD_DrvStrokeAndFillPath])) (pso, ppo, pco, pxo, pboStroke, plineattrs, pboFill, pptlBrushOrg, mixFill, flOptions));
+}
@@ -43,6 +43,12 @@ static const DRVFN OEMHookFuncs[] =
     { INDEX_DrvEndDoc,                      (PFN) OEMEndDoc                     },
 	{ INDEX_DrvEscape,						(PFN) OEMEscape						},
 	{ INDEX_DrvTextOut,						(PFN) OEMTextOut					},
+	{ INDEX_DrvBitBlt,						(PFN) OEMBitBlt						},
+	{ INDEX_DrvStretchBlt,					(PFN) OEMStretchBlt					},
+	{ INDEX_DrvCopyBits,					(PFN) OEMCopyBits					},
+	{ INDEX_DrvStrokePath,					(PFN) OEMStrokePath					},
+	{ INDEX_DrvFillPath,					(PFN) OEMFillPath					},
+	{ INDEX_DrvStrokeAndFillPath,			(PFN) OEMStrokeAndFillPath			},
 };
 
 
@@ -84,6 +90,9 @@ PDEVOEM APIENTRY OEMEnablePDEV(PDEVOBJ pdevobj, PWSTR pPrinterName, ULONG cPatte
 	poempdev->nPage = 0;
 	poempdev->pLinks = NULL;
 	poempdev->pTranslator = NULL;
+	poempdev->bDiscardOutput = false;
+	poempdev->bStreamURLs = false;
+	poempdev->bTextLayer = false;
 	POEMDEV pDevMode = (POEMDEV)pdevobj->pOEMDM;
 	poempdev->bNeedText = pDevMode->bAutoURLs ? true : false;
 
@@ -130,18 +139,14 @@ VOID APIENTRY OEMDisablePDEV(PDEVOBJ pdevobj)
     //
     assert(NULL != pdevobj->pdevOEM);
     POEMPDEV poempdev = (POEMPDEV)pdevobj->pdevOEM;
-	while (poempdev->pLinks != NULL)
-	{
-		InnerEscapeLinkData* pLink = poempdev->pLinks;
-		poempdev->pLinks = pLink->pNext;
-		delete pLink;
-	}
+	// The links live in the page arena, which is freed with the OEMPDEV
+	poempdev->pLinks = NULL;
 	if (poempdev->pTranslator != NULL)
 	{
 		delete poempdev->pTranslator;
 		poempdev->pTranslator = NULL;
 	}
-    delete pdevobj->pdevOEM;
+    delete poempdev;
 }
 
 /**
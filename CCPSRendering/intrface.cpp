@@ -106,6 +106,11 @@ HRESULT __stdcall IOemPS::QueryInterface(const IID& iid, void** ppv)
         *ppv = static_cast<IPrintOemPS*>(this);
         VERBOSE(DLLTEXT("IOemPS::QueryInterface IPrintOemPs.\r\n")); 
     }
+    else if (iid == IID_IPrintOemPS2)
+    {
+        *ppv = static_cast<IPrintOemPS2*>(this);
+        VERBOSE(DLLTEXT("IOemPS::QueryInterface IPrintOemPs2.\r\n")); 
+    }
     else
     {
 #if DBG && defined(USERMODE_DRIVER)
@@ -373,6 +378,32 @@ HRESULT __stdcall IOemPS::Command(PDEVOBJ pdevobj, DWORD dwIndex, PVOID pData, D
     return S_OK;
 }
 
+/**
+	@param pdevobj Pointer to the DEVOBJ structure
+	@param pBuf Data to write to the spooler (NULL when the driver checks if we support this method)
+	@param cbBuffer Size of the data in pBuf
+	@param pcbWritten Pointer to the count of bytes written
+	@return S_OK if successful, E_FAIL if failed
+*/
+HRESULT __stdcall IOemPS::WritePrinter(PDEVOBJ pdevobj, PVOID pBuf, DWORD cbBuffer, PDWORD pcbWritten)
+{
+	return OEMWritePrinter(pdevobj, pBuf, cbBuffer, pcbWritten);
+}
+
+/**
+	@param pdevobj Not used
+	@param dwAdjustType Not used
+	@param pBuf Not used
+	@param cbBuffer Not used
+	@param pbAdjustmentDone Not used
+	@return E_NOTIMPL
+*/
+HRESULT __stdcall IOemPS::GetPDEVAdjustment(PDEVOBJ pdevobj, DWORD dwAdjustType, PVOID pBuf, DWORD cbBuffer, OUT BOOL *pbAdjustmentDone)
+{
+    VERBOSE(DLLTEXT("IOemPS::GetPDEVAdjustment() entry.\r\n"));
+    return E_NOTIMPL;
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 //
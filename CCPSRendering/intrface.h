@@ -33,7 +33,7 @@
 /**
     @brief Interface for PostScript OEM sample rendering module
 */
-class IOemPS : public IPrintOemPS
+class IOemPS : public IPrintOemPS2
 {
 public:
     // *** IUnknown methods ***
@@ -72,6 +72,13 @@ public:
     /// OEMCommand - PSCRIPT only, return E_NOTIMPL on Unidrv
     STDMETHOD(Command) (THIS_ PDEVOBJ pdevobj, DWORD dwIndex, PVOID pData, DWORD cbSize, OUT DWORD *pdwResult);
 
+    // *** IPrintOemPS2 methods ***
+	/// Method for OEM to take over the spooler writes of the core driver
+    STDMETHOD(WritePrinter) (THIS_ PDEVOBJ pdevobj, PVOID pBuf, DWORD cbBuffer, PDWORD pcbWritten);
+
+	/// Method for OEM to adjust PDEV settings - not used
+    STDMETHOD(GetPDEVAdjustment) (THIS_ PDEVOBJ pdevobj, DWORD dwAdjustType, PVOID pBuf, DWORD cbBuffer, OUT BOOL *pbAdjustmentDone);
+
 	/// Constructor
     IOemPS();
 	/// Destructor
@@ -33,6 +33,8 @@
 #include "DEVMODE.H"
 #include "CCPrintData.h"
 #include "TextPart.h"
+#include "TextRecorder.h"
+#include "PageArena.h"
 
 /**
 	Escape code for adding a link to the current page.
@@ -60,6 +62,12 @@ typedef enum tag_Hooks {
     UD_DrvEndDoc,
 	UD_DrvEscape,
 	UD_DrvTextOut,
+	UD_DrvBitBlt,
+	UD_DrvStretchBlt,
+	UD_DrvCopyBits,
+	UD_DrvStrokePath,
+	UD_DrvFillPath,
+	UD_DrvStrokeAndFillPath,
 
     MAX_DDI_HOOKS,
 
@@ -86,36 +94,62 @@ struct EscapeLinkData
 
 /**
     @brief Class holding a single link's data for writing into the page
+
+	The objects and their data are allocated from the page arena, and so are never deleted: 
+	they are gone when the arena is reset at the end of the page.
 */
 struct InnerEscapeLinkData
 {
+	/**
+		@brief Allocates a link data object from the page arena
+		@param nSize Size of the object
+		@param arena The page arena
+		@return Pointer to the object's memory, NULL if out of memory (the constructor isn't called then)
+	*/
+	static void* operator new(size_t nSize, PageArena& arena) throw() {return arena.Alloc(nSize);};
+	/**
+		@brief Matching delete operator, only called if a constructor throws (the arena memory is released by Reset())
+	*/
+	static void operator delete(void*, PageArena&) throw() {};
 	/**
 		@brief Default constructor
 	*/
 	InnerEscapeLinkData() : pNext(NULL), pData(NULL) {};
 	/**
 		@brief Constructor from escape sequence data
+		@param arena Page arena to allocate the data from
 		@param pInData Pointer to an EscapeLinkData structure
 		@param nSize Size of the structure (including the url part)
 		@param pInNext Pointer to the next link data object
+
+		pData is NULL if the data couldn't be allocated
 	*/
-	InnerEscapeLinkData(const char* pInData, int nSize, InnerEscapeLinkData* pInNext) : pNext(pInNext) {pData = (EscapeLinkData*)new char[nSize]; memcpy(pData, pInData, nSize);};
+	InnerEscapeLinkData(PageArena& arena, const char* pInData, int nSize, InnerEscapeLinkData* pInNext) : pNext(pInNext) {pData = (EscapeLinkData*)arena.Alloc(nSize); if (pData != NULL) memcpy(pData, pInData, nSize);};
 	/**
 		@brief Constructor from link-file data
+		@param arena Page arena to allocate the data from
 		@param rect Location of the link on the page
 		@param pURL URL of the link
 		@param pInNext Pointer to the next link data object
 		@param pTitle Tooltip for the link (future use only)
+
+		pData is NULL if the data couldn't be allocated
 	*/
-	InnerEscapeLinkData(const RECTL& rect, const char* pURL, InnerEscapeLinkData* pInNext, const char* pTitle = NULL) : pNext(pInNext)
+	InnerEscapeLinkData(PageArena& arena, const RECTL& rect, const char* pURL, InnerEscapeLinkData* pInNext, const char* pTitle = NULL) : pNext(pInNext)
 	{
+		// No title if it's empty
+		if ((pTitle != NULL) && (*pTitle == '\0'))
+			pTitle = NULL;
+
 		// Calculate the structure's size
 		size_t nSize = sizeof(EscapeLinkData) + strlen(pURL);
-		if ((pTitle != NULL) && (strlen(pTitle) > 0))
+		if (pTitle != NULL)
 			nSize += strlen(pTitle) + 1;
 
 		// Create structure
-		pData = (EscapeLinkData*)new char[nSize];
+		pData = (EscapeLinkData*)arena.Alloc(nSize);
+		if (pData == NULL)
+			return;
 		// Populate it
 		pData->left = rect.left;
 		pData->right = rect.right;
@@ -127,13 +161,9 @@ struct InnerEscapeLinkData
 		else
 		{
 			pData->lTitleOffset = strlen(pURL) + 1;
-			strcpy_s(pData->url + pData->lTitleOffset, strlen(pTitle), pTitle);
+			strcpy_s(pData->url + pData->lTitleOffset, strlen(pTitle)+1, pTitle);
 		}
 	}
-	/**
-		@brief Destructor
-	*/
-	~InnerEscapeLinkData() {delete [] pData;};
 	/// Pointer to the next link data object
 	InnerEscapeLinkData* pNext;
 	/// Pointer to the link data
@@ -172,13 +202,34 @@ typedef struct _OEMPDEV {
 	bool					bNeedText;
 	/// Set to true if loaded data from a link INI file
 	bool					bLoadedData;
-	/// Current page text data
+	/// Current page text runs, as printed (not translated yet)
+	TextRecorder			oRuns;
+	/// Current page text data (decoded from the runs when searched)
 	TextArea				oText;
+	/// URLs of the current page (Auto-URL jobs), found as the text is printed
+	URLDetector				oURLs;
+	/// Text link phrases of the current page (kept to reuse its memory)
+	TextMatcher				oMatcher;
+	/// Memory for the current page's allocations (links, strings, etc.)
+	PageArena				oArena;
+	/// Glyph advance widths of the text run being printed (kept to reuse its memory: it only grows)
+	std::vector<POINTQF>	arWidths;
 	/// link INI file data
 	CCPrintData				dataLinks;
 	/// Actual printing flag: true if data was actually printed
 	bool					bUsedPrintData;
+	/// Discard flag: true while a link calibration (test page) job is printed, so no PostScript is spooled
+	bool					bDiscardOutput;
+	/// Auto-URL flag: true if the page's runs are checked for URLs as they are printed (and not kept)
+	bool					bStreamURLs;
+	/// Text layer flag: true if the text of each page is written to the PostScript file for the converter app
+	bool					bTextLayer;
+	/// Text layer line of the current page (kept to reuse its memory)
+	std::string				sTextLayer;
 
 } OEMPDEV, *POEMPDEV;
 
+/// Writes the core driver's output to the spooler (ddihook.cpp)
+HRESULT OEMWritePrinter(PDEVOBJ pdevobj, PVOID pBuf, DWORD cbBuffer, PDWORD pcbWritten);
+
 #endif
@@ -48,6 +48,8 @@ void SAMTrace(LPCWSTR lpszFormat, ...)
 
 	// Cleanup variables
 	va_end(args);
+#else
+	UNREFERENCED_PARAMETER(lpszFormat);
 #endif
 }
 
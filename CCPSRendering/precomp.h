@@ -43,6 +43,10 @@
 
 // Required header files that shouldn't change often.
 
+#ifdef DDI_REPLAY
+// Linux-hosted replay build (see replay/ddireplay.cpp): stand-ins for the Win32 and DDK declarations
+#include "ddihost.h"
+#else
 #pragma warning (disable: 4786)
 
 #include <STDDEF.H>
@@ -63,6 +67,7 @@ extern "C"
 #include <EXCPT.H>
 #include <ASSERT.H>
 #include <PRINTOEM.H>
+#endif
 
 #define COUNTOF(p)  (sizeof(p)/sizeof(*(p)))
 
@@ -71,7 +76,7 @@ void SAMTrace(LPCWSTR lpszFormat, ...);
 #if defined(_DEBUG) || defined(ENABLE_TRACE)
 #define TRACE	SAMTrace
 #else
-#define TRACE	1 ? 0 : SAMTrace
+#define TRACE	1 ? (void)0 : SAMTrace
 #endif
 
 #endif
@@ -0,0 +1,334 @@
+/**
+	@file
+	@brief Benchmark for building glyph maps from TrueType character map tables
+*/
+
+/*
+ * CC PDF Converter: Windows PDF Printer with Creative Commons license support
+ * Excel to PDF Converter: Excel PDF printing addin, keeping hyperlinks AND Creative Commons license support
+ * Copyright (C) 2007-2010 Guy Hachlili <hguy@cogniview.com>, Cogniview LTD.
+ * 
+ * This file is part of CC PDF Converter / Excel to PDF Converter
+ * 
+ * CC PDF Converter and Excel to PDF Converter are free software;
+ * you can redistribute them and/or modify them under the terms of the 
+ * GNU General Public License as published by the Free Software Foundation;
+ * either version 2 of the License, or (at your option) any later version.
+ * 
+ * CC PDF Converter and Excel to PDF Converter are is distributed in the hope 
+ * that they will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. * 
+ */
+
+/*
+ * Usage: cmapbench [-r repeats] font.ttf ...
+ *
+ * Memory-maps each font file and builds its glyph-to-Unicode map twice:
+ *   - as the driver did before: for each Unicode range of the font (GetFontUnicodeRanges(), 
+ *     worked out here before the timing starts), look up the glyph of every character 
+ *     (GetGlyphIndices(), emulated by a binary search of the character map) and add it;
+ *   - with TrueTypeCmap::ReadGlyphMap(), in one pass over the character map.
+ * Both maps must be the same for all 65536 glyphs. For each font the number of glyphs and 
+ * characters mapped and the best time of each way (over the repeats) are reported, then totals.
+ * The emulated GDI calls don't cross into the kernel, as the real ones do, so the old way's 
+ * times here are the least it costs.
+ *
+ * Not part of the driver project; build it with g++ from this directory:
+ *   g++ -std=c++11 -O2 -DDDI_REPLAY -DUNICODE -D_UNICODE -DKERNEL_MODE -DCC_PDF_CONVERTER
+ *       -I. -Iinclude -I.. -I../../Common -I../../General -o cmapbench cmapbench.cpp ddihost.cpp
+ *       ../GlyphTranslator.cpp ../GlyphMapFile.cpp ../TrueTypeCmap.cpp ../precomp.cpp
+ *       ../../Common/CCTChar.cpp
+ * and run it on the fonts the installer ships:
+ *   (cd ../../Install/urwfonts && ../../CCPSRendering/replay/cmapbench -r 20 *.ttf)
+ */
+
+#include "precomp.h"
+#include "GlyphTranslator.h"
+#include "TrueTypeCmap.h"
+#include <chrono>
+#include <algorithm>
+
+/**
+	@brief A font's Unicode subtable, as the emulated GDI reads it
+*/
+struct BenchCmap
+{
+	/// The subtable
+	const BYTE*	pSub;
+	/// Size of the subtable (up to the end of the character map table)
+	size_t		nSize;
+	/// The subtable's format (4 or 12)
+	WORD		wFormat;
+};
+
+/// Emulated GetGlyphIndices(): looks up the glyphs of a run of characters (0xFFFF if missing)
+typedef void (*BenchGlyphIndicesFn)(const BenchCmap& cmap, const WCHAR* pChars, UINT nCount, WORD* pGlyphs);
+
+/**
+	@brief Reads a big-endian WORD
+*/
+static inline WORD BenchWord(const BYTE* p)
+{
+	return (WORD)((p[0] << 8) | p[1]);
+}
+
+/**
+	@brief Reads a big-endian DWORD
+*/
+static inline DWORD BenchDWord(const BYTE* p)
+{
+	return ((DWORD)p[0] << 24) | ((DWORD)p[1] << 16) | ((DWORD)p[2] << 8) | (DWORD)p[3];
+}
+
+/**
+	@brief Finds the Unicode subtable TrueTypeCmap would read
+	@param pCmap The character map table
+	@param nSize Size of the table
+	@param[out] cmap Receives the subtable
+	@return true if found
+*/
+static bool BenchFindSubtable(const BYTE* pCmap, size_t nSize, BenchCmap& cmap)
+{
+	if (nSize < 4)
+		return false;
+	UINT nSubtables = BenchWord(pCmap + 2);
+	int nBestRank = 0;
+	for (UINT n = 0; (n < nSubtables) && (4 + (n + 1) * 8 <= nSize); n++)
+	{
+		const BYTE* pRecord = pCmap + 4 + n * 8;
+		WORD wPlatform = BenchWord(pRecord), wEncoding = BenchWord(pRecord + 2);
+		size_t nOffset = BenchDWord(pRecord + 4);
+		if ((nOffset > nSize) || (nSize - nOffset < 4))
+			continue;
+		if ((wPlatform != 0) && !((wPlatform == 3) && ((wEncoding == 1) || (wEncoding == 10))))
+			continue;
+		WORD wFormat = BenchWord(pCmap + nOffset);
+		int nRank = (wFormat == 12) ? 2 : ((wFormat == 4) ? 1 : 0);
+		if (nRank > nBestRank)
+		{
+			cmap.pSub = pCmap + nOffset;
+			cmap.nSize = nSize - nOffset;
+			cmap.wFormat = wFormat;
+			nBestRank = nRank;
+		}
+	}
+	return nBestRank > 0;
+}
+
+/**
+	@brief Looks up one character's glyph, as GDI does: binary search of the segments (or groups)
+	@param cmap The subtable
+	@param c The character
+	@return The glyph, or 0 if the font doesn't have the character
+*/
+static WORD BenchLookup(const BenchCmap& cmap, WCHAR c)
+{
+	const BYTE* pSub = cmap.pSub;
+	if (cmap.wFormat == 4)
+	{
+		UINT nSegments = BenchWord(pSub + 6) / 2;
+		const BYTE* pEnd = pSub + 14;
+		// First segment ending at or after the character
+		UINT nLow = 0, nHigh = nSegments;
+		while (nLow < nHigh)
+		{
+			UINT nMid = (nLow + nHigh) / 2;
+			if (BenchWord(pEnd + nMid * 2) < (WORD)c)
+				nLow = nMid + 1;
+			else
+				nHigh = nMid;
+		}
+		if (nLow == nSegments)
+			return 0;
+		const BYTE* pStart = pEnd + nSegments * 2 + 2;
+		const BYTE* pDelta = pStart + nSegments * 2;
+		const BYTE* pRangeOffset = pDelta + nSegments * 2;
+		WORD wFirst = BenchWord(pStart + nLow * 2);
+		if ((WORD)c < wFirst)
+			return 0;
+		WORD wDelta = BenchWord(pDelta + nLow * 2), wRangeOffset = BenchWord(pRangeOffset + nLow * 2);
+		if (wRangeOffset == 0)
+			return (WORD)((WORD)c + wDelta);
+		size_t nOffset = (pRangeOffset + nLow * 2 - pSub) + wRangeOffset + ((WORD)c - wFirst) * 2;
+		if (nOffset + 2 > cmap.nSize)
+			return 0;
+		WORD wGlyph = BenchWord(pSub + nOffset);
+		return (wGlyph == 0) ? 0 : (WORD)(wGlyph + wDelta);
+	}
+	// Format 12
+	DWORD dwGroups = BenchDWord(pSub + 12), dwLow = 0, dwHigh = dwGroups;
+	while (dwLow < dwHigh)
+	{
+		DWORD dwMid = (dwLow + dwHigh) / 2;
+		if (BenchDWord(pSub + 16 + dwMid * 12 + 4) < (DWORD)c)
+			dwLow = dwMid + 1;
+		else
+			dwHigh = dwMid;
+	}
+	if (dwLow == dwGroups)
+		return 0;
+	const BYTE* pGroup = pSub + 16 + dwLow * 12;
+	DWORD dwFirst = BenchDWord(pGroup);
+	if ((DWORD)c < dwFirst)
+		return 0;
+	DWORD dwGlyph = BenchDWord(pGroup + 8) + ((DWORD)c - dwFirst);
+	return (dwGlyph > 0xFFFF) ? 0 : (WORD)dwGlyph;
+}
+
+/**
+	@brief Emulated GetGlyphIndices(..., GGI_MARK_NONEXISTING_GLYPHS)
+*/
+static void BenchGlyphIndices(const BenchCmap& cmap, const WCHAR* pChars, UINT nCount, WORD* pGlyphs)
+{
+	for (UINT n = 0; n < nCount; n++)
+	{
+		WORD wGlyph = BenchLookup(cmap, pChars[n]);
+		pGlyphs[n] = (wGlyph == 0) ? 0xFFFF : wGlyph;
+	}
+}
+
+/**
+	@brief Builds a map as GlyphToText::Initialize() does when it falls back to GDI
+	@param cmap The subtable
+	@param arRanges The font's Unicode ranges
+	@param pfnGlyphIndices The (emulated) GetGlyphIndices()
+	@param[out] map The map to add the glyphs to
+*/
+static void BenchBuildFromRanges(const BenchCmap& cmap, const std::vector<WCRANGE>& arRanges, BenchGlyphIndicesFn pfnGlyphIndices, GlyphToText& map)
+{
+	std::vector<WCHAR> arChars;
+	std::vector<WORD> arGlyphs;
+	for (size_t i = 0; i < arRanges.size(); i++)
+	{
+		UINT nCount = arRanges[i].cGlyphs;
+		arChars.resize(nCount);
+		arGlyphs.resize(nCount);
+		for (UINT u = 0; u < nCount; u++)
+			arChars[u] = arRanges[i].wcLow + u;
+		pfnGlyphIndices(cmap, &arChars[0], nCount, &arGlyphs[0]);
+		for (UINT u = 0; u < nCount; u++)
+			if (arGlyphs[u] != 0xFFFF)
+				map.Add(arGlyphs[u], arChars[u]);
+	}
+}
+
+/**
+	@brief Returns the time since the first call
+	@return Time in microseconds
+*/
+static double BenchTime()
+{
+	static std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - tStart).count();
+}
+
+int main(int argc, char* argv[])
+{
+	int nRepeats = 10, nArg = 1;
+	if ((argc > 2) && (strcmp(argv[1], "-r") == 0))
+	{
+		nRepeats = max(1, atoi(argv[2]));
+		nArg = 3;
+	}
+	if (nArg >= argc)
+	{
+		printf("Usage: cmapbench [-r repeats] font.ttf ...\n");
+		return 1;
+	}
+
+	printf("%-26s %6s %6s %10s %10s %8s\n", "font", "glyphs", "chars", "GDI us", "cmap us", "speedup");
+	int nFonts = 0, nFailed = 0;
+	double dTotalOld = 0, dTotalNew = 0;
+	for (; nArg < argc; nArg++)
+	{
+		const char* pName = strrchr(argv[nArg], '/');
+		pName = (pName == NULL) ? argv[nArg] : pName + 1;
+
+		// Map the font file
+		std::wstring sPath = MakeTStringFromUTF8(argv[nArg]);
+		HANDLE hFile = ::CreateFile(sPath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0, NULL);
+		if (hFile == INVALID_HANDLE_VALUE)
+		{
+			printf("%-26s cannot open\n", pName);
+			nFailed++;
+			continue;
+		}
+		size_t nSize = ::GetFileSize(hFile, NULL);
+		HANDLE hMapping = ::CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+		const BYTE* pFont = (const BYTE*)::MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+		const BYTE* pCmap = NULL;
+		size_t nCmapSize = 0;
+		BenchCmap cmap;
+		if ((pFont == NULL) || !TrueTypeCmap::FindTable(pFont, nSize, TRUETYPE_TAG_CMAP, pCmap, nCmapSize))
+		{
+			printf("%-26s no character map\n", pName);
+			nFailed++;
+		}
+		else if (!BenchFindSubtable(pCmap, nCmapSize, cmap))
+			// Symbol fonts: the driver leaves them to GDI
+			printf("%-26s no Unicode character map (symbol font)\n", pName);
+		else
+		{
+			// The font's Unicode ranges, as GetFontUnicodeRanges() gives them (not timed)
+			std::vector<WCRANGE> arRanges;
+			UINT nChars = 0;
+			for (UINT c = 0; c < 0xFFFF; c++)
+			{
+				if (BenchLookup(cmap, (WCHAR)c) == 0)
+					continue;
+				nChars++;
+				if (!arRanges.empty() && ((UINT)arRanges.back().wcLow + arRanges.back().cGlyphs == c))
+					arRanges.back().cGlyphs++;
+				else
+				{
+					WCRANGE range = {(WCHAR)c, 1};
+					arRanges.push_back(range);
+				}
+			}
+
+			// The best time of each way
+			double dOld = 0, dNew = 0;
+			GlyphToText mapOld, mapNew;
+			for (int n = 0; n < nRepeats; n++)
+			{
+				mapOld.clear();
+				double dStart = BenchTime();
+				BenchBuildFromRanges(cmap, arRanges, BenchGlyphIndices, mapOld);
+				double dTime = BenchTime() - dStart;
+				dOld = (n == 0) ? dTime : min(dOld, dTime);
+
+				mapNew.clear();
+				dStart = BenchTime();
+				TrueTypeCmap::ReadGlyphMap(pCmap, nCmapSize, mapNew);
+				dTime = BenchTime() - dStart;
+				dNew = (n == 0) ? dTime : min(dNew, dTime);
+			}
+
+			// Both must give the same letters
+			UINT nDiffer = 0;
+			for (UINT g = 0; g < 0x10000; g++)
+				if (mapOld.Translate((WORD)g) != mapNew.Translate((WORD)g))
+					nDiffer++;
+			printf("%-26s %6u %6u %10.1f %10.1f %7.1fx", pName, (UINT)mapNew.size(), nChars, dOld, dNew, (dNew > 0) ? dOld / dNew : 0.0);
+			if (nDiffer > 0)
+			{
+				printf("  %u glyphs differ", nDiffer);
+				nFailed++;
+			}
+			printf("\n");
+			nFonts++;
+			dTotalOld += dOld;
+			dTotalNew += dNew;
+		}
+		if (pFont != NULL)
+			::UnmapViewOfFile(pFont);
+		::CloseHandle(hMapping);
+		::CloseHandle(hFile);
+	}
+	printf("%-26s %6d fonts     %10.1f %10.1f %7.1fx\n", "total", nFonts, dTotalOld, dTotalNew, (dTotalNew > 0) ? dTotalOld / dTotalNew : 0.0);
+	return (nFailed > 0) ? 1 : 0;
+}
@@ -0,0 +1,710 @@
+/**
+	@file
+	@brief Stand-ins for the Win32, GDI, engine and registry functions the rendering plugin calls, for the Linux-hosted DDI replay build
+*/
+
+/*
+ * CC PDF Converter: Windows PDF Printer with Creative Commons license support
+ * Excel to PDF Converter: Excel PDF printing addin, keeping hyperlinks AND Creative Commons license support
+ * Copyright (C) 2007-2010 Guy Hachlili <hguy@cogniview.com>, Cogniview LTD.
+ * 
+ * This file is part of CC PDF Converter / Excel to PDF Converter
+ * 
+ * CC PDF Converter and Excel to PDF Converter are free software;
+ * you can redistribute them and/or modify them under the terms of the 
+ * GNU General Public License as published by the Free Software Foundation;
+ * either version 2 of the License, or (at your option) any later version.
+ * 
+ * CC PDF Converter and Excel to PDF Converter are is distributed in the hope 
+ * that they will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. * 
+ */
+
+#include "precomp.h"
+#include "CCPrintRegistry.h"
+#include "devmode.h"
+#include <map>
+#include <vector>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <errno.h>
+
+/// Instance of module (defined at dllentry.cpp in the driver)
+HINSTANCE ghInstance = NULL;
+
+////////////////////////////////////////////////////////
+//      Engine functions
+////////////////////////////////////////////////////////
+
+/**
+	@param pstro The text run
+	@param pc Receives the number of glyphs
+	@param ppgpos Receives the glyph positions
+	@return TRUE (all the glyphs are returned at once)
+*/
+BOOL STROBJ_bEnumPositionsOnly(STROBJ* pstro, ULONG* pc, PGLYPHPOS* ppgpos)
+{
+	*pc = pstro->cGlyphs;
+	*ppgpos = ((HostStrObj*)pstro)->pPos;
+	return TRUE;
+}
+
+/**
+	@param pso The text run
+	@param iFirst Index of the first glyph
+	@param c Number of glyphs
+	@param pptqD Receives the advance widths
+	@return TRUE if the glyphs are in the run, FALSE if not
+*/
+BOOL STROBJ_bGetAdvanceWidths(STROBJ* pso, ULONG iFirst, ULONG c, POINTQF* pptqD)
+{
+	if (iFirst + c > pso->cGlyphs)
+		return FALSE;
+	memcpy(pptqD, ((HostStrObj*)pso)->pWidths + iFirst, c * sizeof(POINTQF));
+	return TRUE;
+}
+
+/**
+	@param pfo The font
+	@return The font's metrics
+*/
+PIFIMETRICS FONTOBJ_pifi(FONTOBJ* pfo)
+{
+	return &((HostFontObj*)pfo)->metrics.ifi;
+}
+
+/**
+	@param pfo The font
+	@return The font's transform object
+*/
+XFORMOBJ* FONTOBJ_pxoGetXform(FONTOBJ* pfo)
+{
+	return &((HostFontObj*)pfo)->xo;
+}
+
+/**
+	@param pxo Transform object (returned by FONTOBJ_pxoGetXform)
+	@param pxform Receives the transform
+	@return 0 (GX_IDENTITY is not told apart)
+*/
+ULONG XFORMOBJ_iGetXform(XFORMOBJ* pxo, XFORML* pxform)
+{
+	*pxform = *pxo->pHostXform;
+	return 0;
+}
+
+// Bitmaps are only drawn for the license stamp and page, which the replay doesn't have
+HBITMAP EngCreateBitmap(SIZEL, LONG, ULONG, FLONG, PVOID) {return NULL;}
+SURFOBJ* EngLockSurface(HSURF) {return NULL;}
+void EngUnlockSurface(SURFOBJ*) {}
+BOOL EngDeleteSurface(HSURF) {return FALSE;}
+BOOL EngStretchBlt(SURFOBJ*, SURFOBJ*, SURFOBJ*, CLIPOBJ*, XLATEOBJ*, COLORADJUSTMENT*, POINTL*, RECTL*, RECTL*, POINTL*, ULONG) {return FALSE;}
+int GetObject(HANDLE, int, LPVOID) {return 0;}
+HANDLE LoadImage(HINSTANCE, LPCTSTR, UINT, int, int, UINT) {return NULL;}
+BOOL DeleteObject(HGDIOBJ) {return TRUE;}
+
+////////////////////////////////////////////////////////
+//      GDI fonts
+////////////////////////////////////////////////////////
+
+/*
+ * All the host fonts share one synthetic cmap, laid out like a common TrueType font's: printable
+ * ASCII starts at glyph 3, followed by Latin-1 and Latin Extended-A. The trace encoder uses
+ * HostGlyphIndex() to turn letters into glyph runs, so the translation maps built from the
+ * 'cmap' table (or GetFontUnicodeRanges()/GetGlyphIndices()) turn them back into the same letters.
+ */
+
+/// Unicode ranges of the host fonts
+static const WCRANGE s_arHostRanges[] = {{0x0020, 0x5F}, {0x00A0, 0xE0}};
+
+/**
+	@param c The letter
+	@return The letter's glyph index, or 0xFFFF if the font doesn't have it
+*/
+WORD HostGlyphIndex(WCHAR c)
+{
+	if ((c >= 0x20) && (c <= 0x7E))
+		return (WORD)(c - 0x20 + 3);
+	if ((c >= 0xA0) && (c <= 0x17F))
+		return (WORD)(c - 0xA0 + 3 + 0x5F);
+	return 0xFFFF;
+}
+
+/// The screen DC (there is only one)
+static int s_nHostDC;
+/// The host font (all the fonts have the same glyphs, so there is only one)
+static int s_nHostFont;
+/// The font selected into the DC
+static HGDIOBJ s_hHostFont = NULL;
+
+HFONT CreateFontIndirect(const LOGFONT*)
+{
+	return (HFONT)&s_nHostFont;
+}
+
+HGDIOBJ SelectObject(HDC, HGDIOBJ hObj)
+{
+	HGDIOBJ hOld = s_hHostFont;
+	s_hHostFont = hObj;
+	return hOld;
+}
+
+DWORD GetFontUnicodeRanges(HDC, LPGLYPHSET pSet)
+{
+	DWORD nRanges = _S(s_arHostRanges);
+	DWORD dwSize = (DWORD)(sizeof(GLYPHSET) + (nRanges - 1) * sizeof(WCRANGE));
+	if (pSet == NULL)
+		return dwSize;
+	pSet->cbThis = dwSize;
+	pSet->flAccel = 0;
+	pSet->cGlyphsSupported = 0;
+	pSet->cRanges = nRanges;
+	for (DWORD i = 0; i < nRanges; i++)
+	{
+		pSet->ranges[i] = s_arHostRanges[i];
+		pSet->cGlyphsSupported += s_arHostRanges[i].cGlyphs;
+	}
+	return dwSize;
+}
+
+DWORD GetGlyphIndices(HDC, LPCWSTR lpstr, int c, LPWORD pgi, DWORD)
+{
+	for (int i = 0; i < c; i++)
+		pgi[i] = HostGlyphIndex(lpstr[i]);
+	return (DWORD)c;
+}
+
+/// The host font's TrueType header, with a fixed version
+static const BYTE s_cHostHead[54] = {0, 1, 0, 0,  0, 1, 0, 0,  0x12, 0x34, 0x56, 0x78,  0x5F, 0x0F, 0x3C, 0xF5,  0, 0,  0x08, 0,
+	0, 0, 0, 0, 0xD0, 0, 0, 0,  0, 0, 0, 0, 0xD0, 0, 0, 0};
+/// The host font's character map: one Windows Unicode (3,1) format 4 subtable with the host ranges
+static const BYTE s_cHostCmap[52] = {0, 0,  0, 1,  0, 3, 0, 1,  0, 0, 0, 12,
+	// Format, length, language, segCountX2, searchRange, entrySelector, rangeShift
+	0, 4,  0, 40,  0, 0,  0, 6,  0, 4,  0, 1,  0, 2,
+	// endCode[], pad, startCode[], idDelta[] (3 - 0x20 and 3 + 0x5F - 0xA0), idRangeOffset[]
+	0x00, 0x7E,  0x01, 0x7F,  0xFF, 0xFF,  0, 0,
+	0x00, 0x20,  0x00, 0xA0,  0xFF, 0xFF,
+	0xFF, 0xE3,  0xFF, 0xC2,  0x00, 0x01,
+	0, 0,  0, 0,  0, 0};
+
+/**
+	@return The host font's tables (only 'head' and 'cmap' are there)
+*/
+DWORD GetFontData(HDC, DWORD dwTable, DWORD dwOffset, PVOID pvBuffer, DWORD cjBuffer)
+{
+	const BYTE* pTable;
+	DWORD dwTableSize;
+	switch (dwTable)
+	{
+		case 0x64616568:
+			pTable = s_cHostHead;
+			dwTableSize = sizeof(s_cHostHead);
+			break;
+		case 0x70616D63:
+			pTable = s_cHostCmap;
+			dwTableSize = sizeof(s_cHostCmap);
+			break;
+		default:
+			return GDI_ERROR;
+	}
+	if (dwOffset > dwTableSize)
+		return GDI_ERROR;
+	DWORD dwSize = min(dwTableSize - dwOffset, cjBuffer);
+	if (pvBuffer != NULL)
+		memcpy(pvBuffer, pTable + dwOffset, dwSize);
+	return (pvBuffer == NULL) ? dwTableSize - dwOffset : dwSize;
+}
+
+HDC GetDC(HANDLE)
+{
+	return (HDC)&s_nHostDC;
+}
+
+BOOL DeleteDC(HDC)
+{
+	return TRUE;
+}
+
+////////////////////////////////////////////////////////
+//      Code pages
+////////////////////////////////////////////////////////
+
+/*
+ * The ANSI code page is taken to be Latin-1 (what 1252 is, for the letters a URL can have); UTF-8
+ * is converted as it is on Windows, surrogate pairs included, with host wchar_t letters in place
+ * of UTF-16 ones.
+ */
+
+int WideCharToMultiByte(UINT nCodePage, DWORD, LPCWSTR pWide, int nWide, LPSTR pMulti, int nMulti, LPCSTR, BOOL*)
+{
+	if (nWide < 0)
+		nWide = (int)wcslen(pWide) + 1;
+	std::string s;
+	for (int i = 0; i < nWide; i++)
+	{
+		unsigned int c = (unsigned int)pWide[i];
+		if (nCodePage != CP_UTF8)
+		{
+			s += (c < 0x100) ? (char)c : '?';
+			continue;
+		}
+		if ((c >= 0xD800) && (c < 0xDC00) && (i + 1 < nWide) && ((unsigned int)pWide[i + 1] >= 0xDC00) && ((unsigned int)pWide[i + 1] < 0xE000))
+			c = 0x10000 + ((c - 0xD800) << 10) + ((unsigned int)pWide[++i] - 0xDC00);
+		if (c < 0x80)
+			s += (char)c;
+		else if (c < 0x800)
+		{
+			s += (char)(0xC0 | (c >> 6));
+			s += (char)(0x80 | (c & 0x3F));
+		}
+		else if (c < 0x10000)
+		{
+			s += (char)(0xE0 | (c >> 12));
+			s += (char)(0x80 | ((c >> 6) & 0x3F));
+			s += (char)(0x80 | (c & 0x3F));
+		}
+		else
+		{
+			s += (char)(0xF0 | (c >> 18));
+			s += (char)(0x80 | ((c >> 12) & 0x3F));
+			s += (char)(0x80 | ((c >> 6) & 0x3F));
+			s += (char)(0x80 | (c & 0x3F));
+		}
+	}
+	if (nMulti == 0)
+		return (int)s.size();
+	if ((int)s.size() > nMulti)
+		return 0;
+	memcpy(pMulti, s.data(), s.size());
+	return (int)s.size();
+}
+
+int MultiByteToWideChar(UINT nCodePage, DWORD, LPCSTR pMulti, int nMulti, LPWSTR pWide, int nWide)
+{
+	if (nMulti < 0)
+		nMulti = (int)strlen(pMulti) + 1;
+	std::wstring s;
+	const unsigned char* p = (const unsigned char*)pMulti;
+	for (int i = 0; i < nMulti; )
+	{
+		unsigned int c = p[i++];
+		if ((nCodePage == CP_UTF8) && (c >= 0xC0))
+		{
+			int nMore = (c >= 0xF0) ? 3 : ((c >= 0xE0) ? 2 : 1);
+			c &= (0x3F >> nMore);
+			while ((nMore-- > 0) && (i < nMulti) && ((p[i] & 0xC0) == 0x80))
+				c = (c << 6) | (p[i++] & 0x3F);
+		}
+		s += (WCHAR)c;
+	}
+	if (nWide == 0)
+		return (int)s.size();
+	if ((int)s.size() > nWide)
+		return 0;
+	wmemcpy(pWide, s.data(), s.size());
+	return (int)s.size();
+}
+
+////////////////////////////////////////////////////////
+//      Runtime library
+////////////////////////////////////////////////////////
+
+/**
+	@param pBuffer Buffer to write to
+	@param nSize Size of the buffer, in letters
+	@param pFormat Windows-style format: %s and %c are wide, %S and %C are narrow
+	@param args Values to format
+	@return Number of letters written, or -1 if they don't fit
+*/
+int ddihost_vswprintf(WCHAR* pBuffer, size_t nSize, const WCHAR* pFormat, va_list args)
+{
+	// glibc's wide printf has the narrow meaning for %s and %c, so make the format say what Windows means
+	std::wstring sFormat;
+	for (const WCHAR* p = pFormat; *p != 0; p++)
+	{
+		sFormat += *p;
+		if (*p != '%')
+			continue;
+		// Copy flags, width, precision and size
+		while ((p[1] != 0) && (wcschr(L"-+ #0123456789.*hlLzjtI", p[1]) != NULL))
+			sFormat += *++p;
+		switch (p[1])
+		{
+			case 's':
+			case 'c':
+				if (sFormat[sFormat.size() - 1] != 'l')
+					sFormat += 'l';
+				break;
+			case 'S':
+				sFormat += 's';
+				p++;
+				continue;
+			case 'C':
+				sFormat += 'c';
+				p++;
+				continue;
+		}
+		if (p[1] != 0)
+			sFormat += *++p;
+	}
+	return vswprintf(pBuffer, nSize, sFormat.c_str(), args);
+}
+
+/**
+	@param pName Wide file name
+	@return The file name in the host's (UTF-8) encoding, with the Windows path separators replaced
+*/
+static std::string HostPath(LPCTSTR pName)
+{
+	int n = WideCharToMultiByte(CP_UTF8, 0, pName, -1, NULL, 0, NULL, NULL);
+	std::string s(n, '\0');
+	WideCharToMultiByte(CP_UTF8, 0, pName, -1, &s[0], n, NULL, NULL);
+	s.resize(n - 1);
+	for (std::string::iterator i = s.begin(); i != s.end(); i++)
+		if (*i == '\\')
+			*i = '/';
+	return s;
+}
+
+int ddihost_unlink(LPCTSTR pName)
+{
+	return unlink(HostPath(pName).c_str());
+}
+
+int ddihost_fopen(FILE** ppFile, LPCTSTR pName, LPCTSTR pMode)
+{
+	// Text and binary modes are the same here
+	std::string sMode;
+	for (; (*pMode != 0) && (*pMode != ','); pMode++)
+		if (*pMode != 't')
+			sMode += (char)*pMode;
+	*ppFile = fopen(HostPath(pName).c_str(), sMode.c_str());
+	return (*ppFile == NULL) ? 1 : 0;
+}
+
+DWORD GetCurrentProcessId()
+{
+	return (DWORD)getpid();
+}
+
+DWORD GetTempPath(DWORD nSize, LPTSTR pPath)
+{
+	const char* pTemp = getenv("TMPDIR");
+	std::tstring s = MakeTStringFromUTF8((pTemp == NULL) ? "/tmp" : pTemp);
+	if (s.empty() || (s[s.size() - 1] != '/'))
+		s += '/';
+	if (s.size() + 1 > nSize)
+		return (DWORD)(s.size() + 1);
+	wcscpy(pPath, s.c_str());
+	return (DWORD)s.size();
+}
+
+UINT GetTempFileName(LPCTSTR pPath, LPCTSTR pPrefix, UINT, LPTSTR pName)
+{
+	// <path><up to 3 letters of prefix><hex number>.tmp, created empty (as Windows does)
+	std::string sTemplate = HostPath(pPath) + HostPath(std::wstring(pPrefix).substr(0, 3).c_str()) + "XXXXXX";
+	std::vector<char> arName(sTemplate.begin(), sTemplate.end());
+	arName.push_back('\0');
+	int fd = mkstemp(&arName[0]);
+	if (fd < 0)
+		return 0;
+	close(fd);
+	std::wstring s = MakeTStringFromUTF8(&arName[0]);
+	wcsncpy_s(pName, MAX_PATH, s.c_str(), s.size());
+	return 1;
+}
+
+void OutputDebugString(LPCTSTR pString)
+{
+	fputws(pString, stderr);
+}
+
+////////////////////////////////////////////////////////
+//      File mappings
+////////////////////////////////////////////////////////
+
+/**
+    @brief A file or file mapping handle
+*/
+struct HostFileHandle
+{
+	/// The file descriptor (the mapping's file's for a mapping)
+	int		fd;
+	/// true for a file mapping handle
+	bool	bMapping;
+	/// Size of the file
+	size_t	nSize;
+};
+
+/// Size of each mapped view (munmap needs it)
+static std::map<const void*, size_t> s_mapViews;
+
+HANDLE CreateFile(LPCTSTR pName, DWORD, DWORD, PVOID, DWORD, DWORD, HANDLE)
+{
+	// Only opening an existing file for reading is needed
+	int fd = open(HostPath(pName).c_str(), O_RDONLY);
+	if (fd < 0)
+		return INVALID_HANDLE_VALUE;
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		close(fd);
+		return INVALID_HANDLE_VALUE;
+	}
+	HostFileHandle* pHandle = new HostFileHandle;
+	pHandle->fd = fd;
+	pHandle->bMapping = false;
+	pHandle->nSize = (size_t)st.st_size;
+	return pHandle;
+}
+
+DWORD GetFileSize(HANDLE hFile, DWORD* pdwHigh)
+{
+	size_t nSize = ((HostFileHandle*)hFile)->nSize;
+	if (pdwHigh != NULL)
+		*pdwHigh = (DWORD)((unsigned long long)nSize >> 32);
+	return (DWORD)nSize;
+}
+
+HANDLE CreateFileMapping(HANDLE hFile, PVOID, DWORD, DWORD, DWORD, LPCTSTR)
+{
+	HostFileHandle* pHandle = new HostFileHandle(*(HostFileHandle*)hFile);
+	pHandle->bMapping = true;
+	return pHandle;
+}
+
+PVOID MapViewOfFile(HANDLE hMapping, DWORD, DWORD dwOffsetHigh, DWORD dwOffsetLow, size_t nSize)
+{
+	HostFileHandle* pHandle = (HostFileHandle*)hMapping;
+	if (nSize == 0)
+		nSize = pHandle->nSize;
+	void* pView = mmap(NULL, nSize, PROT_READ, MAP_SHARED, pHandle->fd, ((off_t)dwOffsetHigh << 32) | dwOffsetLow);
+	if (pView == MAP_FAILED)
+		return NULL;
+	s_mapViews[pView] = nSize;
+	return pView;
+}
+
+BOOL UnmapViewOfFile(const void* pView)
+{
+	std::map<const void*, size_t>::iterator i = s_mapViews.find(pView);
+	if (i == s_mapViews.end())
+		return FALSE;
+	munmap((void*)pView, (*i).second);
+	s_mapViews.erase(i);
+	return TRUE;
+}
+
+BOOL CloseHandle(HANDLE h)
+{
+	HostFileHandle* pHandle = (HostFileHandle*)h;
+	// The mapping shares its file's descriptor, and a token has none
+	if (!pHandle->bMapping && (pHandle->fd >= 0))
+		close(pHandle->fd);
+	delete pHandle;
+	return TRUE;
+}
+
+BOOL MoveFileEx(LPCTSTR pFrom, LPCTSTR pTo, DWORD)
+{
+	return (rename(HostPath(pFrom).c_str(), HostPath(pTo).c_str()) == 0) ? TRUE : FALSE;
+}
+
+/// Error of the last failed folder function
+static DWORD s_dwLastError = 0;
+
+DWORD GetLastError()
+{
+	return s_dwLastError;
+}
+
+////////////////////////////////////////////////////////
+//      Users and folders
+////////////////////////////////////////////////////////
+
+/// The host user's ID, standing for the user's SID
+static uid_t s_uidUser;
+
+HANDLE GetCurrentThread()
+{
+	return (HANDLE)(ptrdiff_t)-2;
+}
+
+HANDLE GetCurrentProcess()
+{
+	return (HANDLE)(ptrdiff_t)-1;
+}
+
+BOOL OpenThreadToken(HANDLE, DWORD, BOOL, HANDLE*)
+{
+	// Never impersonating
+	return FALSE;
+}
+
+BOOL OpenProcessToken(HANDLE, DWORD, HANDLE* phToken)
+{
+	// A handle without a file, so CloseHandle() takes it
+	HostFileHandle* pHandle = new HostFileHandle;
+	pHandle->fd = -1;
+	pHandle->bMapping = false;
+	pHandle->nSize = 0;
+	*phToken = pHandle;
+	return TRUE;
+}
+
+BOOL GetTokenInformation(HANDLE, TOKEN_INFORMATION_CLASS, PVOID pInfo, DWORD dwSize, DWORD* pdwSize)
+{
+	*pdwSize = sizeof(TOKEN_USER);
+	if ((pInfo == NULL) || (dwSize < sizeof(TOKEN_USER)))
+		return FALSE;
+	s_uidUser = getuid();
+	((TOKEN_USER*)pInfo)->User.Sid = &s_uidUser;
+	((TOKEN_USER*)pInfo)->User.Attributes = 0;
+	return TRUE;
+}
+
+BOOL ConvertSidToStringSid(PSID pSID, LPTSTR* ppString)
+{
+	std::wstring s = L"S-1-22-1-" + MakeTStringFromUTF8(std::to_string(*(uid_t*)pSID).c_str());
+	*ppString = wcsdup(s.c_str());
+	return (*ppString != NULL) ? TRUE : FALSE;
+}
+
+BOOL ConvertStringSecurityDescriptorToSecurityDescriptor(LPCTSTR pString, DWORD, PSECURITY_DESCRIPTOR* ppDescriptor, ULONG*)
+{
+	// Kept as it is: CreateDirectory() only needs to know there is one
+	*ppDescriptor = wcsdup(pString);
+	return (*ppDescriptor != NULL) ? TRUE : FALSE;
+}
+
+HANDLE LocalFree(HANDLE hMem)
+{
+	free(hMem);
+	return NULL;
+}
+
+HRESULT SHGetFolderPath(HANDLE, int, HANDLE, DWORD, LPTSTR pPath)
+{
+	// The temporary files folder, so a replay leaves nothing in the user's home
+	DWORD dwLength = GetTempPath(MAX_PATH, pPath);
+	if ((dwLength == 0) || (dwLength > MAX_PATH))
+		return E_FAIL;
+	if ((dwLength > 1) && (pPath[dwLength - 1] == '/'))
+		pPath[dwLength - 1] = '\0';
+	return S_OK;
+}
+
+BOOL CreateDirectory(LPCTSTR pName, SECURITY_ATTRIBUTES* pSecurity)
+{
+	// An access list means the user's access only
+	mode_t mode = ((pSecurity != NULL) && (pSecurity->lpSecurityDescriptor != NULL)) ? 0700 : 0777;
+	if (mkdir(HostPath(pName).c_str(), mode) == 0)
+		return TRUE;
+	s_dwLastError = (errno == EEXIST) ? ERROR_ALREADY_EXISTS : (DWORD)errno;
+	return FALSE;
+}
+
+////////////////////////////////////////////////////////
+//      Printer registry settings
+////////////////////////////////////////////////////////
+
+/*
+ * The printer's registry settings are kept in memory for the process, one set for all printer
+ * handles; the replay trace fills them with its "set" lines, and the plugin's link data handling
+ * writes and erases its job keys the same way it does on Windows.
+ */
+
+/**
+    @brief A registry value: a DWORD or a string
+*/
+struct HostRegistryValue
+{
+	/// true for a string value
+	bool			bString;
+	/// DWORD value
+	DWORD			dwValue;
+	/// String value
+	std::tstring	sValue;
+};
+
+/**
+	@brief Returns the printer registry settings
+	@return The settings, by value name
+*/
+static std::map<std::tstring, HostRegistryValue>& HostRegistry()
+{
+	static std::map<std::tstring, HostRegistryValue> mapValues;
+	return mapValues;
+}
+
+namespace CCPrintRegistry
+{
+
+DWORD GetRegistryDWORD(HANDLE, LPCTSTR lpSetting, DWORD dwDefault)
+{
+	std::map<std::tstring, HostRegistryValue>::const_iterator i = HostRegistry().find(lpSetting);
+	return ((i == HostRegistry().end()) || (*i).second.bString) ? dwDefault : (*i).second.dwValue;
+}
+
+std::tstring GetRegistryString(HANDLE, LPCTSTR lpSetting, LPCTSTR lpDefault)
+{
+	std::map<std::tstring, HostRegistryValue>::const_iterator i = HostRegistry().find(lpSetting);
+	return ((i == HostRegistry().end()) || !(*i).second.bString) ? std::tstring(lpDefault) : (*i).second.sValue;
+}
+
+bool SetRegistryDWORD(HANDLE, LPCTSTR lpSetting, DWORD dwValue)
+{
+	HostRegistryValue& value = HostRegistry()[lpSetting];
+	value.bString = false;
+	value.dwValue = dwValue;
+	return true;
+}
+
+bool SetRegistryString(HANDLE, LPCTSTR lpSetting, const std::tstring& sValue)
+{
+	HostRegistryValue& value = HostRegistry()[lpSetting];
+	value.bString = true;
+	value.sValue = sValue;
+	return true;
+}
+
+bool EraseRegistryValue(HANDLE, LPCTSTR lpSetting)
+{
+	return HostRegistry().erase(lpSetting) > 0;
+}
+
+bool EnumRegistryValues(HANDLE, STRLIST& lValues, LPCTSTR lpPrefix /* = NULL */)
+{
+	lValues.clear();
+	std::tstring::size_type nPrefix = (lpPrefix == NULL) ? 0 : _tcslen(lpPrefix);
+	std::map<std::tstring, HostRegistryValue>::const_iterator i;
+	for (i = HostRegistry().begin(); i != HostRegistry().end(); i++)
+		if ((nPrefix == 0) || ((*i).first.compare(0, nPrefix, lpPrefix) == 0))
+			lValues.push_back((*i).first);
+	return true;
+}
+
+};
+
+////////////////////////////////////////////////////////
+//      License stamp
+////////////////////////////////////////////////////////
+
+/**
+	@param bFirstPage true for the first page
+	@param szPageSize Size of the page
+	@param szLicenseSize Size of the stamp
+	@return The stamp's top-left corner (the replay never draws it: there are no stamp images)
+*/
+POINT LicenseLocationInfo::LocationForPage(bool, SIZE, SIZE) const
+{
+	POINT pt;
+	pt.x = pt.y = 0;
+	return pt;
+}
@@ -0,0 +1,508 @@
+/**
+	@file
+	@brief Stand-ins for the Win32 and DDK declarations the rendering plugin uses, for the Linux-hosted DDI replay build
+*/
+
+/*
+ * CC PDF Converter: Windows PDF Printer with Creative Commons license support
+ * Excel to PDF Converter: Excel PDF printing addin, keeping hyperlinks AND Creative Commons license support
+ * Copyright (C) 2007-2010 Guy Hachlili <hguy@cogniview.com>, Cogniview LTD.
+ *
+ * This file is part of CC PDF Converter / Excel to PDF Converter
+ *
+ * CC PDF Converter and Excel to PDF Converter are free software;
+ * you can redistribute them and/or modify them under the terms of the
+ * GNU General Public License as published by the Free Software Foundation;
+ * either version 2 of the License, or (at your option) any later version.
+ *
+ * CC PDF Converter and Excel to PDF Converter are is distributed in the hope
+ * that they will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ */
+
+#ifndef _DDIHOST_H_
+#define _DDIHOST_H_
+
+/*
+ * Only what the plugin sources compiled into ddireplay actually use is declared here, with the
+ * same names and (where it matters) the same layout as in the DDK. The engine, GDI, registry and
+ * spooler functions are implemented in ddihost.cpp on top of the replayed trace.
+ *
+ * WCHAR is the host's wchar_t (4 bytes on Linux), so std::wstring and L"" literals work as they
+ * do on Windows; LONG is the host's long, so the plugin's "%d" formats of RECTL members still
+ * print the right values.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+#include <assert.h>
+#include <type_traits>
+
+////////////////////////////////////////////////////////
+//      Basic types
+////////////////////////////////////////////////////////
+
+typedef int					BOOL;
+typedef unsigned char		BYTE;
+typedef unsigned short		WORD;
+typedef unsigned short		USHORT;
+typedef unsigned int		DWORD;
+typedef unsigned int		UINT;
+typedef unsigned int		ULONG;
+typedef int					LONG;
+typedef int					INT;
+typedef ULONG				FLONG;
+typedef char				CHAR;
+typedef wchar_t				WCHAR;
+typedef WCHAR				TCHAR;
+typedef float				FLOATL;
+typedef int					HRESULT;
+typedef size_t				ULONG_PTR;
+typedef ULONG				MIX;
+typedef ULONG				ROP4;
+typedef ULONG				HGLYPH;
+
+typedef void*				PVOID;
+typedef void*				LPVOID;
+typedef char*				LPSTR;
+typedef const char*			LPCSTR;
+typedef const char*			PCSTR;
+typedef WCHAR*				LPWSTR;
+typedef WCHAR*				PWSTR;
+typedef const WCHAR*		LPCWSTR;
+typedef TCHAR*				LPTSTR;
+typedef const TCHAR*		LPCTSTR;
+typedef DWORD*				PDWORD;
+typedef WORD*				LPWORD;
+
+typedef void*				HANDLE;
+typedef HANDLE				HINSTANCE;
+typedef HANDLE				HBITMAP;
+typedef HANDLE				HSURF;
+typedef HANDLE				HDEV;
+typedef HANDLE				HDC;
+typedef HANDLE				HFONT;
+typedef HANDLE				HGDIOBJ;
+typedef HANDLE				DHSURF;
+typedef HANDLE				DHPDEV;
+typedef HANDLE				HMODULE;
+typedef void*				PDEVOEM;
+typedef long				(*PFN)();
+
+#define TRUE				1
+#define FALSE				0
+#define S_OK				((HRESULT)0)
+#define E_FAIL				((HRESULT)0x80004005L)
+#define E_NOTIMPL			((HRESULT)0x80004001L)
+#define MAX_PATH			260
+#define APIENTRY
+#define VOID				void
+#define WINAPI
+#define FAR
+#define IN
+#define OUT
+
+#define __TEXT(s)			L##s
+#define TEXT(s)				__TEXT(s)
+#define _T(s)				__TEXT(s)
+#define _ASSERT(c)
+#define NOP_FUNCTION(...)	((void)0)
+
+////////////////////////////////////////////////////////
+//      Structures
+////////////////////////////////////////////////////////
+
+typedef struct _RECTL {LONG left; LONG top; LONG right; LONG bottom;} RECTL, *PRECTL;
+typedef struct _POINTL {LONG x; LONG y;} POINTL, *PPOINTL;
+typedef POINTL				POINT;
+typedef struct _SIZE {LONG cx; LONG cy;} SIZE, SIZEL, *PSIZEL;
+typedef union _LARGE_INTEGER
+{
+	struct {DWORD LowPart; LONG HighPart;};
+	long long QuadPart;
+} LARGE_INTEGER;
+typedef struct _POINTQF {LARGE_INTEGER x; LARGE_INTEGER y;} POINTQF, *PPOINTQF;
+
+/// Font description (LOGFONTW)
+#define LF_FACESIZE			32
+typedef struct tagLOGFONT
+{
+	LONG	lfHeight;
+	LONG	lfWidth;
+	LONG	lfEscapement;
+	LONG	lfOrientation;
+	LONG	lfWeight;
+	BYTE	lfItalic;
+	BYTE	lfUnderline;
+	BYTE	lfStrikeOut;
+	BYTE	lfCharSet;
+	BYTE	lfOutPrecision;
+	BYTE	lfClipPrecision;
+	BYTE	lfQuality;
+	BYTE	lfPitchAndFamily;
+	WCHAR	lfFaceName[LF_FACESIZE];
+} LOGFONT;
+#define OUT_DEFAULT_PRECIS	0
+#define CLIP_DEFAULT_PRECIS	0
+#define DEFAULT_QUALITY		0
+
+/// Unicode ranges of a font
+typedef struct tagWCRANGE {WCHAR wcLow; USHORT cGlyphs;} WCRANGE;
+typedef struct tagGLYPHSET {DWORD cbThis; DWORD flAccel; DWORD cGlyphsSupported; DWORD cRanges; WCRANGE ranges[1];} GLYPHSET, *LPGLYPHSET;
+#define GGI_MARK_NONEXISTING_GLYPHS	0x0001
+
+/// Bitmaps (only used by the license page, which the replay doesn't draw)
+typedef struct tagBITMAP {LONG bmType; LONG bmWidth; LONG bmHeight; LONG bmWidthBytes; WORD bmPlanes; WORD bmBitsPixel; LPVOID bmBits;} BITMAP;
+typedef struct tagBITMAPINFOHEADER {DWORD biSize; LONG biWidth; LONG biHeight; WORD biPlanes; WORD biBitCount; DWORD biCompression; DWORD biSizeImage;} BITMAPINFOHEADER;
+typedef struct tagDIBSECTION {BITMAP dsBm; BITMAPINFOHEADER dsBmih;} DIBSECTION;
+#define IMAGE_BITMAP		0
+#define LR_CREATEDIBSECTION	0x2000
+#define LR_LOADFROMFILE		0x0010
+
+/// The public part of the DEVMODE (only the members the plugin reads)
+typedef struct _DEVMODE {short dmPrintQuality; WORD dmLogPixels;} DEVMODE, *PDEVMODE;
+
+////////////////////////////////////////////////////////
+//      DDI objects
+////////////////////////////////////////////////////////
+
+typedef struct _SURFOBJ
+{
+	DHSURF	dhsurf;
+	HSURF	hsurf;
+	DHPDEV	dhpdev;
+	HDEV	hdev;
+	SIZEL	sizlBitmap;
+	ULONG	cjBits;
+	PVOID	pvBits;
+	PVOID	pvScan0;
+	LONG	lDelta;
+	ULONG	iUniq;
+	ULONG	iBitmapFormat;
+	USHORT	iType;
+	USHORT	fjBitmap;
+} SURFOBJ;
+#define STYPE_BITMAP		0
+#define STYPE_DEVICE		1
+
+typedef struct _GLYPHPOS {HGLYPH hg; struct _GLYPHDEF* pgdf; POINTL ptl;} GLYPHPOS, *PGLYPHPOS;
+
+typedef struct _STROBJ
+{
+	ULONG	cGlyphs;
+	FLONG	flAccel;
+	ULONG	ulCharInc;
+	RECTL	rclBkGround;
+	GLYPHPOS* pgp;
+	LPWSTR	pwszOrg;
+} STROBJ;
+#define SO_GLYPHINDEX_TEXTOUT	0x00000100
+#define DDI_ERROR			0xFFFFFFFF
+
+typedef struct _FONTOBJ
+{
+	ULONG	iUniq;
+	ULONG	iFace;
+	ULONG	cxMax;
+	FLONG	flFontType;
+	ULONG_PTR iTTUniq;
+	ULONG_PTR iFile;
+	SIZE	sizLogResPpi;
+	ULONG	ulStyleSize;
+	PVOID	pvConsumer;
+	PVOID	pvProducer;
+} FONTOBJ;
+
+/// Font metrics (only the members the plugin reads, in a host layout)
+typedef struct _IFIMETRICS
+{
+	ULONG	cjThis;
+	ULONG	dpwszFamilyName;
+	USHORT	fwdUnitsPerEm;
+	USHORT	usWinWeight;
+	USHORT	fsSelection;
+	BYTE	jWinCharSet;
+	BYTE	jWinPitchAndFamily;
+} IFIMETRICS, *PIFIMETRICS;
+#define FM_SEL_ITALIC		0x0001
+#define FM_SEL_UNDERSCORE	0x0002
+#define FM_SEL_STRIKEOUT	0x0010
+
+typedef struct _XFORML {FLOATL eM11; FLOATL eM12; FLOATL eM21; FLOATL eM22; FLOATL eDx; FLOATL eDy;} XFORML;
+typedef struct _XFORMOBJ {ULONG ulReserved; const XFORML* pHostXform;} XFORMOBJ;	// pHostXform: replay only
+typedef struct _CLIPOBJ {ULONG iUniq; RECTL rclBounds; BYTE iDComplexity; BYTE iFComplexity; BYTE iMode; BYTE fjOptions;} CLIPOBJ;
+typedef struct _BRUSHOBJ {ULONG iSolidColor; PVOID pvRbrush; FLONG flColorType;} BRUSHOBJ;
+typedef struct _XLATEOBJ {ULONG iUniq; FLONG flXlate; USHORT iSrcType; USHORT iDstType; ULONG cEntries; ULONG* pulXlate;} XLATEOBJ;
+typedef struct _PATHOBJ {FLONG fl; ULONG cCurves;} PATHOBJ;
+typedef struct _LINEATTRS {FLONG fl; ULONG iJoin; ULONG iEndCap;} LINEATTRS;
+typedef struct _COLORADJUSTMENT {WORD caSize; WORD caFlags;} COLORADJUSTMENT;
+#define DC_RECT				1
+#define FC_RECT				1
+#define TC_RECTANGLES		0
+#define COLORONCOLOR		3
+#define BMF_1BPP			1
+#define BMF_4BPP			2
+#define BMF_8BPP			3
+#define BMF_16BPP			4
+#define BMF_24BPP			5
+#define BMF_32BPP			6
+#define BMF_TOPDOWN			0x0001
+#define BMF_USERMEM			0x0008
+#define QUERYESCSUPPORT		8
+#define ED_ABORTDOC			1
+
+/// Printer driver device object
+typedef struct _DEVOBJ
+{
+	DWORD		dwSize;
+	PDEVOEM		pdevOEM;
+	HANDLE		hEngine;
+	HANDLE		hPrinter;
+	HANDLE		hOEM;
+	PDEVMODE	pPublicDM;
+	PVOID		pOEMDM;
+	PVOID		pDrvProcs;
+} DEVOBJ, *PDEVOBJ;
+
+/// Extra DEVMODE data header
+typedef struct _OEM_DMEXTRAHEADER {DWORD dwSize; DWORD dwSignature; DWORD dwVersion;} OEM_DMEXTRAHEADER;
+typedef struct _OEMDMPARAM* POEMDMPARAM;
+typedef struct _PUBLISHERINFO* PPUBLISHERINFO;
+typedef struct _GDIINFO {ULONG ulVersion;} GDIINFO;
+typedef struct _DEVINFO {FLONG flGraphicsCaps;} DEVINFO;
+
+/// DDI function table
+typedef struct _DRVFN {ULONG iFunc; PFN pfn;} DRVFN, *PDRVFN;
+typedef struct _DRVENABLEDATA {ULONG iDriverVersion; ULONG c; DRVFN* pdrvfn;} DRVENABLEDATA, *PDRVENABLEDATA;
+#define PRINTER_OEMINTF_VERSION	0x00010000
+
+#define INDEX_DrvStartDoc			35
+#define INDEX_DrvEndDoc				34
+#define INDEX_DrvStartPage			33
+#define INDEX_DrvSendPage			32
+#define INDEX_DrvEscape				24
+#define INDEX_DrvTextOut			23
+#define INDEX_DrvBitBlt				18
+#define INDEX_DrvStretchBlt			20
+#define INDEX_DrvCopyBits			19
+#define INDEX_DrvStrokePath			14
+#define INDEX_DrvFillPath			15
+#define INDEX_DrvStrokeAndFillPath	16
+
+typedef BOOL (*PFN_DrvStartDoc)(SURFOBJ*, LPWSTR, DWORD);
+typedef BOOL (*PFN_DrvEndDoc)(SURFOBJ*, FLONG);
+typedef BOOL (*PFN_DrvStartPage)(SURFOBJ*);
+typedef BOOL (*PFN_DrvSendPage)(SURFOBJ*);
+typedef ULONG (*PFN_DrvEscape)(SURFOBJ*, ULONG, ULONG, PVOID, ULONG, PVOID);
+typedef BOOL (*PFN_DrvTextOut)(SURFOBJ*, STROBJ*, FONTOBJ*, CLIPOBJ*, RECTL*, RECTL*, BRUSHOBJ*, BRUSHOBJ*, POINTL*, MIX);
+typedef BOOL (*PFN_DrvBitBlt)(SURFOBJ*, SURFOBJ*, SURFOBJ*, CLIPOBJ*, XLATEOBJ*, RECTL*, POINTL*, POINTL*, BRUSHOBJ*, POINTL*, ROP4);
+typedef BOOL (*PFN_DrvStretchBlt)(SURFOBJ*, SURFOBJ*, SURFOBJ*, CLIPOBJ*, XLATEOBJ*, COLORADJUSTMENT*, POINTL*, RECTL*, RECTL*, POINTL*, ULONG);
+typedef BOOL (*PFN_DrvCopyBits)(SURFOBJ*, SURFOBJ*, CLIPOBJ*, XLATEOBJ*, RECTL*, POINTL*);
+typedef BOOL (*PFN_DrvStrokePath)(SURFOBJ*, PATHOBJ*, CLIPOBJ*, XFORMOBJ*, BRUSHOBJ*, POINTL*, LINEATTRS*, MIX);
+typedef BOOL (*PFN_DrvFillPath)(SURFOBJ*, PATHOBJ*, CLIPOBJ*, BRUSHOBJ*, POINTL*, MIX, FLONG);
+typedef BOOL (*PFN_DrvStrokeAndFillPath)(SURFOBJ*, PATHOBJ*, CLIPOBJ*, XFORMOBJ*, BRUSHOBJ*, LINEATTRS*, BRUSHOBJ*, POINTL*, MIX, FLONG);
+
+////////////////////////////////////////////////////////
+//      Engine and GDI functions (ddihost.cpp)
+////////////////////////////////////////////////////////
+
+BOOL		STROBJ_bEnumPositionsOnly(STROBJ* pstro, ULONG* pc, PGLYPHPOS* ppgpos);
+BOOL		STROBJ_bGetAdvanceWidths(STROBJ* pso, ULONG iFirst, ULONG c, POINTQF* pptqD);
+PIFIMETRICS	FONTOBJ_pifi(FONTOBJ* pfo);
+XFORMOBJ*	FONTOBJ_pxoGetXform(FONTOBJ* pfo);
+ULONG		XFORMOBJ_iGetXform(XFORMOBJ* pxo, XFORML* pxform);
+HBITMAP		EngCreateBitmap(SIZEL sizl, LONG lWidth, ULONG iFormat, FLONG fl, PVOID pvBits);
+SURFOBJ*	EngLockSurface(HSURF hsurf);
+void		EngUnlockSurface(SURFOBJ* pso);
+BOOL		EngDeleteSurface(HSURF hsurf);
+BOOL		EngStretchBlt(SURFOBJ*, SURFOBJ*, SURFOBJ*, CLIPOBJ*, XLATEOBJ*, COLORADJUSTMENT*, POINTL*, RECTL*, RECTL*, POINTL*, ULONG);
+
+HFONT		CreateFontIndirect(const LOGFONT* plf);
+HGDIOBJ		SelectObject(HDC hDC, HGDIOBJ hObj);
+BOOL		DeleteObject(HGDIOBJ hObj);
+DWORD		GetFontUnicodeRanges(HDC hDC, LPGLYPHSET pSet);
+#define GDI_ERROR			0xFFFFFFFF
+DWORD		GetFontData(HDC hDC, DWORD dwTable, DWORD dwOffset, PVOID pvBuffer, DWORD cjBuffer);
+DWORD		GetGlyphIndices(HDC hDC, LPCWSTR lpstr, int c, LPWORD pgi, DWORD fl);
+HDC			GetDC(HANDLE hWnd);
+BOOL		DeleteDC(HDC hDC);
+int			GetObject(HANDLE h, int c, LPVOID pv);
+HANDLE		LoadImage(HINSTANCE hInst, LPCTSTR name, UINT type, int cx, int cy, UINT fuLoad);
+
+#define CP_ACP				0
+#define CP_UTF8				65001
+#define WC_COMPOSITECHECK	0x00000200
+#define WC_DEFAULTCHAR		0x00000040
+int			WideCharToMultiByte(UINT nCodePage, DWORD dwFlags, LPCWSTR pWide, int nWide, LPSTR pMulti, int nMulti, LPCSTR pDefault, BOOL* pUsedDefault);
+int			MultiByteToWideChar(UINT nCodePage, DWORD dwFlags, LPCSTR pMulti, int nMulti, LPWSTR pWide, int nWide);
+
+DWORD		GetCurrentProcessId();
+DWORD		GetTempPath(DWORD nSize, LPTSTR pPath);
+UINT		GetTempFileName(LPCTSTR pPath, LPCTSTR pPrefix, UINT nUnique, LPTSTR pName);
+void		OutputDebugString(LPCTSTR pString);
+
+#define INVALID_HANDLE_VALUE		((HANDLE)(ptrdiff_t)-1)
+#define INVALID_FILE_SIZE			((DWORD)0xFFFFFFFF)
+#define GENERIC_READ				0x80000000
+#define FILE_SHARE_READ				0x00000001
+#define FILE_SHARE_DELETE			0x00000004
+#define OPEN_EXISTING				3
+#define FILE_ATTRIBUTE_NORMAL		0x00000080
+#define PAGE_READONLY				0x02
+#define FILE_MAP_READ				0x0004
+#define MOVEFILE_REPLACE_EXISTING	0x00000001
+HANDLE		CreateFile(LPCTSTR pName, DWORD dwAccess, DWORD dwShare, PVOID pSecurity, DWORD dwCreation, DWORD dwFlags, HANDLE hTemplate);
+DWORD		GetFileSize(HANDLE hFile, DWORD* pdwHigh);
+HANDLE		CreateFileMapping(HANDLE hFile, PVOID pSecurity, DWORD dwProtect, DWORD dwSizeHigh, DWORD dwSizeLow, LPCTSTR pName);
+PVOID		MapViewOfFile(HANDLE hMapping, DWORD dwAccess, DWORD dwOffsetHigh, DWORD dwOffsetLow, size_t nSize);
+BOOL		UnmapViewOfFile(const void* pView);
+BOOL		CloseHandle(HANDLE h);
+BOOL		MoveFileEx(LPCTSTR pFrom, LPCTSTR pTo, DWORD dwFlags);
+#define ERROR_ALREADY_EXISTS		183L
+DWORD		GetLastError();
+
+// There's one user here: the folders are the user's, and a folder's access list becomes its mode
+#define TOKEN_IMPERSONATE			0x0004
+#define TOKEN_QUERY					0x0008
+#define CSIDL_LOCAL_APPDATA			0x001C
+#define CSIDL_FLAG_CREATE			0x8000
+#define SHGFP_TYPE_CURRENT			0
+#define SDDL_REVISION_1				1
+#define SUCCEEDED(hr)				((HRESULT)(hr) >= 0)
+typedef PVOID				PSID;
+typedef PVOID				PSECURITY_DESCRIPTOR;
+typedef struct _SID_AND_ATTRIBUTES {PSID Sid; DWORD Attributes;} SID_AND_ATTRIBUTES;
+typedef struct _TOKEN_USER {SID_AND_ATTRIBUTES User;} TOKEN_USER;
+typedef enum _TOKEN_INFORMATION_CLASS {TokenUser = 1} TOKEN_INFORMATION_CLASS;
+typedef struct _SECURITY_ATTRIBUTES {DWORD nLength; PSECURITY_DESCRIPTOR lpSecurityDescriptor; BOOL bInheritHandle;} SECURITY_ATTRIBUTES;
+HANDLE		GetCurrentThread();
+HANDLE		GetCurrentProcess();
+BOOL		OpenThreadToken(HANDLE hThread, DWORD dwAccess, BOOL bOpenAsSelf, HANDLE* phToken);
+BOOL		OpenProcessToken(HANDLE hProcess, DWORD dwAccess, HANDLE* phToken);
+BOOL		GetTokenInformation(HANDLE hToken, TOKEN_INFORMATION_CLASS nClass, PVOID pInfo, DWORD dwSize, DWORD* pdwSize);
+BOOL		ConvertSidToStringSid(PSID pSID, LPTSTR* ppString);
+BOOL		ConvertStringSecurityDescriptorToSecurityDescriptor(LPCTSTR pString, DWORD dwRevision, PSECURITY_DESCRIPTOR* ppDescriptor, ULONG* pnSize);
+HANDLE		LocalFree(HANDLE hMem);
+HRESULT		SHGetFolderPath(HANDLE hWnd, int nFolder, HANDLE hToken, DWORD dwFlags, LPTSTR pPath);
+BOOL		CreateDirectory(LPCTSTR pName, SECURITY_ATTRIBUTES* pSecurity);
+
+// The replayed job's spooler is in ddireplay.cpp
+BOOL		WritePrinter(HANDLE hPrinter, PVOID pBuf, DWORD cbBuf, DWORD* pcWritten);
+
+////////////////////////////////////////////////////////
+//      Plugin entry points (PRINTOEM.H)
+////////////////////////////////////////////////////////
+
+BOOL		APIENTRY OEMEnableDriver(DWORD dwOEMintfVersion, DWORD dwSize, PDRVENABLEDATA pded);
+void		APIENTRY OEMDisableDriver();
+PDEVOEM		APIENTRY OEMEnablePDEV(PDEVOBJ pdevobj, PWSTR pPrinterName, ULONG cPatterns, HSURF* phsurfPatterns, ULONG cjGdiInfo, GDIINFO* pGdiInfo, ULONG cjDevInfo, DEVINFO* pDevInfo, DRVENABLEDATA* pded);
+void		APIENTRY OEMDisablePDEV(PDEVOBJ pdevobj);
+BOOL		APIENTRY OEMResetPDEV(PDEVOBJ pdevobjOld, PDEVOBJ pdevobjNew);
+BOOL		APIENTRY OEMStartDoc(SURFOBJ* pso, PWSTR pwszDocName, DWORD dwJobId);
+BOOL		APIENTRY OEMEndDoc(SURFOBJ* pso, FLONG fl);
+BOOL		APIENTRY OEMStartPage(SURFOBJ* pso);
+BOOL		APIENTRY OEMSendPage(SURFOBJ* pso);
+ULONG		APIENTRY OEMEscape(SURFOBJ* pso, ULONG iEsc, ULONG cjIn, PVOID pvIn, ULONG cjOut, PVOID pvOut);
+BOOL		APIENTRY OEMTextOut(SURFOBJ* pso, STROBJ* pstro, FONTOBJ* pfo, CLIPOBJ* pco, RECTL* prclExtra, RECTL* prclOpaque, BRUSHOBJ* pboFore, BRUSHOBJ* pboOpaque, POINTL* pptlOrg, MIX mix);
+BOOL		APIENTRY OEMBitBlt(SURFOBJ* psoTrg, SURFOBJ* psoSrc, SURFOBJ* psoMask, CLIPOBJ* pco, XLATEOBJ* pxlo, RECTL* prclTrg, POINTL* pptlSrc, POINTL* pptlMask, BRUSHOBJ* pbo, POINTL* pptlBrush, ROP4 rop4);
+BOOL		APIENTRY OEMStretchBlt(SURFOBJ* psoDest, SURFOBJ* psoSrc, SURFOBJ* psoMask, CLIPOBJ* pco, XLATEOBJ* pxlo, COLORADJUSTMENT* pca, POINTL* pptlHTOrg, RECTL* prclDest, RECTL* prclSrc, POINTL* pptlMask, ULONG iMode);
+BOOL		APIENTRY OEMCopyBits(SURFOBJ* psoDst, SURFOBJ* psoSrc, CLIPOBJ* pco, XLATEOBJ* pxlo, RECTL* prclDst, POINTL* pptlSrc);
+BOOL		APIENTRY OEMStrokePath(SURFOBJ* pso, PATHOBJ* ppo, CLIPOBJ* pco, XFORMOBJ* pxo, BRUSHOBJ* pbo, POINTL* pptlBrushOrg, LINEATTRS* plineattrs, MIX mix);
+BOOL		APIENTRY OEMFillPath(SURFOBJ* pso, PATHOBJ* ppo, CLIPOBJ* pco, BRUSHOBJ* pbo, POINTL* pptlBrushOrg, MIX mix, FLONG flOptions);
+BOOL		APIENTRY OEMStrokeAndFillPath(SURFOBJ* pso, PATHOBJ* ppo, CLIPOBJ* pco, XFORMOBJ* pxo, BRUSHOBJ* pboStroke, LINEATTRS* plineattrs, BRUSHOBJ* pboFill, POINTL* pptlBrushOrg, MIX mixFill, FLONG flOptions);
+
+////////////////////////////////////////////////////////
+//      Runtime library
+////////////////////////////////////////////////////////
+
+/// Wide printf with the Windows meaning of %s and %c (wide strings and letters)
+int			ddihost_vswprintf(WCHAR* pBuffer, size_t nSize, const WCHAR* pFormat, va_list args);
+inline int	ddihost_swprintf(WCHAR* pBuffer, size_t nSize, const WCHAR* pFormat, ...) {va_list args; va_start(args, pFormat); int n = ddihost_vswprintf(pBuffer, nSize, pFormat, args); va_end(args); return n;}
+
+#define sprintf_s			snprintf
+#define _stprintf_s			ddihost_swprintf
+#define swprintf_s			ddihost_swprintf
+#define _ttoi(s)			((int)wcstol((s), NULL, 10))
+#define _ttol(s)			wcstol((s), NULL, 10)
+#define _tcsstr				wcsstr
+#define _tcslen				wcslen
+#define _tcschr				wcschr
+#define _tcsncmp			wcsncmp
+#define _tcsnicmp			wcsncasecmp
+#define _wcsnicmp			wcsncasecmp
+#define _tcsicmp			wcscasecmp
+#define _tunlink(s)			ddihost_unlink(s)
+#define _tfopen_s(pp, s, m)	ddihost_fopen(pp, s, m)
+#define _fileno				fileno
+#define _setmode(fd, mode)	((void)(fd))
+#define _O_BINARY			0
+#define UNREFERENCED_PARAMETER(p)	((void)(p))
+int			ddihost_unlink(LPCTSTR pName);
+int			ddihost_fopen(FILE** ppFile, LPCTSTR pName, LPCTSTR pMode);
+
+inline int	strcpy_s(char* pTo, size_t nSize, const char* pFrom) {if (strlen(pFrom) >= nSize) {if (nSize > 0) *pTo = '\0'; return 1;} strcpy(pTo, pFrom); return 0;}
+template <size_t N> inline int strcpy_s(char (&pTo)[N], const char* pFrom) {return strcpy_s(pTo, N, pFrom);}
+inline int	strcat_s(char* pTo, size_t nSize, const char* pFrom) {size_t n = strlen(pTo); return strcpy_s(pTo + n, nSize - n, pFrom);}
+template <size_t N> inline int strcat_s(char (&pTo)[N], const char* pFrom) {return strcat_s(pTo, N, pFrom);}
+inline int	wcsncpy_s(WCHAR* pTo, size_t nSize, const WCHAR* pFrom, size_t nCount) {size_t n = 0; while ((n < nCount) && (n + 1 < nSize) && (pFrom[n] != 0)) {pTo[n] = pFrom[n]; n++;} if (nSize > 0) pTo[n] = 0; return 0;}
+template <size_t N> inline int _tcscpy_s(WCHAR (&pTo)[N], const WCHAR* pFrom) {return wcsncpy_s(pTo, N, pFrom, N - 1);}
+
+/// Windows-style min and max (for arguments of different types too)
+template <class A, class B> inline typename std::common_type<A, B>::type min(A a, B b) {return (a < b) ? a : b;}
+template <class A, class B> inline typename std::common_type<A, B>::type max(A a, B b) {return (a > b) ? a : b;}
+
+/// Secure CRT array size helper
+#ifndef _S
+#define _S(v) sizeof(v)/sizeof(v[0])
+#endif
+
+////////////////////////////////////////////////////////
+//      Replay host objects (ddihost.cpp)
+////////////////////////////////////////////////////////
+
+/**
+    @brief A text run as the engine hands it to DrvTextOut, with the data behind the STROBJ_ functions
+*/
+struct HostStrObj : public STROBJ
+{
+	/// Letters (string runs) or glyph indices (glyph runs)
+	WCHAR*		pLetters;
+	/// Glyph positions
+	GLYPHPOS*	pPos;
+	/// Glyph advance widths (28.36 fixed point, as the engine returns them)
+	POINTQF*	pWidths;
+};
+
+/**
+    @brief A font as the engine hands it to DrvTextOut, with the data behind the FONTOBJ_ functions
+*/
+struct HostFontObj : public FONTOBJ
+{
+	/// Font metrics, immediately followed by the family name
+	struct
+	{
+		/// The metrics
+		IFIMETRICS	ifi;
+		/// Family name (IFIMETRICS::dpwszFamilyName points here)
+		WCHAR		cFamily[LF_FACESIZE];
+	}			metrics;
+	/// Notional to device transform
+	XFORML		xform;
+	/// Transform object returned by FONTOBJ_pxoGetXform
+	XFORMOBJ	xo;
+};
+
+/// Synthetic font cmap shared by all host fonts: returns the glyph index of a letter (0xFFFF if the font doesn't have it)
+WORD		HostGlyphIndex(WCHAR c);
+
+#include "debug.h"
+
+#endif   //#define _DDIHOST_H_
@@ -0,0 +1,1052 @@
+/**
+	@file
+	@brief Linux-hosted DDI replay harness: replays recorded print jobs through the rendering plugin's DDI hooks
+*/
+
+/*
+ * CC PDF Converter: Windows PDF Printer with Creative Commons license support
+ * Excel to PDF Converter: Excel PDF printing addin, keeping hyperlinks AND Creative Commons license support
+ * Copyright (C) 2007-2010 Guy Hachlili <hguy@cogniview.com>, Cogniview LTD.
+ * 
+ * This file is part of CC PDF Converter / Excel to PDF Converter
+ * 
+ * CC PDF Converter and Excel to PDF Converter are free software;
+ * you can redistribute them and/or modify them under the terms of the 
+ * GNU General Public License as published by the Free Software Foundation;
+ * either version 2 of the License, or (at your option) any later version.
+ * 
+ * CC PDF Converter and Excel to PDF Converter are is distributed in the hope 
+ * that they will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. * 
+ */
+
+/*
+ * Usage: ddireplay [-o out.ps] [-r repeats] trace.ddt
+ *        ddireplay [-o out.ps] [-r repeats] -g rows columns pages [auto|links|layer]
+ *        ddireplay -w rows columns pages [auto|links|layer] > trace.ddt
+ *
+ * Replays a print job trace through the plugin's actual hooks (ddihook.cpp, enable.cpp and the text
+ * model behind them), with the engine, GDI, registry and spooler replaced by the stand-ins in
+ * ddihost.cpp and a stand-in core PostScript driver below. As the core driver does, the stand-in
+ * buffers what is spooled (its own output and the plugin's) and passes it to the spooler through
+ * the plugin's OEMWritePrinter. The spooled PostScript is captured
+ * (-o writes it to a file), and for each hooked DDI call the number of calls, the time they took
+ * (total, mean, 99th percentile and worst) and the memory allocations made in them are reported,
+ * with the job's throughput.
+ *
+ * -g generates a dense spreadsheet job instead of reading a trace: rows x columns cells on each of
+ * pages pages, printed as an Auto-URL job (auto, glyph runs in row order, the default), as a job
+ * with text links (links, string runs in column order, with search regions and repeat counts) or
+ * with the text layer on (layer, glyph runs in row order). -w writes the generated trace instead
+ * of replaying it; the traces in replay/traces were made that way.
+ *
+ * Trace files are text, one DDI call or setting per line (# starts a comment):
+ *   surface <width> <height> <dpi>         The page surface (default: A4 at 600 dpi)
+ *   set <name> <value>                     Printer registry setting (DWORD if a number, else a string)
+ *   devmode <autourls|autoopen|temp> <0|1> Plugin DEVMODE flag
+ *   devmode file <name>                    Plugin DEVMODE file name
+ *   font <id> <glyphs|chars> <height> <advance> <face>
+ *                                          A font; glyph fonts print glyph runs, char fonts strings
+ *   link <page> <repeat> <url> <text>      Text link in the job's link data
+ *   linkin <page> <repeat> <left> <top> <right> <bottom> <url> <text>
+ *                                          Text link with a search region
+ *   linkat <page> <left> <top> <right> <bottom> <url>
+ *                                          Location link
+ *   testpage                               The link data is a calibration job
+ *   start_doc [name]                       DrvStartDoc (the link data is saved for the job first)
+ *   start_page                             DrvStartPage
+ *   t <font> <x> <y> <text>                DrvTextOut of a proportional run, baseline at x,y
+ *   tf <font> <x> <y> <text>               DrvTextOut of a fixed-pitch run
+ *   escape link <left> <top> <right> <bottom> <url>
+ *                                          DrvEscape(ESCAPE_LINK_DATA)
+ *   escape noauto                          DrvEscape(ESCAPE_DISABLE_AUTO_URL)
+ *   send_page                              DrvSendPage
+ *   end_doc                                DrvEndDoc
+ *   expect links <count>                   The job must put count links on its pages; ddireplay fails
+ *                                          if it doesn't
+ *   expect file <name>                     The job must name the file <name> to the converter (%%File)
+ * Text is UTF-8, and is the rest of the line.
+ * The traces in replay/traces expect all their links. auto.ddt and layer.ddt print their URLs in
+ * glyph runs, so they check that glyph runs are decoded through the GlyphTranslator. testpage.ddt
+ * is a link calibration job: it checks that its drop file header is spooled and nothing else is.
+ *
+ * Not part of the driver project; build it with g++ from this directory:
+ *   g++ -std=c++11 -O2 -DDDI_REPLAY -DUNICODE -D_UNICODE -DKERNEL_MODE -DCC_PDF_CONVERTER
+ *       -I. -Iinclude -I.. -I../../Common -I../../General -o ddireplay ddireplay.cpp ddihost.cpp
+ *       ../ddihook.cpp ../enable.cpp ../TextPart.cpp ../TextRecorder.cpp ../PageArena.cpp
+ *       ../GlyphTranslator.cpp ../GlyphMapFile.cpp ../TrueTypeCmap.cpp ../precomp.cpp ../../Common/CCPrintData.cpp
+ *       ../../Common/CCTChar.cpp ../../General/FileINI.cpp
+ * The license page and stamp are not replayed (there is no license database or images).
+ */
+
+#include "precomp.h"
+#include "oemps.h"
+#include <PRCOMOEM.H>
+#include "CCPrintRegistry.h"
+#include <chrono>
+#include <algorithm>
+#include <memory>
+#include <new>
+
+////////////////////////////////////////////////////////
+//      Allocation counting
+////////////////////////////////////////////////////////
+
+/// Number of allocations made so far
+static unsigned long long s_nAllocs = 0;
+/// Number of bytes allocated so far
+static unsigned long long s_nAllocBytes = 0;
+
+void* operator new(size_t nSize)
+{
+	s_nAllocs++;
+	s_nAllocBytes += nSize;
+	void* p = malloc((nSize == 0) ? 1 : nSize);
+	if (p == NULL)
+		throw std::bad_alloc();
+	return p;
+}
+void* operator new[](size_t nSize) {return operator new(nSize);}
+void* operator new(size_t nSize, const std::nothrow_t&) throw() {try {return operator new(nSize);} catch (...) {return NULL;}}
+void* operator new[](size_t nSize, const std::nothrow_t&) throw() {return operator new(nSize, std::nothrow);}
+// Not inlined: g++ would pair the free() with the library operator new, and warn of a mismatch
+__attribute__((noinline)) void operator delete(void* p) throw() {free(p);}
+__attribute__((noinline)) void operator delete[](void* p) throw() {free(p);}
+__attribute__((noinline)) void operator delete(void* p, size_t) throw() {free(p);}
+__attribute__((noinline)) void operator delete[](void* p, size_t) throw() {free(p);}
+
+////////////////////////////////////////////////////////
+//      Spooler and core driver stand-ins
+////////////////////////////////////////////////////////
+
+/**
+    @brief Captures the spooled PostScript (the plugin's writes and the core driver's)
+*/
+class ReplaySpooler : public IPrintOemDriverPS
+{
+public:
+	/**
+		@brief Constructor
+		@param pInFile File to write the PostScript to (NULL to only count it)
+	*/
+	ReplaySpooler(FILE* pInFile) : pdevobj(NULL), nBuffered(0), pFile(pInFile), nBytes(0), nWrites(0), nLinks(0) {cFile[0] = '\0';};
+
+	/**
+		@brief Writes data to the spool file (through the core driver's buffer)
+		@param pdevobj Pointer to the DEVOBJ structure
+		@param pBuffer The data
+		@param cbSize Size of the data
+		@param pdwResult Receives the size written
+		@return S_OK
+	*/
+	virtual HRESULT DrvWriteSpoolBuf(PDEVOBJ, PVOID pBuffer, DWORD cbSize, DWORD* pdwResult) {Spool((const char*)pBuffer, cbSize); *pdwResult = cbSize; return S_OK;};
+	/**
+		@brief Core driver stand-in: adds data to the spool buffer, passing the buffer to the plugin when it's full
+		@param pData The data
+		@param nSize Size of the data
+
+		Each write is passed to the plugin in one piece, so a link annotation is never split.
+	*/
+	void Spool(const char* pData, size_t nSize)
+	{
+		if (nBuffered + nSize > sizeof(cBuffer))
+			Flush();
+		if (nSize >= sizeof(cBuffer))
+		{
+			DWORD dwWritten;
+			OEMWritePrinter(pdevobj, (PVOID)pData, (DWORD)nSize, &dwWritten);
+			return;
+		}
+		memcpy(cBuffer + nBuffered, pData, nSize);
+		nBuffered += nSize;
+	};
+	/// Core driver stand-in: passes the spool buffer to the plugin's WritePrinter
+	void Flush()
+	{
+		if (nBuffered == 0)
+			return;
+		DWORD dwWritten;
+		OEMWritePrinter(pdevobj, cBuffer, (DWORD)nBuffered, &dwWritten);
+		nBuffered = 0;
+	};
+	/**
+		@brief Writes data to the spool file, counting the link annotations in it and keeping the file name it gives the converter
+		@param pData The data
+		@param nSize Size of the data
+	*/
+	void Write(const char* pData, size_t nSize)
+	{
+		static const char cLink[] = "/Subtype /Link";
+		static const char cFileHeader[] = "%%File: ";
+		for (const char* p = pData; (p = (const char*)memchr(p, '/', pData + nSize - p)) != NULL; p++)
+			if (((size_t)(pData + nSize - p) >= sizeof(cLink) - 1) && (memcmp(p, cLink, sizeof(cLink) - 1) == 0))
+				nLinks++;
+		const char* pHeader = (const char*)memmem(pData, nSize, cFileHeader, sizeof(cFileHeader) - 1);
+		if (pHeader != NULL)
+		{
+			pHeader += sizeof(cFileHeader) - 1;
+			size_t nLen = 0;
+			while ((pHeader + nLen < pData + nSize) && (pHeader[nLen] != '\r') && (pHeader[nLen] != '\n') && (nLen < sizeof(cFile) - 1))
+				nLen++;
+			memcpy(cFile, pHeader, nLen);
+			cFile[nLen] = '\0';
+		}
+		if (pFile != NULL)
+			fwrite(pData, 1, nSize, pFile);
+		nBytes += nSize;
+		nWrites++;
+	};
+
+	/// The job's device object (the plugin's WritePrinter gets it)
+	PDEVOBJ				pdevobj;
+	/// The core driver's spool buffer
+	char				cBuffer[4096];
+	/// Bytes in the spool buffer
+	size_t				nBuffered;
+	/// PostScript output file (NULL if not kept)
+	FILE*				pFile;
+	/// Bytes spooled
+	unsigned long long	nBytes;
+	/// Number of writes
+	UINT				nWrites;
+	/// Number of link annotations spooled
+	UINT				nLinks;
+	/// File name given to the converter by the last %%File header spooled
+	char				cFile[MAX_PATH + 1];
+};
+
+/// The spooler (the core driver stand-in writes to it too)
+static ReplaySpooler* s_pSpooler = NULL;
+
+/**
+	@brief Writes data to the printer's spool file
+	@param hPrinter Not used (there's one printer)
+	@param pBuf The data
+	@param cbBuf Size of the data
+	@param pcWritten Receives the size written
+	@return TRUE
+*/
+BOOL WritePrinter(HANDLE, PVOID pBuf, DWORD cbBuf, DWORD* pcWritten)
+{
+	s_pSpooler->Write((const char*)pBuf, cbBuf);
+	*pcWritten = cbBuf;
+	return TRUE;
+}
+
+/**
+	@brief Core driver stand-in: writes a line of PostScript (without allocating, so the plugin's allocations are what's counted)
+	@param pFormat printf-style format
+*/
+static void CorePrint(const char* pFormat, ...)
+{
+	char cLine[256];
+	va_list args;
+	va_start(args, pFormat);
+	int n = vsnprintf(cLine, sizeof(cLine), pFormat, args);
+	va_end(args);
+	s_pSpooler->Spool(cLine, min(n, (int)sizeof(cLine) - 1));
+}
+
+/// Core driver stand-in: current page number
+static UINT s_nCorePage = 0;
+
+static BOOL CoreStartDoc(SURFOBJ*, LPWSTR, DWORD) {s_nCorePage = 0; CorePrint("%%!PS-Adobe-3.0\n%%%%Creator: ddireplay\n%%%%EndComments\n"); return TRUE;}
+static BOOL CoreEndDoc(SURFOBJ*, FLONG) {CorePrint("%%%%EOF\n"); s_pSpooler->Flush(); return TRUE;}
+static BOOL CoreStartPage(SURFOBJ*) {s_nCorePage++; CorePrint("%%%%Page: %u %u\n", s_nCorePage, s_nCorePage); return TRUE;}
+static BOOL CoreSendPage(SURFOBJ*) {CorePrint("showpage\n"); return TRUE;}
+static ULONG CoreEscape(SURFOBJ*, ULONG, ULONG, PVOID, ULONG, PVOID) {return 0;}
+static BOOL CoreBitBlt(SURFOBJ*, SURFOBJ*, SURFOBJ*, CLIPOBJ*, XLATEOBJ*, RECTL*, POINTL*, POINTL*, BRUSHOBJ*, POINTL*, ROP4) {return TRUE;}
+static BOOL CoreStretchBlt(SURFOBJ*, SURFOBJ*, SURFOBJ*, CLIPOBJ*, XLATEOBJ*, COLORADJUSTMENT*, POINTL*, RECTL*, RECTL*, POINTL*, ULONG) {return TRUE;}
+static BOOL CoreCopyBits(SURFOBJ*, SURFOBJ*, CLIPOBJ*, XLATEOBJ*, RECTL*, POINTL*) {return TRUE;}
+static BOOL CoreStrokePath(SURFOBJ*, PATHOBJ*, CLIPOBJ*, XFORMOBJ*, BRUSHOBJ*, POINTL*, LINEATTRS*, MIX) {return TRUE;}
+static BOOL CoreFillPath(SURFOBJ*, PATHOBJ*, CLIPOBJ*, BRUSHOBJ*, POINTL*, MIX, FLONG) {return TRUE;}
+static BOOL CoreStrokeAndFillPath(SURFOBJ*, PATHOBJ*, CLIPOBJ*, XFORMOBJ*, BRUSHOBJ*, LINEATTRS*, BRUSHOBJ*, POINTL*, MIX, FLONG) {return TRUE;}
+
+/**
+	@brief Core driver stand-in: prints a text run (strings as they are, glyph runs as glyph indices)
+*/
+static BOOL CoreTextOut(SURFOBJ*, STROBJ* pstro, FONTOBJ*, CLIPOBJ*, RECTL*, RECTL*, BRUSHOBJ*, BRUSHOBJ*, POINTL*, MIX)
+{
+	bool bGlyphs = (pstro->flAccel & SO_GLYPHINDEX_TEXTOUT) != 0;
+	char cLine[256];
+	int n = snprintf(cLine, sizeof(cLine), "%d %d moveto %c", pstro->rclBkGround.left, pstro->rclBkGround.bottom, bGlyphs ? '<' : '(');
+	for (ULONG i = 0; i < pstro->cGlyphs; i++)
+	{
+		if (n > (int)sizeof(cLine) - 16)
+		{
+			s_pSpooler->Spool(cLine, n);
+			n = 0;
+		}
+		WCHAR c = pstro->pwszOrg[i];
+		if (bGlyphs)
+			n += snprintf(cLine + n, sizeof(cLine) - n, "%04x", (UINT)c & 0xFFFF);
+		else if ((c < 0x20) || (c > 0x7E) || (c == '(') || (c == ')') || (c == '\\'))
+			n += snprintf(cLine + n, sizeof(cLine) - n, "\\%03o", (UINT)c & 0xFF);
+		else
+			cLine[n++] = (char)c;
+	}
+	n += snprintf(cLine + n, sizeof(cLine) - n, "%c show\n", bGlyphs ? '>' : ')');
+	s_pSpooler->Spool(cLine, n);
+	return TRUE;
+}
+
+/**
+	@brief Turns a core driver stand-in into a DRVFN entry
+	@param pfn The stand-in
+	@return The stand-in as a PFN (the engine calls it through the right type again)
+*/
+template <typename TFunc>
+static PFN CorePFN(TFunc* pfn)
+{
+	// Through void (*)(), which converts to and from any function pointer type without a warning
+	return reinterpret_cast<PFN>(reinterpret_cast<void (*)()>(pfn));
+}
+
+/// The core driver's DDI functions, as handed to OEMEnablePDEV
+static DRVFN s_arCoreFuncs[] =
+{
+	{INDEX_DrvStartPage,			CorePFN(CoreStartPage)},
+	{INDEX_DrvSendPage,				CorePFN(CoreSendPage)},
+	{INDEX_DrvStartDoc,				CorePFN(CoreStartDoc)},
+	{INDEX_DrvEndDoc,				CorePFN(CoreEndDoc)},
+	{INDEX_DrvEscape,				CorePFN(CoreEscape)},
+	{INDEX_DrvTextOut,				CorePFN(CoreTextOut)},
+	{INDEX_DrvBitBlt,				CorePFN(CoreBitBlt)},
+	{INDEX_DrvStretchBlt,			CorePFN(CoreStretchBlt)},
+	{INDEX_DrvCopyBits,				CorePFN(CoreCopyBits)},
+	{INDEX_DrvStrokePath,			CorePFN(CoreStrokePath)},
+	{INDEX_DrvFillPath,				CorePFN(CoreFillPath)},
+	{INDEX_DrvStrokeAndFillPath,	CorePFN(CoreStrokeAndFillPath)},
+};
+
+////////////////////////////////////////////////////////
+//      Trace
+////////////////////////////////////////////////////////
+
+/// Replayed DDI calls
+enum ReplayCall {RCStartDoc, RCStartPage, RCTextOut, RCEscape, RCSendPage, RCEndDoc, RCCount};
+/// Names of the replayed DDI calls
+static const char* s_arCallNames[RCCount] = {"DrvStartDoc", "DrvStartPage", "DrvTextOut", "DrvEscape", "DrvSendPage", "DrvEndDoc"};
+
+/**
+    @brief A font of the trace
+*/
+struct ReplayFont
+{
+	/// The font object handed to DrvTextOut
+	HostFontObj		fo;
+	/// true to print glyph runs, false to print strings
+	bool			bGlyphs;
+	/// Letter height
+	int				nHeight;
+	/// Letter advance width
+	int				nAdvance;
+};
+
+/**
+    @brief A text run of the trace, with the data the engine would have for it
+*/
+struct ReplayRun
+{
+	/// The run object handed to DrvTextOut
+	HostStrObj				stro;
+	/// Letters or glyph indices
+	std::vector<WCHAR>		arLetters;
+	/// Glyph positions
+	std::vector<GLYPHPOS>	arPos;
+	/// Advance widths
+	std::vector<POINTQF>	arWidths;
+	/// The run's font
+	ReplayFont*				pFont;
+};
+
+/**
+    @brief A replayed DDI call
+*/
+struct ReplayOp
+{
+	/// The call
+	ReplayCall			eCall;
+	/// Text run (DrvTextOut)
+	ReplayRun*			pRun;
+	/// Escape code (DrvEscape)
+	ULONG				iEsc;
+	/// Escape data (DrvEscape)
+	std::vector<char>	arData;
+};
+
+/**
+    @brief A print job trace, ready to be replayed
+*/
+struct ReplayTrace
+{
+	/// Constructor: default surface is A4 at 600 dpi
+	ReplayTrace() : nDPI(600), bAutoURLs(FALSE), bAutoOpen(FALSE), bCreateAsTemp(FALSE), nRuns(0), nGlyphs(0), nExpectLinks(-1), bExpectFile(false) {sizePage.cx = 4958; sizePage.cy = 7016;};
+
+	/// Page surface size
+	SIZEL								sizePage;
+	/// Resolution
+	int									nDPI;
+	/// DEVMODE flags
+	BOOL								bAutoURLs, bAutoOpen, bCreateAsTemp;
+	/// DEVMODE file name
+	std::wstring						sFilename;
+	/// Fonts by ID
+	std::map<int, ReplayFont>			mapFonts;
+	/// Link data for the job
+	CCPrintData							dataLinks;
+	/// The calls
+	std::vector<ReplayOp>				arOps;
+	/// The runs (referred to by the calls)
+	std::vector<std::unique_ptr<ReplayRun> > arRuns;
+	/// Number of text runs and glyphs
+	UINT								nRuns, nGlyphs;
+	/// Number of links the job must make, -1 if not checked
+	int									nExpectLinks;
+	/// true if the job must name sExpectFile to the converter
+	bool								bExpectFile;
+	/// File name the job must give the converter
+	std::string							sExpectFile;
+
+	/// Parses a trace
+	bool	Parse(const std::string& sTrace, std::string& sError);
+
+protected:
+	/// Adds a text run
+	bool	AddRun(int nFont, int x, int y, const std::wstring& sText, bool bFixed);
+};
+
+/**
+	@brief Reads the next space-separated field of a trace line
+	@param p The line position (moved after the field)
+	@return The field
+*/
+static std::string NextField(const char*& p)
+{
+	while (*p == ' ' || *p == '\t')
+		p++;
+	const char* pStart = p;
+	while ((*p != '\0') && (*p != ' ') && (*p != '\t'))
+		p++;
+	return std::string(pStart, p);
+}
+
+/**
+	@brief Reads the rest of a trace line (one separating space skipped)
+	@param p The line position
+	@return The rest of the line, as wide text
+*/
+static std::wstring RestOfLine(const char* p)
+{
+	if ((*p == ' ') || (*p == '\t'))
+		p++;
+	return MakeTStringFromUTF8(p);
+}
+
+/**
+	@param nFont ID of the run's font
+	@param x X location of the run
+	@param y Baseline of the run
+	@param sText The text
+	@param bFixed true for a fixed-pitch run
+	@return true if added, false if the font is unknown
+*/
+bool ReplayTrace::AddRun(int nFont, int x, int y, const std::wstring& sText, bool bFixed)
+{
+	std::map<int, ReplayFont>::iterator iFont = mapFonts.find(nFont);
+	if ((iFont == mapFonts.end()) || sText.empty())
+		return false;
+	ReplayFont& font = (*iFont).second;
+
+	std::unique_ptr<ReplayRun> pRun(new ReplayRun);
+	UINT nCount = (UINT)sText.size();
+	pRun->pFont = &font;
+	pRun->arLetters.resize(nCount + 1);
+	pRun->arPos.resize(nCount);
+	pRun->arWidths.resize(nCount);
+	for (UINT n = 0; n < nCount; n++)
+	{
+		pRun->arLetters[n] = font.bGlyphs ? (WCHAR)HostGlyphIndex(sText[n]) : sText[n];
+		pRun->arPos[n].hg = pRun->arLetters[n];
+		pRun->arPos[n].pgdf = NULL;
+		pRun->arPos[n].ptl.x = x + n * font.nAdvance;
+		pRun->arPos[n].ptl.y = y;
+		pRun->arWidths[n].x.QuadPart = (long long)font.nAdvance << 36;
+		pRun->arWidths[n].y.QuadPart = 0;
+	}
+	pRun->arLetters[nCount] = 0;
+
+	STROBJ& stro = pRun->stro;
+	stro.cGlyphs = nCount;
+	stro.flAccel = font.bGlyphs ? SO_GLYPHINDEX_TEXTOUT : 0;
+	stro.ulCharInc = bFixed ? font.nAdvance : 0;
+	stro.rclBkGround.left = x;
+	stro.rclBkGround.right = x + nCount * font.nAdvance;
+	stro.rclBkGround.top = y - (font.nHeight * 4) / 5;
+	stro.rclBkGround.bottom = y + font.nHeight / 5;
+	stro.pgp = bFixed ? NULL : &pRun->arPos[0];
+	stro.pwszOrg = &pRun->arLetters[0];
+	pRun->stro.pLetters = &pRun->arLetters[0];
+	pRun->stro.pPos = &pRun->arPos[0];
+	pRun->stro.pWidths = &pRun->arWidths[0];
+
+	ReplayOp op;
+	op.eCall = RCTextOut;
+	op.pRun = pRun.get();
+	op.iEsc = 0;
+	arOps.push_back(op);
+	arRuns.push_back(std::move(pRun));
+	nRuns++;
+	nGlyphs += nCount;
+	return true;
+}
+
+/**
+	@param sTrace The trace text
+	@param[out] sError Receives the line of the error, if any
+	@return true if parsed, false if a line couldn't be understood
+*/
+bool ReplayTrace::Parse(const std::string& sTrace, std::string& sError)
+{
+	std::string::size_type nPos = 0;
+	while (nPos < sTrace.size())
+	{
+		std::string::size_type nEnd = sTrace.find('\n', nPos);
+		if (nEnd == std::string::npos)
+			nEnd = sTrace.size();
+		std::string sLine = sTrace.substr(nPos, nEnd - nPos);
+		nPos = nEnd + 1;
+		if (!sLine.empty() && (sLine[sLine.size() - 1] == '\r'))
+			sLine.resize(sLine.size() - 1);
+
+		const char* p = sLine.c_str();
+		std::string sCmd = NextField(p);
+		bool bOK = true;
+		if (sCmd.empty() || (sCmd[0] == '#'))
+			continue;
+		else if ((sCmd == "t") || (sCmd == "tf"))
+		{
+			int nFont = atoi(NextField(p).c_str());
+			int x = atoi(NextField(p).c_str());
+			int y = atoi(NextField(p).c_str());
+			bOK = AddRun(nFont, x, y, RestOfLine(p), sCmd == "tf");
+		}
+		else if ((sCmd == "start_doc") || (sCmd == "start_page") || (sCmd == "send_page") || (sCmd == "end_doc"))
+		{
+			ReplayOp op;
+			op.eCall = (sCmd == "start_doc") ? RCStartDoc : ((sCmd == "start_page") ? RCStartPage : ((sCmd == "send_page") ? RCSendPage : RCEndDoc));
+			op.pRun = NULL;
+			op.iEsc = 0;
+			arOps.push_back(op);
+		}
+		else if (sCmd == "escape")
+		{
+			ReplayOp op;
+			op.eCall = RCEscape;
+			op.pRun = NULL;
+			std::string sEscape = NextField(p);
+			if (sEscape == "noauto")
+				op.iEsc = ESCAPE_DISABLE_AUTO_URL;
+			else if (sEscape == "link")
+			{
+				op.iEsc = ESCAPE_LINK_DATA;
+				EscapeLinkData link;
+				link.left = atol(NextField(p).c_str());
+				link.top = atol(NextField(p).c_str());
+				link.right = atol(NextField(p).c_str());
+				link.bottom = atol(NextField(p).c_str());
+				link.lTitleOffset = 0;
+				std::string sURL = NextField(p);
+				op.arData.resize(offsetof(EscapeLinkData, url) + sURL.size() + 1);
+				memcpy(&op.arData[0], &link, offsetof(EscapeLinkData, url));
+				memcpy(&op.arData[offsetof(EscapeLinkData, url)], sURL.c_str(), sURL.size() + 1);
+			}
+			else
+				bOK = false;
+			arOps.push_back(op);
+		}
+		else if (sCmd == "font")
+		{
+			int nID = atoi(NextField(p).c_str());
+			ReplayFont& font = mapFonts[nID];
+			font.bGlyphs = NextField(p) == "glyphs";
+			font.nHeight = atoi(NextField(p).c_str());
+			font.nAdvance = atoi(NextField(p).c_str());
+			std::wstring sFace = RestOfLine(p);
+
+			HostFontObj& fo = font.fo;
+			memset(&fo, 0, sizeof(fo));
+			fo.iUniq = nID;
+			fo.iFace = nID;
+			fo.sizLogResPpi.cx = fo.sizLogResPpi.cy = nDPI;
+			fo.metrics.ifi.cjThis = sizeof(fo.metrics);
+			fo.metrics.ifi.dpwszFamilyName = (ULONG)((BYTE*)fo.metrics.cFamily - (BYTE*)&fo.metrics.ifi);
+			fo.metrics.ifi.fwdUnitsPerEm = 2048;
+			fo.metrics.ifi.usWinWeight = 400;
+			wcsncpy_s(fo.metrics.cFamily, LF_FACESIZE, sFace.c_str(), LF_FACESIZE - 1);
+			// Notional (em units) to device transform
+			fo.xform.eM11 = fo.xform.eM22 = (FLOATL)font.nHeight / fo.metrics.ifi.fwdUnitsPerEm;
+			fo.xo.pHostXform = &fo.xform;
+			bOK = (font.nHeight > 0) && (font.nAdvance > 0);
+		}
+		else if ((sCmd == "link") || (sCmd == "linkin"))
+		{
+			int nPage = atoi(NextField(p).c_str());
+			int nRepeat = atoi(NextField(p).c_str());
+			RECTL rcRegion;
+			if (sCmd == "linkin")
+			{
+				rcRegion.left = atol(NextField(p).c_str());
+				rcRegion.top = atol(NextField(p).c_str());
+				rcRegion.right = atol(NextField(p).c_str());
+				rcRegion.bottom = atol(NextField(p).c_str());
+			}
+			std::wstring sURL = MakeTStringFromUTF8(NextField(p).c_str());
+			dataLinks.AddLink(sURL, RestOfLine(p), nPage, nRepeat, (sCmd == "linkin") ? &rcRegion : NULL);
+			bOK = (nPage > 0) && (nRepeat > 0);
+		}
+		else if (sCmd == "linkat")
+		{
+			int nPage = atoi(NextField(p).c_str());
+			RECTL rc;
+			rc.left = atol(NextField(p).c_str());
+			rc.top = atol(NextField(p).c_str());
+			rc.right = atol(NextField(p).c_str());
+			rc.bottom = atol(NextField(p).c_str());
+			dataLinks.AddLink(MakeTStringFromUTF8(NextField(p).c_str()), rc, nPage);
+			bOK = nPage > 0;
+		}
+		else if (sCmd == "testpage")
+			dataLinks.SetTestPage();
+		else if (sCmd == "expect")
+		{
+			std::string sWhat = NextField(p);
+			if (sWhat == "file")
+			{
+				bExpectFile = true;
+				sExpectFile = NextField(p);
+				bOK = !sExpectFile.empty();
+			}
+			else
+			{
+				bOK = sWhat == "links";
+				nExpectLinks = atoi(NextField(p).c_str());
+				bOK = bOK && (nExpectLinks >= 0);
+			}
+		}
+		else if (sCmd == "surface")
+		{
+			sizePage.cx = atol(NextField(p).c_str());
+			sizePage.cy = atol(NextField(p).c_str());
+			nDPI = atoi(NextField(p).c_str());
+			bOK = (sizePage.cx > 0) && (sizePage.cy > 0) && (nDPI > 0);
+		}
+		else if (sCmd == "set")
+		{
+			std::wstring sName = MakeTStringFromUTF8(NextField(p).c_str());
+			std::string sValue = NextField(p);
+			if (!sValue.empty() && (sValue.find_first_not_of("0123456789") == std::string::npos))
+				CCPrintRegistry::SetRegistryDWORD(NULL, sName.c_str(), (DWORD)strtoul(sValue.c_str(), NULL, 10));
+			else
+				CCPrintRegistry::SetRegistryString(NULL, sName.c_str(), MakeTStringFromUTF8(sValue.c_str()));
+		}
+		else if (sCmd == "devmode")
+		{
+			std::string sName = NextField(p);
+			if (sName == "file")
+				sFilename = RestOfLine(p);
+			else
+			{
+				BOOL bValue = atoi(NextField(p).c_str()) ? TRUE : FALSE;
+				if (sName == "autourls")
+					bAutoURLs = bValue;
+				else if (sName == "autoopen")
+					bAutoOpen = bValue;
+				else if (sName == "temp")
+					bCreateAsTemp = bValue;
+				else
+					bOK = false;
+			}
+		}
+		else
+			bOK = false;
+
+		if (!bOK)
+		{
+			sError = sLine;
+			return false;
+		}
+	}
+	return true;
+}
+
+////////////////////////////////////////////////////////
+//      Generator
+////////////////////////////////////////////////////////
+
+/**
+	@brief Generates a dense spreadsheet print job trace
+	@param nRows Rows on each page
+	@param nColumns Columns on each page
+	@param nPages Number of pages
+	@param sMode auto (Auto-URL job), links (text links) or layer (text layer)
+	@return The trace
+*/
+static std::string GenerateTrace(int nRows, int nColumns, int nPages, const std::string& sMode)
+{
+	const int nWidth = 4958, nHeight = 7016, nMargin = 300;
+	int nRowHeight = (nHeight - 2 * nMargin) / nRows, nCellWidth = (nWidth - 2 * nMargin) / nColumns;
+	int nLetterHeight = (nRowHeight * 7) / 10, nAdvance = max(1, min(nLetterHeight / 2, nCellWidth / 14));
+	UINT nCellLetters = max(1, (nCellWidth - nAdvance) / nAdvance);
+	bool bLinks = sMode == "links";
+
+	std::string sTrace;
+	char cLine[512];
+	snprintf(cLine, sizeof(cLine), "# ddireplay -w %d %d %d %s\n# %d x %d cells on each of %d pages\nsurface %d %d 600\n", nRows, nColumns, nPages, sMode.c_str(), nRows, nColumns, nPages, nWidth, nHeight);
+	sTrace += cLine;
+	if (bLinks)
+		sTrace += "font 1 chars";
+	else
+	{
+		sTrace += (sMode == "layer") ? "set TextLayer 1\n" : "";
+		sTrace += "devmode autourls 1\nfont 1 glyphs";
+	}
+	snprintf(cLine, sizeof(cLine), " %d %d Arial\ndevmode file /tmp/ddireplay.pdf\n", nLetterHeight, nAdvance);
+	sTrace += cLine;
+
+	// Text links: every third row's label, and the "Details" two rows down (the 3rd one after the label)
+	if (bLinks)
+	{
+		for (int nPage = 1; nPage <= nPages; nPage++)
+			for (int nRow = 0; nRow < nRows; nRow += 3)
+			{
+				int nItem = (nPage - 1) * nRows + nRow + 1;
+				int nTop = nMargin + nRow * nRowHeight;
+				if ((nRow / 3) % 2 == 0)
+					snprintf(cLine, sizeof(cLine), "linkin %d 1 %d %d %d %d http://www.example.com/items/%d Item %d\n", nPage, nMargin, nTop, nMargin + nCellWidth, nTop + nRowHeight, nItem, nItem);
+				else
+					snprintf(cLine, sizeof(cLine), "link %d 1 http://www.example.com/items/%d Item %d\n", nPage, nItem, nItem);
+				sTrace += cLine;
+				if ((nColumns > 1) && (nRow + 2 < nRows))
+				{
+					snprintf(cLine, sizeof(cLine), "link %d 3 http://www.example.com/details/%d Details\n", nPage, nItem + 2);
+					sTrace += cLine;
+				}
+			}
+	}
+
+	sTrace += "start_doc Book1\n";
+	unsigned int nRandom = 12345;
+	for (int nPage = 1; nPage <= nPages; nPage++)
+	{
+		sTrace += "start_page\n";
+		if (!bLinks)
+		{
+			// The page header is a hyperlink the application set itself
+			snprintf(cLine, sizeof(cLine), "escape link %d %d %d %d http://www.example.com/report\n", nMargin, nMargin / 3, nMargin + nCellWidth, nMargin - 10);
+			sTrace += cLine;
+		}
+		// Spreadsheets print by rows, or down the columns when so set
+		for (int nOuter = 0; nOuter < (bLinks ? nColumns : nRows); nOuter++)
+			for (int nInner = 0; nInner < (bLinks ? nRows : nColumns); nInner++)
+			{
+				int nRow = bLinks ? nInner : nOuter, nColumn = bLinks ? nOuter : nInner;
+				int nItem = (nPage - 1) * nRows + nRow + 1;
+				char cCell[128];
+				if (nColumn == 0)
+					snprintf(cCell, sizeof(cCell), "Item %d", nItem);
+				else if (nColumn == 1)
+					strcpy_s(cCell, "Details");
+				else if ((nColumn == nColumns - 1) && !bLinks)
+					snprintf(cCell, sizeof(cCell), "http://www.example.com/items/%d", nItem);
+				else
+				{
+					nRandom = nRandom * 1103515245 + 12345;
+					snprintf(cCell, sizeof(cCell), "%u.%02u", (nRandom >> 8) % 100000, (nRandom >> 4) % 100);
+				}
+				// Cut to the cell (URLs can overflow into the margin, as long text does in a spreadsheet)
+				if ((strlen(cCell) > nCellLetters) && (nColumn < nColumns - 1))
+					cCell[nCellLetters] = '\0';
+				snprintf(cLine, sizeof(cLine), "t 1 %d %d %s\n", nMargin + nColumn * nCellWidth + nAdvance / 2, nMargin + nRow * nRowHeight + (nRowHeight * 4) / 5, cCell);
+				sTrace += cLine;
+			}
+		sTrace += "send_page\n";
+	}
+	sTrace += "end_doc\n";
+	return sTrace;
+}
+
+////////////////////////////////////////////////////////
+//      Replay
+////////////////////////////////////////////////////////
+
+/**
+    @brief Timing and allocations of a replayed DDI call
+*/
+struct CallStats
+{
+	/// Constructor
+	CallStats() : nAllocs(0), nAllocBytes(0) {};
+	/// Time each call took, in nanoseconds
+	std::vector<unsigned long long>	arNanos;
+	/// Allocations made in the calls
+	unsigned long long				nAllocs;
+	/// Bytes allocated in the calls
+	unsigned long long				nAllocBytes;
+};
+
+/**
+	@brief Replays a trace through the plugin
+	@param trace The trace
+	@param spooler The spooler to capture the output with
+	@param nRepeats Number of times to replay the job
+	@param arStats Receives the call statistics
+	@return true if all the calls succeeded, false if one failed
+*/
+static bool Replay(ReplayTrace& trace, ReplaySpooler& spooler, int nRepeats, CallStats arStats[RCCount])
+{
+	s_pSpooler = &spooler;
+	for (int i = 0; i < RCCount; i++)
+		arStats[i].arNanos.reserve(trace.arOps.size() * nRepeats);
+
+	// The job's DEVMODE and device
+	DEVMODE dm;
+	dm.dmPrintQuality = (short)trace.nDPI;
+	dm.dmLogPixels = (WORD)trace.nDPI;
+	OEMDEV dev;
+	memset(&dev.dmOEMExtra, 0, sizeof(dev.dmOEMExtra));
+	wcsncpy_s(dev.cFilename, MAX_PATH + 1, trace.sFilename.c_str(), MAX_PATH);
+	dev.bAutoOpen = trace.bAutoOpen;
+	dev.bSetProperties = FALSE;
+	dev.bCreateAsTemp = trace.bCreateAsTemp;
+	DEVOBJ devobj;
+	memset(&devobj, 0, sizeof(devobj));
+	devobj.dwSize = sizeof(devobj);
+	devobj.hPrinter = (HANDLE)&devobj;
+	devobj.pPublicDM = &dm;
+	devobj.pOEMDM = &dev;
+
+	// Enable the plugin as the core driver does (with the core driver's DDI functions to hook)
+	DRVENABLEDATA ded;
+	ded.iDriverVersion = PRINTER_OEMINTF_VERSION;
+	ded.c = _S(s_arCoreFuncs);
+	ded.pdrvfn = s_arCoreFuncs;
+	dev.bAutoURLs = trace.bAutoURLs;
+	devobj.pdevOEM = OEMEnablePDEV(&devobj, (PWSTR)L"ddireplay", 0, NULL, 0, NULL, 0, NULL, &ded);
+	if (devobj.pdevOEM == NULL)
+		return false;
+	// What IOemPS::EnablePDEV does
+	((POEMPDEV)devobj.pdevOEM)->pOEMHelp = &spooler;
+	spooler.pdevobj = &devobj;
+
+	SURFOBJ so;
+	memset(&so, 0, sizeof(so));
+	so.dhpdev = (DHPDEV)&devobj;
+	so.sizlBitmap = trace.sizePage;
+	so.iType = STYPE_DEVICE;
+
+	CLIPOBJ clip;
+	memset(&clip, 0, sizeof(clip));
+	BRUSHOBJ brush;
+	memset(&brush, 0, sizeof(brush));
+	POINTL ptOrg = {0, 0};
+
+	bool bRet = true;
+	for (int nRepeat = 0; nRepeat < nRepeats; nRepeat++)
+	{
+		for (std::vector<ReplayOp>::iterator i = trace.arOps.begin(); i != trace.arOps.end(); i++)
+		{
+			ReplayOp& op = *i;
+			if (op.eCall == RCStartDoc)
+			{
+				// Each job starts with the original DEVMODE, and its link data saved as the add-in does
+				dev.bAutoURLs = trace.bAutoURLs;
+				if (trace.dataLinks.HasData() && !trace.dataLinks.SaveProcessData(devobj.hPrinter))
+					return false;
+			}
+
+			unsigned long long nAllocs = s_nAllocs, nAllocBytes = s_nAllocBytes;
+			std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+			ULONG uRet = FALSE;
+			switch (op.eCall)
+			{
+				case RCStartDoc:
+					uRet = OEMStartDoc(&so, (PWSTR)L"Book1", 1);
+					break;
+				case RCStartPage:
+					uRet = OEMStartPage(&so);
+					break;
+				case RCTextOut:
+					clip.rclBounds = op.pRun->stro.rclBkGround;
+					uRet = OEMTextOut(&so, &op.pRun->stro, &op.pRun->pFont->fo, &clip, NULL, NULL, &brush, &brush, &ptOrg, 0x0d0d);
+					break;
+				case RCEscape:
+					uRet = OEMEscape(&so, op.iEsc, (ULONG)op.arData.size(), op.arData.empty() ? NULL : &op.arData[0], 0, NULL);
+					break;
+				case RCSendPage:
+					uRet = OEMSendPage(&so);
+					break;
+				case RCEndDoc:
+					uRet = OEMEndDoc(&so, 0);
+					break;
+				default:
+					break;
+			}
+			std::chrono::steady_clock::time_point tEnd = std::chrono::steady_clock::now();
+			CallStats& stats = arStats[op.eCall];
+			stats.nAllocs += s_nAllocs - nAllocs;
+			stats.nAllocBytes += s_nAllocBytes - nAllocBytes;
+			stats.arNanos.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(tEnd - tStart).count());
+			if (uRet == FALSE)
+			{
+				fprintf(stderr, "ddireplay: %s failed\n", s_arCallNames[op.eCall]);
+				bRet = false;
+			}
+		}
+	}
+
+	OEMDisablePDEV(&devobj);
+	return bRet;
+}
+
+/**
+	@brief Prints the replay results
+	@param trace The replayed trace
+	@param spooler The spooler that captured the output
+	@param nRepeats Number of times the job was replayed
+	@param arStats The call statistics
+*/
+static void Report(const ReplayTrace& trace, const ReplaySpooler& spooler, int nRepeats, CallStats arStats[RCCount])
+{
+	printf("%-14s %9s %11s %10s %10s %10s %12s %12s\n", "call", "count", "total ms", "mean us", "p99 us", "max us", "allocs/call", "bytes/call");
+	unsigned long long nTotal = 0;
+	for (int i = 0; i < RCCount; i++)
+	{
+		std::vector<unsigned long long>& arNanos = arStats[i].arNanos;
+		if (arNanos.empty())
+			continue;
+		unsigned long long nSum = 0;
+		for (size_t n = 0; n < arNanos.size(); n++)
+			nSum += arNanos[n];
+		nTotal += nSum;
+		std::sort(arNanos.begin(), arNanos.end());
+		size_t nCount = arNanos.size();
+		printf("%-14s %9u %11.2f %10.2f %10.2f %10.2f %12.2f %12.1f\n", s_arCallNames[i], (UINT)nCount, nSum / 1e6, nSum / 1e3 / nCount,
+			arNanos[min(nCount - 1, (nCount * 99) / 100)] / 1e3, arNanos[nCount - 1] / 1e3,
+			(double)arStats[i].nAllocs / nCount, (double)arStats[i].nAllocBytes / nCount);
+	}
+
+	double dSeconds = nTotal / 1e9;
+	UINT nPages = (UINT)arStats[RCSendPage].arNanos.size();
+	printf("\n%u pages, %u text runs (%u glyphs) in %.2f ms: %.0f pages/s, %.0f runs/s, %.0f glyphs/s\n", nPages, trace.nRuns * nRepeats, trace.nGlyphs * nRepeats, nTotal / 1e6,
+		nPages / dSeconds, trace.nRuns * nRepeats / dSeconds, trace.nGlyphs * nRepeats / dSeconds);
+	printf("spooled %llu bytes in %u writes (%.1f MB/s), %u links\n", spooler.nBytes, spooler.nWrites, spooler.nBytes / 1e6 / dSeconds, spooler.nLinks);
+}
+
+/**
+	@brief Reads a whole file
+	@param pPath The file path
+	@param[out] sData Receives the file's contents
+	@return true if read, false if failed
+*/
+static bool ReadFile(const char* pPath, std::string& sData)
+{
+	FILE* pFile = fopen(pPath, "rb");
+	if (pFile == NULL)
+		return false;
+	char cBuffer[65536];
+	size_t n;
+	while ((n = fread(cBuffer, 1, sizeof(cBuffer), pFile)) > 0)
+		sData.append(cBuffer, n);
+	fclose(pFile);
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	const char* pOutput = NULL;
+	const char* pTrace = NULL;
+	int nRepeats = 1, nRows = 0, nColumns = 0, nPages = 0;
+	bool bWrite = false;
+	std::string sMode = "auto";
+	for (int i = 1; i < argc; i++)
+	{
+		std::string sArg = argv[i];
+		if ((sArg == "-o") && (i + 1 < argc))
+			pOutput = argv[++i];
+		else if ((sArg == "-r") && (i + 1 < argc))
+			nRepeats = max(1, atoi(argv[++i]));
+		else if (((sArg == "-g") || (sArg == "-w")) && (i + 3 < argc))
+		{
+			bWrite = sArg == "-w";
+			nRows = atoi(argv[++i]);
+			nColumns = atoi(argv[++i]);
+			nPages = atoi(argv[++i]);
+			if ((i + 1 < argc) && (argv[i + 1][0] != '-'))
+				sMode = argv[++i];
+		}
+		else if (sArg[0] != '-')
+			pTrace = argv[i];
+		else
+			pTrace = NULL, nRows = -1, i = argc;
+	}
+	if (((pTrace == NULL) == (nRows == 0)) || (nRows < 0) || ((nRows > 0) && ((nColumns < 1) || (nPages < 1) || ((sMode != "auto") && (sMode != "links") && (sMode != "layer")))))
+	{
+		fprintf(stderr, "Usage: ddireplay [-o out.ps] [-r repeats] trace.ddt\n"
+						"       ddireplay [-o out.ps] [-r repeats] -g rows columns pages [auto|links|layer]\n"
+						"       ddireplay -w rows columns pages [auto|links|layer] > trace.ddt\n");
+		return 2;
+	}
+
+	// Get the trace
+	std::string sTrace, sError;
+	if (nRows > 0)
+		sTrace = GenerateTrace(nRows, nColumns, nPages, sMode);
+	else if (!ReadFile(pTrace, sTrace))
+	{
+		fprintf(stderr, "ddireplay: cannot read %s\n", pTrace);
+		return 1;
+	}
+	if (bWrite)
+	{
+		fwrite(sTrace.data(), 1, sTrace.size(), stdout);
+		return 0;
+	}
+	ReplayTrace trace;
+	if (!trace.Parse(sTrace, sError))
+	{
+		fprintf(stderr, "ddireplay: cannot understand trace line: %s\n", sError.c_str());
+		return 1;
+	}
+
+	// Replay it
+	FILE* pFile = NULL;
+	if ((pOutput != NULL) && ((pFile = fopen(pOutput, "wb")) == NULL))
+	{
+		fprintf(stderr, "ddireplay: cannot write %s\n", pOutput);
+		return 1;
+	}
+	ReplaySpooler spooler(pFile);
+	CallStats arStats[RCCount];
+	bool bRet = Replay(trace, spooler, nRepeats, arStats);
+	if (pFile != NULL)
+		fclose(pFile);
+
+	printf("ddireplay: %s, %d time(s)\n", (pTrace != NULL) ? pTrace : "generated job", nRepeats);
+	Report(trace, spooler, nRepeats, arStats);
+	if ((trace.nExpectLinks >= 0) && (spooler.nLinks != (UINT)trace.nExpectLinks * nRepeats))
+	{
+		fprintf(stderr, "ddireplay: %u links, expected %u\n", spooler.nLinks, (UINT)trace.nExpectLinks * nRepeats);
+		bRet = false;
+	}
+	if (trace.bExpectFile && (trace.sExpectFile != spooler.cFile))
+	{
+		fprintf(stderr, "ddireplay: file \"%s\", expected \"%s\"\n", spooler.cFile, trace.sExpectFile.c_str());
+		bRet = false;
+	}
+	return bRet ? 0 : 1;
+}
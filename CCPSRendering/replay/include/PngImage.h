@@ -0,0 +1,44 @@
+/**
+	@file
+	@brief Replay build: PNG images (the license stamp) can't be loaded, so none is drawn
+*/
+
+/*
+ * CC PDF Converter: Windows PDF Printer with Creative Commons license support
+ * Excel to PDF Converter: Excel PDF printing addin, keeping hyperlinks AND Creative Commons license support
+ * Copyright (C) 2007-2010 Guy Hachlili <hguy@cogniview.com>, Cogniview LTD.
+ * 
+ * This file is part of CC PDF Converter / Excel to PDF Converter
+ * 
+ * CC PDF Converter and Excel to PDF Converter are free software;
+ * you can redistribute them and/or modify them under the terms of the 
+ * GNU General Public License as published by the Free Software Foundation;
+ * either version 2 of the License, or (at your option) any later version.
+ * 
+ * CC PDF Converter and Excel to PDF Converter are is distributed in the hope 
+ * that they will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. * 
+ */
+
+#ifndef _PNGIMAGE_H_
+#define _PNGIMAGE_H_
+
+/**
+    @brief Stand-in for the PNG image loader; loading always fails
+*/
+class PngImage
+{
+public:
+	const BYTE*	GetBits() const {return NULL;};
+	int			GetWidth() const {return 0;};
+	int			GetHeight() const {return 0;};
+	int			GetBitsPerPixel() const {return 0;};
+	int			GetWidthInBytes() const {return 0;};
+	bool		LoadFromResource(UINT, bool = true, HMODULE = NULL, LPCTSTR = _T("PNG"), bool = false) {return false;};
+};
+
+#endif   //#define _PNGIMAGE_H_
@@ -0,0 +1,70 @@
+/**
+	@file
+	@brief Replay build: there is no license database, so the license page is never written
+*/
+
+/*
+ * CC PDF Converter: Windows PDF Printer with Creative Commons license support
+ * Excel to PDF Converter: Excel PDF printing addin, keeping hyperlinks AND Creative Commons license support
+ * Copyright (C) 2007-2010 Guy Hachlili <hguy@cogniview.com>, Cogniview LTD.
+ * 
+ * This file is part of CC PDF Converter / Excel to PDF Converter
+ * 
+ * CC PDF Converter and Excel to PDF Converter are free software;
+ * you can redistribute them and/or modify them under the terms of the 
+ * GNU General Public License as published by the Free Software Foundation;
+ * either version 2 of the License, or (at your option) any later version.
+ * 
+ * CC PDF Converter and Excel to PDF Converter are is distributed in the hope 
+ * that they will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. * 
+ */
+
+#ifndef _SQLITEDB_H_
+#define _SQLITEDB_H_
+
+#include "CCTChar.h"
+
+namespace SQLite
+{
+
+/**
+    @brief Stand-in for a database record
+*/
+class Record
+{
+public:
+	bool			IsValid() const {return false;};
+	int				GetNumField(LPCTSTR) const {return 0;};
+	std::tstring	GetField(LPCTSTR) const {return std::tstring();};
+};
+
+/**
+    @brief Stand-in for a query result
+*/
+class Recordset
+{
+public:
+	bool			IsValid() const {return false;};
+	int				GetRecordCount() const {return 0;};
+	Record			GetRecord(int) const {return Record();};
+};
+
+/**
+    @brief Stand-in for the database; it can't be opened
+*/
+class DB
+{
+public:
+	bool			Open(LPCTSTR) {return false;};
+	Recordset		Query(LPCTSTR) {return Recordset();};
+	std::tstring	GetLastError() const {return std::tstring();};
+};
+
+};
+
+#endif   //#define _SQLITEDB_H_
@@ -0,0 +1,421 @@
+/**
+	@file
+	@brief Benchmark for the page text model (TextArea) with text printed out of order
+*/
+
+/*
+ * CC PDF Converter: Windows PDF Printer with Creative Commons license support
+ * Excel to PDF Converter: Excel PDF printing addin, keeping hyperlinks AND Creative Commons license support
+ * Copyright (C) 2007-2010 Guy Hachlili <hguy@cogniview.com>, Cogniview LTD.
+ * 
+ * This file is part of CC PDF Converter / Excel to PDF Converter
+ * 
+ * CC PDF Converter and Excel to PDF Converter are free software;
+ * you can redistribute them and/or modify them under the terms of the 
+ * GNU General Public License as published by the Free Software Foundation;
+ * either version 2 of the License, or (at your option) any later version.
+ * 
+ * CC PDF Converter and Excel to PDF Converter are is distributed in the hope 
+ * that they will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. * 
+ */
+
+/*
+ * Usage: textbench [rows [columns [pages]]]
+ *
+ * Prints a spreadsheet-like page of rows x columns cells (500 x 100, 50k text runs, by default)
+ * into a TextArea, with the cells in row order, column order and shuffled, then searches for
+ * every row's first two cells and for the URL at the end of each row.
+ * For each order the time to add the runs, to search the page and the number of expressions 
+ * found are reported; all orders should find them all. The same expressions are then looked for
+ * in one pass (TextMatcher), as the driver does.
+ * Then a text page (rows lines of prose, with a URL every 10 lines) is searched for URLs, as it
+ * is for Auto-URL print jobs.
+ * Then a page with the same label on every row has each row's label looked for by its repeat
+ * count (the Nth "Details" on the page), once with TextArea::SearchFor and once with TextMatcher.
+ * Last, the edges of what SearchFor and SearchForURL find are checked, and any difference from
+ * the expected areas is reported.
+ *
+ * Not part of the driver project; build it with g++ from this directory:
+ *   g++ -std=c++11 -O2 -DDDI_REPLAY -DUNICODE -D_UNICODE -DKERNEL_MODE -DCC_PDF_CONVERTER
+ *       -I. -Iinclude -I.. -I../../Common -I../../General -o textbench textbench.cpp ddihost.cpp
+ *       ../TextPart.cpp ../precomp.cpp ../../Common/CCTChar.cpp
+ */
+
+#include "precomp.h"
+#include "debug.h"
+#include "TextPart.h"
+#include <vector>
+#include <chrono>
+
+/// Width of each printed letter
+#define BENCH_LETTER	20
+/// Height of a row
+#define BENCH_ROW		100
+/// Width of a cell
+#define BENCH_CELL		400
+
+/**
+	@brief Returns a time stamp
+	@return Time in milliseconds
+*/
+double BenchTime()
+{
+	static std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+}
+
+/**
+	@brief Returns the text of a cell
+	@param nRow The cell's row
+	@param nCol The cell's column
+	@param nCols The number of columns
+	@return The text
+*/
+std::wstring CellText(int nRow, int nCol, int nCols)
+{
+	WCHAR c[64];
+	if (nCol == nCols - 1)
+		swprintf_s(c, _S(c), L"http://x.org/%d", nRow);
+	else
+		swprintf_s(c, _S(c), L"r%dc%d", nRow, nCol);
+	return c;
+}
+
+/**
+	@brief Prints a cell into the page text
+	@param oText The page text
+	@param nCell The cell (row * nCols + column)
+	@param nCols The number of columns
+*/
+void PrintCell(TextArea& oText, int nCell, int nCols)
+{
+	int nRow = nCell / nCols, nCol = nCell % nCols;
+	std::wstring s = CellText(nRow, nCol, nCols);
+
+	// Glyph locations and widths, as the DDI gives them
+	GLYPHPOS arGlyphPos[64];
+	POINTQF arWidths[64];
+	for (std::wstring::size_type n = 0; n < s.size(); n++)
+	{
+		arGlyphPos[n].ptl.x = nCol * BENCH_CELL + (long)n * BENCH_LETTER;
+		arGlyphPos[n].ptl.y = nRow * BENCH_ROW + BENCH_ROW / 2;
+		arWidths[n].x.HighPart = BENCH_LETTER << 4;
+	}
+	RECTL rc;
+	rc.left = nCol * BENCH_CELL;
+	rc.right = rc.left + (long)s.size() * BENCH_LETTER;
+	// Cells of a row aren't all exactly at the same height
+	rc.top = nRow * BENCH_ROW + (nCol % 3) * 5;
+	rc.bottom = rc.top + BENCH_ROW * 8 / 10;
+	PGLYPHPOS pGlyphPos = arGlyphPos;
+	oText.AddLine(s, rc, pGlyphPos, arWidths);
+}
+
+/**
+	@brief Runs the benchmark for one order of the cells
+	@param szName The name of the order
+	@param arOrder The cells, in the order to print them
+	@param nRows The number of rows
+	@param nCols The number of columns
+	@param nPages The number of pages to print
+*/
+void RunBench(const char* szName, const std::vector<int>& arOrder, int nRows, int nCols, int nPages)
+{
+	TextArea oText;
+	double dAdd = 0, dSearch = 0, dMatch = 0;
+	int nFound = 0, nURLs = 0, nMatched = 0;
+	for (int nPage = 0; nPage < nPages; nPage++)
+	{
+		oText.clear();
+		nFound = nURLs = nMatched = 0;
+
+		double dStart = BenchTime();
+		for (std::vector<int>::const_iterator i = arOrder.begin(); i != arOrder.end(); i++)
+			PrintCell(oText, *i, nCols);
+		dAdd += BenchTime() - dStart;
+
+		dStart = BenchTime();
+		RECTL rcArea;
+		for (int nRow = 0; nRow < nRows; nRow++)
+		{
+			// Lines are kept in the order they were started, so search each from the beginning
+			oText.InitSearch();
+			STRLIST words;
+			words.push_back(CellText(nRow, 0, nCols));
+			words.push_back(CellText(nRow, 1, nCols));
+			if (oText.SearchFor(words, rcArea))
+				nFound++;
+		}
+		std::wstring sURL;
+		oText.InitSearch();
+		while (oText.SearchForURL(rcArea, sURL))
+			nURLs++;
+		dSearch += BenchTime() - dStart;
+
+		dStart = BenchTime();
+		TextMatcher matcher;
+		std::vector<UINT> arPhrases;
+		for (int nRow = 0; nRow < nRows; nRow++)
+		{
+			STRLIST words;
+			words.push_back(CellText(nRow, 0, nCols) + L" " + CellText(nRow, 1, nCols));
+			arPhrases.push_back(matcher.AddPhrase(words));
+		}
+		oText.FindAll(matcher);
+		for (int nRow = 0; nRow < nRows; nRow++)
+		{
+			matcher.Restart();
+			if (matcher.SearchFor(arPhrases[nRow], rcArea, 1))
+				nMatched++;
+		}
+		dMatch += BenchTime() - dStart;
+	}
+	printf("%-8s %8.2f ms add %8.2f ms search %6d/%d found %6d/%d URLs %8.2f ms match %6d/%d found\n", szName, dAdd / nPages, dSearch / nPages, nFound, nRows, nURLs, nRows, dMatch / nPages, nMatched, nRows);
+}
+
+/**
+	@brief Runs the Auto-URL benchmark on a page of prose
+	@param nLines The number of lines
+	@param nPages The number of pages to search
+*/
+void RunURLBench(int nLines, int nPages)
+{
+	static const WCHAR* arWords[] = {L"the", L"spreadsheet", L"printer", L"converts", L"every", L"page", L"into", L"a", L"document", L"with", L"links,", L"(see", L"below)."};
+	const int nWords = sizeof(arWords) / sizeof(arWords[0]);
+
+	// Print the page once
+	TextArea oText;
+	int nURLs = 0;
+	for (int nLine = 0; nLine < nLines; nLine++)
+	{
+		std::wstring s;
+		for (int n = 0; n < 12; n++)
+		{
+			if (n > 0)
+				s += L' ';
+			if ((nLine % 10 == 0) && (n == 6))
+			{
+				WCHAR c[64];
+				swprintf_s(c, _S(c), L"https://example.org/page/%d).", nLine);
+				s += c;
+				nURLs++;
+			}
+			else
+				s += arWords[(nLine + n) % nWords];
+		}
+		RECTL rc;
+		rc.left = 0;
+		rc.right = (long)s.size() * BENCH_LETTER;
+		rc.top = nLine * BENCH_ROW;
+		rc.bottom = rc.top + BENCH_ROW * 8 / 10;
+		oText.AddLine(s, rc, BENCH_LETTER);
+	}
+
+	// Search it
+	RECTL rcArea;
+	std::wstring sURL;
+	int nFound = 0;
+	double dStart = BenchTime();
+	for (int nPage = 0; nPage < nPages; nPage++)
+	{
+		nFound = 0;
+		oText.InitSearch();
+		while (oText.SearchForURL(rcArea, sURL))
+			nFound++;
+	}
+	printf("%-8s %8.3f ms URLs %6d/%d found\n", "text", (BenchTime() - dStart) / nPages, nFound, nURLs);
+}
+
+/**
+	@brief Runs the repeated label benchmark: the same label on every row, each row's label looked for by its repeat count
+	@param nRows The number of rows
+	@param nPages The number of pages to search
+*/
+void RunRepeatBench(int nRows, int nPages)
+{
+	// Print the page once: a row number and a "Details" label on every row
+	TextArea oText;
+	for (int nRow = 0; nRow < nRows; nRow++)
+	{
+		WCHAR c[64];
+		swprintf_s(c, _S(c), L"%d", nRow);
+		RECTL rc;
+		rc.left = 0;
+		rc.right = (long)wcslen(c) * BENCH_LETTER;
+		rc.top = nRow * BENCH_ROW;
+		rc.bottom = rc.top + BENCH_ROW * 8 / 10;
+		oText.AddLine(c, rc, BENCH_LETTER);
+		rc.left = BENCH_CELL;
+		rc.right = rc.left + 7 * BENCH_LETTER;
+		oText.AddLine(L"Details", rc, BENCH_LETTER);
+	}
+	STRLIST words;
+	words.push_back(L"Details");
+
+	// Search it: every row from the top of the page
+	RECTL rcArea;
+	int nFound = 0, nMatched = 0;
+	double dStart = BenchTime();
+	for (int nPage = 0; nPage < nPages; nPage++)
+	{
+		nFound = 0;
+		for (int nRow = 0; nRow < nRows; nRow++)
+		{
+			oText.InitSearch();
+			if (oText.SearchFor(words, rcArea, nRow + 1) && (rcArea.top == nRow * BENCH_ROW))
+				nFound++;
+		}
+	}
+	double dSearch = BenchTime() - dStart;
+
+	dStart = BenchTime();
+	for (int nPage = 0; nPage < nPages; nPage++)
+	{
+		nMatched = 0;
+		TextMatcher matcher;
+		UINT nPhrase = matcher.AddPhrase(words);
+		oText.FindAll(matcher);
+		for (int nRow = 0; nRow < nRows; nRow++)
+		{
+			matcher.Restart();
+			if (matcher.SearchFor(nPhrase, rcArea, nRow + 1) && (rcArea.top == nRow * BENCH_ROW))
+				nMatched++;
+		}
+	}
+	printf("%-8s %8.3f ms search %6d/%d found %8.3f ms match %6d/%d found\n", "repeat", dSearch / nPages, nFound, nRows, (BenchTime() - dStart) / nPages, nMatched, nRows);
+}
+
+/**
+	@brief Checks one search result
+	@param szName The name of the case
+	@param bFound true if the search found something
+	@param rcArea The area found
+	@param nLeft The expected left edge, or -1 if nothing should be found
+	@param nRight The expected right edge
+	@return 1 if the result isn't the expected one, 0 if it is
+*/
+int CheckCase(const char* szName, bool bFound, const RECTL& rcArea, long nLeft, long nRight)
+{
+	if (nLeft < 0)
+	{
+		if (!bFound)
+			return 0;
+		printf("%-24s found [%ld,%ld], expected nothing\n", szName, (long)rcArea.left, (long)rcArea.right);
+		return 1;
+	}
+	if (bFound && (rcArea.left == nLeft) && (rcArea.right == nRight))
+		return 0;
+	if (bFound)
+		printf("%-24s found [%ld,%ld], expected [%ld,%ld]\n", szName, (long)rcArea.left, (long)rcArea.right, nLeft, nRight);
+	else
+		printf("%-24s not found, expected [%ld,%ld]\n", szName, nLeft, nRight);
+	return 1;
+}
+
+/**
+	@brief Checks the edges of what SearchFor and SearchForURL find
+	@return The number of failed cases
+*/
+int RunEdgeCases()
+{
+	static const struct
+	{
+		const char*		szName;
+		const WCHAR*	szLine;
+		const WCHAR*	szFirst;
+		const WCHAR*	szSecond;
+		long			nLeft;
+		long			nRight;
+	} arCases[] = {
+		// The first word is matched at the end of a page word
+		{"suffix", L"wand more", L"and", L"mo", 1, 9},
+		// ...even when it is also found earlier in it
+		{"repeated suffix", L"andand more", L"and", L"mo", 3, 11},
+		// A page word one letter shorter than the first word doesn't match
+		{"short word", L"an more", L"and", L"mo", -1, 0},
+		// The last word is matched at the start of a page word
+		{"prefix", L"and moreover", L"and", L"more", 0, 12},
+	};
+	static const struct
+	{
+		const char*		szName;
+		const WCHAR*	szLine;
+		long			nLeft;
+		long			nRight;
+	} arURLCases[] = {
+		// The area ends with the URL's last letter
+		{"URL word", L"see http://x.org/1", 4, 18},
+		{"URL trimmed", L"see http://x.org/1).", 4, 18},
+	};
+
+	const int nCases = sizeof(arCases) / sizeof(arCases[0]), nURLCases = sizeof(arURLCases) / sizeof(arURLCases[0]);
+	int nFailed = 0;
+	RECTL rcLine = {0, 0, 0, BENCH_ROW}, rcArea;
+	for (int n = 0; n < nCases; n++)
+	{
+		TextArea oText;
+		rcLine.right = (long)wcslen(arCases[n].szLine) * BENCH_LETTER;
+		oText.AddLine(arCases[n].szLine, rcLine, BENCH_LETTER);
+		STRLIST words;
+		words.push_back(arCases[n].szFirst);
+		words.push_back(arCases[n].szSecond);
+		oText.InitSearch();
+		bool bFound = oText.SearchFor(words, rcArea);
+		nFailed += CheckCase(arCases[n].szName, bFound, rcArea, arCases[n].nLeft * BENCH_LETTER, arCases[n].nRight * BENCH_LETTER);
+	}
+	for (int n = 0; n < nURLCases; n++)
+	{
+		TextArea oText;
+		rcLine.right = (long)wcslen(arURLCases[n].szLine) * BENCH_LETTER;
+		oText.AddLine(arURLCases[n].szLine, rcLine, BENCH_LETTER);
+		std::wstring sURL;
+		oText.InitSearch();
+		bool bFound = oText.SearchForURL(rcArea, sURL);
+		nFailed += CheckCase(arURLCases[n].szName, bFound, rcArea, arURLCases[n].nLeft * BENCH_LETTER, arURLCases[n].nRight * BENCH_LETTER);
+	}
+	printf("%-8s %6d/%d cases passed\n", "edges", nCases + nURLCases - nFailed, nCases + nURLCases);
+	return nFailed;
+}
+
+/**
+	@brief Program entry point
+	@param argc Number of arguments
+	@param argv The arguments
+	@return 0, or 2 if an edge case failed
+*/
+int main(int argc, char* argv[])
+{
+	int nRows = (argc > 1) ? atoi(argv[1]) : 500, nCols = (argc > 2) ? atoi(argv[2]) : 100, nPages = (argc > 3) ? atoi(argv[3]) : 10;
+	if ((nRows < 1) || (nCols < 2) || (nPages < 1))
+	{
+		printf("Usage: textbench [rows [columns [pages]]]\n");
+		return 1;
+	}
+	int nCells = nRows * nCols;
+	printf("%d rows x %d columns = %d runs, %d pages\n", nRows, nCols, nCells, nPages);
+
+	std::vector<int> arOrder(nCells);
+	int n;
+	for (n = 0; n < nCells; n++)
+		arOrder[n] = n;
+	RunBench("rows", arOrder, nRows, nCols, nPages);
+
+	for (n = 0; n < nCells; n++)
+		arOrder[n] = (n % nRows) * nCols + n / nRows;
+	RunBench("columns", arOrder, nRows, nCols, nPages);
+
+	// Fixed seed, so runs can be compared
+	srand(1);
+	for (n = nCells - 1; n > 0; n--)
+		std::swap(arOrder[n], arOrder[(((unsigned)rand() << 15) ^ (unsigned)rand()) % (n + 1)]);
+	RunBench("shuffled", arOrder, nRows, nCols, nPages);
+
+	RunURLBench(nRows, nPages * 100);
+	RunRepeatBench(nRows, nPages);
+	return (RunEdgeCases() == 0) ? 0 : 2;
+}
@@ -0,0 +1,371 @@
+/**
+	@file
+	@brief Generates the built-in glyph maps of the bundled URW fonts (URWGlyphMaps.h)
+*/
+
+/*
+ * CC PDF Converter: Windows PDF Printer with Creative Commons license support
+ * Excel to PDF Converter: Excel PDF printing addin, keeping hyperlinks AND Creative Commons license support
+ * Copyright (C) 2007-2010 Guy Hachlili <hguy@cogniview.com>, Cogniview LTD.
+ * 
+ * This file is part of CC PDF Converter / Excel to PDF Converter
+ * 
+ * CC PDF Converter and Excel to PDF Converter are free software;
+ * you can redistribute them and/or modify them under the terms of the 
+ * GNU General Public License as published by the Free Software Foundation;
+ * either version 2 of the License, or (at your option) any later version.
+ * 
+ * CC PDF Converter and Excel to PDF Converter are is distributed in the hope 
+ * that they will be useful, but WITHOUT ANY WARRANTY; without even the implied 
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. * 
+ */
+
+/*
+ * Usage: urwmapgen output.h font.ttf ...
+ *
+ * Reads each font's family name ('name' table), weight and italic flag ('OS/2' table), version 
+ * ('head' table) and glyph map ('cmap' table, read with TrueTypeCmap as the driver reads it) and
+ * writes them as constexpr tables: the maps' pages (each different page once, as most of the
+ * fonts share them), each map's page list, and the fonts sorted by face name, weight and italic 
+ * flag. GlyphTranslator uses a font's built-in map when the font printed with has the same face, 
+ * style and version. Fonts without a Unicode character map (symbol fonts) are left out.
+ * The output is only rewritten if it changed.
+ *
+ * Not part of the driver; the driver project builds and runs it on ..\Install\urwfonts\*.ttf 
+ * when this file or the character map reader change (custom build step of this file), with the 
+ * driver's include folders (the DDK's too, in INCLUDE) and defines, e.g.:
+ *   cl /nologo /EHsc /O2 /DURWMAPGEN /DSTRICT /DUNICODE /D_UNICODE /DOEMCOM /DUSERMODE_DRIVER /DWINNT 
+ *      /DKERNEL_MODE /DCC_PDF_CONVERTER /I. /I..\Common /I..\General /I..\libpng /I..\zlib /I..\DB 
+ *      urwmapgen.cpp TrueTypeCmap.cpp GlyphTranslator.cpp GlyphMapFile.cpp precomp.cpp ..\Common\CCTChar.cpp 
+ *      gdi32.lib advapi32.lib shell32.lib setargv.obj
+ *   urwmapgen URWGlyphMaps.h ..\Install\urwfonts\*.ttf
+ * or on Linux, with the replay host (see replay/ddireplay.cpp):
+ *   g++ -std=c++11 -O2 -DURWMAPGEN -DDDI_REPLAY -DUNICODE -D_UNICODE -DKERNEL_MODE -I. -Ireplay -Ireplay/include
+ *       -I../Common -I../General -o urwmapgen urwmapgen.cpp TrueTypeCmap.cpp GlyphTranslator.cpp
+ *       GlyphMapFile.cpp precomp.cpp replay/ddihost.cpp ../Common/CCTChar.cpp
+ */
+
+#include "precomp.h"
+#include "GlyphTranslator.h"
+#include "TrueTypeCmap.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+/// Tag of the naming table ('name')
+#define TRUETYPE_TAG_NAME		0x6E616D65
+/// Tag of the OS/2 and Windows metrics table ('OS/2')
+#define TRUETYPE_TAG_OS2		0x4F532F32
+/// Tag of the font header table ('head')
+#define TRUETYPE_TAG_HEAD		0x68656164
+
+/**
+	@brief A bundled font, as it's written to the output
+*/
+struct GenFont
+{
+	/// The font file's name (for the output's comments)
+	std::string		sFile;
+	/// Face name (the family name, as the engine gives it in the font's IFIMETRICS)
+	std::wstring	sFace;
+	/// Weight
+	UINT			nWeight;
+	/// true if italic
+	bool			bItalic;
+	/// The font's version
+	GlyphFontStamp	stamp;
+	/// Number of glyphs in the map
+	UINT			nCount;
+	/// The map's pages: page number and index in the page pool
+	std::vector<std::pair<UINT, UINT> >	arPages;
+
+	/**
+		@brief Sort order of the output (face, weight, italic flag, file)
+	*/
+	bool operator<(const GenFont& other) const
+	{
+		if (sFace != other.sFace)
+			return sFace < other.sFace;
+		if (nWeight != other.nWeight)
+			return nWeight < other.nWeight;
+		if (bItalic != other.bItalic)
+			return !bItalic;
+		return sFile < other.sFile;
+	};
+};
+
+/**
+	@brief Reads a big-endian WORD
+*/
+static inline WORD GenWord(const BYTE* p)
+{
+	return (WORD)((p[0] << 8) | p[1]);
+}
+
+/**
+	@brief Reads a big-endian DWORD
+*/
+static inline DWORD GenDWord(const BYTE* p)
+{
+	return ((DWORD)p[0] << 24) | ((DWORD)p[1] << 16) | ((DWORD)p[2] << 8) | (DWORD)p[3];
+}
+
+/**
+	@brief Reads a font's family name, as Windows names the font (US English name record on the Windows platform)
+	@param pName The naming table
+	@param nSize Size of the table
+	@param[out] sFace Receives the name
+	@return true if found
+*/
+static bool GenReadFamilyName(const BYTE* pName, size_t nSize, std::wstring& sFace)
+{
+	if (nSize < 6)
+		return false;
+	UINT nRecords = GenWord(pName + 2);
+	size_t nStrings = GenWord(pName + 4);
+	const BYTE* pBest = NULL;
+	UINT nBestLength = 0, nBestRank = 0;
+	for (UINT n = 0; (n < nRecords) && (6 + (n + 1) * 12 <= nSize); n++)
+	{
+		// platformID, encodingID, languageID, nameID, length, offset
+		const BYTE* pRecord = pName + 6 + n * 12;
+		if ((GenWord(pRecord) != 3) || (GenWord(pRecord + 6) != 1))
+			continue;
+		UINT nLength = GenWord(pRecord + 8);
+		size_t nOffset = nStrings + GenWord(pRecord + 10);
+		if (nOffset + nLength > nSize)
+			continue;
+		UINT nRank = (GenWord(pRecord + 4) == 0x409) ? 2 : 1;
+		if (nRank > nBestRank)
+		{
+			pBest = pName + nOffset;
+			nBestLength = nLength;
+			nBestRank = nRank;
+		}
+	}
+	if (pBest == NULL)
+		return false;
+	// UTF-16 (big-endian), cut as the LOGFONT face name is
+	sFace.clear();
+	for (UINT n = 0; (n + 1 < nBestLength) && (sFace.size() < LF_FACESIZE - 1); n += 2)
+		sFace += (WCHAR)GenWord(pBest + n);
+	return !sFace.empty();
+}
+
+/**
+	@brief Reads a bundled font
+	@param pFile The font file's path
+	@param[out] font Receives the font's description
+	@param[out] map Receives the font's map
+	@return true if read, false if it isn't a TrueType font with a Unicode character map
+*/
+static bool GenReadFont(const char* pFile, GenFont& font, GlyphToText& map)
+{
+	FILE* pIn = fopen(pFile, "rb");
+	if (pIn == NULL)
+		return false;
+	std::vector<BYTE> arData;
+	BYTE cBuffer[65536];
+	size_t nRead;
+	while ((nRead = fread(cBuffer, 1, sizeof(cBuffer), pIn)) > 0)
+		arData.insert(arData.end(), cBuffer, cBuffer + nRead);
+	fclose(pIn);
+	if (arData.empty())
+		return false;
+
+	const BYTE* pTable;
+	size_t nTableSize;
+	// Face name
+	if (!TrueTypeCmap::FindTable(&arData[0], arData.size(), TRUETYPE_TAG_NAME, pTable, nTableSize) || !GenReadFamilyName(pTable, nTableSize, font.sFace))
+		return false;
+	// usWeightClass and fsSelection
+	if (!TrueTypeCmap::FindTable(&arData[0], arData.size(), TRUETYPE_TAG_OS2, pTable, nTableSize) || (nTableSize < 64))
+		return false;
+	font.nWeight = GenWord(pTable + 4);
+	font.bItalic = (GenWord(pTable + 62) & 1) != 0;
+	// Version, as GlyphTranslator::GetFontStamp() reads it
+	if (!TrueTypeCmap::FindTable(&arData[0], arData.size(), TRUETYPE_TAG_HEAD, pTable, nTableSize) || (nTableSize < 36))
+		return false;
+	font.stamp.dwRevision = GenDWord(pTable + 4);
+	font.stamp.dwChecksum = GenDWord(pTable + 8);
+	font.stamp.dwModifiedHigh = GenDWord(pTable + 28);
+	font.stamp.dwModifiedLow = GenDWord(pTable + 32);
+	// And the map
+	if (!TrueTypeCmap::FindTable(&arData[0], arData.size(), TRUETYPE_TAG_CMAP, pTable, nTableSize) || !TrueTypeCmap::ReadGlyphMap(pTable, nTableSize, map))
+		return false;
+	font.nCount = map.size();
+	return true;
+}
+
+/**
+	@brief Writes a face name as a wide string literal
+	@param sFace The face name
+	@return The literal
+*/
+static std::string GenLiteral(const std::wstring& sFace)
+{
+	std::string s = "L\"";
+	char c[16];
+	for (size_t n = 0; n < sFace.size(); n++)
+	{
+		UINT u = (UINT)sFace[n];
+		if ((u >= 0x20) && (u < 0x7F) && (u != '"') && (u != '\\'))
+			s += (char)u;
+		else
+		{
+			// Escaped, and the literal split so the next letter isn't read as a hex digit
+			snprintf(c, sizeof(c), "\\x%04X\" L\"", u);
+			s += c;
+		}
+	}
+	return s + "\"";
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		printf("Usage: urwmapgen output.h font.ttf ...\n");
+		return 1;
+	}
+
+	// Read the fonts (in file name order, so the output doesn't depend on the argument order)
+	std::vector<std::string> arFiles(argv + 2, argv + argc);
+	std::sort(arFiles.begin(), arFiles.end());
+	std::vector<GenFont> arFonts;
+	std::vector<std::vector<WCHAR> > arPool;
+	std::map<std::vector<WCHAR>, UINT> mapPool;
+	for (size_t i = 0; i < arFiles.size(); i++)
+	{
+		GenFont font;
+		GlyphToText map;
+		const char* pName = arFiles[i].c_str() + arFiles[i].find_last_of("/\\") + 1;
+		font.sFile = pName;
+		if (!GenReadFont(arFiles[i].c_str(), font, map))
+		{
+			fprintf(stderr, "urwmapgen: %s skipped (no Unicode character map)\n", pName);
+			continue;
+		}
+		// Each different page is written once
+		for (UINT nPage = 0; nPage < 256; nPage++)
+		{
+			const WCHAR* pPage = map.GetPage(nPage);
+			if (pPage == NULL)
+				continue;
+			std::vector<WCHAR> arPage(pPage, pPage + 256);
+			std::map<std::vector<WCHAR>, UINT>::iterator iPage = mapPool.find(arPage);
+			if (iPage == mapPool.end())
+			{
+				iPage = mapPool.insert(std::make_pair(arPage, (UINT)arPool.size())).first;
+				arPool.push_back(arPage);
+			}
+			font.arPages.push_back(std::make_pair(nPage, (*iPage).second));
+		}
+		arFonts.push_back(font);
+	}
+	if (arFonts.empty())
+	{
+		fprintf(stderr, "urwmapgen: no fonts read\n");
+		return 1;
+	}
+	std::sort(arFonts.begin(), arFonts.end());
+
+	// Write it all
+	std::string s;
+	char c[256];
+	s +=	"/**\n"
+			"\t@file\n"
+			"\t@brief Glyph maps of the fonts the installer ships (Install/urwfonts), compiled into the driver\n"
+			"*/\n"
+			"\n"
+			"/*\n"
+			" * Generated by urwmapgen (see urwmapgen.cpp) - do not edit.\n"
+			" */\n"
+			"\n"
+			"#ifndef _URWGLYPHMAPS_H_\n"
+			"#define _URWGLYPHMAPS_H_\n"
+			"\n";
+	snprintf(c, sizeof(c), "/// Pages of the built-in maps (%u different pages, shared between the maps)\n", (UINT)arPool.size());
+	s += c;
+	snprintf(c, sizeof(c), "static constexpr WCHAR s_arURWGlyphPages[%u][256] =\n{\n", (UINT)arPool.size());
+	s += c;
+	for (size_t i = 0; i < arPool.size(); i++)
+	{
+		s += "\t{";
+		for (UINT n = 0; n < 256; n++)
+		{
+			snprintf(c, sizeof(c), "%s0x%04X%s", ((n % 16) == 0) ? "\n\t\t" : " ", (UINT)arPool[i][n], (n < 255) ? "," : "");
+			s += c;
+		}
+		s += "\n\t},\n";
+	}
+	s += "};\n\n";
+
+	s += "/// Pages of each built-in map\nstatic constexpr GlyphBuiltInPage s_arURWGlyphPageList[] =\n{\n";
+	UINT nFirst = 0;
+	std::vector<UINT> arFirst;
+	for (size_t i = 0; i < arFonts.size(); i++)
+	{
+		arFirst.push_back(nFirst);
+		s += "\t";
+		for (size_t n = 0; n < arFonts[i].arPages.size(); n++)
+		{
+			snprintf(c, sizeof(c), "{%u, %u}, ", arFonts[i].arPages[n].first, arFonts[i].arPages[n].second);
+			s += c;
+		}
+		s += "// " + arFonts[i].sFile + "\n";
+		nFirst += (UINT)arFonts[i].arPages.size();
+	}
+	s += "};\n\n";
+
+	s += "/// The built-in maps, by face name, weight and italic flag\nstatic constexpr GlyphBuiltInMap s_arURWGlyphMaps[] =\n{\n";
+	for (size_t i = 0; i < arFonts.size(); i++)
+	{
+		const GenFont& font = arFonts[i];
+		snprintf(c, sizeof(c), ", %u, %s, {0x%08X, 0x%08X, 0x%08X, 0x%08X}, %u, %u, %u},\t// %s\n", font.nWeight, font.bItalic ? "true" : "false", 
+			font.stamp.dwRevision, font.stamp.dwChecksum, font.stamp.dwModifiedHigh, font.stamp.dwModifiedLow, font.nCount, arFirst[i], (UINT)font.arPages.size(), font.sFile.c_str());
+		s += "\t{" + GenLiteral(font.sFace) + c;
+	}
+	s += "};\n\n#endif   //#define _URWGLYPHMAPS_H_\n";
+
+	// CRLF, as the rest of the sources
+	std::string sOut;
+	for (size_t n = 0; n < s.size(); n++)
+	{
+		if (s[n] == '\n')
+			sOut += '\r';
+		sOut += s[n];
+	}
+
+	// Only touch the output if it changed, so the driver isn't rebuilt for nothing
+	FILE* pOut = fopen(argv[1], "rb");
+	if (pOut != NULL)
+	{
+		std::string sOld;
+		size_t nRead;
+		while ((nRead = fread(c, 1, sizeof(c), pOut)) > 0)
+			sOld.append(c, nRead);
+		fclose(pOut);
+		if (sOld == sOut)
+		{
+			printf("urwmapgen: %s is up to date\n", argv[1]);
+			return 0;
+		}
+	}
+	pOut = fopen(argv[1], "wb");
+	if ((pOut == NULL) || (fwrite(sOut.data(), 1, sOut.size(), pOut) != sOut.size()))
+	{
+		fprintf(stderr, "urwmapgen: cannot write %s\n", argv[1]);
+		if (pOut != NULL)
+			fclose(pOut);
+		return 1;
+	}
+	fclose(pOut);
+	printf("urwmapgen: %u fonts, %u pages written to %s\n", (UINT)arFonts.size(), (UINT)arPool.size(), argv[1]);
+	return 0;
+}
@@ -41,6 +41,7 @@
 #define SETTINGS_LICENSELOCATION	_T("LicenseLocation")
 #define SETTINGS_AUTOURLS			_T("AutoURLs")
 #define SETTINGS_CREATEASTEMP		_T("CreateAsTemp")
+#define SETTINGS_TEXTLAYER			_T("TextLayer")
 
 
 #endif   //#define _CCCOMMON_H_
@@ -55,7 +55,12 @@ OffsetY<num>=<offset-y>
 
 // for each TEXT-based URL:
 Text<num>=<text>
-Repeat<num>=<repeat> // Optional (defaults to 1)
+Repeat<num>=<repeat> // Optional (defaults to 1); counts only the matches in the region if there is one
+// Optional: page area to look for the text in (the default is the whole page)
+RegionLeft<num>=<left-location>
+RegionRight<num>=<right-location>
+RegionTop<num>=<top-location>
+RegionBottom<num>=<bottom-location>
 
 // For each LOCATION-based link
 Left<num>=<left-location>
@@ -127,6 +132,24 @@ Bottom<num>=<bottom-location>
 /// Link location: text repeat count (write)
 #define DATAFILE_LINK_REPEAT_WRITE		_T("Repeat%d=%d\r\n")
 
+// Text search region
+/// Search region: left
+#define DATAFILE_LINK_REGION_LEFT			_T("RegionLeft%d")
+/// Search region: left (write)
+#define DATAFILE_LINK_REGION_LEFT_WRITE		_T("RegionLeft%d=%d\r\n")
+/// Search region: right
+#define DATAFILE_LINK_REGION_RIGHT			_T("RegionRight%d")
+/// Search region: right (write)
+#define DATAFILE_LINK_REGION_RIGHT_WRITE	_T("RegionRight%d=%d\r\n")
+/// Search region: top
+#define DATAFILE_LINK_REGION_TOP			_T("RegionTop%d")
+/// Search region: top (write)
+#define DATAFILE_LINK_REGION_TOP_WRITE		_T("RegionTop%d=%d\r\n")
+/// Search region: bottom
+#define DATAFILE_LINK_REGION_BOTTOM			_T("RegionBottom%d")
+/// Search region: bottom (write)
+#define DATAFILE_LINK_REGION_BOTTOM_WRITE	_T("RegionBottom%d=%d\r\n")
+
 // Link location rectangle
 /// Link location: left
 #define DATAFILE_LINK_LOC_LEFT			_T("Left%d")
@@ -179,6 +202,7 @@ bool CCPrintData::LinkData::FromFile(const TCHARSTR2STR& data, int nNum)
 	sURL = _T("");
 	sTitle = _T("");
 	nPage = 0;
+	ClearRegion();
 
 	// Could be an internal link
 	_stprintf_s(cName, _S(cName), DATAFILE_LINK_PAGE, nNum);
@@ -226,6 +250,30 @@ bool CCPrintData::LinkData::FromFile(const TCHARSTR2STR& data, int nNum)
 			if (nTemp > 0)
 				nRepeat = nTemp;
 		}
+
+		// Search region (optional, but only if it's all there)
+		RECTL rect;
+		_stprintf_s(cName, _S(cName), DATAFILE_LINK_REGION_LEFT, nNum);
+		if ((iKey = data.find(cName)) != data.end())
+		{
+			rect.left = _ttoi((*iKey).second.c_str());
+			_stprintf_s(cName, _S(cName), DATAFILE_LINK_REGION_RIGHT, nNum);
+			if ((iKey = data.find(cName)) != data.end())
+			{
+				rect.right = _ttoi((*iKey).second.c_str());
+				_stprintf_s(cName, _S(cName), DATAFILE_LINK_REGION_TOP, nNum);
+				if ((iKey = data.find(cName)) != data.end())
+				{
+					rect.top = _ttoi((*iKey).second.c_str());
+					_stprintf_s(cName, _S(cName), DATAFILE_LINK_REGION_BOTTOM, nNum);
+					if ((iKey = data.find(cName)) != data.end())
+					{
+						rect.bottom = _ttoi((*iKey).second.c_str());
+						rectRegion = rect;
+					}
+				}
+			}
+		}
 	}
 	else
 	{
@@ -317,6 +365,18 @@ bool CCPrintData::LinkData::ToFile(std::tstring& sData, int nNum) const
 			_stprintf_s(cName, _S(cName), DATAFILE_LINK_REPEAT_WRITE, nNum, nRepeat);
 			sData += cName;
 		}
+		if (HasRegion())
+		{
+			// And where to look for it
+			_stprintf_s(cName, _S(cName), DATAFILE_LINK_REGION_LEFT_WRITE, nNum, rectRegion.left);
+			sData += cName;
+			_stprintf_s(cName, _S(cName), DATAFILE_LINK_REGION_RIGHT_WRITE, nNum, rectRegion.right);
+			sData += cName;
+			_stprintf_s(cName, _S(cName), DATAFILE_LINK_REGION_TOP_WRITE, nNum, rectRegion.top);
+			sData += cName;
+			_stprintf_s(cName, _S(cName), DATAFILE_LINK_REGION_BOTTOM_WRITE, nNum, rectRegion.bottom);
+			sData += cName;
+		}
 	}
 	return true;
 }
@@ -367,6 +427,28 @@ bool CCPrintData::PageData::FromFile(class FileINI& file, int nPage)
 	return true;
 }
 
+/**
+	@param[out] arRegions Receives the search region of each text link
+	@return true if all the text links have a search region, false if the whole page has to be searched
+*/
+bool CCPrintData::PageData::GetTextRegions(std::vector<RECTL>& arRegions) const
+{
+	arRegions.clear();
+	for (const_iterator i = begin(); i != end(); i++)
+	{
+		if ((*i).IsLocation())
+			continue;
+		if (!(*i).HasRegion())
+		{
+			// This one can be anywhere
+			arRegions.clear();
+			return false;
+		}
+		arRegions.push_back((*i).rectRegion);
+	}
+	return true;
+}
+
 /**
 	@param sData String to write the data to
 	@param nPage The number of this page
@@ -671,7 +753,7 @@ bool CCPrintData::WriteToFile(LPCTSTR lpFilename)
 	
 	// Now open the file
 	FILE* pFile;
-	if (NULL != _tfopen_s(&pFile, lpFilename, _T("wt")))
+	if (0 != _tfopen_s(&pFile, lpFilename, _T("wt")))
 		return false;
 #ifdef _UNICODE
 	// Write unicode identifier at the beginning if it's a unicode string
@@ -710,13 +792,14 @@ void CCPrintData::EnsurePage(int nPage)
 	@param sText The text to look for
 	@param nPage The page in which this link is printed
 	@param nRepeat The amount of times to look for the text before making it the link
+	@param pRegion The page area to look for the text in (NULL for the whole page)
 */
-void CCPrintData::AddLink(const std::tstring& sURL, const std::tstring& sText, int nPage, int nRepeat /* = 1 */)
+void CCPrintData::AddLink(const std::tstring& sURL, const std::tstring& sText, int nPage, int nRepeat /* = 1 */, const RECTL* pRegion /* = NULL */)
 {
 	// Ensure we have enough pages
 	EnsurePage(nPage);
 	// Add the new link data
-	m_pages[nPage - 1].push_back(LinkData(sURL, sText, nRepeat));
+	m_pages[nPage - 1].push_back(LinkData(sURL, sText, nRepeat, NULL, pRegion));
 }
 
 /**
@@ -50,27 +50,28 @@ public:
 		/**
 			@brief Default constructor
 		*/
-		LinkData() : nRepeat(1), nPage(0) {rectLocation.left = rectLocation.right = rectLocation.top = rectLocation.bottom = 0; ptOffset.x = ptOffset.y = 0;};
+		LinkData() : nRepeat(1), nPage(0) {rectLocation.left = rectLocation.right = rectLocation.top = rectLocation.bottom = 0; ptOffset.x = ptOffset.y = 0; ClearRegion();};
 		/**
 			@brief Copy constructor
 			@param other The link data to copy
 		*/
-		LinkData(const LinkData& other) : sText(other.sText), sURL(other.sURL), sTitle(other.sTitle), nRepeat(other.nRepeat), rectLocation(other.rectLocation), ptOffset(other.ptOffset), nPage(other.nPage) {};
+		LinkData(const LinkData& other) : sText(other.sText), sURL(other.sURL), sTitle(other.sTitle), nRepeat(other.nRepeat), rectLocation(other.rectLocation), nPage(other.nPage), ptOffset(other.ptOffset), rectRegion(other.rectRegion) {};
 		/**
 			@brief Create a text-based link data
 			@param sU The URL
 			@param sT The text to find
 			@param n The repeat count
 			@param lpTitle The link tooltip (future)
+			@param pRegion The page area to look for the text in (NULL for the whole page)
 		*/
-		LinkData(const std::tstring& sU, const std::tstring& sT, int n, LPCTSTR lpTitle = NULL) : sURL(sU), sText(sT), nRepeat(n), nPage(0), sTitle(lpTitle == NULL ? _T("") : lpTitle) {CleanText();};
+		LinkData(const std::tstring& sU, const std::tstring& sT, int n, LPCTSTR lpTitle = NULL, const RECTL* pRegion = NULL) : sText(sT), sURL(sU), sTitle(lpTitle == NULL ? _T("") : lpTitle), nRepeat(n), nPage(0) {CleanText(); if (pRegion != NULL) rectRegion = *pRegion; else ClearRegion();};
 		/**
 			@brief Creates a location-based link data
 			@param sU The URL
 			@param rect The location
 			@param lpTitle The link tooltip (future)
 		*/
-		LinkData(const std::tstring& sU, const RECTL& rect, LPCTSTR lpTitle = NULL) : sURL(sU), rectLocation(rect), nPage(0), sTitle(lpTitle == NULL ? _T("") : lpTitle) {};
+		LinkData(const std::tstring& sU, const RECTL& rect, LPCTSTR lpTitle = NULL) : sURL(sU), sTitle(lpTitle == NULL ? _T("") : lpTitle), rectLocation(rect), nPage(0) {ClearRegion();};
 		/**
 			@brief Creates a location-based internal link data
 			@param rect The link location
@@ -79,7 +80,7 @@ public:
 			@param lY The Y offset to link to
 			@param lpTitle The link tooltip (future)
 		*/
-		LinkData(const RECTL& rect, int nP, long lX, long lY, LPCTSTR lpTitle = NULL) : nRepeat(1), nPage(nP), rectLocation(rect), sTitle(lpTitle == NULL ? _T("") : lpTitle) {CleanText(); ptOffset.x = lX; ptOffset.y = lY;};
+		LinkData(const RECTL& rect, int nP, long lX, long lY, LPCTSTR lpTitle = NULL) : sTitle(lpTitle == NULL ? _T("") : lpTitle), nRepeat(1), rectLocation(rect), nPage(nP) {CleanText(); ptOffset.x = lX; ptOffset.y = lY; ClearRegion();};
 
 		// Data
 		/// Text of link; empty for location links
@@ -96,6 +97,8 @@ public:
 		int				nPage;
 		/// Offset in page (internal links only)
 		POINTL			ptOffset;
+		/// Page area to look for the text in (text links only; empty for the whole page)
+		RECTL			rectRegion;
 
 		/// Write the data in an INI file format
 		bool			ToFile(std::tstring& sData, int nNum) const;
@@ -111,6 +114,15 @@ public:
 			@return true if this is an internal link, false for external (URL) links
 		*/
 		bool			IsInner() const {return IsLocation() && (nPage != 0);};
+		/**
+			@brief Checks if the text of a text link is only looked for in a part of the page
+			@return true if the link has a search region, false if the whole page is searched
+		*/
+		bool			HasRegion() const {return !IsLocation() && (rectRegion.right > rectRegion.left) && (rectRegion.bottom > rectRegion.top);};
+		/**
+			@brief Sets the link to be looked for in the whole page
+		*/
+		void			ClearRegion() {rectRegion.left = rectRegion.right = rectRegion.top = rectRegion.bottom = 0;};
 		/// Cleans the text-link representation
 		void			CleanText();
 	};
@@ -143,6 +155,8 @@ public:
 			@return true if there's a text link, false if all the links are location-based
 		*/
 		bool			HasTextLink() const {for (const_iterator i = begin(); i != end(); i++) if (!(*i).IsLocation()) return true; return false;};
+		/// Lists the page areas the text links are looked for in
+		bool			GetTextRegions(std::vector<RECTL>& arRegions) const;
 		/**
 			@brief Clears the page data
 		*/
@@ -193,7 +207,7 @@ public:
 	*/
 	void	SetTestPage(bool bSet = true) {m_bTestPage = bSet;};
 	/// Add a text-based link data
-	void	AddLink(const std::tstring& sURL, const std::tstring& sText, int nPage, int nRepeat = 1);
+	void	AddLink(const std::tstring& sURL, const std::tstring& sText, int nPage, int nRepeat = 1, const RECTL* pRegion = NULL);
 	/// Add a location-based link data
 	void	AddLink(const std::tstring& sURL, const RECTL& rect, int nPage, LPCTSTR lpTitle = NULL);
 	/// Add a location-based INTERNAL link data
@@ -275,7 +275,7 @@ bool FileINI::LoadINIFile(LPCTSTR lpFilename)
 {
 	// Open the file for reading, in text mode
 	FILE* pFile;		
-	if (NULL != _tfopen_s(&pFile, lpFilename, _T("rt")))
+	if (0 != _tfopen_s(&pFile, lpFilename, _T("rt")))
 		return false;
 
 	// Clean old data
@@ -292,16 +292,15 @@ bool FileINI::LoadINIFile(LPCTSTR lpFilename)
 	fseek(pFile, 0, SEEK_SET);
 
 	// Create buffer
-	m_pData = new char[(lSize + 1) * 2];
+	m_pData = new char[lSize + 2 * sizeof(TCHAR)];
 	m_bOwn = true;
 
 	// Read the file
 	lReadSize = fread(m_pData, 1, lSize, pFile);
 	fclose(pFile);
 
-	// Terminate
-	m_pData[lReadSize] = (char)'\0';
-	m_pData[lReadSize+1] = (char)'\0';
+	// Terminate (as a character string or a TCHAR one)
+	memset(m_pData + lReadSize, 0, sizeof(TCHAR));
 
 	// Set up unicode (if it is unicode)
 	m_bUnicode = TestUnicode();
@@ -364,7 +363,7 @@ bool FileINI::GetLines(LPCTSTR pFilename, LPCTSTR pSection, TCHARSTRLIST& listLi
 {
 	// Open the file for reading, in text mode
 	FILE* pFile;
-	if (NULL != _tfopen_s(&pFile, pFilename, _T("rt")))
+	if (0 != _tfopen_s(&pFile, pFilename, _T("rt")))
 		return false;
 
 	// Check Unicodeness
@@ -448,7 +447,7 @@ bool FileINI::GetKeys(LPCTSTR pFilename, LPCTSTR pSection, INILINELIST& listLine
 {
 	// Open the file for reading, in text mode
 	FILE* pFile;
-	if (NULL != _tfopen_s(&pFile, pFilename, _T("rt")))
+	if (0 != _tfopen_s(&pFile, pFilename, _T("rt")))
 		return false;
 
 	// Check Unicodeness
@@ -737,7 +736,8 @@ bool ReplaceVariables(LPCTSTR pValue, const TCHARSTR2STRLIST& lVariables, TCHARS
 */
 bool FileINI::ReplaceVariables(LPCTSTR pValue, const TCHARSTR2STRLIST& lVariables, TCHARSTRLIST& lResults)
 {
-	return ::ReplaceVariables(pValue, lVariables, lVariables.begin(), lResults);
+	TCHARSTR2STRLIST::const_iterator iPos = lVariables.begin();
+	return ::ReplaceVariables(pValue, lVariables, iPos, lResults);
 }
 
 /**
@@ -749,7 +749,7 @@ bool FileINI::GetAllSections(LPCTSTR pFilename, TCHARSTRLIST& lSections)
 {
 	// Open the file for reading, in text mode
 	FILE* pFile;
-	if (NULL != _tfopen_s (&pFile, pFilename, _T("rt")))
+	if (0 != _tfopen_s (&pFile, pFilename, _T("rt")))
 		return false;
 
 	// Check Unicodeness
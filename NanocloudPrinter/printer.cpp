@@ -17,6 +17,7 @@
 #include <boost/asio.hpp>
 #include "Helpers.h"
 #include <io.h>
+#include "../redmon/redring.h"
 
 using boost::asio::ip::tcp;
 
@@ -24,6 +25,14 @@ using boost::asio::ip::tcp;
 
 /// Input file pointer
 FILE* fileInput;
+/// Shared memory ring used instead of fileInput when RedMon sets REDMON_RING
+REDMON_RING_HANDLES ringInput = { NULL, NULL, NULL, NULL, NULL, NULL, 0, 0, FALSE };
+/// Buffer for single characters read from the ring
+BYTE cRing[4096];
+/// Length of data in the ring buffer
+DWORD nRing = 0;
+/// Current location in the ring buffer
+DWORD nInRing = 0;
 /// Initial input buffer
 char cBuffer[MAX_PATH * 2 + 1];
 /// Length of data in initial buffer
@@ -34,6 +43,22 @@ int nInBuffer = 0;
 #define MAX_ERR		1023
 /// Error string buffer
 char cErr[MAX_ERR + 1];
+/// Start of the driver's text layer lines (they go to a file next to the PDF, not to GhostScript)
+#define TEXTLAYER_MARK		"%%TextLayer: "
+/// Length of TEXTLAYER_MARK
+#define TEXTLAYER_MARK_LEN	13
+/// Text layer file path (empty if there's no output file)
+char cTextLayerPath[MAX_PATH + 16] = "";
+/// Text layer file, opened with the first text layer line
+FILE* fileTextLayer = NULL;
+/// Characters read while checking for a text layer line, still to be passed to GhostScript
+char cPending[TEXTLAYER_MARK_LEN];
+/// Length of data in the pending buffer
+int nPending = 0;
+/// Current location in the pending buffer
+int nInPending = 0;
+/// true if the next character starts a line
+bool bLineStart = true;
 
 #define TEMP_FILENAME "print_"
 #define TEMP_EXTENSION "pdf"
@@ -83,6 +108,135 @@ std::string getTmpPath() {
 	return path;
 }
 
+/**
+	@brief Reads data from the input, either the shared memory ring or fileInput
+	@param buf Buffer to fill with data
+	@param len Length of requested data
+	@return Size of retrieved data (in bytes), less than len only at the end of the data
+*/
+size_t ReadInput(char* buf, size_t len)
+{
+	if (ringInput.ring == NULL)
+		return fread(buf, 1, len, fileInput);
+	size_t nRead = 0;
+	// Anything left over from GetInputChar comes first
+	while ((nRead < len) && (nInRing < nRing))
+		buf[nRead++] = cRing[nInRing++];
+	while (nRead < len)
+	{
+		DWORD dwRead = ring_read(&ringInput, (BYTE*)buf + nRead, (DWORD)(len - nRead));
+		if (dwRead == 0)
+			break;
+		nRead += dwRead;
+	}
+	return nRead;
+}
+
+/**
+	@brief Reads a single character from the input, either the shared memory ring or fileInput
+	@return The character, or EOF at the end of the data
+*/
+int GetInputChar()
+{
+	if (ringInput.ring == NULL)
+		return fgetc(fileInput);
+	if (nInRing >= nRing)
+	{
+		nInRing = 0;
+		nRing = ring_read(&ringInput, cRing, sizeof(cRing));
+		if (nRing == 0)
+			return EOF;
+	}
+	return cRing[nInRing++];
+}
+
+/**
+	@brief Maps the shared memory ring when RedMon passes the data that way
+	(REDMON_RING is set, and the first line of stdin holds the handles of the mapping, its two events and RedMon's process)
+	@return true if the ring is ready, false to read from stdin
+*/
+bool OpenRingInput()
+{
+	char cHandles[64];
+	if (GetEnvironmentVariable(REDMON_RING_VAR, cHandles, sizeof(cHandles)) == 0)
+		return false;
+	// Read the line straight from the pipe, so nothing after it is buffered
+	HANDLE hInput = GetStdHandle(STD_INPUT_HANDLE);
+	DWORD dwRead, nLen = 0;
+	while ((nLen < sizeof(cHandles) - 1) && ReadFile(hInput, cHandles + nLen, 1, &dwRead, NULL) && (dwRead == 1) && (cHandles[nLen] != '\n'))
+		nLen++;
+	cHandles[nLen] = '\0';
+	char* pPos = cHandles;
+	ringInput.hMap = (HANDLE)(ULONG_PTR)_strtoui64(pPos, &pPos, 16);
+	if (*pPos == ',')
+		ringInput.hData = (HANDLE)(ULONG_PTR)_strtoui64(pPos + 1, &pPos, 16);
+	if (*pPos == ',')
+		ringInput.hSpace = (HANDLE)(ULONG_PTR)_strtoui64(pPos + 1, &pPos, 16);
+	if (*pPos == ',')
+		ringInput.hWriter = (HANDLE)(ULONG_PTR)_strtoui64(pPos + 1, &pPos, 16);
+	if ((ringInput.hMap == NULL) || (ringInput.hData == NULL) || (ringInput.hSpace == NULL) || (ringInput.hWriter == NULL))
+		return false;
+	return ring_open(&ringInput);
+}
+
+/**
+	@brief Reads the next character for GhostScript: first the characters put aside, then the initial buffer and then the input
+	@return The character, or EOF at the end of the data
+*/
+int ReadChar()
+{
+	if (nPending > nInPending)
+		return cPending[nInPending++];
+	if (nBuffer > nInBuffer)
+		return cBuffer[nInBuffer++];
+	return GetInputChar();
+}
+
+/**
+	@brief Checks if a line starting with '%' is a text layer line, and if so writes it to the text layer file
+	@return true if the line was a text layer line (and was read to its end), false if not (the characters 
+	read after the '%' are put aside for ReadChar)
+*/
+bool ReadTextLayerLine()
+{
+	// The '%' was already read
+	char cRead[TEXTLAYER_MARK_LEN];
+	cRead[0] = '%';
+	int nRead = 1, ch;
+	while (nRead < TEXTLAYER_MARK_LEN)
+	{
+		ch = ReadChar();
+		if (ch == EOF)
+			break;
+		cRead[nRead++] = (char)ch;
+		if (ch != TEXTLAYER_MARK[nRead - 1])
+			break;
+	}
+	if ((nRead < TEXTLAYER_MARK_LEN) || (cRead[TEXTLAYER_MARK_LEN - 1] != TEXTLAYER_MARK[TEXTLAYER_MARK_LEN - 1]))
+	{
+		// Not one of ours, so GhostScript gets the characters after the '%' next
+		nPending = nRead - 1;
+		nInPending = 0;
+		memcpy(cPending, cRead + 1, nPending);
+		return false;
+	}
+
+	// Copy the rest of the line (without the line break) to the text layer file
+	if ((fileTextLayer == NULL) && (cTextLayerPath[0] != '\0'))
+	{
+		if (fopen_s(&fileTextLayer, cTextLayerPath, "wb") != 0)
+			fileTextLayer = NULL;
+		// Don't try again
+		cTextLayerPath[0] = '\0';
+	}
+	while (((ch = ReadChar()) != EOF) && (ch != '\n'))
+		if ((ch != '\r') && (fileTextLayer != NULL))
+			fputc(ch, fileTextLayer);
+	if (fileTextLayer != NULL)
+		fputc('\n', fileTextLayer);
+	return true;
+}
+
 /**
 	@brief Callback function used by GhostScript to retrieve more data from the input buffer; stops at newlines
 	@param instance Pointer to the GhostScript instance (not used)
@@ -99,16 +253,15 @@ static int GSDLLCALL my_in(void *instance, char *buf, int len)
 	// Read until we reached the wanted size...
     while (count < len) 
 	{
-		// Is there still data in the initial buffer?
-		if (nBuffer > nInBuffer)
-			// Yes, read from there
-			ch = cBuffer[nInBuffer++];
-		else
-			// No, get more data
-			ch = fgetc(fileInput);
+		// Get the next character (from the initial buffer first)
+		ch = ReadChar();
 		if (ch == EOF)
 			// That's it
 			return 0;
+		// Text layer lines are taken out of the PostScript
+		if (bLineStart && (ch == '%') && ReadTextLayerLine())
+			continue;
+		bLineStart = (ch == '\n');
 		// Put the character in the buffer and increate the countn
 		*buf++ = ch;
 		count++;
@@ -155,10 +308,49 @@ static int GSDLLCALL my_err(void *instance, const char *str, int len)
 void CleanInput()
 {
 	char cBuffer[1024];
-	while (fread(cBuffer, 1, 1024, fileInput) > 0)
+	while (ReadInput(cBuffer, 1024) > 0)
 		;
 }
 
+/**
+	@brief Waits for the job environment when started ahead of time by RedMon (WarmStart).
+	RedMon passes the handle of a control pipe in REDMON_CONTROL and writes the job's
+	environment variables to it (Unicode NAME=VALUE strings, ending with an empty string)
+	when the job arrives
+	@return true to go on with the job, false if RedMon closed the pipe without sending a job
+*/
+bool ReadJobEnvironment()
+{
+	char cHandle[32];
+	if (GetEnvironmentVariable("REDMON_CONTROL", cHandle, sizeof(cHandle)) == 0)
+		// Started for a specific job, nothing to wait for
+		return true;
+	HANDLE hControl = (HANDLE)(ULONG_PTR)_strtoui64(cHandle, NULL, 16);
+	SetEnvironmentVariable("REDMON_CONTROL", NULL);
+
+	// Read everything until RedMon closes the pipe
+	std::string sBlock;
+	char cRead[1024];
+	DWORD dwRead;
+	while (ReadFile(hControl, cRead, sizeof(cRead), &dwRead, NULL) && (dwRead > 0))
+		sBlock.append(cRead, dwRead);
+	CloseHandle(hControl);
+	if (sBlock.size() < sizeof(WCHAR))
+		return false;
+
+	// Set each variable
+	std::wstring sEnv((const WCHAR*)sBlock.data(), sBlock.size() / sizeof(WCHAR));
+	std::wstring::size_type nPos = 0, nEnd;
+	while (((nEnd = sEnv.find(L'\0', nPos)) != std::wstring::npos) && (nEnd > nPos))
+	{
+		std::wstring::size_type nEqual = sEnv.find(L'=', nPos + 1);
+		if (nEqual < nEnd)
+			SetEnvironmentVariableW(sEnv.substr(nPos, nEqual - nPos).c_str(), sEnv.substr(nEqual + 1, nEnd - nEqual - 1).c_str());
+		nPos = nEnd + 1;
+	}
+	return true;
+}
+
 /// Command line options used by GhostScript
 const char* ARGS[] =
 {
@@ -184,6 +376,10 @@ const char* ARGS[] =
 */
 int APIENTRY WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
 {
+	// When pre-spawned, wait here until RedMon hands us a job
+	if (!ReadJobEnvironment())
+		return 0;
+
 	srand(time(NULL));
 	// Initialize stuff
 	std::string randomPath = getTmpPath();
@@ -209,15 +405,17 @@ int APIENTRY WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLi
 		ARGS[6] = cInclude;
 	}
 
-	// Get the data from stdin (that's where the redmon port monitor sends it)
+	// Get the data from stdin (that's where the redmon port monitor sends it),
+	// or from shared memory if the port is set up that way
 	fileInput = stdin;
+	OpenRingInput();
 
 	// Check if we have a filename to write to:
 	cPath[0] = '\0';
 	bool bAutoOpen = false;
 	bool bMakeTemp = false;
 	// Read the start of the file; if we have a filename and/or the auto-open flag, they must be there:
-	nBuffer = fread(cBuffer, 1, MAX_PATH * 2, fileInput);
+	nBuffer = (int)ReadInput(cBuffer, MAX_PATH * 2);
 	cBuffer[nBuffer] = EOF;
 
 	// Do we have a %%File: starting the buffer?
@@ -307,6 +505,8 @@ int APIENTRY WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLi
 		}
 	}
 
+	// The driver's text layer (if it writes one) goes next to the PDF
+	sprintf_s(cTextLayerPath, sizeof(cTextLayerPath), "%s.text.jsonl", cPath);
 	
 	// First try to initialize a new GhostScript instance
 	void* pGS;
@@ -329,6 +529,15 @@ int APIENTRY WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLi
 
 	gsapi_exit(pGS);
 	gsapi_delete_instance(pGS);
+	if (fileTextLayer != NULL)
+	{
+		fclose(fileTextLayer);
+		fileTextLayer = NULL;
+	}
+
+	// A broken ring cut the job short, so the PDF isn't complete
+	if (ringInput.broken)
+		return -3;
 
 	// Did we get an error?
 	if (strlen(cErr) > 0)
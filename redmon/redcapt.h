@@ -0,0 +1,52 @@
+/* redcapt.h */
+
+/*
+ * Format of RedMon capture files (.rmc), written when a port has 
+ * a CaptureDirectory and read by redreplay.
+ *
+ * A capture file contains:
+ *   REDMON_CAPTURE_HEADER
+ *   The job environment variables (REDMON_JOB etc.) as a Unicode
+ *     environment block of cbEnvironment bytes.
+ *   Blocks of print data, each a REDMON_CAPTURE_BLOCK followed by
+ *     cbStored bytes, either stored or LZNT1 compressed.
+ *   A final REDMON_CAPTURE_BLOCK with cbData = 0, whose dwTime 
+ *     is the time of EndDocPort.
+ * All times are in milliseconds since StartDocPort.
+ */
+
+#define REDMON_CAPTURE_MAGIC 0x50434d52		/* "RMCP" */
+#define REDMON_CAPTURE_VERSION 1
+#define REDMON_CAPTURE_EXT TEXT(".rmc")
+#define REDMON_CAPTURE_BLOCK_SIZE 65536		/* largest cbData */
+
+#define REDMON_BLOCK_STORED 0
+#define REDMON_BLOCK_LZNT1 1
+
+typedef struct redmon_capture_header_s {
+    DWORD dwMagic;		/* REDMON_CAPTURE_MAGIC */
+    DWORD dwVersion;		/* REDMON_CAPTURE_VERSION */
+    DWORD cbEnvironment;	/* bytes of environment which follow */
+    DWORD dwReserved;
+} REDMON_CAPTURE_HEADER;
+
+typedef struct redmon_capture_block_s {
+    DWORD dwTime;		/* when the data arrived */
+    DWORD dwFlags;		/* REDMON_BLOCK_STORED or REDMON_BLOCK_LZNT1 */
+    DWORD cbData;		/* bytes after decompression */
+    DWORD cbStored;		/* bytes which follow in the file */
+} REDMON_CAPTURE_BLOCK;
+
+/* From ntdll.dll, loaded with GetProcAddress */
+#ifndef COMPRESSION_FORMAT_LZNT1
+#define COMPRESSION_FORMAT_LZNT1 2
+#endif
+#ifndef COMPRESSION_ENGINE_STANDARD
+#define COMPRESSION_ENGINE_STANDARD 0
+#endif
+typedef LONG (WINAPI *PFN_RTLGETCOMPRESSIONWORKSPACESIZE)(USHORT, 
+    PULONG, PULONG);
+typedef LONG (WINAPI *PFN_RTLCOMPRESSBUFFER)(USHORT, PUCHAR, ULONG, 
+    PUCHAR, ULONG, ULONG, PULONG, PVOID);
+typedef LONG (WINAPI *PFN_RTLDECOMPRESSBUFFER)(USHORT, PUCHAR, ULONG, 
+    PUCHAR, ULONG, PULONG);
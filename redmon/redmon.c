@@ -54,6 +54,9 @@
 #include <userenv.h>
 #include "portmon.h"
 #include "redmon.h"
+#include "redstats.h"
+#include "redcapt.h"
+#include "redring.h"
 #ifdef BETA
 #include <time.h>
 #endif
@@ -81,6 +84,19 @@ const TCHAR version[] = VERSION;
 #define PRINTERRORKEY TEXT("PrintError")
 #define LASTUSERKEY TEXT("LastUser")
 #define LASTFILEKEY TEXT("LastFile")
+#define WARMSTARTKEY TEXT("WarmStart")
+#define CAPTUREDIRKEY TEXT("CaptureDirectory")
+#define CAPTUREBUDGETKEY TEXT("CaptureBudget")
+#define WORKERSKEY TEXT("Workers")
+#define SHAREDMEMKEY TEXT("SharedMemory")
+#define JOBMEMORYKEY TEXT("JobMemory")
+#define JOBCPUWEIGHTKEY TEXT("JobCpuWeight")
+#define JOBPRIORITYKEY TEXT("JobPriority")
+#define JOBAFFINITYKEY TEXT("JobAffinity")
+#define FIFOQUEUEKEY TEXT("FifoQueue")
+#define DROPFILEKEY TEXT("DropFile")
+#define SESSIONSNAME TEXT("Sessions")
+#define WEIGHTKEY TEXT("Weight")
 #define REDMONUSERKEY TEXT("Software\\Ghostgum\\RedMon")
 typedef struct reconfig_s {
     DWORD dwSize;	/* sizeof this structure */
@@ -98,8 +114,70 @@ typedef struct reconfig_s {
     TCHAR szLogFileName[MAXSTR];
     DWORD dwLogFileDebug;
     DWORD dwPrintError;
+    DWORD dwWarmStart;	/* keep a pre-spawned converter per session */
+    TCHAR szCaptureDir[MAXSTR];	/* directory for job captures */
+    DWORD dwCaptureBudget;	/* megabytes of captures to keep */
+    DWORD dwWorkers;		/* convert jobs in parallel if non-zero */
+    DWORD dwSharedMemory;	/* pass data in shared memory, not stdin */
+    DWORD dwJobMemory;		/* megabytes of memory for each session */
+    DWORD dwJobCpuWeight;	/* CPU weight 1-9 for each session */
+    DWORD dwJobPriority;	/* priority class of converters */
+    DWORD dwJobAffinity;	/* processors converters may use */
+    DWORD dwFifoQueue;		/* workers take jobs in the order printed */
+    DWORD dwDropFile;		/* discard drop-file jobs without a converter */
 };
 
+/* Pre-spawned converter, waiting for a job on its control pipe */
+#define WARM_SLOTS 4	/* number of sessions with a waiting converter */
+#define WARM_WAIT 10000	/* ms to wait for a converter still being spawned */
+#define POOL_MAX_WORKERS 16	/* most converter workers for a port */
+#define POOL_FLOWS 32		/* sessions with fair queue state */
+#define POOL_MAX_SKIPS 8	/* times a job may be overtaken in its session */
+#define POOL_MAX_WEIGHT 100	/* largest session weight */
+typedef struct warm_s {
+    BOOL ready;			/* true if process is waiting for a job */
+    TCHAR user[MAXSTR];		/* user the process was started for */
+    TCHAR session[MAXSTR];	/* session the process was started for */
+    TCHAR command[1024];	/* command line of the process */
+    DWORD last_used;		/* tick count when slot was last used */
+    HANDLE hthread;		/* thread spawning the process */
+    HANDLE hControlWr;		/* We write the job environment to this one */
+    HANDLE hChildStdinRd;
+    HANDLE hChildStdinWr;
+    HANDLE hChildStdoutRd;
+    HANDLE hChildStdoutWr;
+    HANDLE hChildStderrRd;
+    HANDLE hChildStderrWr;
+    PROCESS_INFORMATION piProcInfo;
+} WARM;
+
+/* First line of a job which is to be discarded */
+#define DROPFILE_MARK "%%File: :dropfile:"
+#define DROPFILE_LEN (sizeof(DROPFILE_MARK)-1)
+
+/* Fair queue state for the jobs of one session and user */
+typedef struct pool_flow_s {
+    TCHAR session[MAXSTR];
+    TCHAR user[MAXSTR];
+    DWORDLONG finish;		/* virtual finish time of last job started */
+    int queued;			/* jobs waiting, slot is free if 0 */
+} POOL_FLOW;
+
+/* Job objects limiting the converters of each session */
+#define JOBOBJ_SLOTS 64	/* number of sessions with a job object */
+typedef struct jobobj_s {
+    TCHAR session[MAXSTR];	/* session the job object is for */
+    HANDLE hJob;		/* job object, or NULL if slot unused */
+} JOBOBJ;
+
+typedef struct jobobj_table_s {
+    HANDLE hPort;		/* port owning the table */
+    HANDLE hmutex;		/* To control access to the slots */
+    HANDLE hiocp;		/* completion port for job object messages */
+    HANDLE hthread;		/* thread counting job object messages */
+    JOBOBJ slot[JOBOBJ_SLOTS];
+} JOBOBJ_TABLE;
+
 struct redata_s {
     /* Members required by all RedMon implementations */
     HANDLE hPort;		/* handle to this structure */
@@ -154,11 +232,73 @@ struct redata_s {
 
     /* for output to second printer queue */
     TCHAR tempname[MAXSTR];	/* temporary file name  */
+    BOOL cancelled;		/* job has been cancelled by us */
+    DWORD start_tick;		/* tick count at StartDocPort */
+
+    /* Capture of the job for replay */
+    TCHAR capture_name[MAXSTR];	/* capture file name */
+    HANDLE capture_file;	/* written only by capture thread */
+    HANDLE capture_hthread;	/* thread compressing and writing capture */
+    HANDLE capture_event;	/* set when data is queued or job ends */
+    HANDLE capture_hmutex;	/* To control access to capture queue */
+    HGLOBAL capture_hbuf;	/* data waiting for capture thread */
+    DWORD capture_length;	/* bytes in capture_hbuf */
+    DWORD capture_tick;		/* time of first byte in capture_hbuf */
+    BOOL capture_end;		/* no more data for capture thread */
+    BOOL capture_dropped;	/* capture thread didn't keep up */
+
+    /* Job to be converted by a worker */
+    TCHAR spoolname[MAXSTR];	/* spool file name */
+    HANDLE spool_file;		/* open while spooling */
+    HGLOBAL pool_next;		/* next job in queue */
+    DWORDLONG spool_length;	/* bytes in spool file */
+    DWORD pool_weight;		/* share of workers for this session */
+    DWORD pool_skips;		/* times overtaken by a shorter job */
+    int pool_flow;		/* fair queue slot */
+
+    REDMON_RING_HANDLES ring;	/* shared memory used instead of stdin */
+
+    /* Converter held back until we know the job isn't dropped */
+    BOOL launch_pending;	/* converter not started yet */
+    BOOL dropping;		/* discard the rest of the job */
+    BYTE sniff[DROPFILE_LEN+1];	/* start of job, held while pending */
+    DWORD sniff_length;		/* bytes in sniff */
+
     HANDLE printer;		/* handle to a printer */ 
     DWORD printer_bytes;
     BYTE pipe_buf[PIPE_BUF_SIZE]; /* buffer for use in flush_stdout */
+
+    /* Port statistics, kept between jobs (not reset) */
+    HANDLE stats_hmap;		/* shared memory for stats */
+    HANDLE stats_hmutex;	/* To serialise updates of stats */
+    REDMON_STATS *stats;	/* view of stats_hmap */
+
+    /* Converter workers, kept between jobs (not reset) */
+    HANDLE pool_hmutex;		/* To control access to the pool */
+    HANDLE pool_event;		/* set when a queued job may be ready */
+    HGLOBAL pool_head;		/* queued jobs, oldest first */
+    BOOL pool_shutdown;		/* port is closing */
+    int pool_workers;		/* worker threads started */
+    HANDLE pool_hthread[POOL_MAX_WORKERS];
+    TCHAR pool_session[POOL_MAX_WORKERS][MAXSTR]; /* session being converted */
+    DWORDLONG pool_vtime;	/* virtual time of the fair queue */
+    POOL_FLOW pool_flow[POOL_FLOWS];
+
+    /* Pre-spawned converters, kept between jobs (not reset) */
+    HANDLE warm_hmutex;		/* To control access to warm slots */
+    WARM warm[WARM_SLOTS];
+
+    /* Session job objects, shared with queued jobs (not reset) */
+    JOBOBJ_TABLE *jobobj;
 };
 
+/* Details passed to WarmThread */
+typedef struct warm_spawn_s {
+    HANDLE hPort;	/* port owning the slot */
+    int slot;		/* slot to fill */
+    REDATA rd;		/* private copy of the job details */
+} WARM_SPAWN;
+
 void write_error(REDATA *prd, DWORD err);
 void write_string_to_log(REDATA *prd, LPCTSTR buf);
 void redmon_cancel_job(REDATA *prd);
@@ -180,6 +320,38 @@ BOOL make_env(REDATA * prd);
 BOOL query_session_id(REDATA * prd);
 BOOL get_filename_as_user(REDATA * prd);
 BOOL redmon_print_error(REDATA *prd);
+void stats_open(REDATA *prd);
+void stats_close(REDATA *prd);
+BOOL stats_begin(REDATA *prd);
+void stats_end(REDATA *prd);
+void stats_job_start(REDATA *prd, BOOL flag);
+void stats_job_end(REDATA *prd);
+void capture_start(REDATA *prd);
+void capture_write(REDATA *prd, LPBYTE pBuffer, DWORD cbBuf);
+void capture_finish(REDATA *prd);
+void close_handle(HANDLE *ph);
+void redmon_close_handles(REDATA *prd);
+BOOL redmon_launch(REDATA *prd);
+BOOL redmon_start_job(REDATA *prd);
+BOOL dropfile_allowed(REDATA *prd);
+BOOL dropfile_launch(REDATA *prd);
+BOOL dropfile_write(REDATA *prd, LPBYTE pBuffer, DWORD cbBuf, 
+    LPDWORD pcbWritten);
+BOOL dropfile_end(REDATA *prd);
+void pool_init(REDATA *prd);
+BOOL pool_allowed(REDATA *prd);
+BOOL pool_spool_start(REDATA *prd);
+BOOL pool_spool_write(REDATA *prd, LPBYTE pBuffer, DWORD cbBuf, 
+    LPDWORD pcbWritten);
+BOOL pool_spool_end(REDATA *prd);
+void pool_shutdown(REDATA *prd);
+void warm_init(REDATA *prd);
+BOOL warm_take(REDATA *prd);
+void warm_shutdown(REDATA *prd);
+void jobobj_init(REDATA *prd);
+BOOL jobobj_wanted(REDATA *prd);
+void jobobj_assign(REDATA *prd);
+void jobobj_shutdown(REDATA *prd);
 
 /* we don't rely on the import library having XcvData,
  * since we may be compiling with VC++ 5.0 */
@@ -204,6 +376,8 @@ BOOL WINAPI XcvData(HANDLE hXcv, LPCWSTR pszDataName,
 #define REDMON_DOCNAME  TEXT("REDMON_DOCNAME=")
 #define REDMON_FILENAME  TEXT("REDMON_FILENAME=")
 #define REDMON_SESSIONID  TEXT("REDMON_SESSIONID=")
+#define REDMON_CONTROL  TEXT("REDMON_CONTROL=")
+#define REDMON_RINGENV  TEXT("REDMON_RING=")
 #define REDMON_TEMP     TEXT("TEMP=")
 #define REDMON_TMP      TEXT("TMP=")
 
@@ -411,6 +585,39 @@ BOOL redmon_get_config(HANDLE hMonitor, LPCTSTR portname, RECONFIG *config)
     cbData = sizeof(config->dwPrintError);
     rc = RedMonQueryValue(hMonitor, hkey, PRINTERRORKEY, &dwType, 
 	(PBYTE)(&config->dwPrintError), &cbData);
+    cbData = sizeof(config->dwWarmStart);
+    rc = RedMonQueryValue(hMonitor, hkey, WARMSTARTKEY, &dwType, 
+	(PBYTE)(&config->dwWarmStart), &cbData);
+    cbData = sizeof(config->szCaptureDir)-sizeof(TCHAR);
+    rc = RedMonQueryValue(hMonitor, hkey, CAPTUREDIRKEY, &dwType, 
+	(PBYTE)(config->szCaptureDir), &cbData);
+    cbData = sizeof(config->dwCaptureBudget);
+    rc = RedMonQueryValue(hMonitor, hkey, CAPTUREBUDGETKEY, &dwType, 
+	(PBYTE)(&config->dwCaptureBudget), &cbData);
+    cbData = sizeof(config->dwWorkers);
+    rc = RedMonQueryValue(hMonitor, hkey, WORKERSKEY, &dwType, 
+	(PBYTE)(&config->dwWorkers), &cbData);
+    cbData = sizeof(config->dwSharedMemory);
+    rc = RedMonQueryValue(hMonitor, hkey, SHAREDMEMKEY, &dwType, 
+	(PBYTE)(&config->dwSharedMemory), &cbData);
+    cbData = sizeof(config->dwJobMemory);
+    rc = RedMonQueryValue(hMonitor, hkey, JOBMEMORYKEY, &dwType, 
+	(PBYTE)(&config->dwJobMemory), &cbData);
+    cbData = sizeof(config->dwJobCpuWeight);
+    rc = RedMonQueryValue(hMonitor, hkey, JOBCPUWEIGHTKEY, &dwType, 
+	(PBYTE)(&config->dwJobCpuWeight), &cbData);
+    cbData = sizeof(config->dwJobPriority);
+    rc = RedMonQueryValue(hMonitor, hkey, JOBPRIORITYKEY, &dwType, 
+	(PBYTE)(&config->dwJobPriority), &cbData);
+    cbData = sizeof(config->dwJobAffinity);
+    rc = RedMonQueryValue(hMonitor, hkey, JOBAFFINITYKEY, &dwType, 
+	(PBYTE)(&config->dwJobAffinity), &cbData);
+    cbData = sizeof(config->dwFifoQueue);
+    rc = RedMonQueryValue(hMonitor, hkey, FIFOQUEUEKEY, &dwType, 
+	(PBYTE)(&config->dwFifoQueue), &cbData);
+    cbData = sizeof(config->dwDropFile);
+    rc = RedMonQueryValue(hMonitor, hkey, DROPFILEKEY, &dwType, 
+	(PBYTE)(&config->dwDropFile), &cbData);
     RedMonCloseKey(hMonitor, hkey);
     return TRUE;
 }
@@ -474,6 +681,40 @@ BOOL redmon_set_config(HANDLE hMonitor, RECONFIG *config)
     if (rc == ERROR_SUCCESS)
 	rc = RedMonSetValue(hMonitor, hkey, PRINTERRORKEY, REG_DWORD, 
 	    (PBYTE)(&config->dwPrintError), sizeof(config->dwPrintError));
+    if (rc == ERROR_SUCCESS)
+	rc = RedMonSetValue(hMonitor, hkey, WARMSTARTKEY, REG_DWORD, 
+	    (PBYTE)(&config->dwWarmStart), sizeof(config->dwWarmStart));
+    if (rc == ERROR_SUCCESS)
+	rc = RedMonSetValue(hMonitor, hkey, CAPTUREDIRKEY, REG_SZ, 
+	    (PBYTE)(config->szCaptureDir), 
+	    sizeof(TCHAR)*(lstrlen(config->szCaptureDir)+1));
+    if (rc == ERROR_SUCCESS)
+	rc = RedMonSetValue(hMonitor, hkey, CAPTUREBUDGETKEY, REG_DWORD, 
+	    (PBYTE)(&config->dwCaptureBudget), sizeof(config->dwCaptureBudget));
+    if (rc == ERROR_SUCCESS)
+	rc = RedMonSetValue(hMonitor, hkey, WORKERSKEY, REG_DWORD, 
+	    (PBYTE)(&config->dwWorkers), sizeof(config->dwWorkers));
+    if (rc == ERROR_SUCCESS)
+	rc = RedMonSetValue(hMonitor, hkey, SHAREDMEMKEY, REG_DWORD, 
+	    (PBYTE)(&config->dwSharedMemory), sizeof(config->dwSharedMemory));
+    if (rc == ERROR_SUCCESS)
+	rc = RedMonSetValue(hMonitor, hkey, JOBMEMORYKEY, REG_DWORD, 
+	    (PBYTE)(&config->dwJobMemory), sizeof(config->dwJobMemory));
+    if (rc == ERROR_SUCCESS)
+	rc = RedMonSetValue(hMonitor, hkey, JOBCPUWEIGHTKEY, REG_DWORD, 
+	    (PBYTE)(&config->dwJobCpuWeight), sizeof(config->dwJobCpuWeight));
+    if (rc == ERROR_SUCCESS)
+	rc = RedMonSetValue(hMonitor, hkey, JOBPRIORITYKEY, REG_DWORD, 
+	    (PBYTE)(&config->dwJobPriority), sizeof(config->dwJobPriority));
+    if (rc == ERROR_SUCCESS)
+	rc = RedMonSetValue(hMonitor, hkey, JOBAFFINITYKEY, REG_DWORD, 
+	    (PBYTE)(&config->dwJobAffinity), sizeof(config->dwJobAffinity));
+    if (rc == ERROR_SUCCESS)
+	rc = RedMonSetValue(hMonitor, hkey, FIFOQUEUEKEY, REG_DWORD, 
+	    (PBYTE)(&config->dwFifoQueue), sizeof(config->dwFifoQueue));
+    if (rc == ERROR_SUCCESS)
+	rc = RedMonSetValue(hMonitor, hkey, DROPFILEKEY, REG_DWORD, 
+	    (PBYTE)(&config->dwDropFile), sizeof(config->dwDropFile));
     RedMonCloseKey(hMonitor, hkey);
     return (rc == ERROR_SUCCESS);
 }
@@ -544,11 +785,183 @@ reset_redata(REDATA *prd)
     prd->write_buffer = NULL;
     prd->write_buffer_length = 0;
     prd->tempname[0] = '\0';
+    prd->cancelled = FALSE;
+    prd->start_tick = 0;
+    prd->capture_name[0] = '\0';
+    prd->capture_file = INVALID_HANDLE_VALUE;
+    prd->capture_hthread = INVALID_HANDLE_VALUE;
+    prd->capture_event = INVALID_HANDLE_VALUE;
+    prd->capture_hmutex = INVALID_HANDLE_VALUE;
+    prd->capture_hbuf = NULL;
+    prd->capture_length = 0;
+    prd->capture_tick = 0;
+    prd->capture_end = FALSE;
+    prd->capture_dropped = FALSE;
+    prd->spoolname[0] = '\0';
+    prd->spool_file = INVALID_HANDLE_VALUE;
+    prd->pool_next = NULL;
+    prd->spool_length = 0;
+    prd->pool_weight = 1;
+    prd->pool_skips = 0;
+    prd->pool_flow = 0;
+    prd->ring.ring = NULL;
+    prd->ring.hMap = NULL;
+    prd->ring.hData = NULL;
+    prd->ring.hSpace = NULL;
+    prd->launch_pending = FALSE;
+    prd->dropping = FALSE;
+    prd->sniff_length = 0;
     prd->printer = INVALID_HANDLE_VALUE;
     prd->printer_bytes = 0;
 	prd->primary_token = NULL;
 }
 
+/* Open the shared memory block for port statistics.
+ * Statistics are optional, so failure is ignored.
+ */
+void
+stats_open(REDATA *prd)
+{
+TCHAR name[MAXSTR];
+LPTSTR s;
+BOOL bCreated;
+    prd->stats_hmap = NULL;
+    prd->stats_hmutex = NULL;
+    prd->stats = NULL;
+    lstrcpy(name, REDMON_STATS_NAME);
+    s = name + lstrlen(name);
+    lstrcpyn(s, prd->portname, MAXSTR - lstrlen(name));
+    for (; *s; s++) {
+	if (*s == '\\')
+	    *s = '_';
+    }
+    prd->stats_hmap = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, 
+	PAGE_READWRITE, 0, sizeof(REDMON_STATS), name);
+    if (prd->stats_hmap == NULL)
+	return;
+    bCreated = (GetLastError() != ERROR_ALREADY_EXISTS);
+    prd->stats = (REDMON_STATS *)MapViewOfFile(prd->stats_hmap, 
+	FILE_MAP_WRITE, 0, 0, sizeof(REDMON_STATS));
+    if (prd->stats == NULL) {
+	CloseHandle(prd->stats_hmap);
+	prd->stats_hmap = NULL;
+	return;
+    }
+    if (bCreated) {
+	/* new mappings are zero filled */
+	prd->stats->dwSize = sizeof(REDMON_STATS);
+	prd->stats->dwVersion = REDMON_STATS_VERSION;
+    }
+    else if ((prd->stats->dwSize != sizeof(REDMON_STATS)) ||
+	(prd->stats->dwVersion != REDMON_STATS_VERSION)) {
+	/* Left over from another build of RedMon, or owned by 
+	 * something else.  Don't write our layout over it. */
+	UnmapViewOfFile(prd->stats);
+	prd->stats = NULL;
+	CloseHandle(prd->stats_hmap);
+	prd->stats_hmap = NULL;
+	return;
+    }
+    /* jobs converted by workers update the stats at the same time */
+    prd->stats_hmutex = CreateMutex(NULL, FALSE, NULL);
+    if (prd->stats_hmutex == NULL)
+	stats_close(prd);
+}
+
+void
+stats_close(REDATA *prd)
+{
+    if (prd->stats != NULL)
+	UnmapViewOfFile(prd->stats);
+    prd->stats = NULL;
+    if (prd->stats_hmap != NULL)
+	CloseHandle(prd->stats_hmap);
+    prd->stats_hmap = NULL;
+    if (prd->stats_hmutex != NULL)
+	CloseHandle(prd->stats_hmutex);
+    prd->stats_hmutex = NULL;
+}
+
+/* Start updating statistics.  Returns FALSE if they aren't available. 
+ * Every stats_begin() which returns TRUE must be followed by stats_end().
+ */
+BOOL
+stats_begin(REDATA *prd)
+{
+    if (prd->stats == NULL)
+	return FALSE;
+    WaitForSingleObject(prd->stats_hmutex, INFINITE);
+    InterlockedIncrement(&prd->stats->lSequence);
+    return TRUE;
+}
+
+void
+stats_end(REDATA *prd)
+{
+    InterlockedIncrement(&prd->stats->lSequence);
+    ReleaseMutex(prd->stats_hmutex);
+}
+
+/* Record the start of a job.  flag is FALSE if the converter 
+ * couldn't be started.
+ */
+void
+stats_job_start(REDATA *prd, BOOL flag)
+{
+    prd->start_tick = GetTickCount();
+    if (!stats_begin(prd))
+	return;
+    FillMemory((PVOID)&prd->stats->job, sizeof(prd->stats->job), 0);
+    prd->stats->dwJobId = prd->JobId;
+    prd->stats->dwJobs++;
+    if (flag)
+	prd->stats->dwActive++;
+    else
+	prd->stats->dwErrors++;
+    stats_end(prd);
+}
+
+/* Record the end of a job, including converter CPU time 
+ * and memory.  Call this before closing the process handle.
+ */
+void
+stats_job_end(REDATA *prd)
+{
+DWORDLONG cpu_ms = 0;
+DWORDLONG peak_memory = 0;
+#if defined(UNICODE) && (defined(NT40) || defined(NT50)) && !defined(__BORLANDC__)
+FILETIME ftCreation, ftExit, ftKernel, ftUser;
+PROCESS_MEMORY_COUNTERS pmc;
+    if (prd->piProcInfo.hProcess != INVALID_HANDLE_VALUE) {
+	if (GetProcessTimes(prd->piProcInfo.hProcess, &ftCreation, &ftExit,
+	    &ftKernel, &ftUser)) {
+	    /* FILETIME is in 100ns units */
+	    cpu_ms = ((((DWORDLONG)ftKernel.dwHighDateTime << 32) + 
+		ftKernel.dwLowDateTime) + 
+		(((DWORDLONG)ftUser.dwHighDateTime << 32) + 
+		ftUser.dwLowDateTime)) / 10000;
+	}
+	pmc.cb = sizeof(pmc);
+	if (GetProcessMemoryInfo(prd->piProcInfo.hProcess, &pmc, sizeof(pmc)))
+	    peak_memory = pmc.PeakWorkingSetSize;
+    }
+#endif
+    if (!stats_begin(prd))
+	return;
+    prd->stats->job.dwDurationMs = GetTickCount() - prd->start_tick;
+    prd->stats->job.qwCpuMs = cpu_ms;
+    prd->stats->job.qwPeakMemory = peak_memory;
+    prd->stats->total.dwDurationMs += prd->stats->job.dwDurationMs;
+    prd->stats->total.qwCpuMs += cpu_ms;
+    if (peak_memory > prd->stats->total.qwPeakMemory)
+	prd->stats->total.qwPeakMemory = peak_memory;
+    if (prd->error && prd->started)
+	prd->stats->dwErrors++;
+    if (prd->stats->dwActive)
+	prd->stats->dwActive--;
+    stats_end(prd);
+}
+
 /* copy stdout and stderr to log file, if open */
 BOOL
 flush_stdout(REDATA *prd)
@@ -568,6 +981,11 @@ flush_stdout(REDATA *prd)
 	    &dwRead, NULL) || dwRead == 0) 
 	    break;
 	got_something = TRUE;
+	if (stats_begin(prd)) {
+	    prd->stats->job.qwBytesOut += dwRead;
+	    prd->stats->total.qwBytesOut += dwRead;
+	    stats_end(prd);
+	}
 	if (prd->config.dwOutput == OUTPUT_STDOUT) {
 	    if (prd->printer != INVALID_HANDLE_VALUE) {
 		if (!redmon_write_printer(prd, prd->pipe_buf, dwRead)) {
@@ -609,6 +1027,11 @@ flush_stdout(REDATA *prd)
 		&dwRead, NULL) || dwRead == 0) 
 		break;
 	    got_something = TRUE;
+	    if (stats_begin(prd)) {
+		prd->stats->job.qwBytesOut += dwRead;
+		prd->stats->total.qwBytesOut += dwRead;
+		stats_end(prd);
+	    }
 	    if (prd->printer != INVALID_HANDLE_VALUE) {
 		if (!redmon_write_printer(prd, prd->pipe_buf, dwRead)) {
 		    redmon_abort_printer(prd);
@@ -681,7 +1104,19 @@ DWORD WINAPI WriteThread(LPVOID lpThreadParameter)
 	WaitForSingleObject(prd->write_event, INFINITE);
 	ResetEvent(prd->write_event);
 	if (prd->write_buffer_length && prd->write_buffer) {
-	    if (! (prd->write_flag = WriteFile(prd->hChildStdinWr, 
+	    if (prd->ring.ring != NULL) {
+		prd->write_flag = ring_write(&prd->ring, prd->write_buffer, 
+		    prd->write_buffer_length, prd->piProcInfo.hProcess);
+		prd->write_written = prd->write_flag ? 
+		    prd->write_buffer_length : 0;
+		if (!prd->write_flag && 
+		    (GetLastError() == ERROR_INVALID_DATA))
+		    write_string_to_log(prd, 
+		      TEXT("\r\nREDMON WriteThread: converter broke the shared memory ring, job failed\r\n"));
+		if (!prd->write_flag)
+		    prd->write = FALSE;	/* get out of here */
+	    }
+	    else if (! (prd->write_flag = WriteFile(prd->hChildStdinWr, 
 		prd->write_buffer, prd->write_buffer_length, 
 		&prd->write_written, NULL)) )
 		prd->write = FALSE;	/* get out of here */
@@ -1090,6 +1525,10 @@ redmon_open_port(HANDLE hMonitor, LPTSTR pName, PHANDLE pHandle)
     prd->hPort = hglobal;
 
     prd->hMonitor = hMonitor;
+    stats_open(prd);
+    warm_init(prd);
+    pool_init(prd);
+    jobobj_init(prd);
 
     /* Do the rest of the opening in rStartDocPort() */
 
@@ -1106,9 +1545,279 @@ redmon_close_port(HANDLE hPort)
     syslog(TEXT("redmon_close_port: calling ClosePort\r\n"));
 #endif
 
-    if (hPort)
+    if (hPort) {
+	REDATA *prd = (REDATA *)GlobalLock((HGLOBAL)hPort);
+	if (prd != (REDATA *)NULL) {
+	    pool_shutdown(prd);
+	    warm_shutdown(prd);
+	    jobobj_shutdown(prd);
+	    stats_close(prd);
+	    GlobalUnlock((HGLOBAL)hPort);
+	}
 	GlobalFree((HGLOBAL)hPort);
+    }
+
+    return TRUE;
+}
+
+/* close all file and object handles of a job which didn't start */
+void
+redmon_close_handles(REDATA *prd)
+{
+    /* CreateFile() and the pipe handles use INVALID_HANDLE_VALUE, 
+     * CreateMutex() returns NULL */
+    if (prd->hLogFile != INVALID_HANDLE_VALUE)
+	CloseHandle(prd->hLogFile);
+    prd->hLogFile = INVALID_HANDLE_VALUE;
+
+    if (prd->hChildStderrRd != INVALID_HANDLE_VALUE)
+	CloseHandle(prd->hChildStderrRd);
+    if (prd->hChildStderrWr != INVALID_HANDLE_VALUE)
+	CloseHandle(prd->hChildStderrWr);
+    if (prd->hChildStdoutRd != INVALID_HANDLE_VALUE)
+	CloseHandle(prd->hChildStdoutRd);
+    if (prd->hChildStdoutWr != INVALID_HANDLE_VALUE)
+	CloseHandle(prd->hChildStdoutWr);
+    if (prd->hChildStdinRd != INVALID_HANDLE_VALUE)
+	CloseHandle(prd->hChildStdinRd);
+    if (prd->hChildStdinWr != INVALID_HANDLE_VALUE)
+	CloseHandle(prd->hChildStdinWr);
+    if (prd->hPipeRd != INVALID_HANDLE_VALUE)
+	CloseHandle(prd->hPipeRd);
+    if (prd->hPipeWr != INVALID_HANDLE_VALUE)
+	CloseHandle(prd->hPipeWr);
+    prd->hChildStderrRd   = INVALID_HANDLE_VALUE;
+    prd->hChildStderrWr   = INVALID_HANDLE_VALUE;
+    prd->hChildStdoutRd   = INVALID_HANDLE_VALUE;
+    prd->hChildStdoutWr   = INVALID_HANDLE_VALUE;
+    prd->hChildStdinRd    = INVALID_HANDLE_VALUE;
+    prd->hChildStdinWr    = INVALID_HANDLE_VALUE;
+    prd->hPipeRd   = INVALID_HANDLE_VALUE;
+    prd->hPipeWr   = INVALID_HANDLE_VALUE;
+#ifdef SAVESTD
+    SetStdHandle(STD_INPUT_HANDLE, prd->hSaveStdin);
+    SetStdHandle(STD_OUTPUT_HANDLE, prd->hSaveStdout);
+    SetStdHandle(STD_ERROR_HANDLE, prd->hSaveStdout);
+#endif
+
+    if ((prd->hmutex != INVALID_HANDLE_VALUE) && (prd->hmutex != NULL))
+	CloseHandle(prd->hmutex);
+    prd->hmutex    = INVALID_HANDLE_VALUE;
+
+    if (prd->ring.ring != NULL)
+	ring_destroy(&prd->ring);
+}
+
+/* Start the converter for a job, with a thread to write to its stdin.
+ * The command line and environment must already be set up.
+ */
+BOOL
+redmon_launch(REDATA *prd)
+{
+    TCHAR buf[MAXSTR];
+    BOOL flag;
+
+    prd->hmutex = CreateMutex(NULL, FALSE, NULL);
+    /* use a pre-spawned converter if one is waiting for this session */
+    flag = warm_take(prd);
+    if (!flag)
+	flag = start_redirect(prd);
+    stats_job_start(prd, flag);
+    if (flag) {
+	/* Only this converter gets handles to the shared memory */
+	if ((prd->ring.ring != NULL) && !ring_give(&prd->ring, 
+	    prd->piProcInfo.hProcess, prd->hChildStdinWr)) {
+	    write_string_to_log(prd, 
+	      TEXT("\r\nREDMON StartDocPort: can't give shared memory to converter, using stdin\r\n"));
+	    ring_destroy(&prd->ring);
+	}
+        WaitForInputIdle(prd->piProcInfo.hProcess, 5000);
+
+	/* Create thread to write to stdin pipe
+	 * We need this to avoid a deadlock when stdin and stdout
+	 * pipes are both blocked.
+	 */
+	prd->write_event = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (prd->write_event == NULL)
+	    write_string_to_log(prd, 
+		TEXT("couldn't create synchronization event\r\n"));
+	prd->write = TRUE;
+	prd->write_hthread = CreateThread(NULL, 0, &WriteThread, 
+		prd->hPort, 0, &prd->write_threadid);
+    }
+    else {
+	DWORD err = GetLastError();
+	/* ENGLISH */
+	if (prd->environment) {
+	    GlobalUnlock(prd->environment);
+	    GlobalFree(prd->environment);
+	    prd->environment = NULL;
+	}
+	wsprintf(buf, 
+	   TEXT("StartDocPort: failed to start process\r\n  Port = %s\r\n  Command = %s\r\n  Error = %ld\r\n"),
+	   prd->portname, prd->command, err);
+	switch(err) {
+	    case ERROR_FILE_NOT_FOUND:
+		lstrcat(buf, TEXT("  File not found\r\n"));
+		break;
+	    case ERROR_PATH_NOT_FOUND:
+		lstrcat(buf, TEXT("  Path not found\r\n"));
+		break;
+	    case ERROR_BAD_PATHNAME:
+		lstrcat(buf, TEXT("  Bad path name\r\n"));
+		break;
+	}
+	write_string_to_log(prd, buf);
+	write_error(prd, err);
+    }
+
+    return flag;
+}
+
+/* Start the converter, or spool the job for a converter worker */
+BOOL
+redmon_start_job(REDATA *prd)
+{
+    BOOL flag;
+
+    /* With converter workers, spool the job and convert it later */
+    if (pool_allowed(prd))
+	flag = pool_spool_start(prd);
+    else
+	flag = redmon_launch(prd);
+    if (flag)
+	capture_start(prd);
+    return flag;
+}
+
+/* Drop-file jobs
+ *
+ * Test pages from the CCPSRendering driver start with the line
+ * "%%File: :dropfile:", which tells the converter to discard the job.
+ * Rather than start a converter just to read and discard the job,
+ * StartDocPort holds the converter back and WritePort looks at the
+ * start of the job.  As soon as the data differs from the drop-file 
+ * line, the converter is started and given the data held so far.
+ * Dropped jobs are discarded by RedMon.
+ * This is only done if DropFile is set for the port, and never for
+ * converters writing to a printer (OUTPUT_STDOUT or OUTPUT_HANDLE).
+ * If the converter can't be started once the job is seen not to be
+ * a drop-file job, the error is logged and WritePort or EndDocPort 
+ * fails, as StartDocPort would have done.
+ */
+
+BOOL
+dropfile_allowed(REDATA *prd)
+{
+    return prd->config.dwDropFile &&
+	(prd->config.dwOutput != OUTPUT_STDOUT) &&
+	(prd->config.dwOutput != OUTPUT_HANDLE);
+}
+
+/* Start the converter for a job which was held back, and write 
+ * the data held in sniff.  If the converter can't be started, 
+ * the job has failed and the rest of it is discarded.
+ */
+BOOL
+dropfile_launch(REDATA *prd)
+{
+    DWORD dwWritten;
+
+    prd->launch_pending = FALSE;
+    if (!redmon_start_job(prd)) {
+	prd->error = TRUE;
+	prd->dropping = TRUE;
+	write_string_to_log(prd, 
+	    TEXT("REDMON: converter could not be started, job failed\r\n"));
+	SetLastError(ERROR_OPEN_FAILED);
+	return FALSE;
+    }
+    if (prd->sniff_length)
+	redmon_write_port(prd, prd->sniff, prd->sniff_length, &dwWritten);
+    prd->sniff_length = 0;
+    return TRUE;
+}
+
+/* WritePort while the converter is held back */
+BOOL
+dropfile_write(REDATA *prd, LPBYTE pBuffer, DWORD cbBuf, 
+    LPDWORD pcbWritten)
+{
+    DWORD held = prd->sniff_length;
+    DWORD count = min(cbBuf, sizeof(prd->sniff) - held);
+    DWORD i;
+
+    *pcbWritten = cbBuf;
+    CopyMemory(prd->sniff + held, pBuffer, count);
+    prd->sniff_length += count;
+
+    for (i=0; (i < prd->sniff_length) && (i < DROPFILE_LEN); i++) {
+	if (prd->sniff[i] != (BYTE)DROPFILE_MARK[i])
+	    break;
+    }
+    if ((i == prd->sniff_length) || (i == DROPFILE_LEN)) {
+	if (prd->sniff_length <= DROPFILE_LEN)
+	    return TRUE;	/* can't tell yet */
+	if ((prd->sniff[DROPFILE_LEN] == '\r') || 
+	    (prd->sniff[DROPFILE_LEN] == '\n')) {
+	    prd->launch_pending = FALSE;
+	    prd->dropping = TRUE;
+	    if (prd->config.dwLogFileDebug)
+		write_string_to_log(prd, 
+		    TEXT("REDMON WritePort: drop-file job, discarding\r\n"));
+	    return TRUE;
+	}
+    }
+
+    /* Not a drop-file job.  The held data from earlier calls goes 
+     * first, then all of this buffer. */
+    prd->sniff_length = held;
+    if (!dropfile_launch(prd)) {
+	*pcbWritten = 0;
+	return FALSE;
+    }
+    return redmon_write_port(prd, pBuffer, cbBuf, pcbWritten);
+}
+
+/* EndDocPort for a job which was discarded, or whose converter 
+ * could not be started */
+BOOL
+dropfile_end(REDATA *prd)
+{
+    HANDLE hPrinter;
+    BOOL failed = prd->error;
+
+    if (failed)
+	write_string_to_log(prd, 
+	    TEXT("REDMON EndDocPort: converter not started, job failed\r\n"));
+    else if (prd->config.dwLogFileDebug)
+	write_string_to_log(prd, 
+	    TEXT("REDMON EndDocPort: drop-file job discarded\r\n"));
+
+    /* As for a converted job, we cancel a dropped print job ourselves.
+     * A failed job is left to the spooler to report. */
+    if (!failed && OpenPrinter(prd->pPrinterName, &hPrinter, NULL)) {
+	SetJob(hPrinter, prd->JobId, 0, NULL, JOB_CONTROL_CANCEL);
+	ClosePrinter(hPrinter);
+    }
 
+    if (prd->config.dwOutput == OUTPUT_FILE)
+	DeleteFile(prd->tempname);
+    if (prd->environment) {
+	GlobalUnlock(prd->environment);
+	GlobalFree(prd->environment);
+	prd->environment = NULL;
+    }
+    if (prd->primary_token != NULL) {
+	CloseHandle(prd->primary_token);
+	prd->primary_token = NULL;
+    }
+    redmon_close_handles(prd);
+    reset_redata(prd);
+    if (failed) {
+	SetLastError(ERROR_OPEN_FAILED);
+	return FALSE;
+    }
     return TRUE;
 }
 
@@ -1301,6 +2010,12 @@ redmon_start_doc_port(REDATA *prd, LPTSTR pPrinterName,
 	CloseHandle(hPipeTemp);
     }
 
+    /* Shared memory for print data, passed in the environment */
+    if (prd->config.dwSharedMemory && 
+	!ring_create(&prd->ring, REDMON_RING_SIZE))
+	write_string_to_log(prd, 
+	  TEXT("\r\nREDMON StartDocPort: shared memory failed, using stdin\r\n"));
+
     query_session_id(prd);
     make_env(prd);
 
@@ -1514,48 +2229,18 @@ redmon_start_doc_port(REDATA *prd, LPTSTR pPrinterName,
 	}
     }
 
-    prd->hmutex = CreateMutex(NULL, FALSE, NULL);
-    flag = start_redirect(prd);
-    if (flag) {
-        WaitForInputIdle(prd->piProcInfo.hProcess, 5000);
+    /* Times in the capture file are from here.  Starting the 
+     * converter sets it again, but pooled jobs don't start it yet. */
+    prd->start_tick = GetTickCount();
 
-	/* Create thread to write to stdin pipe
-	 * We need this to avoid a deadlock when stdin and stdout
-	 * pipes are both blocked.
-	 */
-	prd->write_event = CreateEvent(NULL, TRUE, FALSE, NULL);
-	if (prd->write_event == NULL)
-	    write_string_to_log(prd, 
-		TEXT("couldn't create synchronization event\r\n"));
-	prd->write = TRUE;
-	prd->write_hthread = CreateThread(NULL, 0, &WriteThread, 
-		prd->hPort, 0, &prd->write_threadid);
-    }
-    else {
-	DWORD err = GetLastError();
-	/* ENGLISH */
-	if (prd->environment) {
-	    GlobalUnlock(prd->environment);
-	    GlobalFree(prd->environment);
-	    prd->environment = NULL;
-	}
-	wsprintf(buf, 
-	   TEXT("StartDocPort: failed to start process\r\n  Port = %s\r\n  Command = %s\r\n  Error = %ld\r\n"),
-	   prd->portname, prd->command, err);
-	switch(err) {
-	    case ERROR_FILE_NOT_FOUND:
-		lstrcat(buf, TEXT("  File not found\r\n"));
-		break;
-	    case ERROR_PATH_NOT_FOUND:
-		lstrcat(buf, TEXT("  Path not found\r\n"));
-		break;
-	    case ERROR_BAD_PATHNAME:
-		lstrcat(buf, TEXT("  Bad path name\r\n"));
-		break;
-	}
-	write_string_to_log(prd, buf);
-	write_error(prd, err);
+    /* Wait for the first data before starting the converter, 
+     * in case the job is to be dropped */
+    if (dropfile_allowed(prd)) {
+	prd->launch_pending = TRUE;
+	flag = TRUE;
     }
+    else
+	flag = redmon_start_job(prd);
 
     if (prd->config.dwLogFileDebug) {
 	wsprintf(buf, 
@@ -1617,48 +2302,10 @@ redmon_start_doc_port(REDATA *prd, LPTSTR pPrinterName,
 	write_string_to_log(prd, buf);
     }
 
-    if (!flag) {
-	/* close all file and object handles */
-	if (prd->hLogFile != INVALID_HANDLE_VALUE);
-	    CloseHandle(prd->hLogFile);
-	prd->hLogFile = INVALID_HANDLE_VALUE;
+    if (!flag)
+	redmon_close_handles(prd);
 
-	if (prd->hChildStderrRd)
-	    CloseHandle(prd->hChildStderrRd);
-	if (prd->hChildStderrWr)
-	    CloseHandle(prd->hChildStderrWr);
-	if (prd->hChildStdoutRd)
-	    CloseHandle(prd->hChildStdoutRd);
-	if (prd->hChildStdoutWr)
-	    CloseHandle(prd->hChildStdoutWr);
-	if (prd->hChildStdinRd)
-	    CloseHandle(prd->hChildStdinRd);
-	if (prd->hChildStdinWr)
-	    CloseHandle(prd->hChildStdinWr);
-	if (prd->hPipeRd)
-	    CloseHandle(prd->hPipeRd);
-	if (prd->hPipeWr)
-	    CloseHandle(prd->hPipeWr);
-	prd->hChildStderrRd   = INVALID_HANDLE_VALUE;
-	prd->hChildStderrWr   = INVALID_HANDLE_VALUE;
-	prd->hChildStdoutRd   = INVALID_HANDLE_VALUE;
-	prd->hChildStdoutWr   = INVALID_HANDLE_VALUE;
-	prd->hChildStdinRd    = INVALID_HANDLE_VALUE;
-	prd->hChildStdinWr    = INVALID_HANDLE_VALUE;
-	prd->hPipeRd   = INVALID_HANDLE_VALUE;
-	prd->hPipeWr   = INVALID_HANDLE_VALUE;
-#ifdef SAVESTD
-	SetStdHandle(STD_INPUT_HANDLE, prd->hSaveStdin);
-	SetStdHandle(STD_OUTPUT_HANDLE, prd->hSaveStdout);
-	SetStdHandle(STD_ERROR_HANDLE, prd->hSaveStdout);
-#endif
-
-	if (prd->hmutex != INVALID_HANDLE_VALUE)
-	    CloseHandle(prd->hmutex);
-	prd->hmutex    = INVALID_HANDLE_VALUE;
-    }
-
-    prd->started = flag;
+    prd->started = flag;
 
     return flag;
 }
@@ -1668,6 +2315,11 @@ redmon_cancel_job(REDATA *prd)
 {
     TCHAR buf[MAXSTR];
     HANDLE hPrinter;
+    if (!prd->cancelled && stats_begin(prd)) {
+	prd->stats->dwCancels++;
+	stats_end(prd);
+    }
+    prd->cancelled = TRUE;
     if (OpenPrinter(prd->pPrinterName, &hPrinter, NULL)) {
 	DWORD dwNeeded = 0;
 	HGLOBAL hglobal = GlobalAlloc(GPTR, (DWORD)4096);
@@ -1708,6 +2360,7 @@ BOOL redmon_write_port(REDATA *prd, LPBYTE  pBuffer,
 {
     TCHAR buf[MAXSTR];
     unsigned int sleep_count;
+    DWORD blocked_tick;
 
     if (prd == (REDATA *)NULL) {
 	SetLastError(ERROR_INVALID_HANDLE);
@@ -1725,6 +2378,31 @@ BOOL redmon_write_port(REDATA *prd, LPBYTE  pBuffer,
 	return FALSE;
     }
 
+    if (prd->launch_pending)
+	return dropfile_write(prd, pBuffer, cbBuf, pcbWritten);
+    if (prd->dropping) {
+	if (prd->error) {
+	    /* the converter for this job could not be started */
+	    *pcbWritten = 0;
+	    SetLastError(ERROR_OPEN_FAILED);
+	    return FALSE;
+	}
+	*pcbWritten = cbBuf;
+	return TRUE;
+    }
+
+    capture_write(prd, pBuffer, cbBuf);
+    if (prd->spool_file != INVALID_HANDLE_VALUE) {
+	/* converter will be started later by a worker */
+	return pool_spool_write(prd, pBuffer, cbBuf, pcbWritten);
+    }
+
+    if (stats_begin(prd)) {
+	prd->stats->job.qwBytesIn += cbBuf;
+	prd->stats->total.qwBytesIn += cbBuf;
+	stats_end(prd);
+    }
+
     /* copy from output pipes to printer or log file */
     flush_stdout(prd);
 
@@ -1766,6 +2444,7 @@ Returning TRUE.\r\n    Ignoring %d bytes\r\n"), cbBuf);
     prd->write_buffer = pBuffer;
     prd->write_flag = TRUE;
     prd->write_written = 0;
+    blocked_tick = GetTickCount();
     SetEvent(prd->write_event);
     if (prd->write && prd->write_buffer_length) {
 	flush_stdout(prd);
@@ -1799,10 +2478,21 @@ Returning TRUE.\r\n    Ignoring %d bytes\r\n"), cbBuf);
 	    else
 	        Sleep(100);
 	    sleep_count++;
+	    if (stats_begin(prd)) {
+		prd->stats->job.dwBackoffSleeps++;
+		prd->stats->total.dwBackoffSleeps++;
+		stats_end(prd);
+	    }
 	}
 	/* Make sure process is still running */
 	check_process(prd);
     }
+    if (stats_begin(prd)) {
+	blocked_tick = GetTickCount() - blocked_tick;
+	prd->stats->job.qwBlockedMs += blocked_tick;
+	prd->stats->total.qwBlockedMs += blocked_tick;
+	stats_end(prd);
+    }
     *pcbWritten = prd->write_written;
 
     if (prd->error)
@@ -1886,6 +2576,15 @@ BOOL redmon_end_doc_port(REDATA *prd)
 	write_string_to_log(prd, 
 		TEXT("REDMON EndDocPort: starting\r\n"));
 
+    /* a job too short to tell still goes to the converter */
+    if (prd->launch_pending)
+	dropfile_launch(prd);
+    if (prd->dropping)
+	return dropfile_end(prd);
+
+    if (prd->spool_file != INVALID_HANDLE_VALUE)
+	return pool_spool_end(prd);
+
     /* tell write thread to shut down */
     prd->write_buffer_length = 0;
     prd->write_buffer = NULL;
@@ -1905,6 +2604,8 @@ BOOL redmon_end_doc_port(REDATA *prd)
     CloseHandle(prd->write_hthread);
 
     /* Close stdin to signal EOF */
+    if (prd->ring.ring != NULL)
+	ring_close_write(&prd->ring);
     if (prd->hChildStdinWr != INVALID_HANDLE_VALUE)
 	CloseHandle(prd->hChildStdinWr);
 
@@ -2028,6 +2729,9 @@ BOOL redmon_end_doc_port(REDATA *prd)
 		prd->primary_token = NULL;
 	}
 
+    if (prd->ring.ring != NULL)
+	ring_destroy(&prd->ring);
+
     if (prd->config.dwLogFileDebug)
 	write_string_to_log(prd, 
 		TEXT("REDMON EndDocPort: ending\r\n"));
@@ -2043,6 +2747,9 @@ BOOL redmon_end_doc_port(REDATA *prd)
     if ((prd->hmutex != NULL) && (prd->hmutex != INVALID_HANDLE_VALUE))
 	CloseHandle(prd->hmutex);
 
+    stats_job_end(prd);
+    capture_finish(prd);
+
     if (prd->piProcInfo.hProcess != INVALID_HANDLE_VALUE)
 	CloseHandle(prd->piProcInfo.hProcess);
 
@@ -3230,6 +3937,7 @@ HGLOBAL make_job_env(REDATA *prd)
 {
 int len;
 TCHAR buf[32];
+TCHAR ring[64];
 TCHAR temp[256];
 HGLOBAL henv;
 LPTSTR env;
@@ -3237,6 +3945,9 @@ BOOL bTEMP = FALSE;
 BOOL bTMP = FALSE;
 
     wsprintf(buf, TEXT("%d"), prd->JobId);
+    ring[0] = '\0';
+    if (prd->ring.ring != NULL)	/* handles are given on stdin */
+	lstrcpy(ring, TEXT(REDMON_RING_STDIN));
     len = sizeof(REDMON_PORT) + 
           sizeof(REDMON_JOB) + 
           sizeof(REDMON_PRINTER) + 
@@ -3266,6 +3977,8 @@ BOOL bTMP = FALSE;
 	len += sizeof(REDMON_TEMP) + (lstrlen(temp) + 1) * sizeof(TCHAR);
     if (bTMP)
 	len += sizeof(REDMON_TMP) + (lstrlen(temp) + 1) * sizeof(TCHAR);
+    if (ring[0])
+	len += sizeof(REDMON_RINGENV) + (lstrlen(ring) + 1) * sizeof(TCHAR);
 
     henv = GlobalAlloc(GPTR, len);
     env = GlobalLock(henv);
@@ -3283,11 +3996,53 @@ BOOL bTMP = FALSE;
 	append_env(env, REDMON_TEMP, sizeof(REDMON_TEMP), temp);
     if (bTMP)
 	append_env(env, REDMON_TMP, sizeof(REDMON_TMP), temp);
+    if (ring[0])
+	append_env(env, REDMON_RINGENV, sizeof(REDMON_RINGENV), ring);
     GlobalUnlock(henv);
     return henv;
 }
 
 
+/* As make_job_env(), but always a Unicode environment block, 
+ * for passing to other processes or files.
+ * The length in bytes is returned in pcb.
+ */
+HGLOBAL make_job_env_unicode(REDATA *prd, DWORD *pcb)
+{
+HGLOBAL henv;
+#ifndef UNICODE
+LPTSTR env;
+HGLOBAL hwenv;
+LPWSTR wenv;
+int len;
+#endif
+    *pcb = 0;
+    henv = make_job_env(prd);
+    if (henv == NULL)
+	return NULL;
+#ifdef UNICODE
+    *pcb = env_length((LPTSTR)GlobalLock(henv)) * sizeof(WCHAR);
+    GlobalUnlock(henv);
+    return henv;
+#else
+    env = GlobalLock(henv);
+    len = env_length(env);
+    hwenv = GlobalAlloc(GPTR, len * sizeof(WCHAR));
+    wenv = GlobalLock(hwenv);
+    if (wenv != NULL) {
+	len = MultiByteToWideChar(CP_ACP, 0, env, len, wenv, len);
+	*pcb = len * sizeof(WCHAR);
+	GlobalUnlock(hwenv);
+    }
+    GlobalUnlock(henv);
+    GlobalFree(henv);
+    if (*pcb == 0) {
+	GlobalFree(hwenv);
+	hwenv = NULL;
+    }
+    return hwenv;
+#endif
+}
 
 /* write contents of the environment block to the log file */
 void
@@ -3410,6 +4165,312 @@ BOOL query_session_id(REDATA * prd)
 #endif
 
 
+/* Converter resource limits
+ *
+ * If JobMemory, JobCpuWeight, JobPriority or JobAffinity is set for 
+ * the port, each converter is started suspended and put in a job 
+ * object for its session before it runs.  All the converters of one 
+ * session share a job object, so the memory limit and CPU weight 
+ * apply to the session as a whole, and one session printing a huge 
+ * job can't starve the others.
+ *   JobMemory     memory limit in megabytes for the session
+ *   JobCpuWeight  CPU weight 1-9, 5 is normal (Windows 8 and later)
+ *   JobPriority   priority class, e.g. 0x4000 for BELOW_NORMAL
+ *   JobAffinity   mask of processors converters may use
+ * The same values in the port key Sessions\<session id> override 
+ * those of the port for one session, with 0 removing a limit.
+ * Memory limit hits and converters which end abnormally are counted 
+ * in the port statistics.
+ */
+
+#if defined(UNICODE) && defined(NT50) && !defined(__BORLANDC__)
+/* Count job object messages in the port statistics */
+DWORD WINAPI
+JobObjThread(LPVOID lpThreadParameter)
+{
+HANDLE hPort = (HANDLE)lpThreadParameter;
+REDATA *prd;
+JOBOBJ_TABLE *pt;
+DWORD msg;
+ULONG_PTR key;
+LPOVERLAPPED pov;
+    prd = (REDATA *)GlobalLock((HGLOBAL)hPort);
+    if (prd == (REDATA *)NULL)
+	return 1;
+    pt = prd->jobobj;
+    while (GetQueuedCompletionStatus(pt->hiocp, &msg, &key, &pov, INFINITE)) {
+	if (key == 0)
+	    break;	/* port is closing */
+	switch (msg) {
+	    case JOB_OBJECT_MSG_JOB_MEMORY_LIMIT:
+	    case JOB_OBJECT_MSG_PROCESS_MEMORY_LIMIT:
+		if (stats_begin(prd)) {
+		    prd->stats->dwMemoryLimits++;
+		    stats_end(prd);
+		}
+		break;
+	    case JOB_OBJECT_MSG_ABNORMAL_EXIT_PROCESS:
+		if (stats_begin(prd)) {
+		    prd->stats->dwAbnormalExits++;
+		    stats_end(prd);
+		}
+		break;
+	}
+    }
+    GlobalUnlock((HGLOBAL)hPort);
+    return 0;
+}
+
+/* Allocate the table of job objects.  
+ * The completion port and its thread are started when first needed.
+ */
+void
+jobobj_init(REDATA *prd)
+{
+    prd->jobobj = (JOBOBJ_TABLE *)GlobalAlloc(GPTR, sizeof(JOBOBJ_TABLE));
+    if (prd->jobobj == NULL)
+	return;
+    prd->jobobj->hPort = prd->hPort;
+    prd->jobobj->hmutex = CreateMutex(NULL, FALSE, NULL);
+    if (prd->jobobj->hmutex == NULL) {
+	GlobalFree((HGLOBAL)prd->jobobj);
+	prd->jobobj = NULL;
+    }
+}
+
+/* TRUE if converters for this port must be put in a job object */
+BOOL
+jobobj_wanted(REDATA *prd)
+{
+    return (prd->jobobj != NULL) &&
+	(prd->config.dwJobMemory || prd->config.dwJobCpuWeight ||
+	 prd->config.dwJobPriority || prd->config.dwJobAffinity);
+}
+
+/* Read limits for this session which override those of the port */
+void
+jobobj_session_config(REDATA *prd, RECONFIG *config)
+{
+    LONG rc;
+    HANDLE hkey;
+    TCHAR buf[MAXSTR];
+    DWORD cbData;
+    DWORD dwType;
+
+    lstrcpy(buf, PORTSNAME);
+    lstrcat(buf, BACKSLASH);
+    lstrcat(buf, prd->portname);
+    lstrcat(buf, BACKSLASH);
+    lstrcat(buf, SESSIONSNAME);
+    lstrcat(buf, BACKSLASH);
+    lstrcat(buf, prd->pSessionId);
+    rc = RedMonOpenKey(prd->hMonitor, buf, KEY_READ, &hkey);
+    if (rc != ERROR_SUCCESS)
+	return;
+    cbData = sizeof(config->dwJobMemory);
+    rc = RedMonQueryValue(prd->hMonitor, hkey, JOBMEMORYKEY, &dwType, 
+	(PBYTE)(&config->dwJobMemory), &cbData);
+    cbData = sizeof(config->dwJobCpuWeight);
+    rc = RedMonQueryValue(prd->hMonitor, hkey, JOBCPUWEIGHTKEY, &dwType, 
+	(PBYTE)(&config->dwJobCpuWeight), &cbData);
+    cbData = sizeof(config->dwJobPriority);
+    rc = RedMonQueryValue(prd->hMonitor, hkey, JOBPRIORITYKEY, &dwType, 
+	(PBYTE)(&config->dwJobPriority), &cbData);
+    cbData = sizeof(config->dwJobAffinity);
+    rc = RedMonQueryValue(prd->hMonitor, hkey, JOBAFFINITYKEY, &dwType, 
+	(PBYTE)(&config->dwJobAffinity), &cbData);
+    RedMonCloseKey(prd->hMonitor, hkey);
+}
+
+/* Create a job object with the limits for this session,
+ * and connect it to the completion port.
+ * Called with the table mutex held.
+ */
+HANDLE
+jobobj_create(REDATA *prd, int slot)
+{
+JOBOBJ_TABLE *pt = prd->jobobj;
+RECONFIG config;
+JOBOBJECT_EXTENDED_LIMIT_INFORMATION eli;
+JOBOBJECT_ASSOCIATE_COMPLETION_PORT acp;
+HANDLE hJob;
+DWORD threadid;
+TCHAR buf[MAXSTR];
+    if (pt->hiocp == NULL) {
+	pt->hiocp = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+	if (pt->hiocp != NULL) {
+	    pt->hthread = CreateThread(NULL, 0, &JobObjThread, 
+		(LPVOID)pt->hPort, 0, &threadid);
+	    if (pt->hthread == NULL) {
+		CloseHandle(pt->hiocp);
+		pt->hiocp = NULL;
+	    }
+	}
+    }
+
+    hJob = CreateJobObject(NULL, NULL);
+    if (hJob == NULL)
+	return NULL;
+
+    config = prd->config;
+    jobobj_session_config(prd, &config);
+    FillMemory((PVOID)&eli, sizeof(eli), 0);
+    if (config.dwJobMemory) {
+	eli.BasicLimitInformation.LimitFlags |= JOB_OBJECT_LIMIT_JOB_MEMORY;
+	eli.JobMemoryLimit = (SIZE_T)config.dwJobMemory * 1024 * 1024;
+    }
+    if (config.dwJobPriority) {
+	eli.BasicLimitInformation.LimitFlags |= JOB_OBJECT_LIMIT_PRIORITY_CLASS;
+	eli.BasicLimitInformation.PriorityClass = config.dwJobPriority;
+    }
+    if (config.dwJobAffinity) {
+	eli.BasicLimitInformation.LimitFlags |= JOB_OBJECT_LIMIT_AFFINITY;
+	eli.BasicLimitInformation.Affinity = (ULONG_PTR)config.dwJobAffinity;
+    }
+    if (eli.BasicLimitInformation.LimitFlags &&
+	!SetInformationJobObject(hJob, JobObjectExtendedLimitInformation,
+	    &eli, sizeof(eli))) {
+	DWORD err = GetLastError();
+	wsprintf(buf, TEXT("REDMON: can't set job object limits, error code=%d\r\n"), err);
+	write_string_to_log(prd, buf);
+    }
+#ifdef JOB_OBJECT_CPU_RATE_CONTROL_ENABLE
+    if (config.dwJobCpuWeight) {
+	JOBOBJECT_CPU_RATE_CONTROL_INFORMATION cpu;
+	FillMemory((PVOID)&cpu, sizeof(cpu), 0);
+	cpu.ControlFlags = JOB_OBJECT_CPU_RATE_CONTROL_ENABLE | 
+	    JOB_OBJECT_CPU_RATE_CONTROL_WEIGHT_BASED;
+	cpu.Weight = (config.dwJobCpuWeight > 9) ? 9 : config.dwJobCpuWeight;
+	if (!SetInformationJobObject(hJob, JobObjectCpuRateControlInformation,
+	    &cpu, sizeof(cpu))) {
+	    DWORD err = GetLastError();
+	    wsprintf(buf, TEXT("REDMON: can't set job object CPU weight, error code=%d\r\n"), err);
+	    write_string_to_log(prd, buf);
+	}
+    }
+#endif
+    if (pt->hiocp != NULL) {
+	/* key 0 is used to stop the thread */
+	acp.CompletionKey = (PVOID)(DWORD_PTR)(slot + 1);
+	acp.CompletionPort = pt->hiocp;
+	SetInformationJobObject(hJob, 
+	    JobObjectAssociateCompletionPortInformation, &acp, sizeof(acp));
+    }
+    return hJob;
+}
+
+/* Find or create the job object for this session.
+ * Called with the table mutex held.
+ */
+HANDLE
+jobobj_get(REDATA *prd)
+{
+JOBOBJ_TABLE *pt = prd->jobobj;
+JOBOBJECT_BASIC_ACCOUNTING_INFORMATION bai;
+int i, slot = -1;
+    for (i=0; i<JOBOBJ_SLOTS; i++) {
+	if ((pt->slot[i].hJob != NULL) && 
+	    (lstrcmp(pt->slot[i].session, prd->pSessionId) == 0))
+	    return pt->slot[i].hJob;
+	if ((slot < 0) && (pt->slot[i].hJob == NULL))
+	    slot = i;
+    }
+    if (slot < 0) {
+	/* reuse the job object of a session with no converters running */
+	for (i=0; i<JOBOBJ_SLOTS; i++) {
+	    if (QueryInformationJobObject(pt->slot[i].hJob, 
+		JobObjectBasicAccountingInformation, &bai, sizeof(bai), NULL)
+		&& (bai.ActiveProcesses == 0)) {
+		CloseHandle(pt->slot[i].hJob);
+		pt->slot[i].hJob = NULL;
+		slot = i;
+		break;
+	    }
+	}
+    }
+    if (slot < 0)
+	return NULL;
+    pt->slot[slot].hJob = jobobj_create(prd, slot);
+    lstrcpy(pt->slot[slot].session, prd->pSessionId);
+    return pt->slot[slot].hJob;
+}
+
+/* Put a converter which was started suspended in the job object 
+ * for its session, then let it run.  If there is no job object, 
+ * the converter runs without limits.
+ */
+void
+jobobj_assign(REDATA *prd)
+{
+JOBOBJ_TABLE *pt = prd->jobobj;
+HANDLE hJob;
+TCHAR buf[MAXSTR];
+    WaitForSingleObject(pt->hmutex, INFINITE);
+    hJob = jobobj_get(prd);
+    if (hJob == NULL)
+	write_string_to_log(prd, 
+	    TEXT("REDMON: no job object for session, converter not limited\r\n"));
+    else if (!AssignProcessToJobObject(hJob, prd->piProcInfo.hProcess)) {
+	DWORD err = GetLastError();
+	wsprintf(buf, TEXT("REDMON: AssignProcessToJobObject failed, error code=%d\r\n"), err);
+	write_string_to_log(prd, buf);
+	write_error(prd, err);
+    }
+    ReleaseMutex(pt->hmutex);
+    ResumeThread(prd->piProcInfo.hThread);
+}
+
+/* Stop the message thread and close the job objects.
+ * Converters still running keep their limits.
+ */
+void
+jobobj_shutdown(REDATA *prd)
+{
+JOBOBJ_TABLE *pt = prd->jobobj;
+int i;
+    if (pt == NULL)
+	return;
+    if (pt->hthread != NULL) {
+	PostQueuedCompletionStatus(pt->hiocp, 0, 0, NULL);
+	WaitForSingleObject(pt->hthread, INFINITE);
+	CloseHandle(pt->hthread);
+    }
+    if (pt->hiocp != NULL)
+	CloseHandle(pt->hiocp);
+    for (i=0; i<JOBOBJ_SLOTS; i++) {
+	if (pt->slot[i].hJob != NULL)
+	    CloseHandle(pt->slot[i].hJob);
+    }
+    CloseHandle(pt->hmutex);
+    GlobalFree((HGLOBAL)pt);
+    prd->jobobj = NULL;
+}
+#else
+/* Job objects need Windows 2000 or later */
+void
+jobobj_init(REDATA *prd)
+{
+    prd->jobobj = NULL;
+}
+
+BOOL
+jobobj_wanted(REDATA *prd)
+{
+    return FALSE;
+}
+
+void
+jobobj_assign(REDATA *prd)
+{
+    ResumeThread(prd->piProcInfo.hThread);
+}
+
+void
+jobobj_shutdown(REDATA *prd)
+{
+}
+#endif
+
 /* start_redirect() was originally based on an example in the Win32 SDK
  * which used GetStdHandle() and SetStdHandle() to redirect stdio.
  * The example works under Windows 95, but not under NT.
@@ -3431,6 +4492,7 @@ BOOL start_redirect(REDATA * prd)
     STARTUPINFO siStartInfo;
     HANDLE hPipeTemp;
     LPVOID env;
+    DWORD dwCreate = 0;
 
     /* Set the bInheritHandle flag so pipe handles are inherited. */
     saAttr.nLength = sizeof(SECURITY_ATTRIBUTES);
@@ -3522,7 +4584,10 @@ BOOL start_redirect(REDATA * prd)
     else
 	env = NULL;
 
-    /* Create the child process. */
+    /* Create the child process, suspended if it must be 
+     * put in a job object before it runs. */
+    if (jobobj_wanted(prd))
+	dwCreate = CREATE_SUSPENDED;
 
 #if defined(UNICODE) && (defined(NT40) || defined(NT50)) && !defined(__BORLANDC__)
     if (prd->config.dwRunUser) {
@@ -3544,7 +4609,7 @@ BOOL start_redirect(REDATA * prd)
 			NULL,          /* process security attributes        */
 			NULL,          /* primary thread security attributes */
 			TRUE,          /* handles are inherited              */
-			CREATE_UNICODE_ENVIRONMENT,  /* creation flags       */
+			CREATE_UNICODE_ENVIRONMENT | dwCreate, /* creation flags */
 			env,           /* environment                        */
 			NULL,          /* use parent's current directory     */
 			&siStartInfo,  /* STARTUPINFO pointer                */
@@ -3569,9 +4634,9 @@ BOOL start_redirect(REDATA * prd)
         NULL,          /* primary thread security attributes */
         TRUE,          /* handles are inherited              */
 #ifdef UNICODE
-	CREATE_UNICODE_ENVIRONMENT,  /* creation flags       */
+	CREATE_UNICODE_ENVIRONMENT | dwCreate, /* creation flags */
 #else
-	0,             /* creation flags                     */
+	dwCreate,      /* creation flags                     */
 #endif
 	env,           /* environment                        */
         NULL,          /* use parent's current directory     */
@@ -3579,6 +4644,9 @@ BOOL start_redirect(REDATA * prd)
         &prd->piProcInfo))  /* receives PROCESS_INFORMATION  */
 	  return FALSE;
 
+    if (dwCreate & CREATE_SUSPENDED)
+	jobobj_assign(prd);
+
     /* After process creation, restore the saved STDIN and STDOUT. */
 
 #ifdef SAVESTD
@@ -3593,6 +4661,1166 @@ BOOL start_redirect(REDATA * prd)
     return TRUE;
 }
 
+/* Pre-spawned converters
+ *
+ * Starting the converter is a large part of the time taken by a short
+ * job.  If WarmStart is set for the port, a converter is started
+ * before the job arrives, with stdin, stdout and stderr pipes 
+ * created as for start_redirect() and an extra control pipe.
+ * The control pipe handle is passed in the REDMON_CONTROL 
+ * environment variable as a hexadecimal number.
+ * At StartDocPort the job environment variables (REDMON_JOB, etc.)
+ * are written to the control pipe as a Unicode environment block, 
+ * then the control pipe is closed.  If the control pipe is closed 
+ * without anything being written, the converter should exit.
+ * After a converter is used, a replacement is started on a 
+ * separate thread.
+ *
+ * One converter is kept for each session and user, up to WARM_SLOTS.
+ * A pre-spawned converter can't be used if the arguments 
+ * contain %1, %h, %d or %u, since these change for each job.
+ */
+
+void
+warm_clear(WARM *pw)
+{
+    pw->ready = FALSE;
+    pw->hControlWr = INVALID_HANDLE_VALUE;
+    pw->hChildStdinRd = INVALID_HANDLE_VALUE;
+    pw->hChildStdinWr = INVALID_HANDLE_VALUE;
+    pw->hChildStdoutRd = INVALID_HANDLE_VALUE;
+    pw->hChildStdoutWr = INVALID_HANDLE_VALUE;
+    pw->hChildStderrRd = INVALID_HANDLE_VALUE;
+    pw->hChildStderrWr = INVALID_HANDLE_VALUE;
+    pw->piProcInfo.hProcess = INVALID_HANDLE_VALUE;
+    pw->piProcInfo.hThread = INVALID_HANDLE_VALUE;
+}
+
+void
+warm_init(REDATA *prd)
+{
+int i;
+    prd->warm_hmutex = CreateMutex(NULL, FALSE, NULL);
+    for (i=0; i<WARM_SLOTS; i++) {
+	warm_clear(&prd->warm[i]);
+	prd->warm[i].user[0] = '\0';
+	prd->warm[i].session[0] = '\0';
+	prd->warm[i].command[0] = '\0';
+	prd->warm[i].last_used = 0;
+	prd->warm[i].hthread = INVALID_HANDLE_VALUE;
+    }
+}
+
+void
+close_handle(HANDLE *ph)
+{
+    if ((*ph != INVALID_HANDLE_VALUE) && (*ph != NULL))
+	CloseHandle(*ph);
+    *ph = INVALID_HANDLE_VALUE;
+}
+
+/* Close a pre-spawned converter which won't be used.
+ * Closing the control pipe without writing anything 
+ * tells it to exit.
+ */
+void
+warm_discard(WARM *pw)
+{
+    close_handle(&pw->hControlWr);
+    close_handle(&pw->hChildStdinWr);
+    close_handle(&pw->hChildStdinRd);
+    close_handle(&pw->hChildStdoutWr);
+    close_handle(&pw->hChildStdoutRd);
+    close_handle(&pw->hChildStderrWr);
+    close_handle(&pw->hChildStderrRd);
+    close_handle(&pw->piProcInfo.hProcess);
+    close_handle(&pw->piProcInfo.hThread);
+    pw->ready = FALSE;
+}
+
+/* Wait for the thread spawning a converter.
+ * Return TRUE if no thread is running.
+ */
+BOOL
+warm_join(WARM *pw, DWORD timeout)
+{
+    if (pw->hthread == INVALID_HANDLE_VALUE)
+	return TRUE;
+    if (WaitForSingleObject(pw->hthread, timeout) != WAIT_OBJECT_0)
+	return FALSE;
+    CloseHandle(pw->hthread);
+    pw->hthread = INVALID_HANDLE_VALUE;
+    return TRUE;
+}
+
+void
+warm_shutdown(REDATA *prd)
+{
+int i;
+    for (i=0; i<WARM_SLOTS; i++) {
+	if (warm_join(&prd->warm[i], INFINITE))
+	    warm_discard(&prd->warm[i]);
+    }
+    if ((prd->warm_hmutex != NULL) && 
+	(prd->warm_hmutex != INVALID_HANDLE_VALUE))
+	CloseHandle(prd->warm_hmutex);
+    prd->warm_hmutex = INVALID_HANDLE_VALUE;
+}
+
+/* Return TRUE if a pre-spawned converter can run this job */
+BOOL
+warm_allowed(REDATA *prd)
+{
+LPTSTR s;
+    if (!prd->config.dwWarmStart)
+	return FALSE;
+    if (prd->config.dwOutput == OUTPUT_HANDLE)
+	return FALSE;
+    /* ring handles must be inherited when the converter starts */
+    if (prd->ring.ring != NULL)
+	return FALSE;
+    for (s = prd->config.szArguments; *s; s++) {
+	if (*s == '%') {
+	    if (*(s+1) != '%')
+		return FALSE;	/* job specific argument */
+	    s++;
+	}
+    }
+    return TRUE;
+}
+
+/* Environment for a pre-spawned converter.  This doesn't contain
+ * the job variables, but does contain the control pipe handle.
+ */
+HGLOBAL
+make_warm_env(REDATA *prd, HANDLE hControl)
+{
+LPTSTR env, extra_env;
+BOOL bCreated = FALSE; 
+HGLOBAL h_extra_env;
+HGLOBAL henv = NULL;
+TCHAR buf[32];
+    env = NULL;
+#if defined(UNICODE) && (defined(NT40) || defined(NT50)) && !defined(__BORLANDC__)
+    if (prd->config.dwRunUser) {
+	fill_primary_token(prd);
+	if (prd->primary_token != NULL)
+	    bCreated = CreateEnvironmentBlock(&env, prd->primary_token, FALSE);
+	if (!bCreated)
+	    env = NULL;
+    }
+#endif
+    if (env == NULL)
+	env = GetEnvironmentStrings();
+#ifdef _WIN64
+    wsprintf(buf, TEXT("%08x%08x"), (DWORD)((DWORD_PTR)hControl >> 32),
+	(DWORD)((DWORD_PTR)hControl));
+#else
+    wsprintf(buf, TEXT("%08x"), (DWORD)hControl);
+#endif
+    h_extra_env = GlobalAlloc(GPTR, 
+	sizeof(REDMON_CONTROL) + (lstrlen(buf) + 2) * sizeof(TCHAR));
+    extra_env = GlobalLock(h_extra_env);
+    if (extra_env != NULL) {
+	append_env(extra_env, REDMON_CONTROL, sizeof(REDMON_CONTROL), buf);
+	henv = join_env(env, extra_env);
+	GlobalUnlock(h_extra_env);
+    }
+    GlobalFree(h_extra_env);
+    if (bCreated)
+	DestroyEnvironmentBlock(env);
+    else
+	FreeEnvironmentStrings(env);
+    return henv;
+}
+
+/* Thread which starts a converter and stores it in a slot */
+DWORD WINAPI WarmThread(LPVOID lpThreadParameter)
+{
+    HGLOBAL hspawn = (HGLOBAL)lpThreadParameter;
+    WARM_SPAWN *ps;
+    REDATA *prd;
+    REDATA *pscratch;
+    WARM *pw;
+    SECURITY_ATTRIBUTES saAttr;
+    HANDLE hControlRd = INVALID_HANDLE_VALUE;
+    HANDLE hControlWr = INVALID_HANDLE_VALUE;
+    HANDLE hPipeTemp;
+    BOOL flag = FALSE;
+
+    ps = (WARM_SPAWN *)GlobalLock(hspawn);
+    if (ps == (WARM_SPAWN *)NULL)
+	return 1;
+    prd = (REDATA *)GlobalLock((HGLOBAL)ps->hPort);
+    if (prd == (REDATA *)NULL) {
+	GlobalUnlock(hspawn);
+	GlobalFree(hspawn);
+	return 1;
+    }
+    pscratch = &ps->rd;
+    pw = &prd->warm[ps->slot];
+
+    /* Inheritable read end for the converter, 
+     * non-inheritable write end for us. */
+    saAttr.nLength = sizeof(SECURITY_ATTRIBUTES);
+    saAttr.bInheritHandle = TRUE;
+    saAttr.lpSecurityDescriptor = NULL;
+    if (CreatePipe(&hControlRd, &hPipeTemp, &saAttr, 0)) {
+	flag = DuplicateHandle(GetCurrentProcess(), hPipeTemp,
+            GetCurrentProcess(), &hControlWr, 0,
+            FALSE,       /* not inherited */
+            DUPLICATE_SAME_ACCESS);
+	CloseHandle(hPipeTemp);
+    }
+    if (flag) {
+	pscratch->environment = make_warm_env(pscratch, hControlRd);
+	flag = (pscratch->environment != NULL) && start_redirect(pscratch);
+    }
+    /* converter has its own copy of the read end */
+    close_handle(&hControlRd);
+
+    if (flag) {
+	WaitForSingleObject(prd->warm_hmutex, 30000);
+	pw->hControlWr = hControlWr;
+	pw->hChildStdinRd = pscratch->hChildStdinRd;
+	pw->hChildStdinWr = pscratch->hChildStdinWr;
+	pw->hChildStdoutRd = pscratch->hChildStdoutRd;
+	pw->hChildStdoutWr = pscratch->hChildStdoutWr;
+	pw->hChildStderrRd = pscratch->hChildStderrRd;
+	pw->hChildStderrWr = pscratch->hChildStderrWr;
+	pw->piProcInfo = pscratch->piProcInfo;
+	pw->ready = TRUE;
+	ReleaseMutex(prd->warm_hmutex);
+    }
+    else {
+	close_handle(&hControlWr);
+	close_handle(&pscratch->hChildStdinRd);
+	close_handle(&pscratch->hChildStdinWr);
+	close_handle(&pscratch->hChildStdoutRd);
+	close_handle(&pscratch->hChildStdoutWr);
+	close_handle(&pscratch->hChildStderrRd);
+	close_handle(&pscratch->hChildStderrWr);
+    }
+
+    if (pscratch->environment) {
+	GlobalUnlock(pscratch->environment);
+	GlobalFree(pscratch->environment);
+	pscratch->environment = NULL;
+    }
+    if (pscratch->primary_token != NULL)
+	CloseHandle(pscratch->primary_token);
+
+    GlobalUnlock((HGLOBAL)ps->hPort);
+    GlobalUnlock(hspawn);
+    GlobalFree(hspawn);
+    return 0;
+}
+
+/* Start a converter for the next job from this session in a slot.
+ * The slot must not have a thread running.
+ */
+void
+warm_spawn(REDATA *prd, int slot)
+{
+    WARM *pw = &prd->warm[slot];
+    HGLOBAL hspawn;
+    WARM_SPAWN *ps;
+    DWORD threadid;
+
+    lstrcpy(pw->user, prd->pUserName);
+    lstrcpy(pw->session, prd->pSessionId);
+    lstrcpy(pw->command, prd->command);
+    pw->last_used = GetTickCount();
+
+    hspawn = GlobalAlloc(GPTR, sizeof(WARM_SPAWN));
+    ps = (WARM_SPAWN *)GlobalLock(hspawn);
+    if (ps == (WARM_SPAWN *)NULL)
+	return;
+    ps->hPort = prd->hPort;
+    ps->slot = slot;
+    reset_redata(&ps->rd);
+    ps->rd.config = prd->config;
+    lstrcpy(ps->rd.portname, prd->portname);
+    lstrcpy(ps->rd.pUserName, prd->pUserName);
+    lstrcpy(ps->rd.pSessionId, prd->pSessionId);
+    lstrcpy(ps->rd.command, prd->command);
+    ps->rd.hMonitor = prd->hMonitor;
+    ps->rd.jobobj = prd->jobobj;
+    GlobalUnlock(hspawn);
+
+    pw->hthread = CreateThread(NULL, 0, &WarmThread, hspawn, 0, &threadid);
+    if (pw->hthread == NULL) {
+	pw->hthread = INVALID_HANDLE_VALUE;
+	GlobalFree(hspawn);
+    }
+}
+
+/* Send the job environment to a pre-spawned converter */
+BOOL
+warm_send_env(REDATA *prd, WARM *pw)
+{
+HGLOBAL henv;
+LPWSTR env;
+DWORD cbEnv, dwWritten;
+BOOL flag = FALSE;
+    henv = make_job_env_unicode(prd, &cbEnv);
+    env = GlobalLock(henv);
+    if (env == NULL)
+	return FALSE;
+    flag = WriteFile(pw->hControlWr, env, cbEnv, &dwWritten, NULL);
+    GlobalUnlock(henv);
+    GlobalFree(henv);
+    return flag;
+}
+
+/* Hand the job to a pre-spawned converter for this session, if any.
+ * On success the process and pipe handles are moved to prd.
+ * A converter for the next job is then started.
+ */
+BOOL
+warm_take(REDATA *prd)
+{
+int i, slot;
+WARM *pw;
+DWORD exit_status;
+BOOL flag = FALSE;
+TCHAR buf[MAXSTR];
+
+    if (!warm_allowed(prd))
+	return FALSE;
+
+    /* find slot for this session, or a free slot, 
+     * or else the least recently used */
+    slot = -1;
+    for (i=0; i<WARM_SLOTS; i++) {
+	if ((lstrcmp(prd->warm[i].user, prd->pUserName) == 0) &&
+	    (lstrcmp(prd->warm[i].session, prd->pSessionId) == 0)) {
+	    slot = i;
+	    break;
+	}
+    }
+    if (slot < 0) {
+	for (i=0; i<WARM_SLOTS; i++) {
+	    if ((prd->warm[i].user[0] == '\0') || (slot < 0) || 
+		(prd->warm[i].last_used < prd->warm[slot].last_used))
+		slot = i;
+	    if (prd->warm[i].user[0] == '\0')
+		break;
+	}
+    }
+    pw = &prd->warm[slot];
+
+    /* wait for a converter which is still being started */
+    if (!warm_join(pw, WARM_WAIT))
+	return FALSE;
+
+    WaitForSingleObject(prd->warm_hmutex, 30000);
+    if (pw->ready && 
+	(lstrcmp(pw->user, prd->pUserName) == 0) &&
+	(lstrcmp(pw->session, prd->pSessionId) == 0) &&
+	(lstrcmp(pw->command, prd->command) == 0) &&
+	GetExitCodeProcess(pw->piProcInfo.hProcess, &exit_status) &&
+	(exit_status == STILL_ACTIVE))
+	flag = warm_send_env(prd, pw);
+    if (flag) {
+	close_handle(&pw->hControlWr);
+	prd->hChildStdinRd = pw->hChildStdinRd;
+	prd->hChildStdinWr = pw->hChildStdinWr;
+	prd->hChildStdoutRd = pw->hChildStdoutRd;
+	prd->hChildStdoutWr = pw->hChildStdoutWr;
+	prd->hChildStderrRd = pw->hChildStderrRd;
+	prd->hChildStderrWr = pw->hChildStderrWr;
+	prd->piProcInfo = pw->piProcInfo;
+	warm_clear(pw);
+    }
+    else
+	warm_discard(pw);
+    ReleaseMutex(prd->warm_hmutex);
+
+    if (prd->config.dwLogFileDebug) {
+	wsprintf(buf, TEXT("REDMON StartDocPort: %s pre-spawned converter\r\n"),
+	    flag ? TEXT("using") : TEXT("no"));
+	write_string_to_log(prd, buf);
+    }
+
+    /* get ready for the next job from this session */
+    warm_spawn(prd, slot);
+    return flag;
+}
+
+/* Capture of jobs for replay
+ *
+ * If CaptureDirectory is set for the port, the print data and 
+ * the job environment are copied to a capture file (see redcapt.h).
+ * WritePort only copies the data to a queue.  A separate thread
+ * compresses the queue and writes it, so the converter isn't 
+ * held up.  If the thread can't keep up, the capture is abandoned.
+ * When a capture is complete, the oldest capture files are deleted
+ * until the directory is within CaptureBudget megabytes.
+ */
+
+#define CAPTURE_QUEUE_MAX (8*1024*1024)	/* bytes waiting to be written */
+#define CAPTURE_DEFAULT_BUDGET 100	/* megabytes */
+
+/* Delete the oldest capture files until the total size 
+ * is within the budget.
+ */
+void
+capture_trim(REDATA *prd)
+{
+TCHAR pattern[MAXSTR];
+TCHAR oldest_name[MAX_PATH];
+TCHAR filename[MAXSTR];
+WIN32_FIND_DATA fd;
+FILETIME oldest_time;
+HANDLE hfind;
+DWORDLONG total, budget;
+    budget = prd->config.dwCaptureBudget ? 
+	prd->config.dwCaptureBudget : CAPTURE_DEFAULT_BUDGET;
+    budget *= 1024 * 1024;
+    lstrcpy(pattern, prd->config.szCaptureDir);
+    lstrcat(pattern, BACKSLASH);
+    lstrcat(pattern, TEXT("*"));
+    lstrcat(pattern, REDMON_CAPTURE_EXT);
+    while (1) {
+	total = 0;
+	oldest_name[0] = '\0';
+	hfind = FindFirstFile(pattern, &fd);
+	if (hfind == INVALID_HANDLE_VALUE)
+	    return;
+	do {
+	    total += ((DWORDLONG)fd.nFileSizeHigh << 32) + fd.nFileSizeLow;
+	    if ((oldest_name[0] == '\0') || 
+		(CompareFileTime(&fd.ftLastWriteTime, &oldest_time) < 0)) {
+		lstrcpy(oldest_name, fd.cFileName);
+		oldest_time = fd.ftLastWriteTime;
+	    }
+	} while (FindNextFile(hfind, &fd));
+	FindClose(hfind);
+	if (total <= budget)
+	    return;
+	lstrcpy(filename, prd->config.szCaptureDir);
+	lstrcat(filename, BACKSLASH);
+	lstrcat(filename, oldest_name);
+	if (!DeleteFile(filename))
+	    return;	/* don't loop forever */
+    }
+}
+
+/* Write one block of the capture file, compressing it if possible */
+BOOL
+capture_block(REDATA *prd, DWORD dwTime, LPBYTE data, DWORD length, 
+    PFN_RTLCOMPRESSBUFFER pRtlCompressBuffer, PVOID workspace, 
+    LPBYTE compressed)
+{
+REDMON_CAPTURE_BLOCK block;
+ULONG cbCompressed = 0;
+DWORD dwWritten;
+    block.dwTime = dwTime;
+    block.dwFlags = REDMON_BLOCK_STORED;
+    block.cbData = length;
+    block.cbStored = length;
+    if ((length != 0) && (pRtlCompressBuffer != NULL) && 
+	(pRtlCompressBuffer(COMPRESSION_FORMAT_LZNT1 | 
+	    COMPRESSION_ENGINE_STANDARD, data, length, compressed, 
+	    REDMON_CAPTURE_BLOCK_SIZE, 4096, &cbCompressed, workspace) == 0)
+	&& (cbCompressed < length)) {
+	block.dwFlags = REDMON_BLOCK_LZNT1;
+	block.cbStored = cbCompressed;
+	data = compressed;
+    }
+    if (!WriteFile(prd->capture_file, &block, sizeof(block), &dwWritten, 
+	NULL) || (dwWritten != sizeof(block)))
+	return FALSE;
+    if (block.cbStored && (!WriteFile(prd->capture_file, data, 
+	block.cbStored, &dwWritten, NULL) || (dwWritten != block.cbStored)))
+	return FALSE;
+    return TRUE;
+}
+
+/* Thread to compress and write the capture file */
+DWORD WINAPI CaptureThread(LPVOID lpThreadParameter)
+{
+    HANDLE hPort = (HANDLE)lpThreadParameter;
+    REDATA *prd = GlobalLock((HGLOBAL)hPort);
+    PFN_RTLGETCOMPRESSIONWORKSPACESIZE pRtlGetCompressionWorkSpaceSize = NULL;
+    PFN_RTLCOMPRESSBUFFER pRtlCompressBuffer = NULL;
+    HMODULE hntdll;
+    HGLOBAL hworkspace = NULL;
+    HGLOBAL hcompressed;
+    PVOID workspace = NULL;
+    LPBYTE compressed;
+    ULONG cbWorkspace, cbFragment;
+    HGLOBAL hbuf;
+    LPBYTE data;
+    DWORD length, dwTime, count;
+    BOOL end = FALSE;
+    BOOL ok = TRUE;
+
+    if (prd == NULL)
+	return 1;
+
+    /* Compression is only available on Windows NT */
+    hntdll = GetModuleHandle(TEXT("ntdll.dll"));
+    if (hntdll) {
+	pRtlGetCompressionWorkSpaceSize = (PFN_RTLGETCOMPRESSIONWORKSPACESIZE)
+	    GetProcAddress(hntdll, "RtlGetCompressionWorkSpaceSize");
+	pRtlCompressBuffer = (PFN_RTLCOMPRESSBUFFER)
+	    GetProcAddress(hntdll, "RtlCompressBuffer");
+    }
+    if (pRtlGetCompressionWorkSpaceSize && pRtlCompressBuffer &&
+	(pRtlGetCompressionWorkSpaceSize(COMPRESSION_FORMAT_LZNT1 | 
+	    COMPRESSION_ENGINE_STANDARD, &cbWorkspace, &cbFragment) == 0)) {
+	hworkspace = GlobalAlloc(GMEM_MOVEABLE, cbWorkspace);
+	workspace = GlobalLock(hworkspace);
+    }
+    hcompressed = GlobalAlloc(GMEM_MOVEABLE, REDMON_CAPTURE_BLOCK_SIZE);
+    compressed = GlobalLock(hcompressed);
+    if ((workspace == NULL) || (compressed == NULL))
+	pRtlCompressBuffer = NULL;
+
+    while (!end) {
+	WaitForSingleObject(prd->capture_event, INFINITE);
+	WaitForSingleObject(prd->capture_hmutex, 30000);
+	hbuf = prd->capture_hbuf;
+	length = prd->capture_length;
+	dwTime = prd->capture_tick;
+	end = prd->capture_end || prd->capture_dropped;
+	prd->capture_hbuf = NULL;
+	prd->capture_length = 0;
+	ReleaseMutex(prd->capture_hmutex);
+
+	if (hbuf != NULL) {
+	    data = GlobalLock(hbuf);
+	    while (ok && data && length) {
+		count = min(length, REDMON_CAPTURE_BLOCK_SIZE);
+		ok = capture_block(prd, dwTime, data, count, 
+		    pRtlCompressBuffer, workspace, compressed);
+		data += count;
+		length -= count;
+	    }
+	    GlobalUnlock(hbuf);
+	    GlobalFree(hbuf);
+	}
+    }
+
+    /* end of job marker */
+    if (ok)
+	ok = capture_block(prd, GetTickCount() - prd->start_tick, NULL, 0,
+	    NULL, NULL, NULL);
+    CloseHandle(prd->capture_file);
+    prd->capture_file = INVALID_HANDLE_VALUE;
+    if (!ok || prd->capture_dropped)
+	DeleteFile(prd->capture_name);
+    else
+	capture_trim(prd);
+
+    if (hcompressed) {
+	GlobalUnlock(hcompressed);
+	GlobalFree(hcompressed);
+    }
+    if (hworkspace) {
+	GlobalUnlock(hworkspace);
+	GlobalFree(hworkspace);
+    }
+    GlobalUnlock((HGLOBAL)hPort);
+    return 0;
+}
+
+/* Open the capture file and start the capture thread */
+void
+capture_start(REDATA *prd)
+{
+REDMON_CAPTURE_HEADER header;
+HGLOBAL henv;
+LPWSTR env;
+DWORD cbEnv = 0;
+DWORD dwWritten;
+DWORD threadid;
+LPTSTR s;
+BOOL flag;
+    if (prd->config.szCaptureDir[0] == '\0')
+	return;
+
+    wsprintf(prd->capture_name, TEXT("%s\\%s-%d-%lu%s"), 
+	prd->config.szCaptureDir, prd->portname, prd->JobId, 
+	GetTickCount(), REDMON_CAPTURE_EXT);
+    for (s = prd->capture_name + lstrlen(prd->config.szCaptureDir) + 1; 
+	*s; s++) {
+	if ((*s == '\\') || (*s == ':') || (*s == '/'))
+	    *s = '_';
+    }
+    prd->capture_file = CreateFile(prd->capture_name, GENERIC_WRITE, 0, 
+	NULL, CREATE_ALWAYS, 
+	FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (prd->capture_file == INVALID_HANDLE_VALUE) {
+	write_string_to_log(prd, TEXT("REDMON: can't create capture file\r\n"));
+	return;
+    }
+
+    henv = make_job_env_unicode(prd, &cbEnv);
+    env = GlobalLock(henv);
+    header.dwMagic = REDMON_CAPTURE_MAGIC;
+    header.dwVersion = REDMON_CAPTURE_VERSION;
+    header.cbEnvironment = (env != NULL) ? cbEnv : 0;
+    header.dwReserved = 0;
+    flag = WriteFile(prd->capture_file, &header, sizeof(header), 
+	&dwWritten, NULL);
+    if (flag && header.cbEnvironment)
+	flag = WriteFile(prd->capture_file, env, header.cbEnvironment, 
+	    &dwWritten, NULL);
+    if (env != NULL)
+	GlobalUnlock(henv);
+    if (henv != NULL)
+	GlobalFree(henv);
+
+    if (flag) {
+	prd->capture_hmutex = CreateMutex(NULL, FALSE, NULL);
+	prd->capture_event = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if ((prd->capture_hmutex != NULL) && (prd->capture_event != NULL))
+	    prd->capture_hthread = CreateThread(NULL, 0, &CaptureThread, 
+		prd->hPort, 0, &threadid);
+	if (prd->capture_hthread == NULL)
+	    prd->capture_hthread = INVALID_HANDLE_VALUE;
+	flag = (prd->capture_hthread != INVALID_HANDLE_VALUE);
+    }
+    if (!flag) {
+	CloseHandle(prd->capture_file);
+	prd->capture_file = INVALID_HANDLE_VALUE;
+	DeleteFile(prd->capture_name);
+	close_handle(&prd->capture_hmutex);
+	close_handle(&prd->capture_event);
+    }
+}
+
+/* Queue data from WritePort for the capture thread */
+void
+capture_write(REDATA *prd, LPBYTE pBuffer, DWORD cbBuf)
+{
+HGLOBAL hnew;
+LPBYTE p;
+DWORD size;
+    if ((prd->capture_hthread == INVALID_HANDLE_VALUE) || 
+	prd->capture_dropped || (cbBuf == 0))
+	return;
+    WaitForSingleObject(prd->capture_hmutex, 30000);
+    if (prd->capture_length + cbBuf > CAPTURE_QUEUE_MAX) {
+	/* capture thread isn't keeping up, so give up */
+	prd->capture_dropped = TRUE;
+    }
+    else {
+	size = prd->capture_hbuf ? (DWORD)GlobalSize(prd->capture_hbuf) : 0;
+	if (prd->capture_length + cbBuf > size) {
+	    size = max(prd->capture_length + cbBuf, 
+		max(2 * size, REDMON_CAPTURE_BLOCK_SIZE));
+	    if (prd->capture_hbuf)
+		hnew = GlobalReAlloc(prd->capture_hbuf, size, GMEM_MOVEABLE);
+	    else
+		hnew = GlobalAlloc(GMEM_MOVEABLE, size);
+	    if (hnew == NULL)
+		prd->capture_dropped = TRUE;
+	    else
+		prd->capture_hbuf = hnew;
+	}
+	if (!prd->capture_dropped) {
+	    if (prd->capture_length == 0)
+		prd->capture_tick = GetTickCount() - prd->start_tick;
+	    p = GlobalLock(prd->capture_hbuf);
+	    MoveMemory(p + prd->capture_length, pBuffer, cbBuf);
+	    GlobalUnlock(prd->capture_hbuf);
+	    prd->capture_length += cbBuf;
+	}
+    }
+    ReleaseMutex(prd->capture_hmutex);
+    SetEvent(prd->capture_event);
+}
+
+/* Wait for the capture thread to finish writing the capture file */
+void
+capture_finish(REDATA *prd)
+{
+    if (prd->capture_hthread != INVALID_HANDLE_VALUE) {
+	WaitForSingleObject(prd->capture_hmutex, 30000);
+	prd->capture_end = TRUE;
+	ReleaseMutex(prd->capture_hmutex);
+	SetEvent(prd->capture_event);
+	WaitForSingleObject(prd->capture_hthread, INFINITE);
+	close_handle(&prd->capture_hthread);
+    }
+    if (prd->capture_hbuf != NULL)
+	GlobalFree(prd->capture_hbuf);
+    prd->capture_hbuf = NULL;
+    close_handle(&prd->capture_hmutex);
+    close_handle(&prd->capture_event);
+}
+
+/* Converter workers
+ *
+ * With Workers set for a port, StartDocPort doesn't start the converter.
+ * Instead WritePort copies the job to a spool file, and EndDocPort 
+ * queues the job for a pool of worker threads, so the spooler can 
+ * move on to the next job.  Each worker starts a converter and feeds
+ * it the spool file, using the same code as a direct job.
+ * Jobs from the same session are converted one at a time, while 
+ * jobs from other sessions convert in parallel.
+ * Workers aren't used when the converter output goes to a printer
+ * (OUTPUT_STDOUT or OUTPUT_HANDLE).
+ *
+ * When several sessions have jobs waiting, a free worker picks one
+ * by weighted fair queuing, with the spool file size as the cost of
+ * a job, so a session printing many large jobs gets its share of 
+ * the workers but no more.  Within a session the shortest job goes 
+ * first, unless an older job has been overtaken POOL_MAX_SKIPS times.
+ * The weight of a session is Weight (1 to POOL_MAX_WEIGHT, default 1) 
+ * in the port key Sessions\<session id>.  If FifoQueue is set for 
+ * the port, jobs are taken in the order they were printed.
+ */
+
+/* Details passed to PoolThread */
+typedef struct pool_worker_s {
+    HANDLE hPort;	/* port owning the pool */
+    int index;		/* worker number */
+} POOL_WORKER;
+
+void
+pool_init(REDATA *prd)
+{
+int i;
+    prd->pool_hmutex = CreateMutex(NULL, FALSE, NULL);
+    prd->pool_event = CreateEvent(NULL, TRUE, FALSE, NULL);
+    prd->pool_head = NULL;
+    prd->pool_shutdown = FALSE;
+    prd->pool_workers = 0;
+    for (i=0; i<POOL_MAX_WORKERS; i++) {
+	prd->pool_hthread[i] = INVALID_HANDLE_VALUE;
+	prd->pool_session[i][0] = '\0';
+    }
+    prd->pool_vtime = 0;
+    for (i=0; i<POOL_FLOWS; i++) {
+	prd->pool_flow[i].session[0] = '\0';
+	prd->pool_flow[i].user[0] = '\0';
+	prd->pool_flow[i].finish = 0;
+	prd->pool_flow[i].queued = 0;
+    }
+}
+
+/* Read the fair queue weight of this session */
+DWORD
+pool_session_weight(REDATA *prd)
+{
+    LONG rc;
+    HANDLE hkey;
+    TCHAR buf[MAXSTR];
+    DWORD cbData;
+    DWORD dwType;
+    DWORD dwWeight = 1;
+
+    lstrcpy(buf, PORTSNAME);
+    lstrcat(buf, BACKSLASH);
+    lstrcat(buf, prd->portname);
+    lstrcat(buf, BACKSLASH);
+    lstrcat(buf, SESSIONSNAME);
+    lstrcat(buf, BACKSLASH);
+    lstrcat(buf, prd->pSessionId);
+    rc = RedMonOpenKey(prd->hMonitor, buf, KEY_READ, &hkey);
+    if (rc != ERROR_SUCCESS)
+	return dwWeight;
+    cbData = sizeof(dwWeight);
+    rc = RedMonQueryValue(prd->hMonitor, hkey, WEIGHTKEY, &dwType, 
+	(PBYTE)(&dwWeight), &cbData);
+    RedMonCloseKey(prd->hMonitor, hkey);
+    if (dwWeight < 1)
+	dwWeight = 1;
+    if (dwWeight > POOL_MAX_WEIGHT)
+	dwWeight = POOL_MAX_WEIGHT;
+    return dwWeight;
+}
+
+/* Find the fair queue slot for a job's session and user, 
+ * or take a free one.  A session keeps its virtual finish time 
+ * until its slot is reused, so it can't jump the queue by printing 
+ * again as soon as its last job starts.
+ * If all slots have jobs waiting, the last slot is shared.
+ * Call with pool_hmutex held.
+ */
+int
+pool_flow_find(REDATA *prd, REDATA *pjob)
+{
+int i, slot = -1;
+POOL_FLOW *pf;
+    for (i=0; i<POOL_FLOWS; i++) {
+	pf = &prd->pool_flow[i];
+	if ((lstrcmp(pf->session, pjob->pSessionId) == 0) &&
+	    (lstrcmp(pf->user, pjob->pUserName) == 0))
+	    return i;
+	if ((slot < 0) && (pf->queued == 0))
+	    slot = i;
+    }
+    if (slot < 0)
+	return POOL_FLOWS - 1;
+    /* an idle session starts again at the current virtual time */
+    pf = &prd->pool_flow[slot];
+    lstrcpy(pf->session, pjob->pSessionId);
+    lstrcpy(pf->user, pjob->pUserName);
+    pf->finish = prd->pool_vtime;
+    return slot;
+}
+
+/* Return TRUE if this job should be converted by a worker */
+BOOL
+pool_allowed(REDATA *prd)
+{
+    if (prd->config.dwWorkers == 0)
+	return FALSE;
+    if ((prd->pool_hmutex == NULL) || (prd->pool_event == NULL))
+	return FALSE;
+    if ((prd->config.dwOutput == OUTPUT_STDOUT) ||
+	(prd->config.dwOutput == OUTPUT_HANDLE))
+	return FALSE;
+    return TRUE;
+}
+
+/* Open the spool file for a job which will be converted later */
+BOOL
+pool_spool_start(REDATA *prd)
+{
+    if (create_tempfile(prd->spoolname, 
+	sizeof(prd->spoolname)/sizeof(TCHAR)))
+	prd->spool_file = CreateFile(prd->spoolname, GENERIC_WRITE, 0,
+	    NULL, CREATE_ALWAYS, 
+	    FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (prd->spool_file == INVALID_HANDLE_VALUE) {
+	write_string_to_log(prd, 
+	    TEXT("\r\nREDMON StartDocPort: spool file creation failed\r\n"));
+	if (prd->spoolname[0])
+	    DeleteFile(prd->spoolname);
+	if (prd->environment)
+	    GlobalFree(prd->environment);
+	prd->environment = NULL;
+	return FALSE;
+    }
+    return TRUE;
+}
+
+BOOL
+pool_spool_write(REDATA *prd, LPBYTE pBuffer, DWORD cbBuf, 
+    LPDWORD pcbWritten)
+{
+    if (!WriteFile(prd->spool_file, pBuffer, cbBuf, pcbWritten, NULL)) {
+	/* As for a converter which has stopped, don't return an error */
+	write_string_to_log(prd, 
+	    TEXT("REDMON WritePort: failed to write spool file\r\n"));
+	prd->error = TRUE;
+	*pcbWritten = cbBuf;
+    }
+    prd->spool_length += cbBuf;
+    return TRUE;
+}
+
+/* Return TRUE if a worker is converting a job from this session.
+ * Call with pool_hmutex held.
+ */
+BOOL
+pool_session_busy(REDATA *prd, REDATA *pjob)
+{
+int i;
+    for (i=0; i<prd->pool_workers; i++) {
+	if (lstrcmp(prd->pool_session[i], pjob->pSessionId) == 0)
+	    return TRUE;
+    }
+    return FALSE;
+}
+
+/* Pick the next job to convert from a session which isn't 
+ * being converted, and remove it from the queue.
+ * Call with pool_hmutex held.
+ */
+HGLOBAL
+pool_next_job(REDATA *prd)
+{
+HGLOBAL hjob, *phprev;
+HGLOBAL pick[POOL_FLOWS];
+BOOL aged[POOL_FLOWS];
+DWORDLONG cost[POOL_FLOWS];
+DWORDLONG start, finish, best_start = 0, best_finish = 0;
+REDATA *pjob;
+int i, best = -1;
+
+    /* For each session, the oldest overtaken job or else the shortest */
+    for (i=0; i<POOL_FLOWS; i++)
+	pick[i] = NULL;
+    for (hjob = prd->pool_head; hjob != NULL; hjob = pjob->pool_next) {
+	pjob = (REDATA *)GlobalLock(hjob);	/* GPTR memory doesn't move */
+	GlobalUnlock(hjob);
+	if (pool_session_busy(prd, pjob))
+	    continue;
+	i = pjob->pool_flow;
+	if (prd->config.dwFifoQueue) {
+	    /* oldest job from a free session */
+	    best = i;
+	    pick[i] = hjob;
+	    break;
+	}
+	if (pick[i] == NULL) {
+	    pick[i] = hjob;
+	    aged[i] = (pjob->pool_skips >= POOL_MAX_SKIPS);
+	    cost[i] = pjob->spool_length / pjob->pool_weight;
+	}
+	else if (!aged[i] && 
+	    (pjob->spool_length / pjob->pool_weight < cost[i])) {
+	    pick[i] = hjob;
+	    cost[i] = pjob->spool_length / pjob->pool_weight;
+	}
+    }
+
+    /* Session whose job would finish first in virtual time */
+    if (!prd->config.dwFifoQueue) {
+	for (i=0; i<POOL_FLOWS; i++) {
+	    if (pick[i] == NULL)
+		continue;
+	    start = max(prd->pool_flow[i].finish, prd->pool_vtime);
+	    finish = start + cost[i];
+	    if ((best < 0) || (finish < best_finish)) {
+		best = i;
+		best_start = start;
+		best_finish = finish;
+	    }
+	}
+	if (best >= 0) {
+	    prd->pool_flow[best].finish = best_finish;
+	    if (best_start > prd->pool_vtime)
+		prd->pool_vtime = best_start;
+	}
+    }
+    if (best < 0)
+	return NULL;
+
+    /* Remove the job from the queue.  Older jobs from the same 
+     * session have been overtaken once more. */
+    phprev = &prd->pool_head;
+    while ((hjob = *phprev) != NULL) {
+	pjob = (REDATA *)GlobalLock(hjob);
+	GlobalUnlock(hjob);
+	if (hjob == pick[best]) {
+	    *phprev = pjob->pool_next;
+	    pjob->pool_next = NULL;
+	    break;
+	}
+	if (pjob->pool_flow == best)
+	    pjob->pool_skips++;
+	phprev = &pjob->pool_next;
+    }
+    prd->pool_flow[best].queued--;
+    return pick[best];
+}
+
+/* Convert a queued job, then free it */
+void
+pool_run(HGLOBAL hjob)
+{
+REDATA *pjob = (REDATA *)GlobalLock(hjob);
+TCHAR spoolname[MAXSTR];
+HGLOBAL hbuf;
+LPBYTE buf;
+HANDLE hspool;
+DWORD dwRead, dwWritten;
+    lstrcpy(spoolname, pjob->spoolname);
+    pjob->started = redmon_launch(pjob);
+    if (pjob->started) {
+	hbuf = GlobalAlloc(GMEM_MOVEABLE, PRINT_BUF_SIZE);
+	buf = GlobalLock(hbuf);
+	hspool = CreateFile(spoolname, GENERIC_READ, 0, NULL, 
+	    OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if ((buf != NULL) && (hspool != INVALID_HANDLE_VALUE)) {
+	    while (ReadFile(hspool, buf, PRINT_BUF_SIZE, &dwRead, NULL) &&
+		dwRead)
+		redmon_write_port(pjob, buf, dwRead, &dwWritten);
+	}
+	if (hspool != INVALID_HANDLE_VALUE)
+	    CloseHandle(hspool);
+	if (buf != NULL)
+	    GlobalUnlock(hbuf);
+	if (hbuf != NULL)
+	    GlobalFree(hbuf);
+	redmon_end_doc_port(pjob);
+    }
+    else {
+	redmon_close_handles(pjob);
+	if (pjob->primary_token != NULL)
+	    CloseHandle(pjob->primary_token);
+	pjob->primary_token = NULL;
+    }
+    DeleteFile(spoolname);
+    GlobalUnlock(hjob);
+    GlobalFree(hjob);
+}
+
+/* Worker thread, converting queued jobs until the port is closed */
+DWORD WINAPI PoolThread(LPVOID lpThreadParameter)
+{
+    HGLOBAL hworker = (HGLOBAL)lpThreadParameter;
+    POOL_WORKER *pw = (POOL_WORKER *)GlobalLock(hworker);
+    HANDLE hPort = pw->hPort;
+    int index = pw->index;
+    REDATA *prd = (REDATA *)GlobalLock((HGLOBAL)hPort);
+    REDATA *pjob;
+    HGLOBAL hjob;
+    GlobalUnlock(hworker);
+    GlobalFree(hworker);
+    if (prd == (REDATA *)NULL)
+	return 1;
+
+    while (1) {
+	WaitForSingleObject(prd->pool_hmutex, INFINITE);
+	hjob = pool_next_job(prd);
+	if (hjob == NULL) {
+	    if (prd->pool_shutdown && (prd->pool_head == NULL)) {
+		ReleaseMutex(prd->pool_hmutex);
+		break;
+	    }
+	    /* nothing we can run until a job is queued or finishes */
+	    ResetEvent(prd->pool_event);
+	    ReleaseMutex(prd->pool_hmutex);
+	    WaitForSingleObject(prd->pool_event, INFINITE);
+	    continue;
+	}
+	pjob = (REDATA *)GlobalLock(hjob);
+	lstrcpy(prd->pool_session[index], pjob->pSessionId);
+	GlobalUnlock(hjob);
+	ReleaseMutex(prd->pool_hmutex);
+
+	pool_run(hjob);
+
+	WaitForSingleObject(prd->pool_hmutex, INFINITE);
+	prd->pool_session[index][0] = '\0';
+	SetEvent(prd->pool_event);	/* next job from this session */
+	ReleaseMutex(prd->pool_hmutex);
+    }
+    GlobalUnlock((HGLOBAL)hPort);
+    return 0;
+}
+
+/* Finish spooling a job and queue it for the workers */
+BOOL
+pool_spool_end(REDATA *prd)
+{
+HGLOBAL hjob, hnext, *phtail;
+REDATA *pjob;
+HGLOBAL hworker;
+POOL_WORKER *pw;
+HANDLE hPrinter;
+DWORD threadid;
+int workers;
+
+    capture_finish(prd);
+    CloseHandle(prd->spool_file);
+    prd->spool_file = INVALID_HANDLE_VALUE;
+
+    /* The job takes over the environment, token and log file */
+    hjob = GlobalAlloc(GPTR, (DWORD)sizeof(REDATA));
+    pjob = (REDATA *)GlobalLock(hjob);
+    if (pjob != (REDATA *)NULL) {
+	CopyMemory(pjob, prd, sizeof(REDATA));
+	pjob->hPort = hjob;
+	pjob->config.dwWarmStart = FALSE;
+	pjob->config.dwWorkers = 0;
+	pjob->pool_next = NULL;
+	pjob->pool_weight = pool_session_weight(pjob);
+	prd->environment = NULL;
+	prd->primary_token = NULL;
+	prd->hLogFile = INVALID_HANDLE_VALUE;
+	prd->ring.ring = NULL;
+	GlobalUnlock(hjob);
+    }
+    else {
+	write_string_to_log(prd, 
+	    TEXT("REDMON EndDocPort: can't queue job\r\n"));
+	DeleteFile(prd->spoolname);
+	if (prd->environment)
+	    GlobalFree(prd->environment);
+	prd->environment = NULL;
+	if (prd->primary_token != NULL)
+	    CloseHandle(prd->primary_token);
+	prd->primary_token = NULL;
+	if (prd->hLogFile != INVALID_HANDLE_VALUE)
+	    CloseHandle(prd->hLogFile);
+	prd->hLogFile = INVALID_HANDLE_VALUE;
+	if (prd->ring.ring != NULL)
+	    ring_destroy(&prd->ring);
+	if (hjob != NULL)
+	    GlobalFree(hjob);
+	hjob = NULL;
+    }
+
+    /* As for a direct job, we cancel the print job ourselves */
+    if (OpenPrinter(prd->pPrinterName, &hPrinter, NULL)) {
+	SetJob(hPrinter, prd->JobId, 0, NULL, JOB_CONTROL_CANCEL);
+	ClosePrinter(hPrinter);
+    }
+
+    if (hjob != NULL) {
+	workers = min(prd->config.dwWorkers, POOL_MAX_WORKERS);
+	WaitForSingleObject(prd->pool_hmutex, INFINITE);
+	phtail = &prd->pool_head;
+	while ((hnext = *phtail) != NULL) {
+	    pjob = (REDATA *)GlobalLock(hnext);
+	    phtail = &pjob->pool_next;	/* GPTR memory doesn't move */
+	    GlobalUnlock(hnext);
+	}
+	*phtail = hjob;
+	pjob = (REDATA *)GlobalLock(hjob);
+	pjob->pool_flow = pool_flow_find(prd, pjob);
+	prd->pool_flow[pjob->pool_flow].queued++;
+	GlobalUnlock(hjob);
+	/* start another worker if allowed */
+	if (prd->pool_workers < workers) {
+	    hworker = GlobalAlloc(GPTR, (DWORD)sizeof(POOL_WORKER));
+	    pw = (POOL_WORKER *)GlobalLock(hworker);
+	    if (pw != (POOL_WORKER *)NULL) {
+		pw->hPort = prd->hPort;
+		pw->index = prd->pool_workers;
+		GlobalUnlock(hworker);
+		prd->pool_hthread[prd->pool_workers] = CreateThread(NULL, 0, 
+		    &PoolThread, hworker, 0, &threadid);
+		if (prd->pool_hthread[prd->pool_workers] == NULL) {
+		    prd->pool_hthread[prd->pool_workers] = INVALID_HANDLE_VALUE;
+		    GlobalFree(hworker);
+		}
+		else
+		    prd->pool_workers++;
+	    }
+	}
+	SetEvent(prd->pool_event);
+	ReleaseMutex(prd->pool_hmutex);
+    }
+
+    reset_redata(prd);
+    return TRUE;
+}
+
+/* Convert any queued jobs, then stop the workers */
+void
+pool_shutdown(REDATA *prd)
+{
+int i;
+    if (prd->pool_hmutex == NULL)
+	return;
+    WaitForSingleObject(prd->pool_hmutex, INFINITE);
+    prd->pool_shutdown = TRUE;
+    SetEvent(prd->pool_event);
+    ReleaseMutex(prd->pool_hmutex);
+    for (i=0; i<prd->pool_workers; i++) {
+	WaitForSingleObject(prd->pool_hthread[i], INFINITE);
+	close_handle(&prd->pool_hthread[i]);
+    }
+    prd->pool_workers = 0;
+    CloseHandle(prd->pool_hmutex);
+    prd->pool_hmutex = NULL;
+    if (prd->pool_event != NULL)
+	CloseHandle(prd->pool_event);
+    prd->pool_event = NULL;
+}
+
 #if defined(UNICODE) && (defined(NT40) || defined(NT50)) && !defined(__BORLANDC__)
 /* Create another process to get the filename.
  * This is needed to make the SaveAs dialog appear on the WTS client
@@ -0,0 +1,406 @@
+/* redreplay.c */
+
+/*
+ * Replay RedMon capture files (see redcapt.h) through a converter,
+ * to benchmark the print pipeline with real spool streams.
+ *
+ * Usage: redreplay [-s speed] [-r repeat] [-m] "command line" file.rmc ...
+ *   -s 0      write as fast as the converter reads (default)
+ *   -s 1      original pacing, as the spooler wrote it
+ *   -s n      n times faster than the original pacing
+ *   -r n      replay each capture n times
+ *   -m        pass the data in shared memory (see redring.h), not stdin
+ *
+ * The captured REDMON_* environment variables are set for the
+ * converter.  Capture files are memory mapped, so stored blocks 
+ * are written to the converter without copying.
+ * For each job the time from starting the converter until it exits
+ * is reported, with the CPU time used by the converter and by the 
+ * writer per GB of print data, followed by the totals.
+ * Running the same captures with and without -m compares the two 
+ * transports.
+ */
+
+#define STRICT
+#define UNICODE
+#define _UNICODE
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "redcapt.h"
+#include "redring.h"
+
+typedef struct replay_result_s {
+    DWORDLONG qwBytes;		/* bytes written to converter */
+    double dMs;			/* converter start to exit */
+    double dCpuMs;		/* CPU time of converter and writer */
+    DWORD dwExitCode;
+} REPLAY_RESULT;
+
+PFN_RTLDECOMPRESSBUFFER pRtlDecompressBuffer;
+BYTE decompressed[REDMON_CAPTURE_BLOCK_SIZE];
+
+/* Length of a Unicode environment block in characters, 
+ * including the final null */
+size_t
+env_length(LPCWSTR env)
+{
+LPCWSTR p = env;
+    while (*p)
+	p += lstrlenW(p) + 1;
+    return p - env + 1;
+}
+
+/* Return TRUE if variable var (NAME=VALUE) is set in env */
+BOOL
+env_contains(LPCWSTR env, LPCWSTR var)
+{
+LPCWSTR eq = wcschr(var + 1, '=');
+size_t len = eq ? (eq - var + 1) : lstrlenW(var);
+    for (; *env; env += lstrlenW(env) + 1) {
+	if (_wcsnicmp(env, var, len) == 0)
+	    return TRUE;
+    }
+    return FALSE;
+}
+
+/* Make the converter environment: extra (NAME=VALUE or NULL), 
+ * the captured variables, then our own variables which weren't 
+ * captured.  A captured REDMON_RING is dropped, since the ring
+ * belonged to the RedMon process.
+ * Free the result with free().
+ */
+LPWSTR
+make_env(LPCWSTR captured, DWORD cbCaptured, LPCWSTR extra)
+{
+LPWSTR current, env, p;
+LPCWSTR s;
+size_t len;
+    current = GetEnvironmentStringsW();
+    len = cbCaptured / sizeof(WCHAR) + env_length(current) + 1;
+    if (extra)
+	len += lstrlenW(extra) + 1;
+    env = (LPWSTR)malloc(len * sizeof(WCHAR));
+    if (env == NULL) {
+	FreeEnvironmentStringsW(current);
+	return NULL;
+    }
+    p = env;
+    *p = '\0';
+    if (extra) {
+	lstrcpyW(p, extra);
+	p += lstrlenW(p) + 1;
+    }
+    if (cbCaptured >= sizeof(WCHAR)) {
+	for (s = captured; *s && (s < captured + cbCaptured/sizeof(WCHAR)); 
+	    s += lstrlenW(s) + 1) {
+	    if (_wcsnicmp(s, TEXT(REDMON_RING_VAR) L"=", 
+		lstrlenW(TEXT(REDMON_RING_VAR)) + 1) == 0)
+		continue;
+	    lstrcpyW(p, s);
+	    p += lstrlenW(p) + 1;
+	}
+    }
+    *p = '\0';
+    for (s = current; *s; s += lstrlenW(s) + 1) {
+	if (!env_contains(env, s)) {
+	    lstrcpyW(p, s);
+	    p += lstrlenW(p) + 1;
+	}
+    }
+    *p = '\0';
+    FreeEnvironmentStringsW(current);
+    return env;
+}
+
+/* Write all of a buffer to the converter.  
+ * Return FALSE if the converter has closed stdin. */
+BOOL
+write_all(HANDLE hWrite, const BYTE *data, DWORD length)
+{
+DWORD dwWritten;
+    while (length) {
+	if (!WriteFile(hWrite, data, length, &dwWritten, NULL))
+	    return FALSE;
+	data += dwWritten;
+	length -= dwWritten;
+    }
+    return TRUE;
+}
+
+/* User plus kernel time of a process or thread, in ms */
+double
+cpu_ms(FILETIME *kernel, FILETIME *user)
+{
+ULARGE_INTEGER k, u;
+    k.LowPart = kernel->dwLowDateTime;
+    k.HighPart = kernel->dwHighDateTime;
+    u.LowPart = user->dwLowDateTime;
+    u.HighPart = user->dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) / 10000.0;
+}
+
+/* Feed one capture through the converter, by stdin or shared memory */
+BOOL
+replay(LPWSTR command, const BYTE *base, DWORDLONG size, double speed,
+    BOOL shared, REPLAY_RESULT *result)
+{
+const REDMON_CAPTURE_HEADER *header = (const REDMON_CAPTURE_HEADER *)base;
+const REDMON_CAPTURE_BLOCK *block;
+const BYTE *p, *end;
+const BYTE *data;
+SECURITY_ATTRIBUTES sa;
+STARTUPINFOW si;
+PROCESS_INFORMATION pi;
+HANDLE hRead, hWrite;
+LARGE_INTEGER freq, start, now;
+LPWSTR env;
+ULONG length;
+double elapsed;
+BOOL ok = TRUE;
+REDMON_RING_HANDLES ring;
+FILETIME ftCreate, ftExit, ftKernel, ftUser;
+double writer_ms;
+
+    ZeroMemory(result, sizeof(*result));
+    if ((size < sizeof(*header)) || 
+	(header->dwMagic != REDMON_CAPTURE_MAGIC) ||
+	(header->dwVersion != REDMON_CAPTURE_VERSION) ||
+	(header->cbEnvironment > size - sizeof(*header))) {
+	fwprintf(stderr, L"  not a RedMon capture file\n");
+	return FALSE;
+    }
+    p = base + sizeof(*header);
+    end = base + size;
+    ZeroMemory(&ring, sizeof(ring));
+    if (shared) {
+	if (!ring_create(&ring, REDMON_RING_SIZE)) {
+	    fwprintf(stderr, L"  can't create shared memory, error %lu\n",
+		GetLastError());
+	    return FALSE;
+	}
+    }
+    env = make_env((LPCWSTR)p, header->cbEnvironment, 
+	shared ? TEXT(REDMON_RING_VAR) L"=" TEXT(REDMON_RING_STDIN) : NULL);
+    p += header->cbEnvironment;
+
+    sa.nLength = sizeof(sa);
+    sa.lpSecurityDescriptor = NULL;
+    sa.bInheritHandle = TRUE;
+    if (!CreatePipe(&hRead, &hWrite, &sa, 0)) {
+	free(env);
+	if (shared)
+	    ring_destroy(&ring);
+	return FALSE;
+    }
+    SetHandleInformation(hWrite, HANDLE_FLAG_INHERIT, 0);
+
+    ZeroMemory(&si, sizeof(si));
+    si.cb = sizeof(si);
+    si.dwFlags = STARTF_USESTDHANDLES;
+    si.hStdInput = hRead;
+    si.hStdOutput = GetStdHandle(STD_OUTPUT_HANDLE);
+    si.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&start);
+    if (!CreateProcessW(NULL, command, NULL, NULL, TRUE, 
+	CREATE_UNICODE_ENVIRONMENT, env, NULL, &si, &pi)) {
+	fwprintf(stderr, L"  can't start converter, error %lu\n", 
+	    GetLastError());
+	CloseHandle(hRead);
+	CloseHandle(hWrite);
+	free(env);
+	if (shared)
+	    ring_destroy(&ring);
+	return FALSE;
+    }
+    CloseHandle(hRead);
+    free(env);
+    if (shared && !ring_give(&ring, pi.hProcess, hWrite)) {
+	fwprintf(stderr, L"  can't give shared memory to converter, "
+	    L"using stdin\n");
+	ring_destroy(&ring);
+	shared = FALSE;
+    }
+    GetThreadTimes(GetCurrentThread(), &ftCreate, &ftExit, 
+	&ftKernel, &ftUser);
+    writer_ms = cpu_ms(&ftKernel, &ftUser);
+
+    while (ok && (p + sizeof(*block) <= end)) {
+	block = (const REDMON_CAPTURE_BLOCK *)p;
+	p += sizeof(*block);
+	if ((block->cbStored > (DWORDLONG)(end - p)) || 
+	    (block->cbData > REDMON_CAPTURE_BLOCK_SIZE)) {
+	    fwprintf(stderr, L"  capture file is truncated\n");
+	    ok = FALSE;
+	    break;
+	}
+	if (block->cbData == 0)
+	    break;	/* end of job */
+
+	/* keep to the original pacing, scaled by speed */
+	if (speed > 0) {
+	    QueryPerformanceCounter(&now);
+	    elapsed = (now.QuadPart - start.QuadPart) * 1000.0 / freq.QuadPart;
+	    if (block->dwTime / speed > elapsed)
+		Sleep((DWORD)(block->dwTime / speed - elapsed));
+	}
+
+	if (block->dwFlags == REDMON_BLOCK_LZNT1) {
+	    if ((pRtlDecompressBuffer == NULL) ||
+		(pRtlDecompressBuffer(COMPRESSION_FORMAT_LZNT1, decompressed,
+		    sizeof(decompressed), (PUCHAR)p, block->cbStored, 
+		    &length) != 0) || (length != block->cbData)) {
+		fwprintf(stderr, L"  can't decompress block\n");
+		ok = FALSE;
+		break;
+	    }
+	    data = decompressed;
+	}
+	else
+	    data = p;	/* straight from the mapped file */
+	if (shared) {
+	    if (!ring_write(&ring, data, block->cbData, pi.hProcess)) {
+		fwprintf(stderr, L"  converter ended early\n");
+		ok = FALSE;
+	    }
+	}
+	else if (!write_all(hWrite, data, block->cbData)) {
+	    fwprintf(stderr, L"  converter closed stdin early\n");
+	    ok = FALSE;
+	}
+	result->qwBytes += block->cbData;
+	p += block->cbStored;
+    }
+
+    if (shared)
+	ring_close_write(&ring);
+    CloseHandle(hWrite);
+    GetThreadTimes(GetCurrentThread(), &ftCreate, &ftExit, 
+	&ftKernel, &ftUser);
+    result->dCpuMs = cpu_ms(&ftKernel, &ftUser) - writer_ms;
+    WaitForSingleObject(pi.hProcess, INFINITE);
+    QueryPerformanceCounter(&now);
+    result->dMs = (now.QuadPart - start.QuadPart) * 1000.0 / freq.QuadPart;
+    if (GetProcessTimes(pi.hProcess, &ftCreate, &ftExit, &ftKernel, &ftUser))
+	result->dCpuMs += cpu_ms(&ftKernel, &ftUser);
+    GetExitCodeProcess(pi.hProcess, &result->dwExitCode);
+    if (shared)
+	ring_destroy(&ring);
+    CloseHandle(pi.hProcess);
+    CloseHandle(pi.hThread);
+    return ok;
+}
+
+/* Map a capture file and replay it */
+BOOL
+replay_file(LPWSTR command, LPCWSTR filename, double speed, BOOL shared,
+    REPLAY_RESULT *result)
+{
+HANDLE hFile, hMap;
+LARGE_INTEGER size;
+const BYTE *base;
+BOOL ok = FALSE;
+    hFile = CreateFileW(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+	OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) {
+	fwprintf(stderr, L"  can't open file, error %lu\n", GetLastError());
+	return FALSE;
+    }
+    if (GetFileSizeEx(hFile, &size) && size.QuadPart) {
+	hMap = CreateFileMappingW(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (hMap != NULL) {
+	    base = (const BYTE *)MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, 0);
+	    if (base != NULL) {
+		ok = replay(command, base, size.QuadPart, speed, shared, 
+		    result);
+		UnmapViewOfFile(base);
+	    }
+	    CloseHandle(hMap);
+	}
+    }
+    CloseHandle(hFile);
+    return ok;
+}
+
+void
+usage(void)
+{
+    fwprintf(stderr, 
+      L"Usage: redreplay [-s speed] [-r repeat] [-m] \"command line\" file.rmc ...\n"
+      L"  -s 0  write as fast as the converter reads (default)\n"
+      L"  -s 1  original pacing, -s n is n times faster\n"
+      L"  -r n  replay each capture n times\n"
+      L"  -m    pass data in shared memory instead of stdin\n");
+}
+
+int
+wmain(int argc, wchar_t *argv[])
+{
+double speed = 0;
+int repeat = 1;
+BOOL shared = FALSE;
+int i, j;
+LPWSTR command;
+REPLAY_RESULT result;
+DWORDLONG qwTotalBytes = 0;
+double dTotalMs = 0;
+double dTotalCpuMs = 0;
+int jobs = 0, failed = 0;
+HMODULE hntdll;
+
+    for (i = 1; (i < argc) && (argv[i][0] == '-'); i++) {
+	if ((lstrcmpW(argv[i], L"-s") == 0) && (i + 1 < argc))
+	    speed = _wtof(argv[++i]);
+	else if ((lstrcmpW(argv[i], L"-r") == 0) && (i + 1 < argc))
+	    repeat = _wtoi(argv[++i]);
+	else if (lstrcmpW(argv[i], L"-m") == 0)
+	    shared = TRUE;
+	else {
+	    usage();
+	    return 1;
+	}
+    }
+    if ((argc - i < 2) || (speed < 0) || (repeat < 1)) {
+	usage();
+	return 1;
+    }
+    /* CreateProcess may modify the command line */
+    command = _wcsdup(argv[i++]);
+
+    hntdll = GetModuleHandleW(L"ntdll.dll");
+    if (hntdll)
+	pRtlDecompressBuffer = (PFN_RTLDECOMPRESSBUFFER)
+	    GetProcAddress(hntdll, "RtlDecompressBuffer");
+
+    for (; i < argc; i++) {
+	for (j = 0; j < repeat; j++) {
+	    wprintf(L"%s: ", argv[i]);
+	    if (!replay_file(command, argv[i], speed, shared, &result)) {
+		wprintf(L"failed\n");
+		failed++;
+		continue;
+	    }
+	    wprintf(L"%I64u bytes, %.1f ms, %.2f MB/s, "
+		L"%.0f CPU ms/GB, exit code %lu\n",
+		result.qwBytes, result.dMs, 
+		result.dMs ? result.qwBytes / 1048.576 / result.dMs : 0.0,
+		result.qwBytes ? 
+		    result.dCpuMs * 1073741824.0 / result.qwBytes : 0.0,
+		result.dwExitCode);
+	    qwTotalBytes += result.qwBytes;
+	    dTotalMs += result.dMs;
+	    dTotalCpuMs += result.dCpuMs;
+	    jobs++;
+	}
+    }
+    wprintf(L"Total (%s): %d jobs, %d failed, %I64u bytes, %.1f ms, "
+	L"%.2f MB/s, %.0f CPU ms/GB\n",
+	shared ? L"shared memory" : L"stdin",
+	jobs, failed, qwTotalBytes, dTotalMs, 
+	dTotalMs ? qwTotalBytes / 1048.576 / dTotalMs : 0.0,
+	qwTotalBytes ? dTotalCpuMs * 1073741824.0 / qwTotalBytes : 0.0);
+    free(command);
+    return failed ? 2 : 0;
+}
@@ -0,0 +1,322 @@
+/* redring.h */
+
+/*
+ * Shared memory ring for passing print data from RedMon (or redreplay)
+ * to the converter, instead of the stdin pipe.
+ *
+ * The writer creates an unnamed file mapping and two auto-reset events.
+ * None of them are inheritable, since converters for other jobs (and
+ * other users) may be started while the ring is open.  Once the 
+ * converter has started, ring_give() duplicates the handles into it
+ * and writes their values in the converter as the first line of its
+ * stdin: four hexadecimal numbers separated by commas, then a newline
+ * (mapping,data event,space event,writer process).  An empty line 
+ * means the ring couldn't be given, and the data follows on stdin 
+ * as usual.
+ * The REDMON_RING environment variable is set to "stdin" to tell 
+ * the converter to read this line before anything else.
+ *
+ * lHead and lTail count bytes written and read, modulo 2^32,
+ * so the ring is empty when they are equal.  Only the writer changes 
+ * lHead and only the reader changes lTail.
+ * Each side can write to the whole mapping, so neither trusts what
+ * the other side puts there.  The size and offset of the data area,
+ * and the side's own count, are kept in REDMON_RING_HANDLES; the 
+ * other side's count is only used after checking that no more than 
+ * dwSize bytes are in the ring.  A ring which fails this check is 
+ * broken, and the job fails.
+ * A side which finds the ring empty (or full) sets its waiting flag,
+ * checks again, then waits for its event.  The other side only sets 
+ * the event if the flag is set, so there are no kernel calls while 
+ * both sides are busy.
+ * The reader also waits for the writer's process (with SYNCHRONIZE
+ * access only), so it doesn't wait forever if the writer goes away.
+ * If the writer destroys the ring before writing all the data (the 
+ * job was cancelled or failed), it sets lWriterFailed.  Either way 
+ * the reader finds the ring broken.
+ *
+ * The converter's stdin pipe is still connected, so a converter 
+ * which doesn't understand REDMON_RING can't be used with the ring.
+ *
+ * These functions use only the Win32 API, since RedMon avoids the 
+ * C run time library.
+ */
+
+#ifndef REDRING_H
+#define REDRING_H
+
+#define REDMON_RING_VAR "REDMON_RING"
+#define REDMON_RING_STDIN "stdin"	/* value of REDMON_RING_VAR */
+#define REDMON_RING_SIZE (1024*1024)	/* bytes, a power of two */
+
+typedef struct redmon_ring_s {
+    DWORD dwSize;		/* bytes in data area, a power of two */
+    DWORD dwOffset;		/* offset of data area from the ring */
+    volatile LONG lWriterDone;	/* TRUE when all data has been written */
+    volatile LONG lReaderWaiting;	/* reader is waiting for data */
+    volatile LONG lWriterWaiting;	/* writer is waiting for space */
+    volatile LONG lWriterFailed;	/* TRUE if not all data was written */
+    BYTE pad1[40];
+    volatile LONG lHead;	/* bytes written, only changed by writer */
+    BYTE pad2[60];
+    volatile LONG lTail;	/* bytes read, only changed by reader */
+    BYTE pad3[60];
+} REDMON_RING;
+
+typedef struct redmon_ring_handles_s {
+    REDMON_RING *ring;		/* mapped view, or NULL if not in use */
+    HANDLE hMap;		/* file mapping */
+    HANDLE hData;		/* set by writer when data is available */
+    HANDLE hSpace;		/* set by reader when space is available */
+    HANDLE hWriter;		/* reader: the writer's process */
+    LPBYTE base;		/* data area */
+    DWORD dwSize;		/* bytes in data area, a power of two */
+    DWORD dwCount;		/* bytes written (writer) or read (reader) */
+    BOOL broken;		/* reader: the ring was broken */
+} REDMON_RING_HANDLES;
+
+/* Create a ring, with handles which aren't inherited.
+ * Return FALSE on failure. */
+static BOOL
+ring_create(REDMON_RING_HANDLES *ph, DWORD size)
+{
+    ph->ring = NULL;
+    ph->hData = CreateEvent(NULL, FALSE, FALSE, NULL);
+    ph->hSpace = CreateEvent(NULL, FALSE, FALSE, NULL);
+    ph->hMap = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+	0, sizeof(REDMON_RING) + size, NULL);
+    if ((ph->hData != NULL) && (ph->hSpace != NULL) && (ph->hMap != NULL))
+	ph->ring = (REDMON_RING *)MapViewOfFile(ph->hMap, FILE_MAP_WRITE, 
+	    0, 0, 0);
+    if (ph->ring == NULL) {
+	if (ph->hData != NULL)
+	    CloseHandle(ph->hData);
+	if (ph->hSpace != NULL)
+	    CloseHandle(ph->hSpace);
+	if (ph->hMap != NULL)
+	    CloseHandle(ph->hMap);
+	ph->hData = ph->hSpace = ph->hMap = NULL;
+	return FALSE;
+    }
+    /* new mappings are zero filled */
+    ph->ring->dwSize = size;
+    ph->ring->dwOffset = sizeof(REDMON_RING);
+    ph->base = (LPBYTE)ph->ring + sizeof(REDMON_RING);
+    ph->dwSize = size;
+    ph->dwCount = 0;
+    ph->broken = FALSE;
+    return TRUE;
+}
+
+/* Give the converter hProcess its own handles to the ring, and write 
+ * them to its stdin pipe hWrite.  If they can't be duplicated, an empty
+ * line is written and FALSE returned; the ring should then be 
+ * destroyed and the data written to stdin.
+ */
+static BOOL
+ring_give(REDMON_RING_HANDLES *ph, HANDLE hProcess, HANDLE hWrite)
+{
+HANDLE hMap = NULL, hData = NULL, hSpace = NULL, hWriter = NULL;
+char line[64];
+DWORD dwWritten;
+BOOL flag;
+    flag = DuplicateHandle(GetCurrentProcess(), ph->hMap, hProcess, &hMap,
+	    0, FALSE, DUPLICATE_SAME_ACCESS) &&
+	DuplicateHandle(GetCurrentProcess(), ph->hData, hProcess, &hData,
+	    0, FALSE, DUPLICATE_SAME_ACCESS) &&
+	DuplicateHandle(GetCurrentProcess(), ph->hSpace, hProcess, &hSpace,
+	    0, FALSE, DUPLICATE_SAME_ACCESS) &&
+	DuplicateHandle(GetCurrentProcess(), GetCurrentProcess(), hProcess,
+	    &hWriter, SYNCHRONIZE, FALSE, 0);
+    if (flag)
+	/* Kernel handles have only 32 significant bits, even on Win64 */
+	wsprintfA(line, "%x,%x,%x,%x\n", (DWORD)(DWORD_PTR)hMap, 
+	    (DWORD)(DWORD_PTR)hData, (DWORD)(DWORD_PTR)hSpace,
+	    (DWORD)(DWORD_PTR)hWriter);
+    else {
+	/* close the handles which were given */
+	if (hMap != NULL)
+	    DuplicateHandle(hProcess, hMap, NULL, NULL, 0, FALSE,
+		DUPLICATE_CLOSE_SOURCE);
+	if (hData != NULL)
+	    DuplicateHandle(hProcess, hData, NULL, NULL, 0, FALSE,
+		DUPLICATE_CLOSE_SOURCE);
+	if (hSpace != NULL)
+	    DuplicateHandle(hProcess, hSpace, NULL, NULL, 0, FALSE,
+		DUPLICATE_CLOSE_SOURCE);
+	lstrcpyA(line, "\n");
+    }
+    if (!WriteFile(hWrite, line, lstrlenA(line), &dwWritten, NULL))
+	flag = FALSE;
+    return flag;
+}
+
+/* Map a ring created by the writer, once ph->hMap, ph->hData,
+ * ph->hSpace and ph->hWriter are set.  The data area must lie within the view.
+ * Return FALSE on failure. */
+static BOOL
+ring_open(REDMON_RING_HANDLES *ph)
+{
+MEMORY_BASIC_INFORMATION mbi;
+DWORD size, offset;
+    ph->ring = (REDMON_RING *)MapViewOfFile(ph->hMap, FILE_MAP_WRITE, 
+	0, 0, 0);
+    if (ph->ring == NULL)
+	return FALSE;
+    size = ph->ring->dwSize;
+    offset = ph->ring->dwOffset;
+    if ((VirtualQuery(ph->ring, &mbi, sizeof(mbi)) != sizeof(mbi)) ||
+	(size == 0) || ((size & (size - 1)) != 0) ||
+	(offset < sizeof(REDMON_RING)) || (offset > mbi.RegionSize) ||
+	(size > mbi.RegionSize - offset)) {
+	UnmapViewOfFile(ph->ring);
+	ph->ring = NULL;
+	return FALSE;
+    }
+    ph->base = (LPBYTE)ph->ring + offset;
+    ph->dwSize = size;
+    ph->dwCount = (DWORD)ph->ring->lTail;
+    ph->broken = FALSE;
+    return TRUE;
+}
+
+/* Unmap the ring and close the handles.
+ * If the writer hasn't called ring_close_write(), the reader is told 
+ * the data is incomplete. */
+static void
+ring_destroy(REDMON_RING_HANDLES *ph)
+{
+    if ((ph->ring != NULL) && !ph->ring->lWriterDone) {
+	InterlockedExchange(&ph->ring->lWriterFailed, TRUE);
+	InterlockedExchange(&ph->ring->lWriterDone, TRUE);
+	SetEvent(ph->hData);
+    }
+    if (ph->ring != NULL)
+	UnmapViewOfFile(ph->ring);
+    if (ph->hData != NULL)
+	CloseHandle(ph->hData);
+    if (ph->hSpace != NULL)
+	CloseHandle(ph->hSpace);
+    if (ph->hMap != NULL)
+	CloseHandle(ph->hMap);
+    ph->ring = NULL;
+    ph->hData = ph->hSpace = ph->hMap = NULL;
+}
+
+/* Write all of the data to the ring.
+ * Waits for the reader to make space, but gives up and returns FALSE 
+ * if hProcess (the reader) ends, or with ERROR_INVALID_DATA if the 
+ * reader has broken the ring.
+ */
+static BOOL
+ring_write(REDMON_RING_HANDLES *ph, const BYTE *data, DWORD len, 
+    HANDLE hProcess)
+{
+REDMON_RING *ring = ph->ring;
+HANDLE handles[2];
+DWORD used, space, pos, count;
+    handles[0] = ph->hSpace;
+    handles[1] = hProcess;
+    while (len) {
+	used = ph->dwCount - (DWORD)ring->lTail;
+	if (used > ph->dwSize) {
+	    SetLastError(ERROR_INVALID_DATA);
+	    return FALSE;
+	}
+	space = ph->dwSize - used;
+	if (space == 0) {
+	    InterlockedExchange(&ring->lWriterWaiting, TRUE);
+	    if (ph->dwCount - (DWORD)ring->lTail == ph->dwSize) {
+		if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) 
+		    != WAIT_OBJECT_0)
+		    return FALSE;	/* reader has gone */
+	    }
+	    InterlockedExchange(&ring->lWriterWaiting, FALSE);
+	    continue;
+	}
+	count = (len < space) ? len : space;
+	pos = ph->dwCount & (ph->dwSize - 1);
+	if (pos + count > ph->dwSize) {
+	    CopyMemory(ph->base + pos, data, ph->dwSize - pos);
+	    CopyMemory(ph->base, data + ph->dwSize - pos, 
+		count - (ph->dwSize - pos));
+	}
+	else
+	    CopyMemory(ph->base + pos, data, count);
+	ph->dwCount += count;
+	/* publish the data, with a full barrier */
+	InterlockedExchange(&ring->lHead, (LONG)ph->dwCount);
+	if (InterlockedCompareExchange(&ring->lReaderWaiting, FALSE, FALSE))
+	    SetEvent(ph->hData);
+	data += count;
+	len -= count;
+    }
+    return TRUE;
+}
+
+/* Tell the reader there is no more data */
+static void
+ring_close_write(REDMON_RING_HANDLES *ph)
+{
+    InterlockedExchange(&ph->ring->lWriterDone, TRUE);
+    SetEvent(ph->hData);
+}
+
+/* Read up to len bytes from the ring, waiting for at least one.
+ * Returns 0 when the writer has finished and the ring is empty,
+ * or with ph->broken set if the writer has broken the ring, 
+ * failed, or gone away.
+ */
+static DWORD
+ring_read(REDMON_RING_HANDLES *ph, BYTE *buf, DWORD len)
+{
+REDMON_RING *ring = ph->ring;
+HANDLE handles[2];
+DWORD avail, pos, count;
+    handles[0] = ph->hData;
+    handles[1] = ph->hWriter;
+    while (1) {
+	avail = (DWORD)ring->lHead - ph->dwCount;
+	if (avail > ph->dwSize) {
+	    ph->broken = TRUE;
+	    return 0;
+	}
+	if (avail)
+	    break;
+	if (ring->lWriterDone) {
+	    if (ring->lWriterFailed) {
+		ph->broken = TRUE;
+		return 0;
+	    }
+	    /* data may have been written just before */
+	    if ((DWORD)ring->lHead == ph->dwCount)
+		return 0;
+	    continue;
+	}
+	InterlockedExchange(&ring->lReaderWaiting, TRUE);
+	if (((DWORD)ring->lHead == ph->dwCount) && !ring->lWriterDone &&
+	    (WaitForMultipleObjects(2, handles, FALSE, INFINITE) 
+		!= WAIT_OBJECT_0)) {
+	    ph->broken = TRUE;	/* writer has gone */
+	    return 0;
+	}
+	InterlockedExchange(&ring->lReaderWaiting, FALSE);
+    }
+    count = (len < avail) ? len : avail;
+    pos = ph->dwCount & (ph->dwSize - 1);
+    if (pos + count > ph->dwSize) {
+	CopyMemory(buf, ph->base + pos, ph->dwSize - pos);
+	CopyMemory(buf + ph->dwSize - pos, ph->base, 
+	    count - (ph->dwSize - pos));
+    }
+    else
+	CopyMemory(buf, ph->base + pos, count);
+    ph->dwCount += count;
+    /* release the space, with a full barrier */
+    InterlockedExchange(&ring->lTail, (LONG)ph->dwCount);
+    if (InterlockedCompareExchange(&ring->lWriterWaiting, FALSE, FALSE))
+	SetEvent(ph->hSpace);
+    return count;
+}
+
+#endif /* REDRING_H */
@@ -0,0 +1,56 @@
+/* redstats.h */
+
+/*
+ * Live statistics for a RedMon port.
+ *
+ * RedMon keeps these in a named shared memory block, so that
+ * monitoring programs can spot stalled ports without enabling 
+ * the debug log.  The name is REDMON_STATS_NAME followed by the 
+ * port name, with any '\' replaced by '_'.  On Windows NT the 
+ * name is in the Global\ namespace, since the spooler doesn't 
+ * run in the user's session.
+ *
+ * Readers don't need a lock.  lSequence is odd while an update 
+ * is in progress, so a reader should copy the block and try again 
+ * if lSequence was odd or changed during the copy.
+ * If a block with the same name already exists but has a different 
+ * dwSize or dwVersion (e.g. from another build of RedMon), the port 
+ * leaves it alone and doesn't publish statistics.
+ * When the port has converter workers, several jobs may run at once.
+ * The job counters are then shared by the running jobs, but the 
+ * totals are still exact.
+ */
+
+#ifdef UNICODE
+#define REDMON_STATS_NAME TEXT("Global\\RedMonStats ")
+#else
+#define REDMON_STATS_NAME TEXT("RedMonStats ")
+#endif
+#define REDMON_STATS_VERSION 2
+
+typedef struct redmon_counters_s {
+    DWORDLONG qwBytesIn;	/* bytes written to the port by the spooler */
+    DWORDLONG qwBytesOut;	/* bytes read from converter stdout or pipe */
+    DWORDLONG qwBlockedMs;	/* ms WritePort waited for the converter */
+    DWORD dwBackoffSleeps;	/* sleeps while waiting for the converter */
+    DWORD dwDurationMs;		/* StartDocPort to EndDocPort */
+    DWORDLONG qwCpuMs;		/* converter user + kernel time */
+    DWORDLONG qwPeakMemory;	/* converter peak working set in bytes,
+				 * for totals the largest of any job */
+} REDMON_COUNTERS;
+
+typedef struct redmon_stats_s {
+    DWORD dwSize;		/* sizeof(REDMON_STATS) */
+    DWORD dwVersion;		/* REDMON_STATS_VERSION */
+    LONG lSequence;		/* odd while an update is in progress */
+    DWORD dwActive;		/* number of jobs running */
+    DWORD dwJobId;		/* current or last job */
+    DWORD dwJobs;		/* jobs started */
+    DWORD dwErrors;		/* jobs where the converter failed */
+    DWORD dwCancels;		/* jobs cancelled by RedMon */
+    REDMON_COUNTERS job;	/* current or last job */
+    REDMON_COUNTERS total;	/* all jobs since the port was opened */
+    /* version 2 */
+    DWORD dwMemoryLimits;	/* converters refused memory by a job limit */
+    DWORD dwAbnormalExits;	/* converters in a job object which crashed */
+} REDMON_STATS;